@@ -0,0 +1,63 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ASYNC_OPERATION_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ASYNC_OPERATION_H_
+
+#include "google/cloud/bigtable/version.h"
+#include <chrono>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * The result of an asynchronous timer.
+ *
+ * Applications receive this value when a timer created with
+ * `CompletionQueue::MakeRelativeTimer()` (or similar functions) expires, or is
+ * cancelled.
+ */
+struct AsyncTimerResult {
+  std::chrono::system_clock::time_point deadline;
+  bool cancelled;
+};
+
+/**
+ * An asynchronous operation.
+ *
+ * Applications receive instances of this class (wrapped in a
+ * `std::shared_ptr<>`) when they start an asynchronous operation.  The only
+ * action they can take is to request the cancellation of the operation.
+ */
+class AsyncOperation {
+ public:
+  virtual ~AsyncOperation() = default;
+
+  /**
+   * Requests that the operation be cancelled.
+   *
+   * Cancellation is best-effort: the operation may complete before the
+   * cancellation takes effect.  In any case, the callback associated with the
+   * operation is invoked exactly once.
+   */
+  virtual void Cancel() = 0;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ASYNC_OPERATION_H_
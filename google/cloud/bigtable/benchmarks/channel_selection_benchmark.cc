@@ -0,0 +1,109 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/common_client.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+/**
+ * @file
+ *
+ * Measure the cost of selecting a channel in `internal::CommonClient`.
+ *
+ * Every RPC made through a `bigtable::DataClient` first selects one of the
+ * channels in the connection pool.  This benchmark measures how many
+ * selections per second the client can make when many threads share it, using
+ * both the default round-robin selection and the load-aware selection.  The
+ * benchmark does not make any RPCs, the channels are never connected.
+ *
+ * Usage: channel_selection_benchmark [iterations-per-thread] [pool-size]
+ */
+
+/// Helper functions and types for the channel_selection_benchmark.
+namespace {
+namespace bigtable = google::cloud::bigtable;
+namespace btproto = google::bigtable::v2;
+
+struct BenchmarkTraits {
+  static std::string const& Endpoint(bigtable::ClientOptions& options) {
+    return options.data_endpoint();
+  }
+};
+
+using Client =
+    bigtable::internal::CommonClient<BenchmarkTraits, btproto::Bigtable>;
+
+constexpr int kThreadCounts[] = {1, 4, 16, 64};
+
+/// Run @p thread_count threads, each selecting @p iterations stubs.
+double RunBenchmark(Client& client, int thread_count, long iterations,
+                    bool counted) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i != thread_count; ++i) {
+    threads.emplace_back([&client, iterations, counted] {
+      for (long j = 0; j != iterations; ++j) {
+        if (counted) {
+          bigtable::internal::CallGuard guard;
+          (void)client.Stub(guard);
+        } else {
+          (void)client.Stub();
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - start);
+  return static_cast<double>(thread_count * iterations) / elapsed.count();
+}
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) try {
+  long iterations = 1000000;
+  std::size_t pool_size = 8;
+  if (argc > 1) {
+    iterations = std::stol(argv[1]);
+  }
+  if (argc > 2) {
+    pool_size = std::stoul(argv[2]);
+  }
+
+  std::cout << "Mode,Threads,PoolSize,SelectionsPerSecond" << std::endl;
+  for (bool load_aware : {false, true}) {
+    Client client(bigtable::ClientOptions(grpc::InsecureChannelCredentials())
+                      .set_data_endpoint("localhost:1")
+                      .set_connection_pool_size(pool_size)
+                      .set_load_aware_channel_selection(load_aware));
+    // Create the channels before measuring anything.
+    (void)client.Stub();
+    for (auto thread_count : kThreadCounts) {
+      auto throughput =
+          RunBenchmark(client, thread_count, iterations, load_aware);
+      std::cout << (load_aware ? "LoadAware" : "RoundRobin") << ","
+                << thread_count << "," << pool_size << "," << throughput
+                << std::endl;
+    }
+  }
+
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception raised: " << ex.what() << std::endl;
+  return 1;
+}
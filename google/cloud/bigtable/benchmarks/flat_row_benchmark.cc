@@ -0,0 +1,130 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/flat_row.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+/**
+ * @file
+ *
+ * Measure the memory used to keep rows in memory as `Row` vs. `FlatRow`.
+ *
+ * The benchmark creates many rows, each with a number of columns and versions
+ * typical of metrics tables, and reports the heap memory used to hold them as
+ * `Row` objects (i.e. `std::vector<Cell>`) and as `FlatRow` objects, as well
+ * as the time to convert them.  The heap usage is measured by replacing the
+ * global `operator new` and `operator delete`.
+ *
+ * Usage: flat_row_benchmark [row-count] [columns] [versions] [value-size]
+ */
+
+/// Helper functions and types for the flat_row_benchmark.
+namespace {
+namespace bigtable = google::cloud::bigtable;
+
+std::atomic<long> live_bytes(0);
+
+/// The size of each allocation is stored before the returned pointer.
+constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+bigtable::Row MakeRow(long index, int columns, int versions, int value_size) {
+  std::ostringstream os;
+  os << "metrics/host-" << index;
+  auto key = os.str();
+  std::vector<bigtable::Cell> cells;
+  for (int c = 0; c != columns; ++c) {
+    for (int v = 0; v != versions; ++v) {
+      cells.emplace_back(key, "stats", "column-" + std::to_string(c),
+                         (versions - v) * 1000,
+                         std::string(static_cast<std::size_t>(value_size), 'x'),
+                         std::vector<std::string>{});
+    }
+  }
+  return bigtable::Row(std::move(key), std::move(cells));
+}
+}  // anonymous namespace
+
+void* operator new(std::size_t size) {
+  auto* p = static_cast<char*>(std::malloc(size + kHeader));
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<std::size_t*>(p) = size;
+  live_bytes += static_cast<long>(size);
+  return p + kHeader;
+}
+
+void operator delete(void* ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto* p = static_cast<char*>(ptr) - kHeader;
+  live_bytes -= static_cast<long>(*reinterpret_cast<std::size_t*>(p));
+  std::free(p);
+}
+
+int main(int argc, char* argv[]) try {
+  long row_count = 100000;
+  int columns = 10;
+  int versions = 3;
+  int value_size = 8;
+  if (argc > 1) {
+    row_count = std::stol(argv[1]);
+  }
+  if (argc > 2) {
+    columns = std::stoi(argv[2]);
+  }
+  if (argc > 3) {
+    versions = std::stoi(argv[3]);
+  }
+  if (argc > 4) {
+    value_size = std::stoi(argv[4]);
+  }
+
+  auto const baseline = live_bytes.load();
+  std::vector<bigtable::Row> rows;
+  rows.reserve(static_cast<std::size_t>(row_count));
+  for (long i = 0; i != row_count; ++i) {
+    rows.emplace_back(MakeRow(i, columns, versions, value_size));
+  }
+  auto const row_bytes = live_bytes.load() - baseline;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<bigtable::FlatRow> flat_rows;
+  flat_rows.reserve(rows.size());
+  for (auto const& r : rows) {
+    flat_rows.emplace_back(r);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  auto const flat_bytes = live_bytes.load() - baseline - row_bytes;
+
+  std::cout << "Rows,Columns,Versions,ValueSize,RowBytes,FlatRowBytes,Ratio"
+            << ",ConversionUsPerRow" << std::endl;
+  std::cout << row_count << "," << columns << "," << versions << ","
+            << value_size << "," << row_bytes << "," << flat_bytes << ","
+            << static_cast<double>(row_bytes) / flat_bytes << ","
+            << static_cast<double>(elapsed.count()) / row_count << std::endl;
+
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception raised: " << ex.what() << std::endl;
+  return 1;
+}
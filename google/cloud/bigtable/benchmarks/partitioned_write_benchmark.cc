@@ -0,0 +1,201 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/partitioned_bulk_writer.h"
+#include "google/cloud/internal/random.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <set>
+#include <thread>
+
+/**
+ * @file
+ *
+ * Measure the latency of `Table::BulkApply()` vs. `PartitionedBulkWriter`.
+ *
+ * The benchmark starts an embedded server that simulates a table with a
+ * number of tablets.  Each tablet has a fixed latency, and every fourth tablet
+ * is five times slower than the rest.  The server applies the entries in a
+ * `MutateRows` request one tablet at a time, so the latency of a request is
+ * the sum of the latencies of the tablets it touches.  The benchmark applies
+ * batches of mutations with random row keys, first using `Table::BulkApply()`
+ * and then using a `PartitionedBulkWriter`, and reports the latency of each
+ * batch.
+ *
+ * Usage: partitioned_write_benchmark [tablets] [batch-size] [iterations]
+ *     [max-concurrency] [tablet-latency-ms]
+ */
+
+/// Helper functions and types for the partitioned_write_benchmark.
+namespace {
+namespace bigtable = google::cloud::bigtable;
+namespace btproto = google::bigtable::v2;
+
+constexpr long kKeySpace = 1000000;
+
+std::string MakeKey(long index) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "user%012ld", index);
+  return buf;
+}
+
+/// Simulate a table with @p tablets tablets of (roughly) the same size.
+class PartitionedBigtableImpl final : public btproto::Bigtable::Service {
+ public:
+  PartitionedBigtableImpl(int tablets, std::chrono::milliseconds latency)
+      : tablet_latency_(latency) {
+    for (int i = 1; i < tablets; ++i) {
+      split_keys_.push_back(MakeKey(kKeySpace * i / tablets));
+    }
+  }
+
+  grpc::Status SampleRowKeys(
+      grpc::ServerContext*, btproto::SampleRowKeysRequest const*,
+      grpc::ServerWriter<btproto::SampleRowKeysResponse>* writer) override {
+    btproto::SampleRowKeysResponse msg;
+    for (auto const& key : split_keys_) {
+      msg.set_row_key(key);
+      writer->Write(msg);
+    }
+    msg.set_row_key("");
+    writer->WriteLast(msg, grpc::WriteOptions());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status MutateRows(
+      grpc::ServerContext*, btproto::MutateRowsRequest const* request,
+      grpc::ServerWriter<btproto::MutateRowsResponse>* writer) override {
+    std::set<std::size_t> tablets;
+    btproto::MutateRowsResponse msg;
+    for (int index = 0; index != request->entries_size(); ++index) {
+      auto const& key = request->entries(index).row_key();
+      tablets.insert(static_cast<std::size_t>(
+          std::upper_bound(split_keys_.begin(), split_keys_.end(), key) -
+          split_keys_.begin()));
+      auto& entry = *msg.add_entries();
+      entry.set_index(index);
+      entry.mutable_status()->set_code(grpc::StatusCode::OK);
+    }
+    std::chrono::microseconds latency(0);
+    for (auto t : tablets) {
+      latency += (t % 4 == 3) ? 5 * tablet_latency_ : tablet_latency_;
+    }
+    std::this_thread::sleep_for(latency);
+    writer->WriteLast(msg, grpc::WriteOptions());
+    return grpc::Status::OK;
+  }
+
+ private:
+  std::chrono::milliseconds tablet_latency_;
+  std::vector<std::string> split_keys_;
+};
+
+bigtable::BulkMutation MakeBatch(google::cloud::internal::DefaultPRNG& gen,
+                                 int batch_size) {
+  std::uniform_int_distribution<long> key_dist(0, kKeySpace - 1);
+  bigtable::BulkMutation mut;
+  for (int i = 0; i != batch_size; ++i) {
+    mut.emplace_back(bigtable::SingleRowMutation(
+        MakeKey(key_dist(gen)),
+        {bigtable::SetCell("cf", "col", std::chrono::milliseconds(0), "v")}));
+  }
+  return mut;
+}
+
+/// Run @p iterations batches using @p apply, print the latency percentiles.
+void RunBenchmark(char const* mode, int iterations, int batch_size,
+                  std::function<void(bigtable::BulkMutation&&)> const& apply) {
+  auto gen = google::cloud::internal::MakeDefaultPRNG();
+  std::vector<std::chrono::microseconds> latencies;
+  for (int i = 0; i != iterations; ++i) {
+    auto mut = MakeBatch(gen, batch_size);
+    auto start = std::chrono::steady_clock::now();
+    apply(std::move(mut));
+    latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&latencies](double p) {
+    auto index = static_cast<std::size_t>(p * (latencies.size() - 1));
+    return latencies[index].count();
+  };
+  std::cout << mode << "," << batch_size << "," << percentile(0.0) << ","
+            << percentile(0.5) << "," << percentile(0.99) << ","
+            << percentile(1.0) << std::endl;
+}
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) try {
+  int tablets = 16;
+  int batch_size = 1000;
+  int iterations = 50;
+  std::size_t max_concurrency = 16;
+  std::chrono::milliseconds tablet_latency(10);
+  if (argc > 1) {
+    tablets = std::stoi(argv[1]);
+  }
+  if (argc > 2) {
+    batch_size = std::stoi(argv[2]);
+  }
+  if (argc > 3) {
+    iterations = std::stoi(argv[3]);
+  }
+  if (argc > 4) {
+    max_concurrency = std::stoul(argv[4]);
+  }
+  if (argc > 5) {
+    tablet_latency = std::chrono::milliseconds(std::stol(argv[5]));
+  }
+
+  PartitionedBigtableImpl service(tablets, tablet_latency);
+  int port;
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("[::]:0", grpc::InsecureServerCredentials(), &port);
+  builder.RegisterService(&service);
+  auto server = builder.BuildAndStart();
+
+  auto client = bigtable::CreateDefaultDataClient(
+      "benchmark-project", "benchmark-instance",
+      bigtable::ClientOptions(grpc::InsecureChannelCredentials())
+          .set_data_endpoint("localhost:" + std::to_string(port))
+          .set_connection_pool_size(max_concurrency));
+  bigtable::Table table(client, "benchmark-table");
+
+  std::cout << "Mode,BatchSize,MinUs,P50Us,P99Us,MaxUs" << std::endl;
+  RunBenchmark("BulkApply", iterations, batch_size,
+               [&table](bigtable::BulkMutation&& mut) {
+                 table.BulkApply(std::move(mut));
+               });
+
+  auto splits = std::make_shared<bigtable::SplitPointCache>(
+      bigtable::noex::Table(client, "benchmark-table"),
+      std::chrono::milliseconds(0));
+  bigtable::PartitionedBulkWriter writer(table, splits, max_concurrency);
+  RunBenchmark("Partitioned", iterations, batch_size,
+               [&writer](bigtable::BulkMutation&& mut) {
+                 writer.BulkApply(std::move(mut));
+               });
+
+  server->Shutdown();
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception raised: " << ex.what() << std::endl;
+  return 1;
+}
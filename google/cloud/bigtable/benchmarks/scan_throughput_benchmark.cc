@@ -45,7 +45,10 @@
  *     - Go back and pick a new random key.
  *
  * The benchmark will report throughput in rows per second for each scans with
- * 100, 1,000 and 10,000 rows.
+ * 100, 1,000 and 10,000 rows.  Each scan size is measured twice, once using
+ * `bigtable::Table::ReadRows()` and once using
+ * `bigtable::Table::ReadRowViews()`, which does not copy the cells into
+ * `bigtable::Row` objects.
  *
  * Using a command-line parameter the benchmark can be configured to create a
  * local gRPC server that implements the Cloud Bigtable APIs used by the
@@ -65,7 +68,7 @@ constexpr int kScanSizes[] = {100, 1000, 10000};
 BenchmarkResult RunBenchmark(bigtable::benchmarks::Benchmark const& benchmark,
                              std::shared_ptr<bigtable::DataClient> data_client,
                              long table_size, std::string const& table_id,
-                             long scan_size,
+                             long scan_size, bool use_views,
                              std::chrono::seconds test_duration);
 }  // anonymous namespace
 
@@ -83,20 +86,23 @@ int main(int argc, char* argv[]) try {
   auto data_client = benchmark.MakeDataClient();
   std::map<std::string, BenchmarkResult> results_by_size;
   for (auto scan_size : kScanSizes) {
-    std::cout << "# Running benchmark [" << scan_size << "] " << std::flush;
-    auto start = std::chrono::steady_clock::now();
-    auto combined =
-        RunBenchmark(benchmark, data_client, setup.table_size(),
-                     setup.table_id(), scan_size, setup.test_duration());
-    using std::chrono::duration_cast;
-    combined.elapsed = duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - start);
-    std::cout << " DONE. Elapsed=" << FormatDuration(combined.elapsed)
-              << ", Ops=" << combined.operations.size()
-              << ", Rows=" << combined.row_count << std::endl;
-    auto op_name = "Scan(" + std::to_string(scan_size) + ")";
-    benchmark.PrintLatencyResult(std::cout, "scant", op_name, combined);
-    results_by_size[op_name] = std::move(combined);
+    for (bool use_views : {false, true}) {
+      auto op_name = std::string(use_views ? "ScanViews(" : "Scan(") +
+                     std::to_string(scan_size) + ")";
+      std::cout << "# Running benchmark [" << op_name << "] " << std::flush;
+      auto start = std::chrono::steady_clock::now();
+      auto combined = RunBenchmark(benchmark, data_client, setup.table_size(),
+                                   setup.table_id(), scan_size, use_views,
+                                   setup.test_duration());
+      using std::chrono::duration_cast;
+      combined.elapsed = duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start);
+      std::cout << " DONE. Elapsed=" << FormatDuration(combined.elapsed)
+                << ", Ops=" << combined.operations.size()
+                << ", Rows=" << combined.row_count << std::endl;
+      benchmark.PrintLatencyResult(std::cout, "scant", op_name, combined);
+      results_by_size[op_name] = std::move(combined);
+    }
   }
 
   std::cout << bigtable::benchmarks::Benchmark::ResultsCsvHeader() << std::endl;
@@ -119,7 +125,7 @@ namespace {
 BenchmarkResult RunBenchmark(bigtable::benchmarks::Benchmark const& benchmark,
                              std::shared_ptr<bigtable::DataClient> data_client,
                              long table_size, std::string const& table_id,
-                             long scan_size,
+                             long scan_size, bool use_views,
                              std::chrono::seconds test_duration) {
   BenchmarkResult result = {};
 
@@ -134,11 +140,17 @@ BenchmarkResult RunBenchmark(bigtable::benchmarks::Benchmark const& benchmark,
         bigtable::RowRange::StartingAt(benchmark.MakeKey(prng(generator)));
 
     long count = 0;
-    auto op = [&count, &table, &scan_size, &range]() {
-      auto reader =
-          table.ReadRows(bigtable::RowSet(std::move(range)), scan_size,
-                         bigtable::Filter::ColumnRangeClosed(
-                             kColumnFamily, "field0", "field9"));
+    auto op = [&count, &table, &scan_size, &range, use_views]() {
+      auto filter = bigtable::Filter::ColumnRangeClosed(kColumnFamily,
+                                                        "field0", "field9");
+      if (use_views) {
+        auto reader = table.ReadRowViews(bigtable::RowSet(std::move(range)),
+                                         scan_size, std::move(filter));
+        count = std::distance(reader.begin(), reader.end());
+        return;
+      }
+      auto reader = table.ReadRows(bigtable::RowSet(std::move(range)),
+                                   scan_size, std::move(filter));
       count = std::distance(reader.begin(), reader.end());
     };
     result.operations.push_back(Benchmark::TimeOperation(op));
@@ -2,26 +2,48 @@
 bigtable_client_HDRS = [
     "admin_client.h",
     "app_profile_config.h",
+    "async_operation.h",
     "bigtable_strong_types.h",
+    "bulk_apply_merge_policy.h",
+    "bulk_apply_rate_limiter.h",
+    "bulk_apply_split_policy.h",
     "cell.h",
+    "cell_view.h",
     "client_options.h",
+    "client_timestamp_policy.h",
     "cluster_config.h",
     "column_family.h",
+    "columnar_reader.h",
+    "completion_queue.h",
     "data_client.h",
     "filters.h",
+    "flat_row.h",
     "grpc_error.h",
+    "hedging_policy.h",
+    "increment_aggregator.h",
     "instance_admin_client.h",
     "instance_admin.h",
     "instance_config.h",
     "instance_update_config.h",
+    "internal/async_bulk_apply.h",
+    "internal/async_read_rows.h",
+    "internal/async_retry_unary_rpc.h",
     "internal/bulk_mutator.h",
     "internal/common_client.h",
+    "internal/completion_queue_impl.h",
     "internal/conjunction.h",
     "internal/encoder.h",
     "internal/endian.h",
+    "internal/flush_timer.h",
     "internal/grpc_error_delegate.h",
+    "internal/hedged_read_row.h",
     "internal/instance_admin.h",
+    "internal/normalized_row_set.h",
+    "internal/prefetching_read_rows_reader.h",
     "internal/prefix_range_end.h",
+    "internal/read_row_coalescer.h",
+    "internal/readrows_view_parser.h",
+    "internal/readrows_visitor_parser.h",
     "internal/readrowsparser.h",
     "internal/rpc_policy_parameters.inc",
     "internal/rpc_policy_parameters.h",
@@ -31,16 +53,25 @@ bigtable_client_HDRS = [
     "internal/table_admin.h",
     "internal/unary_client_utils.h",
     "idempotent_mutation_policy.h",
+    "mutation_batcher.h",
     "mutations.h",
+    "parallel_row_reader.h",
+    "partitioned_bulk_writer.h",
     "polling_policy.h",
     "read_modify_write_rule.h",
+    "read_row_coalescing_policy.h",
     "row.h",
+    "row_cache.h",
     "row_range.h",
     "row_reader.h",
     "row_set.h",
+    "row_view.h",
+    "row_view_reader.h",
+    "row_visitor.h",
     "rpc_backoff_policy.h",
     "rpc_retry_policy.h",
     "metadata_update_policy.h",
+    "split_point_cache.h",
     "table.h",
     "table_admin.h",
     "table_config.h",
@@ -51,33 +82,54 @@ bigtable_client_HDRS = [
 bigtable_client_SRCS = [
     "admin_client.cc",
     "app_profile_config.cc",
+    "bulk_apply_rate_limiter.cc",
+    "cell.cc",
     "client_options.cc",
     "cluster_config.cc",
+    "columnar_reader.cc",
+    "completion_queue.cc",
     "data_client.cc",
+    "flat_row.cc",
     "grpc_error.cc",
+    "hedging_policy.cc",
+    "increment_aggregator.cc",
     "instance_admin_client.cc",
     "instance_admin.cc",
     "instance_config.cc",
     "instance_update_config.cc",
     "internal/bulk_mutator.cc",
     "internal/common_client.cc",
+    "internal/completion_queue_impl.cc",
     "internal/endian.cc",
+    "internal/flush_timer.cc",
     "internal/grpc_error_delegate.cc",
+    "internal/hedged_read_row.cc",
     "internal/instance_admin.cc",
+    "internal/normalized_row_set.cc",
+    "internal/prefetching_read_rows_reader.cc",
     "internal/prefix_range_end.cc",
+    "internal/read_row_coalescer.cc",
+    "internal/readrows_view_parser.cc",
+    "internal/readrows_visitor_parser.cc",
     "internal/readrowsparser.cc",
     "internal/rowreaderiterator.cc",
     "internal/table.cc",
     "internal/table_admin.cc",
     "idempotent_mutation_policy.cc",
+    "mutation_batcher.cc",
     "mutations.cc",
+    "parallel_row_reader.cc",
+    "partitioned_bulk_writer.cc",
     "polling_policy.cc",
+    "row_cache.cc",
     "row_range.cc",
     "row_reader.cc",
     "row_set.cc",
+    "row_view_reader.cc",
     "rpc_backoff_policy.cc",
     "rpc_retry_policy.cc",
     "metadata_update_policy.cc",
+    "split_point_cache.cc",
     "table.cc",
     "table_admin.cc",
     "table_config.cc",
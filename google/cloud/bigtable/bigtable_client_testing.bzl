@@ -3,6 +3,8 @@ bigtable_client_testing_HDRS = [
     "testing/embedded_server_test_fixture.h",
     "testing/internal_table_test_fixture.h",
     "testing/mock_admin_client.h",
+    "testing/mock_async_response_reader.h",
+    "testing/mock_completion_queue.h",
     "testing/mock_data_client.h",
     "testing/mock_instance_admin_client.h",
     "testing/inprocess_data_client.h",
@@ -11,6 +13,7 @@ bigtable_client_testing_HDRS = [
     "testing/mock_read_rows_reader.h",
     "testing/mock_response_reader.h",
     "testing/mock_sample_row_keys_reader.h",
+    "testing/retry_policy_with_setup_hook.h",
     "testing/table_integration_test.h",
     "testing/table_test_fixture.h",
 ]
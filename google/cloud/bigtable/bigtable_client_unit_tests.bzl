@@ -2,28 +2,49 @@
 bigtable_client_unit_tests = [
     "admin_client_test.cc",
     "app_profile_config_test.cc",
+    "bulk_apply_rate_limiter_test.cc",
     "cell_test.cc",
     "client_options_test.cc",
     "cluster_config_test.cc",
     "column_family_test.cc",
+    "columnar_reader_test.cc",
+    "completion_queue_test.cc",
     "data_client_test.cc",
     "filters_test.cc",
+    "flat_row_test.cc",
     "force_sanitizer_failures_test.cc",
     "grpc_error_test.cc",
+    "hedging_policy_test.cc",
     "idempotent_mutation_policy_test.cc",
+    "increment_aggregator_test.cc",
     "instance_admin_client_test.cc",
     "instance_admin_test.cc",
     "instance_config_test.cc",
     "instance_update_config_test.cc",
     "internal/bulk_mutator_test.cc",
+    "internal/common_client_test.cc",
+    "internal/endian_test.cc",
+    "internal/flush_timer_test.cc",
     "internal/instance_admin_test.cc",
     "internal/grpc_error_delegate_test.cc",
+    "internal/hedged_read_row_test.cc",
+    "internal/normalized_row_set_test.cc",
+    "internal/prefetching_read_rows_reader_test.cc",
     "internal/prefix_range_end_test.cc",
+    "internal/read_row_coalescer_test.cc",
+    "internal/readrows_view_parser_test.cc",
+    "internal/readrows_visitor_parser_test.cc",
     "internal/table_admin_test.cc",
     "internal/table_test.cc",
+    "mutation_batcher_test.cc",
     "mutations_test.cc",
+    "parallel_row_reader_test.cc",
+    "partitioned_bulk_writer_test.cc",
     "table_admin_test.cc",
     "table_apply_test.cc",
+    "table_async_apply_test.cc",
+    "table_async_bulk_apply_test.cc",
+    "table_async_read_rows_test.cc",
     "table_bulk_apply_test.cc",
     "table_check_and_mutate_row_test.cc",
     "table_config_test.cc",
@@ -35,10 +56,13 @@ bigtable_client_unit_tests = [
     "read_modify_write_rule_test.cc",
     "row_reader_test.cc",
     "row_test.cc",
+    "row_cache_test.cc",
     "row_range_test.cc",
     "row_set_test.cc",
+    "row_view_reader_test.cc",
     "rpc_backoff_policy_test.cc",
     "metadata_update_policy_test.cc",
     "rpc_retry_policy_test.cc",
+    "split_point_cache_test.cc",
     "polling_policy_test.cc",
 ]
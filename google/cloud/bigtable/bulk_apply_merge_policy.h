@@ -0,0 +1,55 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_MERGE_POLICY_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_MERGE_POLICY_H_
+
+#include "google/cloud/bigtable/version.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Merge the mutations for the same row in `Table::BulkApply()`.
+ *
+ * Each `SingleRowMutation` in a `BulkMutation` becomes a separate entry in the
+ * `MutateRows` request, and the service locks the row and reports a result
+ * for each entry.  With this policy `BulkApply()` merges the entries for the
+ * same row into a single entry before sending the request, keeping the
+ * mutations in their original order.  The request is smaller, and each row is
+ * locked only once.
+ *
+ * If a merged entry fails, `BulkApply()` reports a `FailedMutation` for each
+ * of the original `SingleRowMutation`s, with their original index.  Notice
+ * that the mutations in a merged entry are applied atomically, they all
+ * succeed or they all fail.  By default the entries are not merged.
+ */
+class BulkApplyMergePolicy {
+ public:
+  explicit BulkApplyMergePolicy(bool merge_same_row = true)
+      : merge_same_row_(merge_same_row) {}
+
+  bool merge_same_row() const { return merge_same_row_; }
+
+ private:
+  bool merge_same_row_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_MERGE_POLICY_H_
@@ -0,0 +1,220 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/bulk_apply_rate_limiter.h"
+#include <algorithm>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+// A single Cloud Bigtable node handles about 10,000 writes per second, start
+// there and let the limiter find the actual capacity.
+double constexpr DEFAULT_MUTATIONS_PER_SECOND = 10000.0;
+double constexpr DEFAULT_MIN_MUTATIONS_PER_SECOND = 10.0;
+double constexpr DEFAULT_MAX_MUTATIONS_PER_SECOND = 1000000.0;
+double constexpr DEFAULT_BYTES_PER_SECOND = 10.0 * 1024 * 1024;
+double constexpr DEFAULT_MIN_BYTES_PER_SECOND = 64.0 * 1024;
+double constexpr DEFAULT_MAX_BYTES_PER_SECOND = 1024.0 * 1024 * 1024;
+double constexpr DEFAULT_MUTATIONS_INCREASE = 1000.0;
+double constexpr DEFAULT_BYTES_INCREASE = 1024.0 * 1024;
+double constexpr DEFAULT_DECREASE_FACTOR = 0.5;
+double constexpr DEFAULT_MAX_THROTTLED_RATIO = 0.01;
+auto constexpr DEFAULT_ADJUSTMENT_INTERVAL = std::chrono::milliseconds(500);
+
+/// Sort @p min and @p max, and clamp @p initial to the resulting range.
+void NormalizeRange(double& initial, double& min, double& max) {
+  min = std::max(min, 1.0);
+  max = std::max(max, min);
+  initial = std::min(std::max(initial, min), max);
+}
+}  // anonymous namespace
+
+BulkApplyRateLimiter::Options::Options()
+    : initial_mutations_per_second_(DEFAULT_MUTATIONS_PER_SECOND),
+      min_mutations_per_second_(DEFAULT_MIN_MUTATIONS_PER_SECOND),
+      max_mutations_per_second_(DEFAULT_MAX_MUTATIONS_PER_SECOND),
+      initial_bytes_per_second_(DEFAULT_BYTES_PER_SECOND),
+      min_bytes_per_second_(DEFAULT_MIN_BYTES_PER_SECOND),
+      max_bytes_per_second_(DEFAULT_MAX_BYTES_PER_SECOND),
+      mutations_increase_(DEFAULT_MUTATIONS_INCREASE),
+      bytes_increase_(DEFAULT_BYTES_INCREASE),
+      decrease_factor_(DEFAULT_DECREASE_FACTOR),
+      max_throttled_ratio_(DEFAULT_MAX_THROTTLED_RATIO),
+      target_latency_(std::chrono::milliseconds(0)),
+      adjustment_interval_(DEFAULT_ADJUSTMENT_INTERVAL) {}
+
+BulkApplyRateLimiter::Options&
+BulkApplyRateLimiter::Options::SetMutationsPerSecond(double initial, double min,
+                                                     double max) {
+  NormalizeRange(initial, min, max);
+  initial_mutations_per_second_ = initial;
+  min_mutations_per_second_ = min;
+  max_mutations_per_second_ = max;
+  return *this;
+}
+
+BulkApplyRateLimiter::Options& BulkApplyRateLimiter::Options::SetBytesPerSecond(
+    double initial, double min, double max) {
+  NormalizeRange(initial, min, max);
+  initial_bytes_per_second_ = initial;
+  min_bytes_per_second_ = min;
+  max_bytes_per_second_ = max;
+  return *this;
+}
+
+BulkApplyRateLimiter::Options& BulkApplyRateLimiter::Options::SetIncrease(
+    double mutations, double bytes) {
+  mutations_increase_ = std::max(mutations, 0.0);
+  bytes_increase_ = std::max(bytes, 0.0);
+  return *this;
+}
+
+BulkApplyRateLimiter::Options& BulkApplyRateLimiter::Options::SetDecreaseFactor(
+    double value) {
+  decrease_factor_ = std::min(std::max(value, 0.0), 1.0);
+  return *this;
+}
+
+BulkApplyRateLimiter::Options&
+BulkApplyRateLimiter::Options::SetMaxThrottledRatio(double value) {
+  max_throttled_ratio_ = std::min(std::max(value, 0.0), 1.0);
+  return *this;
+}
+
+BulkApplyRateLimiter::Options& BulkApplyRateLimiter::Options::SetTargetLatency(
+    std::chrono::milliseconds value) {
+  target_latency_ = std::max(std::chrono::milliseconds(0), value);
+  return *this;
+}
+
+BulkApplyRateLimiter::Options&
+BulkApplyRateLimiter::Options::SetAdjustmentInterval(
+    std::chrono::milliseconds value) {
+  adjustment_interval_ = std::max(std::chrono::milliseconds(0), value);
+  return *this;
+}
+
+struct BulkApplyRateLimiter::Impl {
+  explicit Impl(Options o)
+      : options(std::move(o)),
+        mutations_per_second(options.initial_mutations_per_second()),
+        bytes_per_second(options.initial_bytes_per_second()),
+        last_change_was_decrease(false),
+        increase_count(0),
+        decrease_count(0) {}
+
+  Options const options;
+  std::mutex mu;
+  double mutations_per_second;
+  double bytes_per_second;
+  /// The earliest time the next request can be sent.
+  std::chrono::steady_clock::time_point next_request;
+  std::chrono::steady_clock::time_point last_change;
+  bool last_change_was_decrease;
+  std::int64_t increase_count;
+  std::int64_t decrease_count;
+};
+
+BulkApplyRateLimiter::BulkApplyRateLimiter(Options options)
+    : impl_(std::make_shared<Impl>(std::move(options))) {}
+
+double BulkApplyRateLimiter::mutations_per_second() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->mutations_per_second;
+}
+
+double BulkApplyRateLimiter::bytes_per_second() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->bytes_per_second;
+}
+
+std::int64_t BulkApplyRateLimiter::increase_count() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->increase_count;
+}
+
+std::int64_t BulkApplyRateLimiter::decrease_count() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->decrease_count;
+}
+
+std::chrono::microseconds BulkApplyRateLimiter::Reserve(
+    std::size_t mutations, std::size_t bytes,
+    std::chrono::steady_clock::time_point now) {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  // The request is admitted when the previous requests have "paid" for their
+  // size, and then it delays the following requests by its own size.
+  double seconds =
+      std::max(static_cast<double>(mutations) / impl_->mutations_per_second,
+               static_cast<double>(bytes) / impl_->bytes_per_second);
+  auto start = std::max(now, impl_->next_request);
+  impl_->next_request =
+      start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(seconds));
+  return std::chrono::duration_cast<std::chrono::microseconds>(start - now);
+}
+
+void BulkApplyRateLimiter::OnResult(std::size_t mutations,
+                                    std::size_t throttled,
+                                    std::chrono::microseconds latency,
+                                    std::chrono::steady_clock::time_point now) {
+  auto const& options = impl_->options;
+  bool overloaded =
+      (mutations != 0 and static_cast<double>(throttled) >
+                              options.max_throttled_ratio() *
+                                  static_cast<double>(mutations)) or
+      (options.target_latency().count() != 0 and
+       latency > options.target_latency());
+
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  auto elapsed = now - impl_->last_change;
+  if (overloaded) {
+    // Concurrent requests observe the same overload, decrease at most once per
+    // interval so they do not collapse the rates to the minimum.
+    if (impl_->last_change_was_decrease and
+        elapsed < options.adjustment_interval()) {
+      return;
+    }
+    impl_->mutations_per_second =
+        std::max(impl_->mutations_per_second * options.decrease_factor(),
+                 options.min_mutations_per_second());
+    impl_->bytes_per_second =
+        std::max(impl_->bytes_per_second * options.decrease_factor(),
+                 options.min_bytes_per_second());
+    impl_->last_change = now;
+    impl_->last_change_was_decrease = true;
+    ++impl_->decrease_count;
+    return;
+  }
+  if (elapsed < options.adjustment_interval()) {
+    return;
+  }
+  impl_->mutations_per_second =
+      std::min(impl_->mutations_per_second + options.mutations_increase(),
+               options.max_mutations_per_second());
+  impl_->bytes_per_second =
+      std::min(impl_->bytes_per_second + options.bytes_increase(),
+               options.max_bytes_per_second());
+  impl_->last_change = now;
+  impl_->last_change_was_decrease = false;
+  ++impl_->increase_count;
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,176 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_RATE_LIMITER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_RATE_LIMITER_H_
+
+#include "google/cloud/bigtable/version.h"
+#include <grpcpp/grpcpp.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Adapt the rate of `Table::BulkApply()` requests to the server load.
+ *
+ * Cloud Bigtable rejects individual mutations with `RESOURCE_EXHAUSTED` or
+ * `UNAVAILABLE` when it is overloaded.  The retry and backoff policies only
+ * affect a single call, so many workers retrying at the same time keep the
+ * server overloaded.  This limiter is shared by all the calls using the same
+ * table (or tables), it paces each `MutateRows` request by its number of
+ * mutations and bytes, and adapts the rates using additive-increase /
+ * multiplicative-decrease (AIMD):
+ *
+ * - If more than `max_throttled_ratio()` of the mutations in a request are
+ *   throttled, or the request takes longer than `target_latency()`, the rates
+ *   are multiplied by `decrease_factor()`.
+ * - Otherwise, the rates grow by `mutations_increase()` and `bytes_increase()`
+ *   at most once every `adjustment_interval()`.
+ *
+ * Only one decrease happens per `adjustment_interval()`, because concurrent
+ * requests report the same overload.
+ *
+ * Copies of this object share the same state, the application can keep a copy
+ * to examine the current rates.  This class is thread-safe.
+ *
+ * @par Example
+ * @code
+ * bigtable::BulkApplyRateLimiter limiter;
+ * bigtable::Table table(client, "my-table", limiter);
+ * table.BulkApply(std::move(bulk));
+ * std::cout << limiter.mutations_per_second() << " mutations/s\n";
+ * @endcode
+ */
+class BulkApplyRateLimiter {
+ public:
+  /// Configure the initial rates and how they change.
+  class Options {
+   public:
+    Options();
+
+    //@{
+    /// @name The initial, minimum and maximum mutations per second.
+    double initial_mutations_per_second() const {
+      return initial_mutations_per_second_;
+    }
+    double min_mutations_per_second() const {
+      return min_mutations_per_second_;
+    }
+    double max_mutations_per_second() const {
+      return max_mutations_per_second_;
+    }
+    Options& SetMutationsPerSecond(double initial, double min, double max);
+    //@}
+
+    //@{
+    /// @name The initial, minimum and maximum bytes per second.
+    double initial_bytes_per_second() const {
+      return initial_bytes_per_second_;
+    }
+    double min_bytes_per_second() const { return min_bytes_per_second_; }
+    double max_bytes_per_second() const { return max_bytes_per_second_; }
+    Options& SetBytesPerSecond(double initial, double min, double max);
+    //@}
+
+    //@{
+    /// @name How much the rates grow after each `adjustment_interval()`.
+    double mutations_increase() const { return mutations_increase_; }
+    double bytes_increase() const { return bytes_increase_; }
+    Options& SetIncrease(double mutations, double bytes);
+    //@}
+
+    /// The rates are multiplied by this factor when the server is overloaded.
+    double decrease_factor() const { return decrease_factor_; }
+    Options& SetDecreaseFactor(double value);
+
+    /// The fraction of throttled mutations that signals an overload.
+    double max_throttled_ratio() const { return max_throttled_ratio_; }
+    Options& SetMaxThrottledRatio(double value);
+
+    /// Requests slower than this signal an overload, zero disables the check.
+    std::chrono::milliseconds target_latency() const { return target_latency_; }
+    Options& SetTargetLatency(std::chrono::milliseconds value);
+
+    /// The minimum time between two changes in the rates.
+    std::chrono::milliseconds adjustment_interval() const {
+      return adjustment_interval_;
+    }
+    Options& SetAdjustmentInterval(std::chrono::milliseconds value);
+
+   private:
+    double initial_mutations_per_second_;
+    double min_mutations_per_second_;
+    double max_mutations_per_second_;
+    double initial_bytes_per_second_;
+    double min_bytes_per_second_;
+    double max_bytes_per_second_;
+    double mutations_increase_;
+    double bytes_increase_;
+    double decrease_factor_;
+    double max_throttled_ratio_;
+    std::chrono::milliseconds target_latency_;
+    std::chrono::milliseconds adjustment_interval_;
+  };
+
+  explicit BulkApplyRateLimiter(Options options = Options());
+
+  /// Return true if @p code means the server is throttling requests.
+  static bool IsThrottlingError(grpc::StatusCode code) {
+    return code == grpc::StatusCode::RESOURCE_EXHAUSTED or
+           code == grpc::StatusCode::UNAVAILABLE;
+  }
+
+  //@{
+  /// @name The current rates.
+  double mutations_per_second() const;
+  double bytes_per_second() const;
+  //@}
+
+  //@{
+  /// @name Counters to evaluate the effectiveness of the limiter.
+  std::int64_t increase_count() const;
+  std::int64_t decrease_count() const;
+  //@}
+
+  //@{
+  /**
+   * @name Functions used by `Table` to pace the requests.
+   *
+   * `Reserve()` returns how long the caller must wait before sending a request
+   * with @p mutations mutations and @p bytes bytes.  `OnResult()` reports the
+   * outcome of the request, @p throttled is the number of mutations rejected
+   * with a throttling error (see `IsThrottlingError()`).
+   */
+  std::chrono::microseconds Reserve(std::size_t mutations, std::size_t bytes,
+                                    std::chrono::steady_clock::time_point now);
+  void OnResult(std::size_t mutations, std::size_t throttled,
+                std::chrono::microseconds latency,
+                std::chrono::steady_clock::time_point now);
+  //@}
+
+ private:
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_RATE_LIMITER_H_
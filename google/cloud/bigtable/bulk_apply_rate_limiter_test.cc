@@ -0,0 +1,125 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/bulk_apply_rate_limiter.h"
+#include <gmock/gmock.h>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::BulkApplyRateLimiter;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+namespace {
+BulkApplyRateLimiter::Options TestOptions() {
+  return BulkApplyRateLimiter::Options()
+      .SetMutationsPerSecond(1000, 100, 2000)
+      .SetBytesPerSecond(1000000, 1000, 2000000)
+      .SetIncrease(500, 500000)
+      .SetDecreaseFactor(0.5)
+      .SetAdjustmentInterval(milliseconds(100));
+}
+}  // anonymous namespace
+
+/// @test Verify that requests are paced by their number of mutations.
+TEST(BulkApplyRateLimiterTest, PaceByMutations) {
+  BulkApplyRateLimiter limiter(TestOptions());
+  auto now = std::chrono::steady_clock::now();
+  // The first request goes immediately, and delays the next by 100ms.
+  EXPECT_EQ(microseconds(0), limiter.Reserve(100, 0, now));
+  EXPECT_EQ(microseconds(100000), limiter.Reserve(100, 0, now));
+  EXPECT_EQ(microseconds(200000), limiter.Reserve(1, 0, now));
+  // Once the time passes there is no delay.
+  EXPECT_EQ(microseconds(0), limiter.Reserve(1, 0, now + milliseconds(300)));
+}
+
+/// @test Verify that requests are paced by their size.
+TEST(BulkApplyRateLimiterTest, PaceByBytes) {
+  BulkApplyRateLimiter limiter(TestOptions());
+  auto now = std::chrono::steady_clock::now();
+  EXPECT_EQ(microseconds(0), limiter.Reserve(1, 500000, now));
+  EXPECT_EQ(microseconds(500000), limiter.Reserve(1, 0, now));
+}
+
+/// @test Verify that the rates decrease multiplicatively and increase linearly.
+TEST(BulkApplyRateLimiterTest, AdditiveIncreaseMultiplicativeDecrease) {
+  BulkApplyRateLimiter limiter(TestOptions());
+  auto now = std::chrono::steady_clock::now();
+
+  limiter.OnResult(100, 50, microseconds(0), now);
+  EXPECT_DOUBLE_EQ(500.0, limiter.mutations_per_second());
+  EXPECT_DOUBLE_EQ(500000.0, limiter.bytes_per_second());
+  // Concurrent requests reporting the same overload do not decrease further.
+  limiter.OnResult(100, 50, microseconds(0), now + milliseconds(10));
+  EXPECT_DOUBLE_EQ(500.0, limiter.mutations_per_second());
+  EXPECT_EQ(1, limiter.decrease_count());
+
+  // Increase at most once per interval.
+  limiter.OnResult(100, 0, microseconds(0), now + milliseconds(50));
+  EXPECT_DOUBLE_EQ(500.0, limiter.mutations_per_second());
+  limiter.OnResult(100, 0, microseconds(0), now + milliseconds(100));
+  EXPECT_DOUBLE_EQ(1000.0, limiter.mutations_per_second());
+  limiter.OnResult(100, 0, microseconds(0), now + milliseconds(150));
+  EXPECT_DOUBLE_EQ(1000.0, limiter.mutations_per_second());
+  limiter.OnResult(100, 0, microseconds(0), now + milliseconds(200));
+  limiter.OnResult(100, 0, microseconds(0), now + milliseconds(300));
+  // Clamped to the maximum.
+  EXPECT_DOUBLE_EQ(2000.0, limiter.mutations_per_second());
+  EXPECT_DOUBLE_EQ(2000000.0, limiter.bytes_per_second());
+  EXPECT_EQ(3, limiter.increase_count());
+
+  // An overload right after an increase decreases immediately.
+  limiter.OnResult(100, 100, microseconds(0), now + milliseconds(310));
+  EXPECT_DOUBLE_EQ(1000.0, limiter.mutations_per_second());
+}
+
+/// @test Verify that the rates do not go below the minimum.
+TEST(BulkApplyRateLimiterTest, ClampToMinimum) {
+  BulkApplyRateLimiter limiter(TestOptions());
+  auto now = std::chrono::steady_clock::now();
+  for (int i = 0; i != 10; ++i) {
+    limiter.OnResult(1, 1, microseconds(0), now + i * milliseconds(100));
+  }
+  EXPECT_DOUBLE_EQ(100.0, limiter.mutations_per_second());
+  EXPECT_DOUBLE_EQ(1000.0, limiter.bytes_per_second());
+}
+
+/// @test Verify that slow requests are treated as an overload.
+TEST(BulkApplyRateLimiterTest, TargetLatency) {
+  BulkApplyRateLimiter limiter(
+      TestOptions().SetTargetLatency(milliseconds(10)));
+  auto now = std::chrono::steady_clock::now();
+  limiter.OnResult(100, 0, microseconds(20000), now);
+  EXPECT_DOUBLE_EQ(500.0, limiter.mutations_per_second());
+}
+
+/// @test Verify that copies share the same state.
+TEST(BulkApplyRateLimiterTest, CopiesShareState) {
+  BulkApplyRateLimiter limiter(TestOptions());
+  auto copy = limiter;
+  copy.OnResult(100, 100, microseconds(0), std::chrono::steady_clock::now());
+  EXPECT_DOUBLE_EQ(500.0, limiter.mutations_per_second());
+}
+
+/// @test Verify that the options are normalized.
+TEST(BulkApplyRateLimiterOptionsTest, Normalize) {
+  auto options = BulkApplyRateLimiter::Options()
+                     .SetMutationsPerSecond(5, 10, 1)
+                     .SetDecreaseFactor(2.0)
+                     .SetMaxThrottledRatio(-1.0);
+  EXPECT_DOUBLE_EQ(10.0, options.min_mutations_per_second());
+  EXPECT_DOUBLE_EQ(10.0, options.max_mutations_per_second());
+  EXPECT_DOUBLE_EQ(10.0, options.initial_mutations_per_second());
+  EXPECT_DOUBLE_EQ(1.0, options.decrease_factor());
+  EXPECT_DOUBLE_EQ(0.0, options.max_throttled_ratio());
+}
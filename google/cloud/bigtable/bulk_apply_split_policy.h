@@ -0,0 +1,74 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_SPLIT_POLICY_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_SPLIT_POLICY_H_
+
+#include "google/cloud/bigtable/version.h"
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Split large `Table::BulkApply()` calls into concurrent requests.
+ *
+ * Cloud Bigtable rejects `MutateRows` requests with more than 100,000
+ * mutations, and a single large stream is slower than several smaller ones
+ * sent over different channels.  `BulkApply()` splits the pending mutations
+ * into requests with at most `max_mutations_per_request()` mutations and
+ * `max_bytes_per_request()` bytes, and runs up to `max_concurrency()` of them
+ * at the same time.  Each retry splits the remaining mutations again.
+ *
+ * A single row is never split, a row with more mutations (or bytes) than the
+ * limits is sent in a request by itself.
+ */
+class BulkApplySplitPolicy {
+ public:
+  /// The maximum number of mutations accepted by the service in one request.
+  static std::size_t constexpr DEFAULT_MAX_MUTATIONS_PER_REQUEST = 100000;
+  /// Stay well below the maximum message size accepted by the service.
+  static std::size_t constexpr DEFAULT_MAX_BYTES_PER_REQUEST =
+      64 * 1024 * 1024;
+  static std::size_t constexpr DEFAULT_MAX_CONCURRENCY = 4;
+
+  explicit BulkApplySplitPolicy(
+      std::size_t max_mutations_per_request = DEFAULT_MAX_MUTATIONS_PER_REQUEST,
+      std::size_t max_bytes_per_request = DEFAULT_MAX_BYTES_PER_REQUEST,
+      std::size_t max_concurrency = DEFAULT_MAX_CONCURRENCY)
+      : max_mutations_per_request_(
+            max_mutations_per_request == 0 ? 1 : max_mutations_per_request),
+        max_bytes_per_request_(
+            max_bytes_per_request == 0 ? 1 : max_bytes_per_request),
+        max_concurrency_(max_concurrency == 0 ? 1 : max_concurrency) {}
+
+  std::size_t max_mutations_per_request() const {
+    return max_mutations_per_request_;
+  }
+  std::size_t max_bytes_per_request() const { return max_bytes_per_request_; }
+  std::size_t max_concurrency() const { return max_concurrency_; }
+
+ private:
+  std::size_t max_mutations_per_request_;
+  std::size_t max_bytes_per_request_;
+  std::size_t max_concurrency_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_BULK_APPLY_SPLIT_POLICY_H_
@@ -0,0 +1,41 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/cell.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+void EncodeBigEndian64(std::vector<std::int64_t> const& values,
+                       std::vector<std::string>& encoded) {
+  constexpr std::size_t kSize = sizeof(std::int64_t);
+  constexpr std::size_t kBlockSize = internal::kBulkBigEndian64BlockSize;
+  char buffer[kBlockSize * kSize];
+  encoded.reserve(encoded.size() + values.size());
+  for (std::size_t offset = 0; offset < values.size(); offset += kBlockSize) {
+    auto count = std::min(kBlockSize, values.size() - offset);
+    internal::ByteSwap64Array(
+        reinterpret_cast<char const*>(values.data() + offset), count, buffer);
+    for (std::size_t i = 0; i != count; ++i) {
+      encoded.emplace_back(buffer + i * kSize, kSize);
+    }
+  }
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
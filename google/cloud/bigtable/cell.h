@@ -19,6 +19,9 @@
 #include "google/cloud/bigtable/version.h"
 
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
 
 namespace google {
@@ -107,6 +110,85 @@ class Cell {
   std::vector<std::string> labels_;
 };
 
+namespace internal {
+/// The number of values converted at a time by the bulk functions.
+constexpr std::size_t kBulkBigEndian64BlockSize = 256;
+
+/// Return the value of a cell, or the string itself, for the bulk decoder.
+inline std::string const& BulkDecodeValue(std::string const& value) {
+  return value;
+}
+template <typename CellType>
+auto BulkDecodeValue(CellType const& cell) -> decltype(cell.value()) {
+  return cell.value();
+}
+}  // namespace internal
+
+/**
+ * Decode the values in `[begin, end)` as 64-bit big-endian integers.
+ *
+ * This is the bulk version of `Cell::value_as<bigendian64_t>()`.  The elements
+ * may be `Cell`, `CellView`, or `std::string` objects.  The values are
+ * gathered into a contiguous buffer and byte-swapped in blocks, using SIMD
+ * instructions where available.  Malformed values (those that are not exactly
+ * 8 bytes long) do not raise exceptions, they are decoded as 0 and marked as
+ * invalid.
+ *
+ * @param values the decoded values are appended here.
+ * @param valid one element is appended per value, 1 if the value was valid,
+ *     0 if it was malformed.
+ * @return the number of malformed values.
+ */
+template <typename Iterator>
+std::size_t DecodeBigEndian64(Iterator begin, Iterator end,
+                              std::vector<std::int64_t>& values,
+                              std::vector<std::uint8_t>& valid) {
+  constexpr std::size_t kSize = sizeof(std::int64_t);
+  char buffer[internal::kBulkBigEndian64BlockSize * kSize];
+  std::size_t malformed = 0;
+  while (begin != end) {
+    std::size_t count = 0;
+    for (; begin != end and count != internal::kBulkBigEndian64BlockSize;
+         ++begin, ++count) {
+      std::string const& value = internal::BulkDecodeValue(*begin);
+      if (value.size() == kSize) {
+        std::memcpy(buffer + count * kSize, value.data(), kSize);
+        valid.push_back(1);
+      } else {
+        std::memset(buffer + count * kSize, 0, kSize);
+        valid.push_back(0);
+        ++malformed;
+      }
+    }
+    auto offset = values.size();
+    values.resize(offset + count);
+    internal::ByteSwap64Array(buffer, count,
+                              reinterpret_cast<char*>(values.data() + offset));
+  }
+  return malformed;
+}
+
+/**
+ * Encode @p values as 64-bit big-endian strings, for `SetCell` mutations.
+ *
+ * This is the bulk version of the `Cell` constructor taking a
+ * `bigendian64_t` value.  The encoded values are appended to @p encoded, they
+ * fit in the small string buffer of most `std::string` implementations, so
+ * this does not allocate memory per value.
+ *
+ * @par Example
+ * @code
+ * std::vector<std::string> encoded;
+ * bigtable::EncodeBigEndian64(counters, encoded);
+ * for (std::size_t i = 0; i != encoded.size(); ++i) {
+ *   mutation.emplace_back(
+ *       bigtable::SetCell("stats", columns[i], std::move(encoded[i])));
+ * }
+ * @endcode
+ */
+void EncodeBigEndian64(std::vector<std::int64_t> const& values,
+                       std::vector<std::string>& encoded);
+
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
 }  // namespace cloud
@@ -14,7 +14,8 @@
 
 #include "google/cloud/bigtable/cell.h"
 
-#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <limits>
 
 namespace bigtable = google::cloud::bigtable;
 
@@ -78,3 +79,65 @@ TEST(CellTest, SimpleNumericNegativeValue) {
   EXPECT_EQ(value.get(), cell.value_as<bigtable::bigendian64_t>().get());
   EXPECT_EQ(0U, cell.labels().size());
 }
+
+namespace {
+std::vector<std::int64_t> MakeValues(std::size_t count) {
+  std::vector<std::int64_t> values;
+  std::uint64_t v = 0x0102030405060708ULL;
+  for (std::size_t i = 0; i != count; ++i) {
+    values.push_back(static_cast<std::int64_t>(i % 3 == 0 ? ~v : v));
+    v = v * 31 + i;
+  }
+  return values;
+}
+}  // anonymous namespace
+
+/// @test Verify that EncodeBigEndian64() matches the single value encoder.
+TEST(CellTest, EncodeBigEndian64) {
+  auto values = MakeValues(1000);
+  values.push_back(std::numeric_limits<std::int64_t>::min());
+  values.push_back(std::numeric_limits<std::int64_t>::max());
+  std::vector<std::string> encoded{"existing"};
+  bigtable::EncodeBigEndian64(values, encoded);
+  ASSERT_EQ(values.size() + 1, encoded.size());
+  EXPECT_EQ("existing", encoded[0]);
+  for (std::size_t i = 0; i != values.size(); ++i) {
+    EXPECT_EQ(bigtable::internal::AsBigEndian64(
+                  bigtable::bigendian64_t(values[i])),
+              encoded[i + 1]);
+  }
+}
+
+/// @test Verify that DecodeBigEndian64() reverses EncodeBigEndian64().
+TEST(CellTest, DecodeBigEndian64RoundTrip) {
+  auto values = MakeValues(1000);
+  std::vector<std::string> encoded;
+  bigtable::EncodeBigEndian64(values, encoded);
+
+  std::vector<std::int64_t> decoded;
+  std::vector<std::uint8_t> valid;
+  EXPECT_EQ(0U, bigtable::DecodeBigEndian64(encoded.begin(), encoded.end(),
+                                            decoded, valid));
+  EXPECT_EQ(values, decoded);
+  EXPECT_EQ(std::vector<std::uint8_t>(values.size(), 1), valid);
+}
+
+/// @test Verify that DecodeBigEndian64() reports malformed values.
+TEST(CellTest, DecodeBigEndian64Malformed) {
+  std::vector<bigtable::Cell> cells;
+  cells.emplace_back("r1", "fam", "c1", 0, bigtable::bigendian64_t(42),
+                     std::vector<std::string>{});
+  cells.emplace_back("r1", "fam", "c2", 0, "short", std::vector<std::string>{});
+  cells.emplace_back("r1", "fam", "c3", 0, bigtable::bigendian64_t(-7),
+                     std::vector<std::string>{});
+  cells.emplace_back("r1", "fam", "c4", 0, "too long value",
+                     std::vector<std::string>{});
+
+  std::vector<std::int64_t> decoded;
+  std::vector<std::uint8_t> valid;
+  EXPECT_EQ(2U, bigtable::DecodeBigEndian64(cells.begin(), cells.end(),
+                                            decoded, valid));
+  EXPECT_THAT(decoded, ::testing::ElementsAre(42, 0, -7, 0));
+  EXPECT_THAT(valid, ::testing::ElementsAre(1, 0, 1, 0));
+  EXPECT_EQ(cells[0].value_as<bigtable::bigendian64_t>().get(), decoded[0]);
+}
@@ -0,0 +1,112 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_VIEW_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_VIEW_H_
+
+#include "google/cloud/bigtable/cell.h"
+#include <google/protobuf/repeated_field.h>
+#include <chrono>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+class ReadRowsViewParser;
+class ReadRowsVisitorParser;
+}  // namespace internal
+
+/**
+ * A non-owning view of a Bigtable cell.
+ *
+ * This is the counterpart of `Cell` for `RowViewReader`: instead of copying
+ * the data, it refers to the buffers of the `ReadRowsResponse` messages
+ * received from the server.  All the cells in a column share the same family
+ * and column qualifier strings.
+ *
+ * The referenced data is only valid until the `RowViewReader` iterator
+ * advances, use `ToCell()` to keep a copy.
+ */
+class CellView {
+ public:
+  /// Return the row key this cell belongs to.
+  std::string const& row_key() const { return *row_key_; }
+
+  /// Return the family this cell belongs to.
+  std::string const& family_name() const { return *family_name_; }
+
+  /// Return the column this cell belongs to.
+  std::string const& column_qualifier() const { return *column_qualifier_; }
+
+  /// Return the timestamp of this cell.
+  std::chrono::microseconds timestamp() const {
+    return std::chrono::microseconds(timestamp_);
+  }
+
+  /// Return the contents of this cell.
+  std::string const& value() const { return *value_; }
+
+  /**
+   * Interpret the value as an encoded `T` and return it.
+   *
+   * @see `Cell::value_as()` for details.
+   */
+  template <typename T>
+  T value_as() const {
+    return google::cloud::bigtable::internal::Encoder<T>::Decode(*value_);
+  }
+
+  /// Return the labels applied to this cell by label transformer read filters.
+  google::protobuf::RepeatedPtrField<std::string> const& labels() const {
+    return *labels_;
+  }
+
+  /// Return a copy of the cell that owns all its data.
+  Cell ToCell() const {
+    return Cell(*row_key_, *family_name_, *column_qualifier_, timestamp_,
+                *value_,
+                std::vector<std::string>(labels_->begin(), labels_->end()));
+  }
+
+ private:
+  friend class internal::ReadRowsViewParser;
+  friend class internal::ReadRowsVisitorParser;
+
+  CellView(std::string const* row_key, std::string const* family_name,
+           std::string const* column_qualifier, std::int64_t timestamp,
+           std::string const* value,
+           google::protobuf::RepeatedPtrField<std::string> const* labels)
+      : row_key_(row_key),
+        family_name_(family_name),
+        column_qualifier_(column_qualifier),
+        timestamp_(timestamp),
+        value_(value),
+        labels_(labels) {}
+
+  std::string const* row_key_;
+  std::string const* family_name_;
+  std::string const* column_qualifier_;
+  std::int64_t timestamp_;
+  std::string const* value_;
+  google::protobuf::RepeatedPtrField<std::string> const* labels_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CELL_VIEW_H_
@@ -19,6 +19,12 @@
 #define BIGTABLE_CLIENT_DEFAULT_CONNECTION_POOL_SIZE 4
 #endif  // BIGTABLE_CLIENT_DEFAULT_CONNECTION_POOL_SIZE
 
+// gRPC servers typically allow 100 concurrent streams per connection, grow the
+// pool before reaching that limit.
+#ifndef BIGTABLE_CLIENT_DEFAULT_MAX_CALLS_PER_CHANNEL
+#define BIGTABLE_CLIENT_DEFAULT_MAX_CALLS_PER_CHANNEL 64
+#endif  // BIGTABLE_CLIENT_DEFAULT_MAX_CALLS_PER_CHANNEL
+
 #ifndef BIGTABLE_CLIENT_DEFAULT_CHANNELS_PER_CPU
 #define BIGTABLE_CLIENT_DEFAULT_CHANNELS_PER_CPU 2
 #endif  // BIGTABLE_CLIENT_DEFAULT_CHANNELS_PER_CPU
@@ -52,6 +58,10 @@ inline std::size_t CalculateDefaultConnectionPoolSize() {
 ClientOptions::ClientOptions(std::shared_ptr<grpc::ChannelCredentials> creds)
     : credentials_(std::move(creds)),
       connection_pool_size_(CalculateDefaultConnectionPoolSize()),
+      max_connection_pool_size_(0),
+      max_calls_per_channel_(BIGTABLE_CLIENT_DEFAULT_MAX_CALLS_PER_CHANNEL),
+      load_aware_channel_selection_(false),
+      prime_connections_timeout_(0),
       data_endpoint_("bigtable.googleapis.com"),
       admin_endpoint_("bigtableadmin.googleapis.com"),
       instance_admin_endpoint_("bigtableadmin.googleapis.com") {
@@ -18,6 +18,8 @@
 #include "google/cloud/bigtable/version.h"
 #include "google/cloud/internal/throw_delegate.h"
 #include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <chrono>
 
 namespace google {
 namespace cloud {
@@ -114,6 +116,75 @@ class ClientOptions {
   }
   std::size_t connection_pool_size() const { return connection_pool_size_; }
 
+  /**
+   * Set the maximum size of the connection pool.
+   *
+   * A gRPC channel can only run a limited number of concurrent streams, so
+   * long-running streams (such as large `ReadRows()` scans) can delay other
+   * calls sharing the same channels.  If this value is larger than
+   * `connection_pool_size()` the client adds channels to the pool, up to this
+   * limit, when the average number of in-flight calls per channel reaches
+   * `max_calls_per_channel()`.  The pool shrinks back to
+   * `connection_pool_size()` channels when the load decreases, and the
+   * removed channels are closed once their calls complete.
+   */
+  ClientOptions& set_max_connection_pool_size(std::size_t size) {
+    max_connection_pool_size_ = size;
+    return *this;
+  }
+  /// Return the maximum size of the connection pool.
+  std::size_t max_connection_pool_size() const {
+    return (std::max)(max_connection_pool_size_, connection_pool_size_);
+  }
+
+  /// Set the number of in-flight calls per channel that grows the pool.
+  ClientOptions& set_max_calls_per_channel(std::size_t count) {
+    if (count == 0) {
+      google::cloud::internal::RaiseRangeError(
+          "ClientOptions::set_max_calls_per_channel requires count > 0");
+    }
+    max_calls_per_channel_ = count;
+    return *this;
+  }
+  std::size_t max_calls_per_channel() const { return max_calls_per_channel_; }
+
+  /**
+   * Connect all the channels in the pool when the client is created.
+   *
+   * By default the channels connect during their first call, so the first
+   * calls on each channel include the TCP, TLS and HTTP/2 handshakes.  If
+   * @p timeout is positive, `CreateDefaultDataClient()` connects all the
+   * channels in parallel, waiting at most @p timeout for them.  Use
+   * `DataClient::PrimeConnections()` to check if the channels are ready.
+   */
+  ClientOptions& set_prime_connections_timeout(
+      std::chrono::milliseconds timeout) {
+    prime_connections_timeout_ = timeout;
+    return *this;
+  }
+  std::chrono::milliseconds prime_connections_timeout() const {
+    return prime_connections_timeout_;
+  }
+
+  /**
+   * Select the channel with the fewest in-flight calls for each new call.
+   *
+   * By default the client round-robins across the channels in the connection
+   * pool.  That works well when all the calls take about the same time, but a
+   * few long-running calls (such as large `ReadRows()` scans) can make some
+   * channels busier than others.  With this option the client counts the
+   * calls in progress on each channel and picks the least loaded one.
+   * Asynchronous streaming calls (such as `AsyncBulkApply()`) are included
+   * in the count, asynchronous unary calls are not.
+   */
+  ClientOptions& set_load_aware_channel_selection(bool enabled) {
+    load_aware_channel_selection_ = enabled;
+    return *this;
+  }
+  bool load_aware_channel_selection() const {
+    return load_aware_channel_selection_;
+  }
+
   /// Return the current credentials.
   std::shared_ptr<grpc::ChannelCredentials> credentials() const {
     return credentials_;
@@ -297,6 +368,10 @@ class ClientOptions {
   grpc::ChannelArguments channel_arguments_;
   std::string connection_pool_name_;
   std::size_t connection_pool_size_;
+  std::size_t max_connection_pool_size_;
+  std::size_t max_calls_per_channel_;
+  bool load_aware_channel_selection_;
+  std::chrono::milliseconds prime_connections_timeout_;
   std::string data_endpoint_;
   std::string admin_endpoint_;
   // The endpoint for instance admin operations, in most scenarios this should
@@ -152,6 +152,49 @@ TEST(ClientOptionsTest, EditConnectionPoolSize) {
   EXPECT_EQ(42UL, returned.connection_pool_size());
 }
 
+TEST(ClientOptionsTest, EditLoadAwareChannelSelection) {
+  bigtable::ClientOptions client_options_object;
+  EXPECT_FALSE(client_options_object.load_aware_channel_selection());
+  auto& returned =
+      client_options_object.set_load_aware_channel_selection(true);
+  EXPECT_EQ(&returned, &client_options_object);
+  EXPECT_TRUE(returned.load_aware_channel_selection());
+}
+
+TEST(ClientOptionsTest, EditPrimeConnectionsTimeout) {
+  bigtable::ClientOptions client_options_object;
+  EXPECT_EQ(0, client_options_object.prime_connections_timeout().count());
+  auto& returned = client_options_object.set_prime_connections_timeout(
+      std::chrono::milliseconds(500));
+  EXPECT_EQ(&returned, &client_options_object);
+  EXPECT_EQ(500, returned.prime_connections_timeout().count());
+}
+
+TEST(ClientOptionsTest, EditMaxConnectionPoolSize) {
+  bigtable::ClientOptions client_options_object;
+  client_options_object.set_connection_pool_size(4);
+  // By default the pool does not grow.
+  EXPECT_EQ(4UL, client_options_object.max_connection_pool_size());
+  auto& returned = client_options_object.set_max_connection_pool_size(16);
+  EXPECT_EQ(&returned, &client_options_object);
+  EXPECT_EQ(16UL, returned.max_connection_pool_size());
+  // The maximum is never smaller than the initial size.
+  returned.set_connection_pool_size(32);
+  EXPECT_EQ(32UL, returned.max_connection_pool_size());
+}
+
+TEST(ClientOptionsTest, EditMaxCallsPerChannel) {
+  bigtable::ClientOptions client_options_object;
+  EXPECT_LE(1UL, client_options_object.max_calls_per_channel());
+  auto& returned = client_options_object.set_max_calls_per_channel(7);
+  EXPECT_EQ(&returned, &client_options_object);
+  EXPECT_EQ(7UL, returned.max_calls_per_channel());
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(client_options_object.set_max_calls_per_channel(0),
+               std::range_error);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
 TEST(ClientOptionsTest, InvalidConnectionPoolSize) {
   bigtable::ClientOptions client_options_object;
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,72 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CLIENT_TIMESTAMP_POLICY_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CLIENT_TIMESTAMP_POLICY_H_
+
+#include "google/cloud/bigtable/version.h"
+#include <chrono>
+#include <functional>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Assign the timestamps of `SetCell()` mutations in the client.
+ *
+ * `SetCell()` mutations where the server assigns the timestamp are not
+ * idempotent, retrying them may store the value more than once, so by default
+ * `Table::Apply()` and `Table::BulkApply()` do not retry them.  With this
+ * policy the table replaces `ServerSetTimestamp()` with the time when the
+ * mutation is submitted, the mutations become idempotent and are retried like
+ * any other mutation.
+ *
+ * All the mutations in a single `Apply()` or `BulkApply()` call receive the
+ * same timestamp, with millisecond granularity as required by Cloud Bigtable.
+ * Notice that the client clock may differ from the server clock.
+ *
+ * @see BulkMutation::AssignClientTimestamps() to assign the timestamps in a
+ *     single `BulkMutation`.
+ */
+class ClientTimestampPolicy {
+ public:
+  /// The type of the function returning the current time.
+  using Clock = std::function<std::chrono::milliseconds()>;
+
+  /// Use the system clock.
+  ClientTimestampPolicy() : clock_(&SystemClock) {}
+
+  /// Use @p clock to get the current time, mostly useful in tests.
+  explicit ClientTimestampPolicy(Clock clock) : clock_(std::move(clock)) {}
+
+  /// The timestamp for mutations submitted now.
+  std::chrono::milliseconds Now() const { return clock_(); }
+
+ private:
+  static std::chrono::milliseconds SystemClock() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+  }
+
+  Clock clock_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_CLIENT_TIMESTAMP_POLICY_H_
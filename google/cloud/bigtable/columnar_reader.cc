@@ -0,0 +1,111 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/columnar_reader.h"
+#include "google/cloud/internal/make_unique.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+Filter ColumnProjection::filter() const {
+  if (columns_.empty()) {
+    // Only the row keys are needed, return one cell per row without values.
+    return Filter::Chain(Filter::CellsRowLimit(1),
+                         Filter::StripValueTransformer());
+  }
+  auto select = [](ColumnSpec const& c) {
+    return Filter::ColumnRangeClosed(c.family, c.qualifier, c.qualifier);
+  };
+  auto columns = select(columns_.front());
+  for (auto i = columns_.begin() + 1; i != columns_.end(); ++i) {
+    columns = Filter::Interleave(std::move(columns), select(*i));
+  }
+  return Filter::Chain(std::move(columns), Filter::Latest(1));
+}
+
+ColumnarReader::ColumnarReader(RowViewReader reader,
+                               ColumnProjection projection,
+                               std::size_t batch_rows)
+    : reader_(google::cloud::internal::make_unique<RowViewReader>(
+          std::move(reader))),
+      it_(reader_->end()),
+      started_(false),
+      projection_(std::move(projection)),
+      batch_rows_(batch_rows == 0 ? 1 : batch_rows),
+      seen_(projection_.size()) {
+  for (auto const& c : projection_.columns_) {
+    batch_.columns_.emplace_back(c.factory());
+  }
+}
+
+ColumnBatch const* ColumnarReader::Next() {
+  ColumnBuffer& row_keys = batch_.row_keys_;
+  row_keys.Clear();
+  for (auto& c : batch_.columns_) {
+    c->Clear();
+  }
+  if (not started_) {
+    started_ = true;
+    it_ = reader_->begin();
+  } else if (it_ == reader_->end()) {
+    return nullptr;
+  } else {
+    ++it_;
+  }
+
+  auto const column_count = batch_.columns_.size();
+  for (; it_ != reader_->end(); ++it_) {
+    row_keys.Append(it_->row_key());
+    std::fill(seen_.begin(), seen_.end(), false);
+    for (auto const& cell : it_->cells()) {
+      auto index = FindColumn(cell);
+      // The cells in a column are sorted by decreasing timestamp, keep the
+      // first one.
+      if (index == column_count or seen_[index]) {
+        continue;
+      }
+      seen_[index] = true;
+      batch_.columns_[index]->Append(cell.value());
+    }
+    for (std::size_t i = 0; i != column_count; ++i) {
+      if (not seen_[i]) {
+        batch_.columns_[i]->AppendNull();
+      }
+    }
+    if (batch_.size() == batch_rows_) {
+      // Advance the iterator in the next call, doing it now could block
+      // waiting for more data.
+      return &batch_;
+    }
+  }
+  return batch_.size() == 0 ? nullptr : &batch_;
+}
+
+std::size_t ColumnarReader::FindColumn(CellView const& cell) const {
+  auto const& columns = projection_.columns_;
+  for (std::size_t i = 0; i != columns.size(); ++i) {
+    if (columns[i].qualifier == cell.column_qualifier() and
+        columns[i].family == cell.family_name()) {
+      return i;
+    }
+  }
+  return columns.size();
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
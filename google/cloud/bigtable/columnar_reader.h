@@ -0,0 +1,337 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COLUMNAR_READER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COLUMNAR_READER_H_
+
+#include "google/cloud/bigtable/filters.h"
+#include "google/cloud/bigtable/internal/endian.h"
+#include "google/cloud/bigtable/row_view_reader.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+class ColumnarReader;
+
+/**
+ * The values of one column for a batch of rows, and their validity mask.
+ *
+ * Row `i` in the batch has a value for this column iff `is_valid(i)` is true.
+ * The mask is a contiguous array of bytes (0 or 1) so it can be used directly
+ * by vectorized code.
+ */
+class ColumnBuffer {
+ public:
+  virtual ~ColumnBuffer() = default;
+
+  /// The number of rows in the batch.
+  std::size_t size() const { return validity_.size(); }
+
+  /// Return true if row @p row has a value for this column.
+  bool is_valid(std::size_t row) const { return validity_[row] != 0; }
+
+  /// The validity mask, one byte per row.
+  std::vector<std::uint8_t> const& validity() const { return validity_; }
+
+ protected:
+  friend class ColumnarReader;
+
+  /// Append the (encoded) value of a cell.
+  virtual void Append(std::string const& value) = 0;
+  /// Append a row without a value.
+  virtual void AppendNull() = 0;
+  /// Remove all the rows, keeping the allocated memory.
+  virtual void Clear() = 0;
+
+  std::vector<std::uint8_t> validity_;
+};
+
+/**
+ * The values of a column decoded as `T`, stored in a contiguous array.
+ *
+ * The values are decoded using `internal::Encoder<T>`.  Rows without a value
+ * contain a value-initialized `T`, so `T` must be default constructible.
+ * Values that `internal::Encoder<T>` cannot decode are treated as missing.
+ * `Encoder<T>` reports those values with an exception, in builds without
+ * exceptions they abort the program instead; validate the values before
+ * decoding them (as `Column<bigendian64_t>` does) to avoid that.
+ */
+template <typename T>
+class Column : public ColumnBuffer {
+ public:
+  /// The values, one per row.
+  std::vector<T> const& values() const { return values_; }
+
+  T const& operator[](std::size_t row) const { return values_[row]; }
+
+ protected:
+  void Append(std::string const& value) override {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      values_.emplace_back(internal::Encoder<T>::Decode(value));
+    } catch (std::exception const&) {
+      AppendNull();
+      return;
+    }
+#else
+    // There is no generic way to validate `value` first, an invalid value
+    // aborts the program.
+    values_.emplace_back(internal::Encoder<T>::Decode(value));
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    validity_.push_back(1);
+  }
+  void AppendNull() override {
+    values_.emplace_back();
+    validity_.push_back(0);
+  }
+  void Clear() override {
+    values_.clear();
+    validity_.clear();
+  }
+
+ private:
+  std::vector<T> values_;
+};
+
+/**
+ * The values of a column of 64-bit big-endian integers, as `std::int64_t`.
+ *
+ * The values are stored as plain integers so vectorized code can use them
+ * directly.  Rows without a value contain 0, as do rows whose value is not
+ * exactly 8 bytes long; both are marked invalid.
+ */
+template <>
+class Column<bigendian64_t> : public ColumnBuffer {
+ public:
+  /// The values, one per row.
+  std::vector<std::int64_t> const& values() const { return values_; }
+
+  std::int64_t operator[](std::size_t row) const { return values_[row]; }
+
+ protected:
+  void Append(std::string const& value) override {
+    if (value.size() != sizeof(std::int64_t)) {
+      AppendNull();
+      return;
+    }
+    values_.push_back(internal::Encoder<bigendian64_t>::Decode(value).get());
+    validity_.push_back(1);
+  }
+  void AppendNull() override {
+    values_.push_back(0);
+    validity_.push_back(0);
+  }
+  void Clear() override {
+    values_.clear();
+    validity_.clear();
+  }
+
+ private:
+  std::vector<std::int64_t> values_;
+};
+
+/**
+ * The raw values of a column, concatenated in a single buffer.
+ *
+ * Value `i` is the range `[offsets()[i], offsets()[i + 1])` of `data()`, so a
+ * batch of values requires no per-value allocations.  Rows without a value
+ * have an empty range.
+ */
+template <>
+class Column<std::string> : public ColumnBuffer {
+ public:
+  Column() : offsets_(1, 0) {}
+
+  /// All the values, concatenated.
+  std::string const& data() const { return data_; }
+
+  /// The offsets of each value in `data()`, with `size() + 1` elements.
+  std::vector<std::size_t> const& offsets() const { return offsets_; }
+
+  /// Return a copy of the value for row @p row.
+  std::string operator[](std::size_t row) const {
+    return data_.substr(offsets_[row], offsets_[row + 1] - offsets_[row]);
+  }
+
+ protected:
+  void Append(std::string const& value) override {
+    data_.append(value);
+    offsets_.push_back(data_.size());
+    validity_.push_back(1);
+  }
+  void AppendNull() override {
+    offsets_.push_back(data_.size());
+    validity_.push_back(0);
+  }
+  void Clear() override {
+    data_.clear();
+    offsets_.resize(1);
+    validity_.clear();
+  }
+
+ private:
+  std::string data_;
+  std::vector<std::size_t> offsets_;
+};
+
+/**
+ * The columns to materialize in a `ColumnarReader`, and their types.
+ *
+ * @par Example
+ * @code
+ * auto projection = bigtable::ColumnProjection()
+ *     .Add<bigtable::bigendian64_t>("stats", "count")
+ *     .Add<std::string>("stats", "name");
+ * @endcode
+ */
+class ColumnProjection {
+ public:
+  /// Add a column, its values are decoded with `internal::Encoder<T>`.
+  template <typename T>
+  ColumnProjection& Add(std::string family, std::string qualifier) {
+    columns_.emplace_back(ColumnSpec{
+        std::move(family), std::move(qualifier), [] {
+          return std::unique_ptr<ColumnBuffer>(new Column<T>);
+        }});
+    return *this;
+  }
+
+  /// The number of columns.
+  std::size_t size() const { return columns_.size(); }
+
+  /**
+   * Return a filter that selects the latest cell in each projected column.
+   *
+   * `Table::ReadColumns()` chains this filter after the application filter,
+   * so the server only returns the cells used to fill the batches.  Note
+   * that rows without any of the projected columns are not returned.
+   */
+  Filter filter() const;
+
+ private:
+  friend class ColumnarReader;
+
+  struct ColumnSpec {
+    std::string family;
+    std::string qualifier;
+    std::function<std::unique_ptr<ColumnBuffer>()> factory;
+  };
+  std::vector<ColumnSpec> columns_;
+};
+
+/**
+ * A batch of rows, stored as one typed buffer per projected column.
+ *
+ * Column `i` corresponds to the `i`-th column added to the `ColumnProjection`.
+ */
+class ColumnBatch {
+ public:
+  /// The number of rows in the batch.
+  std::size_t size() const { return row_keys_.size(); }
+
+  /// The row keys, one per row.
+  Column<std::string> const& row_keys() const { return row_keys_; }
+
+  /**
+   * Return column @p index, which must have been added as a `T`.
+   *
+   * @throws std::invalid_argument if the column has a different type.
+   */
+  template <typename T>
+  Column<T> const& column(std::size_t index) const {
+    auto const* c = dynamic_cast<Column<T> const*>(columns_.at(index).get());
+    if (c == nullptr) {
+      google::cloud::internal::RaiseInvalidArgument(
+          "ColumnBatch::column() called with the wrong type");
+    }
+    return *c;
+  }
+
+ private:
+  friend class ColumnarReader;
+
+  Column<std::string> row_keys_;
+  std::vector<std::unique_ptr<ColumnBuffer>> columns_;
+};
+
+/**
+ * Read rows into columnar (struct-of-arrays) batches.
+ *
+ * Analytic scans that read a fixed set of columns can use this class instead
+ * of transposing `Row` objects themselves.  The rows are parsed by a
+ * `RowViewReader`, without creating `Row` or `Cell` objects, and the latest
+ * cell of each projected column is appended to a typed, contiguous column
+ * buffer.  The buffers are reused from one batch to the next.
+ *
+ * @par Example
+ * @code
+ * auto reader = table.ReadColumns(
+ *     bigtable::RowSet(), projection, bigtable::Filter::PassAllFilter(), 4096);
+ * while (auto const* batch = reader.Next()) {
+ *   auto const& counts = batch->column<bigtable::bigendian64_t>(0);
+ *   // ... counts.values().data() is valid until the next call to Next() ...
+ * }
+ * @endcode
+ */
+class ColumnarReader {
+ public:
+  ColumnarReader(RowViewReader reader, ColumnProjection projection,
+                 std::size_t batch_rows);
+
+  /**
+   * Read the next batch of up to `batch_rows` rows.
+   *
+   * Values that cannot be decoded as the column type are marked invalid, as
+   * if the row had no value for that column.  In builds without exceptions
+   * such values abort the program, except in the `bigendian64_t` columns,
+   * which check the size first, and the `std::string` columns, which do not
+   * decode the values.
+   *
+   * @return the batch, valid until the next call, or `nullptr` at the end of
+   *     the scan.
+   * @throws std::runtime_error if the read failed after retries, and the
+   *     reader was created with `raise_on_error`.
+   */
+  ColumnBatch const* Next();
+
+  /// Return the status of the read, see `RowReader::Finish()`.
+  grpc::Status Finish() { return reader_->Finish(); }
+
+ private:
+  /// Return the index of the column for @p cell, or `size()` if not projected.
+  std::size_t FindColumn(CellView const& cell) const;
+
+  std::unique_ptr<RowViewReader> reader_;
+  RowViewReader::iterator it_;
+  bool started_;
+  ColumnProjection projection_;
+  std::size_t batch_rows_;
+  ColumnBatch batch_;
+  std::vector<bool> seen_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COLUMNAR_READER_H_
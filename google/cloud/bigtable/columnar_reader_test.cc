@@ -0,0 +1,195 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/columnar_reader.h"
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/bigtable/testing/mock_read_rows_reader.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace ::testing;
+
+/// Define helper types and functions for this test.
+namespace {
+class ColumnarReaderTest : public bigtable::testing::TableTestFixture {};
+using bigtable::testing::MockReadRowsReader;
+
+void AddCell(btproto::ReadRowsResponse& response, std::string const& key,
+             std::string const& column, std::string const& value,
+             bool commit) {
+  auto& chunk = *response.add_chunks();
+  chunk.set_row_key(key);
+  chunk.mutable_family_name()->set_value("fam");
+  chunk.mutable_qualifier()->set_value(column);
+  chunk.set_value(value);
+  chunk.set_commit_row(commit);
+}
+
+std::string Int64(std::int64_t v) {
+  return bigtable::internal::Encoder<bigtable::bigendian64_t>::Encode(
+      bigtable::bigendian64_t(v));
+}
+
+bigtable::ColumnProjection MakeProjection() {
+  return bigtable::ColumnProjection()
+      .Add<bigtable::bigendian64_t>("fam", "count")
+      .Add<std::string>("fam", "name");
+}
+}  // anonymous namespace
+
+/// @test Verify that ColumnarReader fills the columns in batches.
+TEST_F(ColumnarReaderTest, ReadBatches) {
+  btproto::ReadRowsResponse response;
+  AddCell(response, "r1", "count", Int64(10), false);
+  // Only the first (latest) cell in each column is used.
+  AddCell(response, "r1", "count", Int64(9), false);
+  AddCell(response, "r1", "name", "one", true);
+  AddCell(response, "r2", "count", Int64(20), true);
+  AddCell(response, "r3", "ignored", "x", false);
+  AddCell(response, "r3", "name", "three", true);
+
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke([stream](grpc::ClientContext*,
+                                btproto::ReadRowsRequest const& r) {
+        EXPECT_TRUE(r.filter().has_chain());
+        return stream->AsUniqueMocked();
+      }));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto reader = table_.ReadColumns(bigtable::RowSet(), MakeProjection(),
+                                   bigtable::Filter::PassAllFilter(), 2);
+  auto const* batch = reader.Next();
+  ASSERT_NE(nullptr, batch);
+  ASSERT_EQ(2U, batch->size());
+  EXPECT_EQ("r1", batch->row_keys()[0]);
+  EXPECT_EQ("r2", batch->row_keys()[1]);
+  auto const& counts = batch->column<bigtable::bigendian64_t>(0);
+  ASSERT_EQ(2U, counts.size());
+  EXPECT_EQ(10, counts[0]);
+  EXPECT_EQ(20, counts[1]);
+  EXPECT_THAT(counts.validity(), ElementsAre(1, 1));
+  auto const& names = batch->column<std::string>(1);
+  EXPECT_EQ("one", names[0]);
+  EXPECT_EQ("", names[1]);
+  EXPECT_THAT(names.validity(), ElementsAre(1, 0));
+  EXPECT_THAT(names.offsets(), ElementsAre(0, 3, 3));
+
+  batch = reader.Next();
+  ASSERT_NE(nullptr, batch);
+  ASSERT_EQ(1U, batch->size());
+  EXPECT_EQ("r3", batch->row_keys()[0]);
+  EXPECT_FALSE(batch->column<bigtable::bigendian64_t>(0).is_valid(0));
+  EXPECT_EQ("three", batch->column<std::string>(1)[0]);
+  EXPECT_EQ("three", batch->column<std::string>(1).data());
+
+  EXPECT_EQ(nullptr, reader.Next());
+  EXPECT_EQ(nullptr, reader.Next());
+  EXPECT_TRUE(reader.Finish().ok());
+}
+
+/// @test Verify that values with the wrong size are treated as missing.
+TEST_F(ColumnarReaderTest, MalformedValueIsNull) {
+  btproto::ReadRowsResponse response;
+  AddCell(response, "r1", "count", std::string("\0\0\0\x01", 4), true);
+  AddCell(response, "r2", "count", Int64(20), true);
+
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto reader = table_.ReadColumns(bigtable::RowSet(), MakeProjection(),
+                                   bigtable::Filter::PassAllFilter(), 10);
+  auto const* batch = reader.Next();
+  ASSERT_NE(nullptr, batch);
+  ASSERT_EQ(2U, batch->size());
+  auto const& counts = batch->column<bigtable::bigendian64_t>(0);
+  EXPECT_THAT(counts.values(), ElementsAre(0, 20));
+  EXPECT_THAT(counts.validity(), ElementsAre(0, 1));
+
+  EXPECT_EQ(nullptr, reader.Next());
+  EXPECT_TRUE(reader.Finish().ok());
+}
+
+/// @test Verify that an empty scan returns no batches.
+TEST_F(ColumnarReaderTest, EmptyScan) {
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto reader = table_.ReadColumns(bigtable::RowSet(), MakeProjection(),
+                                   bigtable::Filter::PassAllFilter(), 10);
+  EXPECT_EQ(nullptr, reader.Next());
+}
+
+/// @test Verify the filter created for a projection.
+TEST(ColumnProjectionTest, Filter) {
+  auto single = bigtable::ColumnProjection()
+                    .Add<std::string>("fam", "c1")
+                    .filter()
+                    .as_proto();
+  ASSERT_TRUE(single.has_chain());
+  ASSERT_EQ(2, single.chain().filters_size());
+  EXPECT_EQ("c1", single.chain()
+                      .filters(0)
+                      .column_range_filter()
+                      .start_qualifier_closed());
+  EXPECT_EQ(1, single.chain().filters(1).cells_per_column_limit_filter());
+
+  auto proto = MakeProjection().filter().as_proto();
+  ASSERT_TRUE(proto.has_chain());
+  ASSERT_EQ(2, proto.chain().filters_size());
+  auto const& interleave = proto.chain().filters(0).interleave();
+  ASSERT_EQ(2, interleave.filters_size());
+  EXPECT_EQ("count",
+            interleave.filters(0).column_range_filter().end_qualifier_closed());
+  EXPECT_EQ("name",
+            interleave.filters(1).column_range_filter().end_qualifier_closed());
+
+  auto keys_only = bigtable::ColumnProjection().filter().as_proto();
+  ASSERT_TRUE(keys_only.has_chain());
+  EXPECT_EQ(1, keys_only.chain().filters(0).cells_per_row_limit_filter());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that requesting a column with the wrong type fails.
+TEST_F(ColumnarReaderTest, WrongColumnType) {
+  btproto::ReadRowsResponse response;
+  AddCell(response, "r1", "name", "one", true);
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto reader = table_.ReadColumns(bigtable::RowSet(), MakeProjection(),
+                                   bigtable::Filter::PassAllFilter(), 10);
+  auto const* batch = reader.Next();
+  ASSERT_NE(nullptr, batch);
+  EXPECT_THROW(batch->column<std::string>(0), std::invalid_argument);
+  EXPECT_THROW(batch->column<std::string>(2), std::out_of_range);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
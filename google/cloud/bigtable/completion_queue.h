@@ -0,0 +1,197 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COMPLETION_QUEUE_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COMPLETION_QUEUE_H_
+
+#include "google/cloud/bigtable/async_operation.h"
+#include "google/cloud/bigtable/internal/completion_queue_impl.h"
+#include "google/cloud/bigtable/version.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Call the functor associated with asynchronous operations when they complete.
+ *
+ * Applications create one (or a few) `CompletionQueue` objects, run the event
+ * loop in one or more threads using `Run()`, and pass the `CompletionQueue` to
+ * the asynchronous member functions of `Table`.  The callbacks for those
+ * operations are invoked from the threads running the event loop.
+ *
+ * `CompletionQueue` objects are cheap to copy, all the copies share the same
+ * underlying queue.
+ *
+ * @par Example
+ * @code
+ * bigtable::CompletionQueue cq;
+ * std::thread t([&cq]() { cq.Run(); });
+ * table.AsyncApply(std::move(mutation), cq, callback);
+ * // ... eventually ...
+ * cq.Shutdown();
+ * t.join();
+ * @endcode
+ */
+class CompletionQueue {
+ public:
+  CompletionQueue();
+  explicit CompletionQueue(std::shared_ptr<internal::CompletionQueueImpl> impl)
+      : impl_(std::move(impl)) {}
+
+  /**
+   * Run the completion queue event loop.
+   *
+   * Note that more than one thread can call this member function, to create a
+   * pool of threads completing asynchronous operations.
+   */
+  void Run();
+
+  /// Terminate the completion queue event loop.
+  void Shutdown();
+
+  /**
+   * Create a timer that fires at @p deadline.
+   *
+   * @tparam Functor the functor to call when the timer expires and/or it is
+   *     canceled.  It must satisfy the `void(CompletionQueue&,
+   *     AsyncTimerResult&)` signature.
+   * @param deadline when should the timer expire.
+   * @param functor the value of the functor.
+   * @return an asynchronous operation wrapping the functor and timer, can be
+   *   used to cancel the pending timer.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> MakeDeadlineTimer(
+      std::chrono::system_clock::time_point deadline, Functor&& functor) {
+    auto op = std::make_shared<
+        internal::AsyncTimerFunctor<typename std::decay<Functor>::type>>(
+        std::forward<Functor>(functor));
+    void* tag = impl_->RegisterOperation(op);
+    op->Set(impl_->cq(), deadline, tag);
+    return op;
+  }
+
+  /**
+   * Create a timer that fires after the @p duration.
+   *
+   * @tparam Rep a placeholder to match the Rep tparam for @p duration type,
+   *     the semantics of this template parameter are documented in
+   *     `std::chrono::duration<>` (in brief, the underlying arithmetic type
+   *     used to store the number of ticks), for our purposes it is simply a
+   *     formal parameter.
+   * @tparam Period a placeholder to match the Period tparam for @p duration
+   *     type, the semantics of this template parameter are documented in
+   *     `std::chrono::duration<>` (in brief, the length of the tick in seconds,
+   *     expressed as a `std::ratio<>`), for our purposes it is simply a formal
+   *     parameter.
+   * @tparam Functor the functor to call when the timer expires and/or it is
+   *     canceled.  It must satisfy the `void(CompletionQueue&,
+   *     AsyncTimerResult&)` signature.
+   */
+  template <typename Rep, typename Period, typename Functor>
+  std::shared_ptr<AsyncOperation> MakeRelativeTimer(
+      std::chrono::duration<Rep, Period> duration, Functor&& functor) {
+    auto deadline = std::chrono::system_clock::now() +
+                    std::chrono::duration_cast<
+                        std::chrono::system_clock::duration>(duration);
+    return MakeDeadlineTimer(deadline, std::forward<Functor>(functor));
+  }
+
+  /**
+   * Make an asynchronous unary RPC.
+   *
+   * @param client the object implementing the asynchronous API, typically a
+   *     `bigtable::DataClient`.
+   * @param async_call a pointer to the member function of @p client that starts
+   *     the RPC, with signature
+   *     `std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<Response>>(
+   *      grpc::ClientContext*, Request const&, grpc::CompletionQueue*)`.
+   * @param request the contents of the request.
+   * @param context an initialized request context to make the call.
+   * @param functor the callback, invoked as
+   *     `void(CompletionQueue&, Response&, grpc::Status&)` when the RPC
+   *     completes.
+   * @return an asynchronous operation wrapping the RPC, can be used to cancel
+   *     it.
+   *
+   * @tparam Client the type of @p client.
+   * @tparam Request the type of @p request.
+   * @tparam Response the type of the response.
+   * @tparam Functor the type of @p functor.
+   */
+  template <typename Client, typename Request, typename Response,
+            typename Functor>
+  std::shared_ptr<AsyncOperation> MakeUnaryRpc(
+      Client& client,
+      std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<Response>> (
+          Client::*async_call)(grpc::ClientContext*, Request const&,
+                               grpc::CompletionQueue*),
+      Request const& request, std::unique_ptr<grpc::ClientContext> context,
+      Functor&& functor) {
+    auto op = std::make_shared<internal::AsyncUnaryRpcFunctor<
+        Response, typename std::decay<Functor>::type>>(
+        std::move(context), std::forward<Functor>(functor));
+    void* tag = impl_->RegisterOperation(op);
+    op->Set((client.*async_call)(op->context(), request, &impl_->cq()), tag);
+    return op;
+  }
+
+  /**
+   * Make an asynchronous RPC with a streaming response.
+   *
+   * @param client the object implementing the asynchronous API, typically a
+   *     `bigtable::DataClient`.
+   * @param async_call a pointer to the member function of @p client that
+   *     prepares the RPC, with signature
+   *     `std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>>(
+   *      grpc::ClientContext*, Request const&, grpc::CompletionQueue*)`.
+   * @param request the contents of the request.
+   * @param context an initialized request context to make the call.
+   * @param on_read the callback for each response, invoked as
+   *     `void(CompletionQueue&, Response&)`.
+   * @param on_finish the callback for the final status, invoked as
+   *     `void(CompletionQueue&, grpc::Status&)`.
+   * @return an asynchronous operation wrapping the RPC, can be used to cancel
+   *     it.
+   */
+  template <typename Client, typename Request, typename Response,
+            typename ReadFunctor, typename FinishFunctor>
+  std::shared_ptr<AsyncOperation> MakeStreamingReadRpc(
+      Client& client,
+      std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> (
+          Client::*async_call)(grpc::ClientContext*, Request const&,
+                               grpc::CompletionQueue*),
+      Request const& request, std::unique_ptr<grpc::ClientContext> context,
+      ReadFunctor&& on_read, FinishFunctor&& on_finish) {
+    auto op = std::make_shared<internal::AsyncReadStreamFunctor<
+        Response, typename std::decay<ReadFunctor>::type,
+        typename std::decay<FinishFunctor>::type>>(
+        std::move(context), std::forward<ReadFunctor>(on_read),
+        std::forward<FinishFunctor>(on_finish));
+    void* tag = impl_->RegisterOperation(op);
+    op->Set((client.*async_call)(op->context(), request, &impl_->cq()), tag);
+    return op;
+  }
+
+ private:
+  std::shared_ptr<internal::CompletionQueueImpl> impl_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_COMPLETION_QUEUE_H_
@@ -0,0 +1,179 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/testing/mock_async_response_reader.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <gmock/gmock.h>
+#include <future>
+#include <thread>
+
+namespace bigtable = google::cloud::bigtable;
+namespace btproto = google::bigtable::v2;
+using namespace google::cloud::testing_util::chrono_literals;
+using namespace ::testing;
+
+namespace {
+class MockClient {
+ public:
+  MOCK_METHOD3(AsyncMutateRow,
+               std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+                   btproto::MutateRowResponse>>(
+                   grpc::ClientContext*, btproto::MutateRowRequest const&,
+                   grpc::CompletionQueue*));
+  MOCK_METHOD3(PrepareAsyncReadRows,
+               std::unique_ptr<grpc::ClientAsyncReaderInterface<
+                   btproto::ReadRowsResponse>>(grpc::ClientContext*,
+                                               btproto::ReadRowsRequest const&,
+                                               grpc::CompletionQueue*));
+};
+}  // anonymous namespace
+
+/// @test Verify that the basic functionality in a CompletionQueue works.
+TEST(CompletionQueueTest, TimerSmokeTest) {
+  bigtable::CompletionQueue cq;
+  std::thread t([&cq]() { cq.Run(); });
+
+  std::promise<bool> promise;
+  cq.MakeRelativeTimer(
+      2_ms, [&promise](bigtable::CompletionQueue&,
+                       bigtable::AsyncTimerResult& result) {
+        promise.set_value(result.cancelled);
+      });
+  auto f = promise.get_future();
+  auto status = f.wait_for(50_ms);
+  EXPECT_EQ(std::future_status::ready, status);
+  EXPECT_FALSE(f.get());
+
+  cq.Shutdown();
+  t.join();
+}
+
+/// @test Verify that timers can be cancelled.
+TEST(CompletionQueueTest, TimerCancel) {
+  bigtable::CompletionQueue cq;
+  std::thread t([&cq]() { cq.Run(); });
+
+  std::promise<bool> promise;
+  auto op = cq.MakeRelativeTimer(
+      std::chrono::hours(1),
+      [&promise](bigtable::CompletionQueue&,
+                 bigtable::AsyncTimerResult& result) {
+        promise.set_value(result.cancelled);
+      });
+  op->Cancel();
+  auto f = promise.get_future();
+  auto status = f.wait_for(500_ms);
+  EXPECT_EQ(std::future_status::ready, status);
+  EXPECT_TRUE(f.get());
+
+  cq.Shutdown();
+  t.join();
+}
+
+/// @test Verify that unary RPCs deliver their result to the callback.
+TEST(CompletionQueueTest, MockUnaryRpc) {
+  auto impl = std::make_shared<bigtable::testing::MockCompletionQueue>();
+  bigtable::CompletionQueue cq(impl);
+
+  MockClient client;
+  using ReaderType =
+      bigtable::testing::MockAsyncResponseReader<btproto::MutateRowResponse>;
+  // gRPC does not delete these objects, the test must own them.
+  auto reader_owner = google::cloud::internal::make_unique<ReaderType>();
+  auto reader = reader_owner.get();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btproto::MutateRowResponse*, grpc::Status* status,
+                          void*) { *status = grpc::Status::OK; }));
+  EXPECT_CALL(client, AsyncMutateRow(_, _, _))
+      .WillOnce(Invoke([reader](grpc::ClientContext*,
+                                btproto::MutateRowRequest const&,
+                                grpc::CompletionQueue*) {
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            btproto::MutateRowResponse>>(reader);
+      }));
+
+  btproto::MutateRowRequest request;
+  bool completed = false;
+  cq.MakeUnaryRpc(
+      client, &MockClient::AsyncMutateRow, request,
+      std::unique_ptr<grpc::ClientContext>(new grpc::ClientContext),
+      [&completed](bigtable::CompletionQueue&, btproto::MutateRowResponse&,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        completed = true;
+      });
+  EXPECT_EQ(1U, impl->size());
+  impl->SimulateCompletion(cq, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(impl->empty());
+}
+
+/// @test Verify that streaming RPCs deliver each response and the status.
+TEST(CompletionQueueTest, MockStreamingReadRpc) {
+  auto impl = std::make_shared<bigtable::testing::MockCompletionQueue>();
+  bigtable::CompletionQueue cq(impl);
+
+  MockClient client;
+  using ReaderType =
+      bigtable::testing::MockAsyncReader<btproto::ReadRowsResponse>;
+  auto reader = new ReaderType;
+  EXPECT_CALL(*reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*reader, Read(_, _)).Times(3);
+  EXPECT_CALL(*reader, Finish(_, _))
+      .WillOnce(Invoke([](grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+  EXPECT_CALL(client, PrepareAsyncReadRows(_, _, _))
+      .WillOnce(Invoke([reader](grpc::ClientContext*,
+                                btproto::ReadRowsRequest const&,
+                                grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            reader);
+      }));
+
+  btproto::ReadRowsRequest request;
+  int read_count = 0;
+  bool finished = false;
+  cq.MakeStreamingReadRpc(
+      client, &MockClient::PrepareAsyncReadRows, request,
+      std::unique_ptr<grpc::ClientContext>(new grpc::ClientContext),
+      [&read_count](bigtable::CompletionQueue&, btproto::ReadRowsResponse&) {
+        ++read_count;
+      },
+      [&finished](bigtable::CompletionQueue&, grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, status.error_code());
+        finished = true;
+      });
+
+  // The call starts.
+  impl->SimulateCompletion(cq, true);
+  EXPECT_EQ(0, read_count);
+  // Two responses.
+  impl->SimulateCompletion(cq, true);
+  impl->SimulateCompletion(cq, true);
+  EXPECT_EQ(2, read_count);
+  // The end of the stream.
+  impl->SimulateCompletion(cq, false);
+  EXPECT_FALSE(finished);
+  EXPECT_FALSE(impl->empty());
+  // The final status.
+  impl->SimulateCompletion(cq, true);
+  EXPECT_TRUE(finished);
+  EXPECT_TRUE(impl->empty());
+}
@@ -21,6 +21,77 @@ namespace google {
 namespace cloud {
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/**
+ * Wrap a streaming RPC to count it as in-flight until it is destroyed.
+ *
+ * @tparam Response the response type for the stream.
+ */
+template <typename Response>
+class CountedClientReader : public grpc::ClientReaderInterface<Response> {
+ public:
+  CountedClientReader(
+      std::unique_ptr<grpc::ClientReaderInterface<Response>> stream,
+      internal::CallGuard guard)
+      : stream_(std::move(stream)), guard_(std::move(guard)) {}
+
+  bool Read(Response* msg) override { return stream_->Read(msg); }
+  grpc::Status Finish() override { return stream_->Finish(); }
+  bool NextMessageSize(std::uint32_t* sz) override {
+    return stream_->NextMessageSize(sz);
+  }
+  void WaitForInitialMetadata() override { stream_->WaitForInitialMetadata(); }
+
+ private:
+  std::unique_ptr<grpc::ClientReaderInterface<Response>> stream_;
+  internal::CallGuard guard_;
+};
+
+template <typename Response>
+std::unique_ptr<grpc::ClientReaderInterface<Response>> CountStream(
+    std::unique_ptr<grpc::ClientReaderInterface<Response>> stream,
+    internal::CallGuard guard) {
+  return std::unique_ptr<grpc::ClientReaderInterface<Response>>(
+      new CountedClientReader<Response>(std::move(stream), std::move(guard)));
+}
+
+/**
+ * Wrap an asynchronous streaming RPC to count it as in-flight until it is
+ * destroyed.
+ *
+ * @tparam Response the response type for the stream.
+ */
+template <typename Response>
+class CountedAsyncReader : public grpc::ClientAsyncReaderInterface<Response> {
+ public:
+  CountedAsyncReader(
+      std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> stream,
+      internal::CallGuard guard)
+      : stream_(std::move(stream)), guard_(std::move(guard)) {}
+
+  void StartCall(void* tag) override { stream_->StartCall(tag); }
+  void ReadInitialMetadata(void* tag) override {
+    stream_->ReadInitialMetadata(tag);
+  }
+  void Read(Response* msg, void* tag) override { stream_->Read(msg, tag); }
+  void Finish(grpc::Status* status, void* tag) override {
+    stream_->Finish(status, tag);
+  }
+
+ private:
+  std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> stream_;
+  internal::CallGuard guard_;
+};
+
+template <typename Response>
+std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> CountAsyncStream(
+    std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> stream,
+    internal::CallGuard guard) {
+  return std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>>(
+      new CountedAsyncReader<Response>(std::move(stream), std::move(guard)));
+}
+}  // anonymous namespace
+
 /**
  * Implement a simple DataClient.
  *
@@ -44,7 +115,12 @@ class DefaultDataClient : public DataClient {
                     ClientOptions options)
       : project_(std::move(project)),
         instance_(std::move(instance)),
-        impl_(std::move(options)) {}
+        impl_(options) {
+    if (options.prime_connections_timeout().count() > 0) {
+      (void)impl_.PrimeConnections(std::chrono::system_clock::now() +
+                                   options.prime_connections_timeout());
+    }
+  }
 
   DefaultDataClient(std::string project, std::string instance)
       : DefaultDataClient(std::move(project), std::move(instance),
@@ -55,43 +131,117 @@ class DefaultDataClient : public DataClient {
 
   std::shared_ptr<grpc::Channel> Channel() override { return impl_.Channel(); }
   void reset() override { impl_.reset(); }
+  std::vector<long> ChannelLoad() override { return impl_.ChannelLoad(); }
+  std::size_t SelectChannel() override { return impl_.SelectChannel(); }
+  grpc::Status PrimeConnections(
+      std::chrono::system_clock::time_point deadline) override {
+    return impl_.PrimeConnections(deadline);
+  }
 
   grpc::Status MutateRow(grpc::ClientContext* context,
                          btproto::MutateRowRequest const& request,
                          btproto::MutateRowResponse* response) override {
-    return impl_.Stub()->MutateRow(context, request, response);
+    internal::CallGuard guard;
+    return impl_.Stub(guard)->MutateRow(context, request, response);
   }
 
   grpc::Status CheckAndMutateRow(
       grpc::ClientContext* context,
       btproto::CheckAndMutateRowRequest const& request,
       btproto::CheckAndMutateRowResponse* response) override {
-    return impl_.Stub()->CheckAndMutateRow(context, request, response);
+    internal::CallGuard guard;
+    return impl_.Stub(guard)->CheckAndMutateRow(context, request, response);
   }
 
   grpc::Status ReadModifyWriteRow(
       grpc::ClientContext* context,
       btproto::ReadModifyWriteRowRequest const& request,
       btproto::ReadModifyWriteRowResponse* response) override {
-    return impl_.Stub()->ReadModifyWriteRow(context, request, response);
+    internal::CallGuard guard;
+    return impl_.Stub(guard)->ReadModifyWriteRow(context, request, response);
   }
 
   std::unique_ptr<grpc::ClientReaderInterface<btproto::ReadRowsResponse>>
   ReadRows(grpc::ClientContext* context,
            btproto::ReadRowsRequest const& request) override {
-    return impl_.Stub()->ReadRows(context, request);
+    internal::CallGuard guard;
+    auto stream = impl_.Stub(guard)->ReadRows(context, request);
+    return CountStream(std::move(stream), std::move(guard));
   }
 
   std::unique_ptr<grpc::ClientReaderInterface<btproto::SampleRowKeysResponse>>
   SampleRowKeys(grpc::ClientContext* context,
                 btproto::SampleRowKeysRequest const& request) override {
-    return impl_.Stub()->SampleRowKeys(context, request);
+    internal::CallGuard guard;
+    auto stream = impl_.Stub(guard)->SampleRowKeys(context, request);
+    return CountStream(std::move(stream), std::move(guard));
   }
 
   std::unique_ptr<grpc::ClientReaderInterface<btproto::MutateRowsResponse>>
   MutateRows(grpc::ClientContext* context,
              btproto::MutateRowsRequest const& request) override {
-    return impl_.Stub()->MutateRows(context, request);
+    internal::CallGuard guard;
+    auto stream = impl_.Stub(guard)->MutateRows(context, request);
+    return CountStream(std::move(stream), std::move(guard));
+  }
+
+  // gRPC never deletes the readers for asynchronous unary RPCs, their memory
+  // belongs to the call and `std::default_delete<>` is specialized as a no-op.
+  // A wrapper would never release its `CallGuard`, so these calls are not
+  // counted.
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<btproto::MutateRowResponse>>
+  AsyncMutateRow(grpc::ClientContext* context,
+                 btproto::MutateRowRequest const& request,
+                 grpc::CompletionQueue* cq) override {
+    return impl_.Stub()->AsyncMutateRow(context, request, cq);
+  }
+
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      btproto::CheckAndMutateRowResponse>>
+  AsyncCheckAndMutateRow(grpc::ClientContext* context,
+                         btproto::CheckAndMutateRowRequest const& request,
+                         grpc::CompletionQueue* cq) override {
+    return impl_.Stub()->AsyncCheckAndMutateRow(context, request, cq);
+  }
+
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      btproto::ReadModifyWriteRowResponse>>
+  AsyncReadModifyWriteRow(grpc::ClientContext* context,
+                          btproto::ReadModifyWriteRowRequest const& request,
+                          grpc::CompletionQueue* cq) override {
+    return impl_.Stub()->AsyncReadModifyWriteRow(context, request, cq);
+  }
+
+  std::unique_ptr<grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>
+  PrepareAsyncReadRows(grpc::ClientContext* context,
+                       btproto::ReadRowsRequest const& request,
+                       grpc::CompletionQueue* cq) override {
+    internal::CallGuard guard;
+    auto stream =
+        impl_.Stub(guard)->PrepareAsyncReadRows(context, request, cq);
+    return CountAsyncStream(std::move(stream), std::move(guard));
+  }
+
+  std::unique_ptr<grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>
+  PrepareAsyncReadRowsOnChannel(grpc::ClientContext* context,
+                                btproto::ReadRowsRequest const& request,
+                                grpc::CompletionQueue* cq,
+                                std::size_t channel) override {
+    internal::CallGuard guard;
+    auto stream = impl_.Stub(guard, channel)
+                      ->PrepareAsyncReadRows(context, request, cq);
+    return CountAsyncStream(std::move(stream), std::move(guard));
+  }
+
+  std::unique_ptr<grpc::ClientAsyncReaderInterface<btproto::MutateRowsResponse>>
+  PrepareAsyncMutateRows(grpc::ClientContext* context,
+                         btproto::MutateRowsRequest const& request,
+                         grpc::CompletionQueue* cq) override {
+    internal::CallGuard guard;
+    auto stream =
+        impl_.Stub(guard)->PrepareAsyncMutateRows(context, request, cq);
+    return CountAsyncStream(std::move(stream), std::move(guard));
   }
 
  private:
@@ -29,6 +29,10 @@ class Table;
 }  // namespace noex
 namespace internal {
 class BulkMutator;
+template <typename Functor>
+class AsyncRetryBulkApply;
+template <typename RowFunctor, typename FinishFunctor>
+class AsyncRowReader;
 }  // namespace internal
 
 /**
@@ -65,6 +69,30 @@ class DataClient {
    */
   virtual void reset() = 0;
 
+  /**
+   * Return the number of in-flight calls on each channel in the pool.
+   *
+   * The size of the result is the current size of the pool, which may change
+   * if `ClientOptions::max_connection_pool_size()` is set.  Implementations
+   * that do not track the load return an empty vector.
+   */
+  virtual std::vector<long> ChannelLoad() { return {}; }
+
+  /**
+   * Connect all the channels in the pool, waiting until @p deadline.
+   *
+   * Applications can call this function before sending traffic, so the first
+   * calls do not pay for the connection setup.  It returns quickly if the
+   * channels are already connected.
+   *
+   * @return OK if all the channels are connected.  Implementations that do
+   *     not support this operation always return OK.
+   */
+  virtual grpc::Status PrimeConnections(
+      std::chrono::system_clock::time_point deadline) {
+    return grpc::Status::OK;
+  }
+
   // The member functions of this class are not intended for general use by
   // application developers (they are simply a dependency injection point). Make
   // them protected, so the mock classes can override them, and then make the
@@ -74,6 +102,11 @@ class DataClient {
   friend class noex::Table;
   friend class internal::BulkMutator;
   friend class RowReader;
+  friend class RowViewReader;
+  template <typename Functor>
+  friend class internal::AsyncRetryBulkApply;
+  template <typename RowFunctor, typename FinishFunctor>
+  friend class internal::AsyncRowReader;
   //@{
   /// @name the `google.bigtable.v2.Bigtable` wrappers.
   virtual grpc::Status MutateRow(
@@ -101,6 +134,58 @@ class DataClient {
   MutateRows(grpc::ClientContext* context,
              google::bigtable::v2::MutateRowsRequest const& request) = 0;
   //@}
+
+  //@{
+  /// @name the asynchronous `google.bigtable.v2.Bigtable` wrappers.
+  virtual std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      google::bigtable::v2::MutateRowResponse>>
+  AsyncMutateRow(grpc::ClientContext* context,
+                 google::bigtable::v2::MutateRowRequest const& request,
+                 grpc::CompletionQueue* cq) = 0;
+  virtual std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      google::bigtable::v2::CheckAndMutateRowResponse>>
+  AsyncCheckAndMutateRow(
+      grpc::ClientContext* context,
+      google::bigtable::v2::CheckAndMutateRowRequest const& request,
+      grpc::CompletionQueue* cq) = 0;
+  virtual std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      google::bigtable::v2::ReadModifyWriteRowResponse>>
+  AsyncReadModifyWriteRow(
+      grpc::ClientContext* context,
+      google::bigtable::v2::ReadModifyWriteRowRequest const& request,
+      grpc::CompletionQueue* cq) = 0;
+  virtual std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<google::bigtable::v2::ReadRowsResponse>>
+  PrepareAsyncReadRows(grpc::ClientContext* context,
+                       google::bigtable::v2::ReadRowsRequest const& request,
+                       grpc::CompletionQueue* cq) = 0;
+  virtual std::unique_ptr<grpc::ClientAsyncReaderInterface<
+      google::bigtable::v2::MutateRowsResponse>>
+  PrepareAsyncMutateRows(grpc::ClientContext* context,
+                         google::bigtable::v2::MutateRowsRequest const& request,
+                         grpc::CompletionQueue* cq) = 0;
+  //@}
+
+  //@{
+  /**
+   * @name Select the channel for a call.
+   *
+   * Hedged reads use these functions to send the hedge on a different channel
+   * than the first attempt.  `SelectChannel()` picks the channel for the next
+   * call, and `PrepareAsyncReadRowsOnChannel()` starts a call on the channel
+   * at @p channel.  Implementations without a pool of channels return 0 and
+   * ignore @p channel.
+   */
+  virtual std::size_t SelectChannel() { return 0; }
+  virtual std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<google::bigtable::v2::ReadRowsResponse>>
+  PrepareAsyncReadRowsOnChannel(
+      grpc::ClientContext* context,
+      google::bigtable::v2::ReadRowsRequest const& request,
+      grpc::CompletionQueue* cq, std::size_t channel) {
+    return PrepareAsyncReadRows(context, request, cq);
+  }
+  //@}
 };
 
 /// Create the default implementation of ClientInterface.
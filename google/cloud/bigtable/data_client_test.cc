@@ -13,10 +13,15 @@
 // limitations under the License.
 
 #include "google/cloud/bigtable/data_client.h"
+#include "google/cloud/bigtable/internal/table.h"
 
 #include <gmock/gmock.h>
+#include <future>
+#include <thread>
 
 namespace bigtable = google::cloud::bigtable;
+namespace btproto = google::bigtable::v2;
+using namespace ::testing;
 
 TEST(DataClientTest, Default) {
   auto data_client = bigtable::CreateDefaultDataClient(
@@ -37,3 +42,34 @@ TEST(DataClientTest, Default) {
   EXPECT_TRUE(channel1);
   EXPECT_NE(channel0.get(), channel1.get());
 }
+
+/// @test Verify that asynchronous streaming calls are counted.
+TEST(DataClientTest, AsyncStreamsAreCounted) {
+  // Nothing listens on this port, so the call fails quickly.
+  auto data_client = bigtable::CreateDefaultDataClient(
+      "test-project", "test-instance",
+      bigtable::ClientOptions(grpc::InsecureChannelCredentials())
+          .set_data_endpoint("localhost:1")
+          .set_connection_pool_size(1));
+  bigtable::noex::Table table(data_client, "test-table");
+
+  bigtable::CompletionQueue cq;
+  std::promise<std::size_t> done;
+  // Use a server-assigned timestamp so the mutation is not retried.
+  auto op = table.AsyncBulkApply(
+      bigtable::BulkMutation(bigtable::SingleRowMutation(
+          "row", {bigtable::SetCell("fam", "col", "value")})),
+      cq,
+      [&done](bigtable::CompletionQueue&,
+              std::vector<bigtable::FailedMutation>& failures,
+              grpc::Status&) { done.set_value(failures.size()); });
+  // No thread is running `cq`, so the call cannot have completed.
+  EXPECT_THAT(data_client->ChannelLoad(), ElementsAre(1));
+
+  std::thread t([&cq] { cq.Run(); });
+  EXPECT_EQ(1U, done.get_future().get());
+  cq.Shutdown();
+  t.join();
+  op.reset();
+  EXPECT_THAT(data_client->ChannelLoad(), ElementsAre(0));
+}
@@ -0,0 +1,191 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/flat_row.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <limits>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+std::uint32_t CheckedSize(std::size_t size) {
+  if (size > std::numeric_limits<std::uint32_t>::max()) {
+    google::cloud::internal::RaiseRangeError("row too large for FlatRow");
+  }
+  return static_cast<std::uint32_t>(size);
+}
+}  // anonymous namespace
+
+FlatRow::Bytes FlatRow::CellRef::family_name() const {
+  auto const& c = row_->cells_[index_];
+  return row_->Get(row_->families_[c.family]);
+}
+
+FlatRow::Bytes FlatRow::CellRef::column_qualifier() const {
+  return row_->Get(row_->cells_[index_].qualifier);
+}
+
+FlatRow::Bytes FlatRow::CellRef::value() const {
+  return row_->Get(row_->cells_[index_].value);
+}
+
+std::chrono::microseconds FlatRow::CellRef::timestamp() const {
+  return std::chrono::microseconds(row_->cells_[index_].timestamp);
+}
+
+std::vector<std::string> FlatRow::CellRef::labels() const {
+  auto const& c = row_->cells_[index_];
+  std::vector<std::string> result;
+  result.reserve(c.label_count);
+  for (std::uint32_t i = 0; i != c.label_count; ++i) {
+    result.emplace_back(row_->Get(row_->labels_[c.first_label + i]).str());
+  }
+  return result;
+}
+
+Cell FlatRow::CellRef::ToCell() const {
+  return Cell(row_->row_key().str(), family_name().str(),
+              column_qualifier().str(), timestamp().count(), value().str(),
+              labels());
+}
+
+FlatRow::FlatRow() : row_key_size_(0) {}
+
+FlatRow::FlatRow(Row const& row) : row_key_size_(0) {
+  Build(row.row_key(), row.cells());
+}
+
+FlatRow::FlatRow(RowView const& row) : row_key_size_(0) {
+  Build(row.row_key(), row.cells());
+}
+
+template <typename CellType>
+void FlatRow::Build(std::string const& row_key,
+                    std::vector<CellType> const& cells) {
+  // Compute the size of the buffer first, so it is allocated only once.
+  std::size_t arena_size = row_key.size();
+  std::size_t label_count = 0;
+  std::string const* family = nullptr;
+  std::string const* column = nullptr;
+  for (auto const& c : cells) {
+    if (family == nullptr or *family != c.family_name()) {
+      // Families are deduplicated below, this may over-estimate the size.
+      arena_size += c.family_name().size() + c.column_qualifier().size();
+    } else if (*column != c.column_qualifier()) {
+      arena_size += c.column_qualifier().size();
+    }
+    family = &c.family_name();
+    column = &c.column_qualifier();
+    arena_size += c.value().size();
+    for (auto const& l : c.labels()) {
+      arena_size += l.size();
+    }
+    label_count += c.labels().size();
+  }
+  arena_.reserve(CheckedSize(arena_size));
+  cells_.reserve(cells.size());
+  labels_.reserve(label_count);
+
+  auto append = [this](std::string const& bytes) {
+    Span s{static_cast<std::uint32_t>(arena_.size()),
+           static_cast<std::uint32_t>(bytes.size())};
+    arena_.append(bytes);
+    return s;
+  };
+  arena_.append(row_key);
+  row_key_size_ = static_cast<std::uint32_t>(row_key.size());
+
+  for (auto const& c : cells) {
+    CellEntry entry;
+    // Rows have few families, a linear search is good enough.
+    std::size_t f = 0;
+    while (f != families_.size() and Get(families_[f]) != c.family_name()) {
+      ++f;
+    }
+    if (f == families_.size()) {
+      if (f == std::numeric_limits<std::uint16_t>::max()) {
+        google::cloud::internal::RaiseRangeError(
+            "too many column families for FlatRow");
+      }
+      families_.emplace_back(append(c.family_name()));
+    }
+    entry.family = static_cast<std::uint16_t>(f);
+    if (not cells_.empty() and cells_.back().family == entry.family and
+        Get(cells_.back().qualifier) == c.column_qualifier()) {
+      entry.qualifier = cells_.back().qualifier;
+    } else {
+      entry.qualifier = append(c.column_qualifier());
+    }
+    entry.value = append(c.value());
+    entry.timestamp = c.timestamp().count();
+    entry.first_label = static_cast<std::uint32_t>(labels_.size());
+    for (auto const& l : c.labels()) {
+      labels_.emplace_back(append(l));
+    }
+    entry.label_count =
+        static_cast<std::uint16_t>(labels_.size() - entry.first_label);
+    cells_.push_back(entry);
+  }
+  families_.shrink_to_fit();
+}
+
+std::pair<std::size_t, std::size_t> FlatRow::FindColumn(
+    std::string const& family, std::string const& column) const {
+  std::size_t f = 0;
+  while (f != families_.size() and Get(families_[f]) != family) {
+    ++f;
+  }
+  if (f == families_.size()) {
+    return std::make_pair(cells_.size(), cells_.size());
+  }
+  for (std::size_t i = 0; i != cells_.size(); ++i) {
+    if (cells_[i].family != f or Get(cells_[i].qualifier) != column) {
+      continue;
+    }
+    // Consecutive cells in the same column share the qualifier span.  Empty
+    // spans may share an offset with the next span, compare the sizes too.
+    auto const& qualifier = cells_[i].qualifier;
+    auto end = i + 1;
+    while (end != cells_.size() and cells_[end].family == f and
+           cells_[end].qualifier.offset == qualifier.offset and
+           cells_[end].qualifier.size == qualifier.size) {
+      ++end;
+    }
+    return std::make_pair(i, end);
+  }
+  return std::make_pair(cells_.size(), cells_.size());
+}
+
+Row FlatRow::ToRow() const {
+  std::vector<Cell> cells;
+  cells.reserve(cells_.size());
+  for (std::size_t i = 0; i != cells_.size(); ++i) {
+    cells.emplace_back(cell(i).ToCell());
+  }
+  return Row(row_key().str(), std::move(cells));
+}
+
+std::size_t FlatRow::memory_usage() const {
+  return sizeof(*this) + arena_.capacity() +
+         families_.capacity() * sizeof(Span) +
+         labels_.capacity() * sizeof(Span) +
+         cells_.capacity() * sizeof(CellEntry);
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
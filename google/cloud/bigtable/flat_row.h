@@ -0,0 +1,155 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_FLAT_ROW_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_FLAT_ROW_H_
+
+#include "google/cloud/bigtable/row.h"
+#include "google/cloud/bigtable/row_view.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * A compact, immutable representation of a Bigtable row.
+ *
+ * A `Row` allocates several strings for each `Cell`: the row key, family,
+ * column qualifier, value, and a vector of labels.  Applications that keep
+ * many rows in memory (caches, join tables) can convert them to `FlatRow`,
+ * which stores all the bytes in a single buffer.  Family names are stored
+ * once, consecutive cells in the same column (i.e. multiple versions) share
+ * the qualifier, and each cell is a small fixed-size entry of offsets into the
+ * buffer.
+ *
+ * The strings returned by the accessors are `FlatRow::Bytes` references into
+ * the buffer, valid as long as the `FlatRow` object.
+ */
+class FlatRow {
+ public:
+  /// A reference to a sequence of bytes stored in a `FlatRow`.
+  class Bytes {
+   public:
+    Bytes(char const* data, std::size_t size) : data_(data), size_(size) {}
+
+    char const* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /// Return a copy of the bytes.
+    std::string str() const { return std::string(data_, size_); }
+
+    bool operator==(std::string const& rhs) const {
+      return rhs.size() == size_ and rhs.compare(0, size_, data_, size_) == 0;
+    }
+    bool operator!=(std::string const& rhs) const { return !(*this == rhs); }
+
+   private:
+    char const* data_;
+    std::size_t size_;
+  };
+
+  /// A reference to a cell stored in a `FlatRow`.
+  class CellRef {
+   public:
+    Bytes family_name() const;
+    Bytes column_qualifier() const;
+    Bytes value() const;
+    std::chrono::microseconds timestamp() const;
+    std::vector<std::string> labels() const;
+
+    /// Return a copy of the cell.
+    Cell ToCell() const;
+
+   private:
+    friend class FlatRow;
+    CellRef(FlatRow const* row, std::size_t index)
+        : row_(row), index_(index) {}
+
+    FlatRow const* row_;
+    std::size_t index_;
+  };
+
+  /// Create an empty row.
+  FlatRow();
+
+  /// Create a compact copy of @p row.
+  explicit FlatRow(Row const& row);
+
+  /// Create a compact copy of @p row, without creating a `Row` first.
+  explicit FlatRow(RowView const& row);
+
+  /// Return the row key.
+  Bytes row_key() const { return Bytes(arena_.data(), row_key_size_); }
+
+  /// The number of cells.
+  std::size_t size() const { return cells_.size(); }
+
+  /// Return the cell at position @p index, in the order of the original row.
+  CellRef cell(std::size_t index) const { return CellRef(this, index); }
+
+  /**
+   * Return the range of cells in @p family and @p column.
+   *
+   * @return the positions `[first, second)` of the cells in the column, an
+   *     empty range if there are none.  The cells are in the order of the
+   *     original row, i.e. newest first for rows returned by the server.
+   */
+  std::pair<std::size_t, std::size_t> FindColumn(
+      std::string const& family, std::string const& column) const;
+
+  /// Return a `Row` with a copy of the data.
+  Row ToRow() const;
+
+  /// Return the approximate number of bytes used by this object.
+  std::size_t memory_usage() const;
+
+ private:
+  struct Span {
+    std::uint32_t offset;
+    std::uint32_t size;
+  };
+  struct CellEntry {
+    Span qualifier;
+    Span value;
+    std::int64_t timestamp;
+    std::uint32_t first_label;
+    std::uint16_t family;
+    std::uint16_t label_count;
+  };
+
+  /// Initialize the row, only used (and defined) in flat_row.cc.
+  template <typename CellType>
+  void Build(std::string const& row_key, std::vector<CellType> const& cells);
+
+  Bytes Get(Span s) const { return Bytes(arena_.data() + s.offset, s.size); }
+
+  std::string arena_;
+  std::uint32_t row_key_size_;
+  std::vector<Span> families_;
+  std::vector<Span> labels_;
+  std::vector<CellEntry> cells_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_FLAT_ROW_H_
@@ -0,0 +1,144 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/flat_row.h"
+#include "google/cloud/bigtable/internal/readrows_view_parser.h"
+#include <gmock/gmock.h>
+
+namespace bigtable = google::cloud::bigtable;
+
+namespace {
+bigtable::Row MakeRow() {
+  return bigtable::Row(
+      "row-key",
+      {bigtable::Cell("row-key", "fam1", "c1", 3000, "v1-3", {}),
+       bigtable::Cell("row-key", "fam1", "c1", 2000, "v1-2", {"l1", "l2"}),
+       bigtable::Cell("row-key", "fam1", "c2", 1000, "v2", {}),
+       bigtable::Cell("row-key", "fam2", "c1", 1000, "other", {}),
+       bigtable::Cell("row-key", "fam1", "c3", 1000, "", {})});
+}
+}  // anonymous namespace
+
+/// @test Verify that FlatRow preserves all the data in a Row.
+TEST(FlatRowTest, RoundTrip) {
+  auto row = MakeRow();
+  bigtable::FlatRow tested(row);
+  EXPECT_TRUE(tested.row_key() == "row-key");
+  ASSERT_EQ(5U, tested.size());
+  auto c1 = tested.cell(1);
+  EXPECT_TRUE(c1.family_name() == "fam1");
+  EXPECT_TRUE(c1.column_qualifier() == "c1");
+  EXPECT_TRUE(c1.value() == "v1-2");
+  EXPECT_EQ(2000, c1.timestamp().count());
+  EXPECT_THAT(c1.labels(), ::testing::ElementsAre("l1", "l2"));
+  EXPECT_TRUE(tested.cell(4).value().empty());
+
+  auto copy = tested.ToRow();
+  EXPECT_EQ(row.row_key(), copy.row_key());
+  ASSERT_EQ(row.cells().size(), copy.cells().size());
+  for (std::size_t i = 0; i != row.cells().size(); ++i) {
+    auto const& expected = row.cells()[i];
+    auto const& actual = copy.cells()[i];
+    EXPECT_EQ(expected.row_key(), actual.row_key());
+    EXPECT_EQ(expected.family_name(), actual.family_name());
+    EXPECT_EQ(expected.column_qualifier(), actual.column_qualifier());
+    EXPECT_EQ(expected.timestamp(), actual.timestamp());
+    EXPECT_EQ(expected.value(), actual.value());
+    EXPECT_EQ(expected.labels(), actual.labels());
+  }
+}
+
+/// @test Verify that families and repeated qualifiers are stored once.
+TEST(FlatRowTest, SharesFamiliesAndQualifiers) {
+  bigtable::FlatRow tested(MakeRow());
+  EXPECT_EQ(tested.cell(0).family_name().data(),
+            tested.cell(4).family_name().data());
+  EXPECT_EQ(tested.cell(0).column_qualifier().data(),
+            tested.cell(1).column_qualifier().data());
+  EXPECT_NE(tested.cell(0).column_qualifier().data(),
+            tested.cell(3).column_qualifier().data());
+}
+
+/// @test Verify FlatRow::FindColumn().
+TEST(FlatRowTest, FindColumn) {
+  bigtable::FlatRow tested(MakeRow());
+  EXPECT_EQ(std::make_pair(std::size_t(0), std::size_t(2)),
+            tested.FindColumn("fam1", "c1"));
+  EXPECT_EQ(std::make_pair(std::size_t(2), std::size_t(3)),
+            tested.FindColumn("fam1", "c2"));
+  EXPECT_EQ(std::make_pair(std::size_t(3), std::size_t(4)),
+            tested.FindColumn("fam2", "c1"));
+  EXPECT_EQ(std::make_pair(std::size_t(4), std::size_t(5)),
+            tested.FindColumn("fam1", "c3"));
+  auto missing = tested.FindColumn("fam2", "c2");
+  EXPECT_EQ(missing.first, missing.second);
+  missing = tested.FindColumn("fam3", "c1");
+  EXPECT_EQ(missing.first, missing.second);
+}
+
+/// @test Verify FlatRow::FindColumn() with empty qualifiers and values.
+TEST(FlatRowTest, FindColumnEmptyQualifier) {
+  // The empty qualifier and value of the first cell start at the same offset
+  // as the qualifier of the second cell.
+  bigtable::FlatRow tested(bigtable::Row(
+      "row-key", {bigtable::Cell("row-key", "fam", "", 2000, "", {}),
+                  bigtable::Cell("row-key", "fam", "c1", 1000, "v1", {})}));
+  EXPECT_EQ(std::make_pair(std::size_t(0), std::size_t(1)),
+            tested.FindColumn("fam", ""));
+  EXPECT_EQ(std::make_pair(std::size_t(1), std::size_t(2)),
+            tested.FindColumn("fam", "c1"));
+}
+
+/// @test Verify that an empty FlatRow works.
+TEST(FlatRowTest, Empty) {
+  bigtable::FlatRow tested;
+  EXPECT_TRUE(tested.row_key().empty());
+  EXPECT_EQ(0U, tested.size());
+  auto r = tested.FindColumn("fam", "col");
+  EXPECT_EQ(r.first, r.second);
+  EXPECT_TRUE(tested.ToRow().cells().empty());
+}
+
+/// @test Verify that FlatRow is smaller than the equivalent Row.
+TEST(FlatRowTest, MemoryUsage) {
+  bigtable::FlatRow tested(MakeRow());
+  // 7 bytes of key, 8 of families, 8 of qualifiers, 19 of values and 4 of
+  // labels, plus the fixed-size entries.
+  EXPECT_LE(46U, tested.memory_usage());
+  EXPECT_GT(sizeof(bigtable::Cell) * 5, tested.memory_usage());
+}
+
+/// @test Verify that FlatRow can be created from a RowView.
+TEST(FlatRowTest, FromRowView) {
+  google::bigtable::v2::ReadRowsResponse response;
+  for (auto const* value : {"v1", "v2"}) {
+    auto& chunk = *response.add_chunks();
+    chunk.set_row_key("row-key");
+    chunk.mutable_family_name()->set_value("fam");
+    chunk.mutable_qualifier()->set_value("col");
+    chunk.set_value(value);
+  }
+  response.mutable_chunks(1)->set_commit_row(true);
+
+  grpc::Status status;
+  bigtable::internal::ReadRowsViewParser parser;
+  parser.HandleResponse(std::move(response));
+  ASSERT_TRUE(parser.NextRow(status));
+  bigtable::FlatRow tested(parser.row());
+  EXPECT_TRUE(tested.row_key() == "row-key");
+  ASSERT_EQ(2U, tested.size());
+  EXPECT_TRUE(tested.cell(1).value() == "v2");
+  EXPECT_EQ(std::make_pair(std::size_t(0), std::size_t(2)),
+            tested.FindColumn("fam", "col"));
+}
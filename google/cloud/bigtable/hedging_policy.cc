@@ -0,0 +1,80 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/hedging_policy.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+std::unique_ptr<HedgingPolicy> FixedDelayHedgingPolicy::clone() const {
+  return std::unique_ptr<HedgingPolicy>(new FixedDelayHedgingPolicy(*this));
+}
+
+std::size_t constexpr PercentileHedgingPolicy::DEFAULT_WINDOW;
+
+PercentileHedgingPolicy::Samples::Samples(
+    double p, std::chrono::microseconds initial_delay, std::size_t w)
+    : percentile(p),
+      window(w),
+      delay_us(initial_delay.count()),
+      latencies(w),
+      next(0),
+      count(0) {
+  if (p <= 0.0 or p >= 1.0) {
+    google::cloud::internal::RaiseRangeError(
+        "PercentileHedgingPolicy percentile must be in the (0, 1) range");
+  }
+  if (w == 0) {
+    google::cloud::internal::RaiseRangeError(
+        "PercentileHedgingPolicy window must be positive");
+  }
+}
+
+std::unique_ptr<HedgingPolicy> PercentileHedgingPolicy::clone() const {
+  return std::unique_ptr<HedgingPolicy>(new PercentileHedgingPolicy(*this));
+}
+
+std::chrono::microseconds PercentileHedgingPolicy::hedge_delay() {
+  return std::chrono::microseconds(
+      samples_->delay_us.load(std::memory_order_relaxed));
+}
+
+void PercentileHedgingPolicy::OnCompletion(std::chrono::microseconds latency) {
+  auto& s = *samples_;
+  std::unique_lock<std::mutex> lk(s.mu);
+  s.latencies[s.next] = latency.count();
+  s.next = (s.next + 1) % s.window;
+  if (s.count < s.window) {
+    ++s.count;
+  }
+  // Recomputing the percentile is O(window), only do it a few times per
+  // window once it is full.
+  auto const period = (std::max)(s.window / 16, std::size_t(1));
+  if (s.count < s.window or s.next % period != 0) {
+    return;
+  }
+  auto copy = s.latencies;
+  lk.unlock();
+  auto const n = static_cast<std::size_t>(s.percentile * copy.size());
+  std::nth_element(copy.begin(), copy.begin() + n, copy.end());
+  s.delay_us.store(copy[n], std::memory_order_relaxed);
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
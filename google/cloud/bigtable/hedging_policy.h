@@ -0,0 +1,144 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_HEDGING_POLICY_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_HEDGING_POLICY_H_
+
+#include "google/cloud/bigtable/version.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Define the interface for controlling hedged reads.
+ *
+ * When a `Table` is configured with a hedging policy, `Table::ReadRow()` sends
+ * a second request if the first one has not completed after `hedge_delay()`.
+ * The second request is sent on the least loaded channel other than the one
+ * used by the first request (if the `DataClient` has more than one channel),
+ * the first successful response is returned and the other request is
+ * cancelled.  Hedging trades some extra load on the service for lower tail
+ * latency, it is only used for reads, which are always idempotent.
+ *
+ * The application provides an instance of this class when the Table is
+ * created.  Unlike the retry and backoff policies, the copies returned by
+ * `clone()` share their state: the counters and any latency samples are
+ * aggregated across all the copies, so the application can keep the original
+ * object to examine the counters.  Implementations must be thread-safe.
+ */
+class HedgingPolicy {
+ public:
+  HedgingPolicy() : counters_(std::make_shared<Counters>()) {}
+  virtual ~HedgingPolicy() = default;
+
+  /**
+   * Return a new copy of this object, sharing the counters and samples.
+   */
+  virtual std::unique_ptr<HedgingPolicy> clone() const = 0;
+
+  /// How long to wait for the first request before sending the hedge.
+  virtual std::chrono::microseconds hedge_delay() = 0;
+
+  /// Record the latency of a successful read.
+  virtual void OnCompletion(std::chrono::microseconds latency) {}
+
+  //@{
+  /// @name Counters for the hedged requests.
+  std::int64_t hedges_sent() const { return counters_->sent.load(); }
+  std::int64_t hedges_won() const { return counters_->won.load(); }
+
+  void OnHedgeSent() { ++counters_->sent; }
+  void OnHedgeWon() { ++counters_->won; }
+  //@}
+
+ private:
+  struct Counters {
+    Counters() : sent(0), won(0) {}
+    std::atomic<std::int64_t> sent;
+    std::atomic<std::int64_t> won;
+  };
+  std::shared_ptr<Counters> counters_;
+};
+
+/**
+ * Send the hedged request after a fixed delay.
+ */
+class FixedDelayHedgingPolicy : public HedgingPolicy {
+ public:
+  template <typename Rep, typename Period>
+  explicit FixedDelayHedgingPolicy(std::chrono::duration<Rep, Period> delay)
+      : delay_(std::chrono::duration_cast<std::chrono::microseconds>(delay)) {}
+
+  std::unique_ptr<HedgingPolicy> clone() const override;
+  std::chrono::microseconds hedge_delay() override { return delay_; }
+
+ private:
+  std::chrono::microseconds delay_;
+};
+
+/**
+ * Send the hedged request when the first one is slower than a percentile.
+ *
+ * The policy keeps the latencies of the last @p window successful reads and
+ * uses their @p percentile (e.g. 0.95) as the hedging delay.  Until the
+ * window is full, it uses @p initial_delay.
+ */
+class PercentileHedgingPolicy : public HedgingPolicy {
+ public:
+  template <typename Rep, typename Period>
+  PercentileHedgingPolicy(double percentile,
+                          std::chrono::duration<Rep, Period> initial_delay,
+                          std::size_t window = DEFAULT_WINDOW)
+      : samples_(std::make_shared<Samples>(
+            percentile,
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                initial_delay),
+            window)) {}
+
+  /// The default number of samples used to compute the percentile.
+  static std::size_t constexpr DEFAULT_WINDOW = 1024;
+
+  std::unique_ptr<HedgingPolicy> clone() const override;
+  std::chrono::microseconds hedge_delay() override;
+  void OnCompletion(std::chrono::microseconds latency) override;
+
+ private:
+  struct Samples {
+    Samples(double p, std::chrono::microseconds initial_delay, std::size_t w);
+
+    double const percentile;
+    std::size_t const window;
+    std::atomic<std::int64_t> delay_us;
+
+    std::mutex mu;
+    std::vector<std::int64_t> latencies;
+    std::size_t next;
+    std::size_t count;
+  };
+  std::shared_ptr<Samples> samples_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_HEDGING_POLICY_H_
@@ -0,0 +1,61 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/hedging_policy.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include <gtest/gtest.h>
+
+namespace bigtable = google::cloud::bigtable;
+using namespace google::cloud::testing_util::chrono_literals;
+
+/// @test Verify that FixedDelayHedgingPolicy returns the configured delay.
+TEST(HedgingPolicyTest, FixedDelay) {
+  bigtable::FixedDelayHedgingPolicy tested(10_ms);
+  EXPECT_EQ(10000, tested.hedge_delay().count());
+  auto clone = tested.clone();
+  EXPECT_EQ(10000, clone->hedge_delay().count());
+}
+
+/// @test Verify that copies share the counters.
+TEST(HedgingPolicyTest, SharedCounters) {
+  bigtable::FixedDelayHedgingPolicy tested(10_ms);
+  auto clone = tested.clone();
+  clone->OnHedgeSent();
+  clone->OnHedgeSent();
+  clone->OnHedgeWon();
+  EXPECT_EQ(2, tested.hedges_sent());
+  EXPECT_EQ(1, tested.hedges_won());
+}
+
+/// @test Verify that PercentileHedgingPolicy tracks the latency percentile.
+TEST(HedgingPolicyTest, Percentile) {
+  bigtable::PercentileHedgingPolicy tested(0.75, 5_ms, 16);
+  auto clone = tested.clone();
+  for (int i = 1; i != 16; ++i) {
+    clone->OnCompletion(std::chrono::milliseconds(i));
+  }
+  // Until the window is full the initial delay is used.
+  EXPECT_EQ(5000, tested.hedge_delay().count());
+  clone->OnCompletion(16_ms);
+  EXPECT_EQ(13000, tested.hedge_delay().count());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that PercentileHedgingPolicy rejects invalid parameters.
+TEST(HedgingPolicyTest, PercentileInvalid) {
+  EXPECT_THROW(bigtable::PercentileHedgingPolicy(1.0, 5_ms), std::range_error);
+  EXPECT_THROW(bigtable::PercentileHedgingPolicy(0.5, 5_ms, 0),
+               std::range_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,229 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/increment_aggregator.h"
+#include "google/cloud/bigtable/grpc_error.h"
+#include "google/cloud/bigtable/internal/endian.h"
+#include "google/cloud/bigtable/internal/grpc_error_delegate.h"
+#include <algorithm>
+#include <exception>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+std::size_t constexpr DEFAULT_MAX_PENDING_CELLS = 1000;
+auto constexpr DEFAULT_MAX_DELAY = std::chrono::milliseconds(10);
+}  // anonymous namespace
+
+IncrementAggregator::Options::Options()
+    : max_pending_cells_(DEFAULT_MAX_PENDING_CELLS),
+      max_delay_(DEFAULT_MAX_DELAY) {}
+
+IncrementAggregator::Options& IncrementAggregator::Options::SetMaxPendingCells(
+    std::size_t value) {
+  max_pending_cells_ = std::max<std::size_t>(1U, value);
+  return *this;
+}
+
+IncrementAggregator::Options& IncrementAggregator::Options::SetMaxDelay(
+    std::chrono::milliseconds value) {
+  max_delay_ = std::max(std::chrono::milliseconds(0), value);
+  return *this;
+}
+
+IncrementAggregator::IncrementAggregator(Table table, CompletionQueue cq,
+                                         Options options)
+    : table_(std::move(table)),
+      cq_(std::move(cq)),
+      options_(std::move(options)),
+      pending_cells_(0),
+      generation_(0),
+      outstanding_requests_(0),
+      timer_(cq_,
+             [this](std::uint64_t generation) { OnTimer(generation); }) {}
+
+IncrementAggregator::~IncrementAggregator() {
+  WaitForNoPendingIncrements();
+  // The timer callback uses `this`, wait until it runs.
+  timer_.Shutdown();
+}
+
+std::future<std::int64_t> IncrementAggregator::Increment(
+    std::string row_key, std::string family, std::string column,
+    std::int64_t amount) {
+  auto promise = std::make_shared<std::promise<std::int64_t>>();
+  auto result = promise->get_future();
+  Increment(std::move(row_key), std::move(family), std::move(column), amount,
+            [promise](CompletionQueue&, std::int64_t value,
+                      grpc::Status& status) {
+              if (status.ok()) {
+                promise->set_value(value);
+                return;
+              }
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+              promise->set_exception(std::make_exception_ptr(
+                  GRpcError("IncrementAggregator::Increment()", status)));
+#else
+              internal::RaiseRpcError(status,
+                                      "IncrementAggregator::Increment()");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+            });
+  return result;
+}
+
+void IncrementAggregator::Increment(std::string row_key, std::string family,
+                                    std::string column, std::int64_t amount,
+                                    CompletionCallback callback) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (pending_.empty()) {
+    deadline_ = std::chrono::system_clock::now() + options_.max_delay();
+  }
+  auto& cells = pending_[std::move(row_key)];
+  auto key = std::make_pair(std::move(family), std::move(column));
+  auto location = cells.find(key);
+  if (location == cells.end()) {
+    location = cells.emplace(std::move(key), PendingCell()).first;
+    ++pending_cells_;
+  }
+  // Let the total wrap around like the server does, without signed overflow.
+  location->second.total = static_cast<std::int64_t>(
+      static_cast<std::uint64_t>(location->second.total) +
+      static_cast<std::uint64_t>(amount));
+  location->second.waiters.emplace_back(Waiter{amount, std::move(callback)});
+
+  if (pending_cells_ >= options_.max_pending_cells()) {
+    auto rows = TakePending();
+    lk.unlock();
+    SendRows(std::move(rows));
+    return;
+  }
+  StartTimerIfNeeded();
+}
+
+void IncrementAggregator::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (pending_.empty()) {
+    return;
+  }
+  auto rows = TakePending();
+  lk.unlock();
+  SendRows(std::move(rows));
+}
+
+void IncrementAggregator::WaitForNoPendingIncrements() {
+  Flush();
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] {
+    return outstanding_requests_ == 0 and pending_.empty();
+  });
+}
+
+IncrementAggregator::PendingRows IncrementAggregator::TakePending() {
+  PendingRows rows;
+  rows.swap(pending_);
+  pending_cells_ = 0;
+  ++generation_;
+  outstanding_requests_ += rows.size();
+  return rows;
+}
+
+void IncrementAggregator::StartTimerIfNeeded() {
+  if (pending_.empty()) {
+    return;
+  }
+  timer_.StartIfNeeded(deadline_, generation_);
+}
+
+void IncrementAggregator::SendRows(PendingRows rows) {
+  for (auto& kv : rows) {
+    auto pending = std::make_shared<PendingRow>(std::move(kv.second));
+    std::vector<ReadModifyWriteRule> rules;
+    rules.reserve(pending->size());
+    for (auto const& cell : *pending) {
+      rules.emplace_back(ReadModifyWriteRule::IncrementAmount(
+          cell.first.first, cell.first.second, cell.second.total));
+    }
+    table_.AsyncReadModifyWriteRow(
+        kv.first, cq_,
+        [this, pending](CompletionQueue& cq, Row row, grpc::Status& status) {
+          OnRowComplete(cq, *pending, row, status);
+        },
+        std::move(rules));
+  }
+}
+
+void IncrementAggregator::OnTimer(std::uint64_t generation) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (pending_.empty()) {
+    return;
+  }
+  if (generation_ != generation) {
+    // The increments were sent already, restart the timer for the new ones.
+    StartTimerIfNeeded();
+    return;
+  }
+  auto rows = TakePending();
+  lk.unlock();
+  SendRows(std::move(rows));
+}
+
+void IncrementAggregator::OnRowComplete(CompletionQueue& cq,
+                                        PendingRow& pending, Row& row,
+                                        grpc::Status& status) {
+  for (auto& kv : pending) {
+    grpc::Status cell_status = status;
+    std::uint64_t value = 0;
+    if (cell_status.ok()) {
+      auto const& family = kv.first.first;
+      auto const& column = kv.first.second;
+      auto cell = std::find_if(
+          row.cells().begin(), row.cells().end(), [&](Cell const& c) {
+            return c.family_name() == family and c.column_qualifier() == column;
+          });
+      if (cell == row.cells().end()) {
+        cell_status = grpc::Status(grpc::StatusCode::INTERNAL,
+                                   "missing counter in response, family=" +
+                                       family + ", column=" + column);
+      } else if (cell->value().size() != sizeof(std::int64_t)) {
+        cell_status = grpc::Status(grpc::StatusCode::INTERNAL,
+                                   "counter is not a 64-bit integer, family=" +
+                                       family + ", column=" + column);
+      } else {
+        // Rewind to the value before this request, then replay the merged
+        // increments in the order they were received.
+        value = static_cast<std::uint64_t>(
+                    cell->value_as<bigtable::bigendian64_t>().get()) -
+                static_cast<std::uint64_t>(kv.second.total);
+      }
+    }
+    for (auto& waiter : kv.second.waiters) {
+      value += static_cast<std::uint64_t>(waiter.amount);
+      std::int64_t result =
+          cell_status.ok() ? static_cast<std::int64_t>(value) : 0;
+      grpc::Status waiter_status = cell_status;
+      waiter.callback(cq, result, waiter_status);
+    }
+  }
+
+  std::unique_lock<std::mutex> lk(mu_);
+  --outstanding_requests_;
+  cv_.notify_all();
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,193 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INCREMENT_AGGREGATOR_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INCREMENT_AGGREGATOR_H_
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/internal/flush_timer.h"
+#include "google/cloud/bigtable/table.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Merge counter increments in memory before sending them to Cloud Bigtable.
+ *
+ * Applications that maintain counters with `ReadModifyWriteRow()` and
+ * `ReadModifyWriteRule::IncrementAmount()` often update the same few cells
+ * from many threads.  Every request on a row is serialized by the server, so
+ * hot rows limit the throughput.  This class accepts increments from any
+ * number of threads, adds up the increments for each (row, family, column),
+ * and sends a single `Table::AsyncReadModifyWriteRow()` per row when:
+ *
+ * - the aggregator holds `max_pending_cells()` distinct cells, or
+ * - the oldest pending increment has waited for `max_delay()`.
+ *
+ * Each increment receives the value of the counter right after it was applied,
+ * as if the increments merged into one request had been applied one at a time
+ * in the order they were received.
+ *
+ * @par Example
+ * @code
+ * bigtable::CompletionQueue cq;
+ * std::thread t([&cq]() { cq.Run(); });
+ * {
+ *   bigtable::IncrementAggregator aggregator(table, cq);
+ *   auto views = aggregator.Increment("page#home", "stats", "views", 1);
+ *   std::cout << "views=" << views.get() << "\n";
+ * }  // The destructor waits until all the increments complete.
+ * cq.Shutdown();
+ * t.join();
+ * @endcode
+ *
+ * @warning The aggregator depends on the completion queue to send the requests
+ *     and to receive the results, the application must have one or more
+ *     threads running `cq.Run()`.  `ReadModifyWriteRow()` is not idempotent,
+ *     so failed requests are not retried, and all the increments merged into
+ *     a failed request receive the error.
+ */
+class IncrementAggregator {
+ public:
+  /// Configure the thresholds used by `IncrementAggregator`.
+  class Options {
+   public:
+    Options();
+
+    /// The number of distinct pending cells that triggers a flush.
+    std::size_t max_pending_cells() const { return max_pending_cells_; }
+    Options& SetMaxPendingCells(std::size_t value);
+
+    /// How long an increment can wait before it is sent.
+    std::chrono::milliseconds max_delay() const { return max_delay_; }
+    Options& SetMaxDelay(std::chrono::milliseconds value);
+
+   private:
+    std::size_t max_pending_cells_;
+    std::chrono::milliseconds max_delay_;
+  };
+
+  /**
+   * The callback invoked with the result of each increment.
+   *
+   * The value is only meaningful if the status is OK.
+   */
+  using CompletionCallback =
+      std::function<void(CompletionQueue&, std::int64_t, grpc::Status&)>;
+
+  IncrementAggregator(Table table, CompletionQueue cq,
+                      Options options = Options());
+
+  /// Flush any pending increments and wait until they complete.
+  ~IncrementAggregator();
+
+  IncrementAggregator(IncrementAggregator const&) = delete;
+  IncrementAggregator& operator=(IncrementAggregator const&) = delete;
+
+  /**
+   * Add @p amount to the counter in @p row_key, @p family, @p column.
+   *
+   * The counter is a 64-bit big-endian integer, as required by
+   * `ReadModifyWriteRule::IncrementAmount()`.
+   *
+   * @return a future that becomes satisfied with the value of the counter
+   *     after this increment was applied.  If the increment fails the future
+   *     contains an exception of type `bigtable::GRpcError`.  In builds
+   *     without exceptions the failure aborts the program, use the overload
+   *     with a callback to handle errors in those builds.
+   */
+  std::future<std::int64_t> Increment(std::string row_key, std::string family,
+                                      std::string column, std::int64_t amount);
+
+  /**
+   * Add @p amount to the counter in @p row_key, @p family, @p column.
+   *
+   * The counter is a 64-bit big-endian integer, as required by
+   * `ReadModifyWriteRule::IncrementAmount()`.
+   *
+   * @param callback invoked when the increment completes, with the value of
+   *     the counter after this increment was applied.
+   */
+  void Increment(std::string row_key, std::string family, std::string column,
+                 std::int64_t amount, CompletionCallback callback);
+
+  /// Send all the pending increments now.
+  void Flush();
+
+  /// Flush the pending increments and wait until all of them complete.
+  void WaitForNoPendingIncrements();
+
+ private:
+  /// An increment waiting for its result.
+  struct Waiter {
+    std::int64_t amount;
+    CompletionCallback callback;
+  };
+
+  /// The merged increments for a single cell.
+  struct PendingCell {
+    PendingCell() : total(0) {}
+    std::int64_t total;
+    std::vector<Waiter> waiters;
+  };
+
+  /// The merged increments for a row, indexed by family and column.
+  using PendingRow =
+      std::map<std::pair<std::string, std::string>, PendingCell>;
+  using PendingRows = std::map<std::string, PendingRow>;
+
+  /// Remove the pending increments, the caller must send them.
+  PendingRows TakePending();
+
+  /// Start the timer to flush the pending increments, if needed.
+  void StartTimerIfNeeded();
+
+  void SendRows(PendingRows rows);
+  void OnTimer(std::uint64_t generation);
+  void OnRowComplete(CompletionQueue& cq, PendingRow& pending, Row& row,
+                     grpc::Status& status);
+
+  Table table_;
+  CompletionQueue cq_;
+  Options options_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  PendingRows pending_;
+  std::size_t pending_cells_;
+  /// Identifies the current set of pending increments, for the timer.
+  std::uint64_t generation_;
+  std::chrono::system_clock::time_point deadline_;
+  std::size_t outstanding_requests_;
+  internal::FlushTimer timer_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INCREMENT_AGGREGATOR_H_
@@ -0,0 +1,269 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/increment_aggregator.h"
+#include "google/cloud/bigtable/grpc_error.h"
+#include "google/cloud/bigtable/internal/endian.h"
+#include "google/cloud/bigtable/testing/mock_async_response_reader.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+
+namespace bigtable = google::cloud::bigtable;
+namespace btproto = google::bigtable::v2;
+using namespace ::testing;
+
+/// Define types and functions used in the tests.
+namespace {
+class IncrementAggregatorTest : public bigtable::testing::TableTestFixture {
+ protected:
+  IncrementAggregatorTest()
+      : cq_impl_(std::make_shared<bigtable::testing::MockCompletionQueue>()),
+        cq_(cq_impl_) {}
+
+  /**
+   * Return a functor that creates a mock reader returning @p response.
+   *
+   * The functor also saves the request in @p request, the mock readers are
+   * owned by the test fixture.
+   */
+  std::function<std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      btproto::ReadModifyWriteRowResponse>>(
+      grpc::ClientContext*, btproto::ReadModifyWriteRowRequest const&,
+      grpc::CompletionQueue*)>
+  MakeReader(grpc::Status status, btproto::ReadModifyWriteRowResponse response,
+             btproto::ReadModifyWriteRowRequest& request) {
+    using Response = btproto::ReadModifyWriteRowResponse;
+    return [this, status, response, &request](
+               grpc::ClientContext*,
+               btproto::ReadModifyWriteRowRequest const& r,
+               grpc::CompletionQueue*) {
+      request = r;
+      auto owner = std::make_shared<
+          bigtable::testing::MockAsyncResponseReader<Response>>();
+      readers_.push_back(owner);
+      auto reader = owner.get();
+      EXPECT_CALL(*reader, Finish(_, _, _))
+          .WillOnce(Invoke(
+              [status, response](Response* r, grpc::Status* s, void*) {
+                *r = response;
+                *s = status;
+              }));
+      return std::unique_ptr<
+          grpc::ClientAsyncResponseReaderInterface<Response>>(reader);
+    };
+  }
+
+  /// Return a callback that stores the result of an increment.
+  bigtable::IncrementAggregator::CompletionCallback Capture(
+      std::int64_t& value, grpc::Status& status) {
+    return [&value, &status](bigtable::CompletionQueue&, std::int64_t v,
+                             grpc::Status& s) {
+      value = v;
+      status = s;
+    };
+  }
+
+  std::shared_ptr<bigtable::testing::MockCompletionQueue> cq_impl_;
+  bigtable::CompletionQueue cq_;
+  std::vector<std::shared_ptr<void>> readers_;
+};
+
+/// Create a response with the given counter values for @p row_key.
+btproto::ReadModifyWriteRowResponse MakeResponse(
+    std::string const& row_key,
+    std::vector<std::pair<std::string, std::int64_t>> const& columns) {
+  btproto::ReadModifyWriteRowResponse response;
+  auto& row = *response.mutable_row();
+  row.set_key(row_key);
+  auto& family = *row.add_families();
+  family.set_name("fam");
+  for (auto const& kv : columns) {
+    auto& column = *family.add_columns();
+    column.set_qualifier(kv.first);
+    column.add_cells()->set_value(google::cloud::bigtable::internal::Encoder<
+                                  bigtable::bigendian64_t>::
+                                      Encode(bigtable::bigendian64_t(
+                                          kv.second)));
+  }
+  return response;
+}
+}  // anonymous namespace
+
+/// @test Verify that increments on the same cell are merged.
+TEST_F(IncrementAggregatorTest, MergeIncrements) {
+  btproto::ReadModifyWriteRowRequest request;
+  EXPECT_CALL(*client_, AsyncReadModifyWriteRow(_, _, _))
+      .WillOnce(Invoke(MakeReader(
+          grpc::Status::OK, MakeResponse("r1", {{"c1", 13}, {"c2", 105}}),
+          request)));
+
+  std::int64_t v0 = 0, v1 = 0, v2 = 0;
+  grpc::Status s0, s1, s2;
+  {
+    bigtable::IncrementAggregator aggregator(
+        table_, cq_,
+        bigtable::IncrementAggregator::Options().SetMaxDelay(
+            std::chrono::minutes(1)));
+    aggregator.Increment("r1", "fam", "c1", 1, Capture(v0, s0));
+    aggregator.Increment("r1", "fam", "c2", 5, Capture(v1, s1));
+    aggregator.Increment("r1", "fam", "c1", 2, Capture(v2, s2));
+    aggregator.Flush();
+    // The timer and the request are pending.
+    EXPECT_EQ(2U, cq_impl_->size());
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+  EXPECT_TRUE(cq_impl_->empty());
+
+  EXPECT_EQ("r1", request.row_key());
+  ASSERT_EQ(2, request.rules_size());
+  EXPECT_EQ("c1", request.rules(0).column_qualifier());
+  EXPECT_EQ(3, request.rules(0).increment_amount());
+  EXPECT_EQ("c2", request.rules(1).column_qualifier());
+  EXPECT_EQ(5, request.rules(1).increment_amount());
+
+  EXPECT_TRUE(s0.ok());
+  EXPECT_TRUE(s1.ok());
+  EXPECT_TRUE(s2.ok());
+  // The merged increments report the values as if applied one at a time.
+  EXPECT_EQ(11, v0);
+  EXPECT_EQ(105, v1);
+  EXPECT_EQ(13, v2);
+}
+
+/// @test Verify that the aggregator flushes when it holds enough cells.
+TEST_F(IncrementAggregatorTest, FlushOnPendingCells) {
+  btproto::ReadModifyWriteRowRequest r1;
+  btproto::ReadModifyWriteRowRequest r2;
+  EXPECT_CALL(*client_, AsyncReadModifyWriteRow(_, _, _))
+      .WillOnce(Invoke(MakeReader(grpc::Status::OK,
+                                  MakeResponse("r1", {{"c1", 7}}), r1)))
+      .WillOnce(
+          Invoke(MakeReader(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try"),
+                            btproto::ReadModifyWriteRowResponse(), r2)));
+
+  std::int64_t v0 = 0, v1 = 0;
+  grpc::Status s0, s1;
+  {
+    bigtable::IncrementAggregator aggregator(
+        table_, cq_,
+        bigtable::IncrementAggregator::Options()
+            .SetMaxPendingCells(2)
+            .SetMaxDelay(std::chrono::minutes(1)));
+    aggregator.Increment("r1", "fam", "c1", 7, Capture(v0, s0));
+    EXPECT_EQ(1U, cq_impl_->size());
+    aggregator.Increment("r2", "fam", "c1", 1, Capture(v1, s1));
+    // The timer and one request per row are pending.
+    EXPECT_EQ(3U, cq_impl_->size());
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+  EXPECT_TRUE(cq_impl_->empty());
+  EXPECT_EQ("r1", r1.row_key());
+  EXPECT_EQ("r2", r2.row_key());
+  EXPECT_TRUE(s0.ok());
+  EXPECT_EQ(7, v0);
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, s1.error_code());
+}
+
+/// @test Verify that the aggregator sends pending increments after a delay.
+TEST_F(IncrementAggregatorTest, FlushOnDelay) {
+  btproto::ReadModifyWriteRowRequest request;
+  EXPECT_CALL(*client_, AsyncReadModifyWriteRow(_, _, _))
+      .WillOnce(Invoke(MakeReader(grpc::Status::OK,
+                                  MakeResponse("r1", {{"c1", 42}}), request)));
+
+  std::int64_t v0 = 0;
+  grpc::Status s0(grpc::StatusCode::UNKNOWN, "not-set");
+  {
+    bigtable::IncrementAggregator aggregator(table_, cq_);
+    aggregator.Increment("r1", "fam", "c1", 2, Capture(v0, s0));
+    // Only the timer is pending.
+    EXPECT_EQ(1U, cq_impl_->size());
+    // The timer expires and the request is sent.
+    cq_impl_->SimulateCompletion(cq_, true);
+    EXPECT_EQ(1U, cq_impl_->size());
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+  EXPECT_TRUE(cq_impl_->empty());
+  EXPECT_TRUE(s0.ok());
+  EXPECT_EQ(42, v0);
+}
+
+/// @test Verify that a response without the counter is reported as an error.
+TEST_F(IncrementAggregatorTest, MissingCounter) {
+  btproto::ReadModifyWriteRowRequest request;
+  EXPECT_CALL(*client_, AsyncReadModifyWriteRow(_, _, _))
+      .WillOnce(Invoke(MakeReader(grpc::Status::OK,
+                                  MakeResponse("r1", {{"other", 1}}),
+                                  request)));
+
+  std::int64_t v0 = 0;
+  grpc::Status s0;
+  {
+    bigtable::IncrementAggregator aggregator(table_, cq_);
+    aggregator.Increment("r1", "fam", "c1", 1, Capture(v0, s0));
+    aggregator.Flush();
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+  EXPECT_EQ(grpc::StatusCode::INTERNAL, s0.error_code());
+}
+
+/// @test Verify that the futures returned by Increment() carry the values.
+TEST_F(IncrementAggregatorTest, IncrementFuture) {
+  btproto::ReadModifyWriteRowRequest request;
+  EXPECT_CALL(*client_, AsyncReadModifyWriteRow(_, _, _))
+      .WillOnce(Invoke(MakeReader(grpc::Status::OK,
+                                  MakeResponse("r1", {{"c1", 10}}), request)));
+
+  std::future<std::int64_t> f0;
+  std::future<std::int64_t> f1;
+  {
+    bigtable::IncrementAggregator aggregator(table_, cq_);
+    f0 = aggregator.Increment("r1", "fam", "c1", 4);
+    f1 = aggregator.Increment("r1", "fam", "c1", 6);
+    aggregator.Flush();
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+  EXPECT_EQ(6, request.rules(0).increment_amount());
+  EXPECT_EQ(4, f0.get());
+  EXPECT_EQ(10, f1.get());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that the futures returned by Increment() carry the errors.
+TEST_F(IncrementAggregatorTest, IncrementFutureError) {
+  btproto::ReadModifyWriteRowRequest request;
+  EXPECT_CALL(*client_, AsyncReadModifyWriteRow(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader(grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh"),
+                     btproto::ReadModifyWriteRowResponse(), request)));
+
+  std::future<std::int64_t> f0;
+  {
+    bigtable::IncrementAggregator aggregator(table_, cq_);
+    f0 = aggregator.Increment("r1", "fam", "c1", 1);
+    aggregator.Flush();
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+  EXPECT_THROW(f0.get(), bigtable::GRpcError);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+/// @test Verify that IncrementAggregator::Options rejects zero-sized limits.
+TEST(IncrementAggregatorOptionsTest, ClampLimits) {
+  auto options = bigtable::IncrementAggregator::Options()
+                     .SetMaxPendingCells(0)
+                     .SetMaxDelay(std::chrono::milliseconds(-1));
+  EXPECT_EQ(1U, options.max_pending_cells());
+  EXPECT_EQ(std::chrono::milliseconds(0), options.max_delay());
+}
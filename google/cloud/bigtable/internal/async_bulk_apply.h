@@ -0,0 +1,194 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_BULK_APPLY_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_BULK_APPLY_H_
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/internal/bulk_mutator.h"
+#include "google/cloud/bigtable/metadata_update_policy.h"
+#include "google/cloud/bigtable/rpc_backoff_policy.h"
+#include "google/cloud/bigtable/rpc_retry_policy.h"
+#include "google/cloud/internal/make_unique.h"
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Perform an asynchronous `Table::BulkApply()` operation.
+ *
+ * This is the asynchronous version of `noex::Table::BulkApply()`.  It uses a
+ * `BulkMutator` to keep track of the mutations, and retries the mutations that
+ * fail with transient errors, using timers in the `CompletionQueue` to
+ * implement the backoff policy.
+ *
+ * Objects of this class must be created using `std::make_shared<>`, because
+ * the pending operations hold a reference to the object to keep it alive.
+ *
+ * @tparam Functor the type of the callback, it must be invocable as
+ *     `void(CompletionQueue&, std::vector<FailedMutation>&, grpc::Status&)`.
+ */
+template <typename Functor>
+class AsyncRetryBulkApply
+    : public AsyncOperation,
+      public std::enable_shared_from_this<AsyncRetryBulkApply<Functor>> {
+ public:
+  AsyncRetryBulkApply(std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+                      std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
+                      IdempotentMutationPolicy& idempotent_policy,
+                      MetadataUpdatePolicy metadata_update_policy,
+                      std::shared_ptr<DataClient> client,
+                      bigtable::AppProfileId const& app_profile_id,
+                      bigtable::TableId const& table_name, BulkMutation&& mut,
+                      Functor callback)
+      : rpc_retry_policy_(std::move(rpc_retry_policy)),
+        rpc_backoff_policy_(std::move(rpc_backoff_policy)),
+        metadata_update_policy_(std::move(metadata_update_policy)),
+        client_(std::move(client)),
+        mutator_(app_profile_id, table_name, idempotent_policy,
+                 std::forward<BulkMutation>(mut)),
+        callback_(std::move(callback)),
+        cancelled_(false) {}
+
+  /// Start the first request, return the operation to allow cancellation.
+  std::shared_ptr<AsyncOperation> Start(CompletionQueue& cq) {
+    StartIteration(cq);
+    return this->shared_from_this();
+  }
+
+  void Cancel() override {
+    std::shared_ptr<AsyncOperation> op;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      cancelled_ = true;
+      op = current_op_;
+    }
+    if (op) {
+      op->Cancel();
+    }
+  }
+
+ private:
+  void StartIteration(CompletionQueue& cq) {
+    auto context = google::cloud::internal::make_unique<grpc::ClientContext>();
+    rpc_retry_policy_->Setup(*context);
+    rpc_backoff_policy_->Setup(*context);
+    metadata_update_policy_.Setup(*context);
+
+    auto self = this->shared_from_this();
+    std::unique_lock<std::mutex> lk(mu_);
+    if (cancelled_) {
+      // `Cancel()` was called after `OnTimer()` checked, when there was no
+      // operation to cancel.
+      lk.unlock();
+      grpc::Status cancelled(grpc::StatusCode::CANCELLED,
+                             "pending operation cancelled");
+      Done(cq, cancelled);
+      return;
+    }
+    auto const& request = mutator_.BeforeStart();
+    current_op_ = cq.MakeStreamingReadRpc(
+        *client_, &DataClient::PrepareAsyncMutateRows, request,
+        std::move(context),
+        [self](CompletionQueue&, google::bigtable::v2::MutateRowsResponse& r) {
+          self->mutator_.OnRead(r);
+        },
+        [self](CompletionQueue& cq, grpc::Status& status) {
+          self->OnFinish(cq, status);
+        });
+  }
+
+  void OnFinish(CompletionQueue& cq, grpc::Status& status) {
+    ReleaseCurrentOp();
+    mutator_.OnFinish();
+    if (not mutator_.HasPendingMutations()) {
+      Done(cq, status);
+      return;
+    }
+    if (IsCancelled()) {
+      grpc::Status cancelled(grpc::StatusCode::CANCELLED,
+                             "pending operation cancelled");
+      Done(cq, cancelled);
+      return;
+    }
+    if (not status.ok() and not rpc_retry_policy_->OnFailure(status)) {
+      Done(cq, status);
+      return;
+    }
+    auto delay = rpc_backoff_policy_->OnCompletion(status);
+    auto self = this->shared_from_this();
+    std::lock_guard<std::mutex> lk(mu_);
+    current_op_ = cq.MakeRelativeTimer(
+        delay, [self](CompletionQueue& cq, AsyncTimerResult& timer) {
+          self->OnTimer(cq, timer);
+        });
+  }
+
+  void OnTimer(CompletionQueue& cq, AsyncTimerResult& timer) {
+    ReleaseCurrentOp();
+    if (timer.cancelled or IsCancelled()) {
+      grpc::Status cancelled(grpc::StatusCode::CANCELLED,
+                             "pending operation cancelled");
+      Done(cq, cancelled);
+      return;
+    }
+    StartIteration(cq);
+  }
+
+  void Done(CompletionQueue& cq, grpc::Status& status) {
+    auto failures = mutator_.ExtractFinalFailures();
+    if (status.ok() and not failures.empty()) {
+      grpc::Status final_status(
+          grpc::StatusCode::INTERNAL,
+          "Permanent (or too many transient) errors in "
+          "Table::AsyncBulkApply()");
+      callback_(cq, failures, final_status);
+      return;
+    }
+    callback_(cq, failures, status);
+  }
+
+  /// The completed operation holds a reference to `this`, break the cycle.
+  void ReleaseCurrentOp() {
+    std::lock_guard<std::mutex> lk(mu_);
+    current_op_.reset();
+  }
+
+  bool IsCancelled() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return cancelled_;
+  }
+
+  std::unique_ptr<RPCRetryPolicy> rpc_retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy_;
+  MetadataUpdatePolicy metadata_update_policy_;
+  std::shared_ptr<DataClient> client_;
+  BulkMutator mutator_;
+  Functor callback_;
+
+  std::mutex mu_;
+  std::shared_ptr<AsyncOperation> current_op_;
+  bool cancelled_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_BULK_APPLY_H_
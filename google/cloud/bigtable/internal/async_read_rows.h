@@ -0,0 +1,347 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_READ_ROWS_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_READ_ROWS_H_
+
+#include "google/cloud/bigtable/bigtable_strong_types.h"
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/data_client.h"
+#include "google/cloud/bigtable/filters.h"
+#include "google/cloud/bigtable/internal/normalized_row_set.h"
+#include "google/cloud/bigtable/internal/readrowsparser.h"
+#include "google/cloud/bigtable/metadata_update_policy.h"
+#include "google/cloud/bigtable/row_set.h"
+#include "google/cloud/bigtable/rpc_backoff_policy.h"
+#include "google/cloud/bigtable/rpc_retry_policy.h"
+#include "google/cloud/bigtable/table_strong_types.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/internal/optional.h"
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Perform an asynchronous `Table::ReadRows()` operation.
+ *
+ * This is the asynchronous version of `RowReader`: the rows are delivered to a
+ * callback as soon as they are parsed, and the final status of the operation is
+ * delivered to a second callback.  Like `RowReader`, the request is retried
+ * (subject to the policies in effect) starting after the last row received.
+ *
+ * Objects of this class must be created using `std::make_shared<>`, because
+ * the pending operations hold a reference to the object to keep it alive.
+ *
+ * @tparam RowFunctor the type of the callback for each row, it must be
+ *     invocable as `void(CompletionQueue&, Row)`.
+ * @tparam FinishFunctor the type of the callback for the final status, it must
+ *     be invocable as `void(CompletionQueue&, grpc::Status&)`.
+ */
+template <typename RowFunctor, typename FinishFunctor>
+class AsyncRowReader : public AsyncOperation,
+                       public std::enable_shared_from_this<
+                           AsyncRowReader<RowFunctor, FinishFunctor>> {
+ public:
+  /// A constant for the magic value that means "no limit, get all rows".
+  static std::int64_t constexpr NO_ROWS_LIMIT = 0;
+
+  AsyncRowReader(std::shared_ptr<DataClient> client,
+                 bigtable::AppProfileId app_profile_id,
+                 bigtable::TableId table_name, RowSet row_set,
+                 std::int64_t rows_limit, Filter filter,
+                 std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+                 std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
+                 MetadataUpdatePolicy metadata_update_policy,
+                 std::unique_ptr<ReadRowsParserFactory> parser_factory,
+                 RowFunctor on_row, FinishFunctor on_finish)
+      : client_(std::move(client)),
+        app_profile_id_(std::move(app_profile_id)),
+        table_name_(std::move(table_name)),
+        row_set_(row_set),
+        rows_limit_(rows_limit),
+        filter_(std::move(filter)),
+        rpc_retry_policy_(std::move(rpc_retry_policy)),
+        rpc_backoff_policy_(std::move(rpc_backoff_policy)),
+        metadata_update_policy_(std::move(metadata_update_policy)),
+        parser_factory_(std::move(parser_factory)),
+        on_row_(std::move(on_row)),
+        on_finish_(std::move(on_finish)),
+        rows_count_(0),
+        cancelled_(false) {}
+
+  /// Start the first request, return the operation to allow cancellation.
+  std::shared_ptr<AsyncOperation> Start(CompletionQueue& cq) {
+    StartIteration(cq);
+    return this->shared_from_this();
+  }
+
+  /**
+   * Send all the requests on the channel at @p channel, including retries.
+   *
+   * Must be called before `Start()`.  Hedged reads use it to send the hedge
+   * on a different channel than the first attempt.
+   */
+  void PinToChannel(std::size_t channel) {
+    channel_ = google::cloud::internal::optional<std::size_t>(channel);
+  }
+
+  void Cancel() override {
+    std::shared_ptr<AsyncOperation> op;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      cancelled_ = true;
+      op = current_op_;
+    }
+    if (op) {
+      op->Cancel();
+    }
+  }
+
+ private:
+  void StartIteration(CompletionQueue& cq) {
+    google::bigtable::v2::ReadRowsRequest request;
+    request.set_app_profile_id(app_profile_id_.get());
+    request.set_table_name(table_name_.get());
+    row_set_.CopyTo(*request.mutable_rows());
+    auto filter_proto = filter_.as_proto();
+    request.mutable_filter()->Swap(&filter_proto);
+    if (rows_limit_ != NO_ROWS_LIMIT) {
+      request.set_rows_limit(rows_limit_ - rows_count_);
+    }
+
+    auto context = google::cloud::internal::make_unique<grpc::ClientContext>();
+    rpc_retry_policy_->Setup(*context);
+    rpc_backoff_policy_->Setup(*context);
+    metadata_update_policy_.Setup(*context);
+
+    parser_ = parser_factory_->Create();
+    parser_status_ = grpc::Status::OK;
+
+    auto self = this->shared_from_this();
+    std::unique_lock<std::mutex> lk(mu_);
+    if (cancelled_) {
+      // `Cancel()` was called after `OnTimer()` checked, when there was no
+      // operation to cancel.
+      lk.unlock();
+      grpc::Status status(grpc::StatusCode::CANCELLED,
+                          "pending operation cancelled");
+      on_finish_(cq, status);
+      return;
+    }
+    current_op_ = cq.MakeStreamingReadRpc(
+        *this, &AsyncRowReader::PrepareAsyncReadRows, request,
+        std::move(context),
+        [self](CompletionQueue& cq,
+               google::bigtable::v2::ReadRowsResponse& response) {
+          self->OnRead(cq, response);
+        },
+        [self](CompletionQueue& cq, grpc::Status& status) {
+          self->OnFinish(cq, status);
+        });
+  }
+
+  /// Start the call on the pinned channel, if any.
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<google::bigtable::v2::ReadRowsResponse>>
+  PrepareAsyncReadRows(grpc::ClientContext* context,
+                       google::bigtable::v2::ReadRowsRequest const& request,
+                       grpc::CompletionQueue* cq) {
+    if (channel_) {
+      return client_->PrepareAsyncReadRowsOnChannel(context, request, cq,
+                                                    *channel_);
+    }
+    return client_->PrepareAsyncReadRows(context, request, cq);
+  }
+
+  void OnRead(CompletionQueue& cq,
+              google::bigtable::v2::ReadRowsResponse& response) {
+    if (not parser_status_.ok()) {
+      // The stream is being cancelled, discard any data still in flight.
+      return;
+    }
+    for (auto& chunk : *response.mutable_chunks()) {
+      parser_->HandleChunk(std::move(chunk), parser_status_);
+      if (not parser_status_.ok()) {
+        CancelStream();
+        return;
+      }
+      while (parser_->HasNext()) {
+        Row row = parser_->Next(parser_status_);
+        if (not parser_status_.ok()) {
+          CancelStream();
+          return;
+        }
+        ++rows_count_;
+        last_read_row_key_ = std::string(row.row_key());
+        on_row_(cq, std::move(row));
+      }
+    }
+  }
+
+  void OnFinish(CompletionQueue& cq, grpc::Status& stream_status) {
+    ReleaseCurrentOp();
+    grpc::Status status =
+        parser_status_.ok() ? stream_status : parser_status_;
+    if (status.ok()) {
+      parser_->HandleEndOfStream(status);
+    }
+    if (status.ok()) {
+      on_finish_(cq, status);
+      return;
+    }
+    // Same as `RowReader::Advance()`: if all the requested rows have been
+    // received, or there are no rows left to request, there is no need to
+    // retry.
+    if (rows_limit_ != NO_ROWS_LIMIT and rows_limit_ <= rows_count_) {
+      on_finish_(cq, status);
+      return;
+    }
+    if (not last_read_row_key_.empty()) {
+      row_set_.ResumeAfter(last_read_row_key_);
+    }
+    if (row_set_.IsEmpty()) {
+      on_finish_(cq, status);
+      return;
+    }
+    if (IsCancelled()) {
+      grpc::Status cancelled(grpc::StatusCode::CANCELLED,
+                             "pending operation cancelled");
+      on_finish_(cq, cancelled);
+      return;
+    }
+    if (not rpc_retry_policy_->OnFailure(status)) {
+      grpc::Status final_status(status.error_code(),
+                                "Unretriable error: " + status.error_message(),
+                                status.error_details());
+      on_finish_(cq, final_status);
+      return;
+    }
+    auto delay = rpc_backoff_policy_->OnCompletion(status);
+    auto self = this->shared_from_this();
+    std::lock_guard<std::mutex> lk(mu_);
+    current_op_ = cq.MakeRelativeTimer(
+        delay, [self](CompletionQueue& cq, AsyncTimerResult& timer) {
+          self->OnTimer(cq, timer);
+        });
+  }
+
+  void OnTimer(CompletionQueue& cq, AsyncTimerResult& timer) {
+    ReleaseCurrentOp();
+    if (timer.cancelled or IsCancelled()) {
+      grpc::Status cancelled(grpc::StatusCode::CANCELLED,
+                             "pending operation cancelled");
+      on_finish_(cq, cancelled);
+      return;
+    }
+    StartIteration(cq);
+  }
+
+  /// Cancel the current stream because the data received is invalid.
+  void CancelStream() {
+    std::shared_ptr<AsyncOperation> op;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      op = current_op_;
+    }
+    if (op) {
+      op->Cancel();
+    }
+  }
+
+  /// The completed operation holds a reference to `this`, break the cycle.
+  void ReleaseCurrentOp() {
+    std::lock_guard<std::mutex> lk(mu_);
+    current_op_.reset();
+  }
+
+  bool IsCancelled() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return cancelled_;
+  }
+
+  std::shared_ptr<DataClient> client_;
+  bigtable::AppProfileId app_profile_id_;
+  bigtable::TableId table_name_;
+  NormalizedRowSet row_set_;
+  std::int64_t rows_limit_;
+  Filter filter_;
+  std::unique_ptr<RPCRetryPolicy> rpc_retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy_;
+  MetadataUpdatePolicy metadata_update_policy_;
+  std::unique_ptr<ReadRowsParserFactory> parser_factory_;
+  RowFunctor on_row_;
+  FinishFunctor on_finish_;
+  google::cloud::internal::optional<std::size_t> channel_;
+
+  std::unique_ptr<ReadRowsParser> parser_;
+  grpc::Status parser_status_;
+  std::int64_t rows_count_;
+  std::string last_read_row_key_;
+
+  std::mutex mu_;
+  std::shared_ptr<AsyncOperation> current_op_;
+  bool cancelled_;
+};
+
+template <typename RowFunctor, typename FinishFunctor>
+std::int64_t constexpr AsyncRowReader<RowFunctor,
+                                      FinishFunctor>::NO_ROWS_LIMIT;
+
+/**
+ * Adapt the callbacks of `AsyncRowReader` to implement `Table::AsyncReadRow()`.
+ *
+ * Reading a single row is implemented as a `ReadRows()` request with a single
+ * key and a row limit of 1, this class keeps the row (if any) until the
+ * request finishes.
+ *
+ * @tparam Functor the type of the application callback, it must be invocable
+ *     as `void(CompletionQueue&, std::pair<bool, Row>, grpc::Status&)`.
+ */
+template <typename Functor>
+class AsyncReadRowAdapter {
+ public:
+  explicit AsyncReadRowAdapter(Functor callback)
+      : callback_(std::move(callback)), row_("", {}), has_row_(false) {}
+
+  /// Receive the row in the `AsyncRowReader` row callback.
+  void OnRow(Row row) {
+    row_ = std::move(row);
+    has_row_ = true;
+  }
+
+  /// Deliver the final result in the `AsyncRowReader` finish callback.
+  void OnFinish(CompletionQueue& cq, grpc::Status& status) {
+    if (not status.ok()) {
+      callback_(cq, std::make_pair(false, Row("", {})), status);
+      return;
+    }
+    callback_(cq, std::make_pair(has_row_, std::move(row_)), status);
+  }
+
+ private:
+  Functor callback_;
+  Row row_;
+  bool has_row_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_READ_ROWS_H_
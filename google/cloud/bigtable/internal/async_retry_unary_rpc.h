@@ -0,0 +1,237 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_RETRY_UNARY_RPC_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_RETRY_UNARY_RPC_H_
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/metadata_update_policy.h"
+#include "google/cloud/bigtable/rpc_backoff_policy.h"
+#include "google/cloud/bigtable/rpc_retry_policy.h"
+#include "google/cloud/internal/make_unique.h"
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Make an asynchronous unary RPC with retries.
+ *
+ * This is the asynchronous version of `UnaryClientUtils::MakeCall()`: it
+ * starts the RPC in a `CompletionQueue`, and if the RPC fails with a transient
+ * error it waits (using a timer in the same `CompletionQueue`) before trying
+ * again.  No threads are blocked while the RPC or the backoff timers are
+ * pending.
+ *
+ * Objects of this class must be created using `std::make_shared<>`, because
+ * the pending operations hold a reference to the object to keep it alive.
+ *
+ * @tparam Client the type of the client, typically `bigtable::DataClient`.
+ * @tparam Request the type of the RPC request.
+ * @tparam Response the type of the RPC response.
+ * @tparam Functor the type of the callback, it must be invocable as
+ *     `void(CompletionQueue&, Response&, grpc::Status&)`.
+ */
+template <typename Client, typename Request, typename Response,
+          typename Functor>
+class AsyncRetryUnaryRpc
+    : public AsyncOperation,
+      public std::enable_shared_from_this<
+          AsyncRetryUnaryRpc<Client, Request, Response, Functor>> {
+ public:
+  /// The type of the member function in @p Client that starts the RPC.
+  using MemberFunction =
+      std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<Response>> (
+          Client::*)(grpc::ClientContext*, Request const&,
+                     grpc::CompletionQueue*);
+
+  AsyncRetryUnaryRpc(char const* error_message,
+                     std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+                     std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
+                     bool is_idempotent,
+                     MetadataUpdatePolicy metadata_update_policy,
+                     std::shared_ptr<Client> client, MemberFunction call,
+                     Request request, Functor callback)
+      : error_message_(error_message),
+        rpc_retry_policy_(std::move(rpc_retry_policy)),
+        rpc_backoff_policy_(std::move(rpc_backoff_policy)),
+        is_idempotent_(is_idempotent),
+        metadata_update_policy_(std::move(metadata_update_policy)),
+        client_(std::move(client)),
+        call_(call),
+        request_(std::move(request)),
+        callback_(std::move(callback)),
+        cancelled_(false) {}
+
+  /**
+   * Start the first attempt of the RPC.
+   *
+   * @return the operation itself, applications can use it to cancel the
+   *     request.
+   */
+  std::shared_ptr<AsyncOperation> Start(CompletionQueue& cq) {
+    StartIteration(cq);
+    return this->shared_from_this();
+  }
+
+  void Cancel() override {
+    std::shared_ptr<AsyncOperation> op;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      cancelled_ = true;
+      op = current_op_;
+    }
+    if (op) {
+      op->Cancel();
+    }
+  }
+
+ private:
+  void StartIteration(CompletionQueue& cq) {
+    auto context = google::cloud::internal::make_unique<grpc::ClientContext>();
+    rpc_retry_policy_->Setup(*context);
+    rpc_backoff_policy_->Setup(*context);
+    metadata_update_policy_.Setup(*context);
+
+    auto self = this->shared_from_this();
+    // Hold the lock while the RPC starts, so a (very fast) completion in a
+    // different thread cannot update `current_op_` before we do.
+    std::unique_lock<std::mutex> lk(mu_);
+    if (cancelled_) {
+      // `Cancel()` was called after `OnTimer()` checked, when there was no
+      // operation to cancel.
+      lk.unlock();
+      Response response;
+      grpc::Status status(grpc::StatusCode::CANCELLED,
+                          FullErrorMessage("pending operation cancelled"));
+      callback_(cq, response, status);
+      return;
+    }
+    current_op_ = cq.MakeUnaryRpc(
+        *client_, call_, request_, std::move(context),
+        [self](CompletionQueue& cq, Response& response, grpc::Status& status) {
+          self->OnCompletion(cq, response, status);
+        });
+  }
+
+  void OnCompletion(CompletionQueue& cq, Response& response,
+                    grpc::Status& status) {
+    ReleaseCurrentOp();
+    if (status.ok()) {
+      callback_(cq, response, status);
+      return;
+    }
+    if (IsCancelled()) {
+      grpc::Status cancelled(grpc::StatusCode::CANCELLED,
+                             FullErrorMessage("pending operation cancelled"),
+                             status.error_details());
+      callback_(cq, response, cancelled);
+      return;
+    }
+    if (not is_idempotent_ or not rpc_retry_policy_->OnFailure(status)) {
+      grpc::Status final_status(status.error_code(),
+                                FullErrorMessage(status.error_message()),
+                                status.error_details());
+      callback_(cq, response, final_status);
+      return;
+    }
+    auto delay = rpc_backoff_policy_->OnCompletion(status);
+    auto self = this->shared_from_this();
+    std::lock_guard<std::mutex> lk(mu_);
+    current_op_ = cq.MakeRelativeTimer(
+        delay, [self](CompletionQueue& cq, AsyncTimerResult& timer) {
+          self->OnTimer(cq, timer);
+        });
+  }
+
+  void OnTimer(CompletionQueue& cq, AsyncTimerResult& timer) {
+    ReleaseCurrentOp();
+    if (timer.cancelled or IsCancelled()) {
+      Response response;
+      grpc::Status status(grpc::StatusCode::CANCELLED,
+                          FullErrorMessage("pending operation cancelled"));
+      callback_(cq, response, status);
+      return;
+    }
+    StartIteration(cq);
+  }
+
+  /// The completed operation holds a reference to `this`, break the cycle.
+  void ReleaseCurrentOp() {
+    std::lock_guard<std::mutex> lk(mu_);
+    current_op_.reset();
+  }
+
+  bool IsCancelled() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return cancelled_;
+  }
+
+  std::string FullErrorMessage(std::string const& message) const {
+    std::string full_message = error_message_;
+    full_message += "(" + metadata_update_policy_.value() + ") ";
+    full_message += message;
+    return full_message;
+  }
+
+  char const* error_message_;
+  std::unique_ptr<RPCRetryPolicy> rpc_retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy_;
+  bool is_idempotent_;
+  MetadataUpdatePolicy metadata_update_policy_;
+  std::shared_ptr<Client> client_;
+  MemberFunction call_;
+  Request request_;
+  Functor callback_;
+
+  std::mutex mu_;
+  std::shared_ptr<AsyncOperation> current_op_;
+  bool cancelled_;
+};
+
+/**
+ * Create and start an `AsyncRetryUnaryRpc`.
+ *
+ * This function deduces the template parameters of `AsyncRetryUnaryRpc` from
+ * its arguments.
+ */
+template <typename Client, typename Request, typename Response,
+          typename Functor>
+std::shared_ptr<AsyncOperation> StartAsyncRetryUnaryRpc(
+    CompletionQueue& cq, char const* error_message,
+    std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+    std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy, bool is_idempotent,
+    MetadataUpdatePolicy metadata_update_policy, std::shared_ptr<Client> client,
+    std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<Response>> (
+        Client::*call)(grpc::ClientContext*, Request const&,
+                       grpc::CompletionQueue*),
+    Request request, Functor&& callback) {
+  using Operation = AsyncRetryUnaryRpc<Client, Request, Response,
+                                       typename std::decay<Functor>::type>;
+  auto op = std::make_shared<Operation>(
+      error_message, std::move(rpc_retry_policy), std::move(rpc_backoff_policy),
+      is_idempotent, std::move(metadata_update_policy), std::move(client), call,
+      std::move(request), std::forward<Functor>(callback));
+  return op->Start(cq);
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_ASYNC_RETRY_UNARY_RPC_H_
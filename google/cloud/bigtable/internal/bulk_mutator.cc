@@ -13,10 +13,14 @@
 // limitations under the License.
 
 #include "google/cloud/bigtable/internal/bulk_mutator.h"
+#include "google/cloud/bigtable/bulk_apply_rate_limiter.h"
 #include "google/cloud/bigtable/internal/table.h"
 #include "google/cloud/bigtable/rpc_retry_policy.h"
 #include "google/cloud/bigtable/table_strong_types.h"
+#include <algorithm>
 #include <numeric>
+#include <thread>
+#include <unordered_map>
 
 namespace google {
 namespace cloud {
@@ -26,10 +30,27 @@ namespace internal {
 
 namespace btproto = google::bigtable::v2;
 
+namespace {
+/// The number of mutations in @p entry, empty entries still count as one.
+std::size_t EntryMutationCount(btproto::MutateRowsRequest::Entry const& entry) {
+  return (std::max)(std::size_t(1), std::size_t(entry.mutations_size()));
+}
+
+/// The number of mutations in @p request, as counted by `SplitRequest()`.
+std::size_t MutationCount(btproto::MutateRowsRequest const& request) {
+  return std::accumulate(
+      request.entries().begin(), request.entries().end(), std::size_t(0),
+      [](std::size_t count, btproto::MutateRowsRequest::Entry const& entry) {
+        return count + EntryMutationCount(entry);
+      });
+}
+}  // anonymous namespace
+
 BulkMutator::BulkMutator(bigtable::AppProfileId const& app_profile_id,
                          bigtable::TableId const& table_name,
                          IdempotentMutationPolicy& idempotent_policy,
-                         BulkMutation&& mut) {
+                         BulkMutation&& mut, bool merge_same_row)
+    : last_request_count_(0), last_request_throttled_count_(0) {
   // Every time the client library calls MakeOneRequest(), the data in the
   // "pending_*" variables initializes the next request.  So in the constructor
   // we start by putting the data on the "pending_*" variables.
@@ -51,13 +72,80 @@ BulkMutator::BulkMutator(bigtable::AppProfileId const& app_profile_id,
                          [&idempotent_policy](btproto::Mutation const& m) {
                            return idempotent_policy.is_idempotent(m);
                          });
-    pending_annotations_.push_back(Annotations{index++, r, false});
+    pending_annotations_.push_back(Annotations{index++, -1, r, false});
+  }
+  if (merge_same_row) {
+    MergeSameRowEntries();
+  }
+}
+
+void BulkMutator::MergeSameRowEntries() {
+  // Each row gets a single entry, at the position of its first entry.  This
+  // preserves the order of the mutations for each row, and the order across
+  // different rows does not matter.
+  std::unordered_map<std::string, int> row_entry;
+  btproto::MutateRowsRequest merged;
+  std::vector<Annotations> annotations;
+  for (int i = 0; i != pending_mutations_.entries_size(); ++i) {
+    auto& entry = *pending_mutations_.mutable_entries(i);
+    auto const& annotation = pending_annotations_[i];
+    auto inserted = row_entry.emplace(entry.row_key(), merged.entries_size());
+    if (inserted.second) {
+      merged.add_entries()->Swap(&entry);
+      annotations.push_back(annotation);
+      continue;
+    }
+    auto& target = *merged.mutable_entries(inserted.first->second);
+    auto& merged_annotation = annotations[inserted.first->second];
+    if (merged_annotation.merged_index < 0) {
+      merged_annotation.merged_index = static_cast<int>(merged_entries_.size());
+      merged_entries_.emplace_back(std::vector<MergedPart>{
+          {merged_annotation.original_index, target.mutations_size()}});
+    }
+    merged_entries_[merged_annotation.merged_index].push_back(
+        MergedPart{annotation.original_index, entry.mutations_size()});
+    merged_annotation.is_idempotent =
+        merged_annotation.is_idempotent and annotation.is_idempotent;
+    for (auto& m : *entry.mutable_mutations()) {
+      target.add_mutations()->Swap(&m);
+    }
   }
+  pending_mutations_.mutable_entries()->Swap(merged.mutable_entries());
+  pending_annotations_.swap(annotations);
+}
+
+std::vector<std::pair<int, SingleRowMutation>> BulkMutator::SplitMergedEntry(
+    btproto::MutateRowsRequest::Entry& entry,
+    Annotations const& annotation) const {
+  std::vector<std::pair<int, SingleRowMutation>> result;
+  if (annotation.merged_index < 0) {
+    result.emplace_back(annotation.original_index,
+                        SingleRowMutation(std::move(entry)));
+    return result;
+  }
+  auto const& parts = merged_entries_[annotation.merged_index];
+  result.reserve(parts.size());
+  int begin = 0;
+  for (auto const& part : parts) {
+    btproto::MutateRowsRequest::Entry e;
+    e.set_row_key(entry.row_key());
+    for (int i = begin; i != begin + part.mutations_count; ++i) {
+      e.add_mutations()->Swap(entry.mutable_mutations(i));
+    }
+    begin += part.mutations_count;
+    result.emplace_back(part.original_index, SingleRowMutation(std::move(e)));
+  }
+  return result;
 }
 
 grpc::Status BulkMutator::MakeOneRequest(bigtable::DataClient& client,
                                          grpc::ClientContext& client_context) {
   PrepareForRequest();
+  return SendRequest(client, client_context);
+}
+
+grpc::Status BulkMutator::SendRequest(bigtable::DataClient& client,
+                                      grpc::ClientContext& client_context) {
   // Send the request to the server and read the resulting result stream.
   auto stream = client.MutateRows(&client_context, mutations_);
   btproto::MutateRowsResponse response;
@@ -68,6 +156,126 @@ grpc::Status BulkMutator::MakeOneRequest(bigtable::DataClient& client,
   return stream->Finish();
 }
 
+grpc::Status BulkMutator::MakeRequests(
+    bigtable::DataClient& client,
+    std::function<std::unique_ptr<grpc::ClientContext>()> const& make_context,
+    BulkApplySplitPolicy const& policy) {
+  PrepareForRequest();
+  auto ranges = SplitRequest(policy);
+  if (ranges.size() <= 1U) {
+    // Avoid the threads and the copies for the common case.
+    auto client_context = make_context();
+    return SendRequest(client, *client_context);
+  }
+
+  std::mutex mu;
+  std::size_t next_range = 0;
+  grpc::Status status;
+  auto worker = [&]() {
+    while (true) {
+      std::pair<int, int> range;
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        if (next_range == ranges.size()) {
+          return;
+        }
+        range = ranges[next_range++];
+      }
+      auto client_context = make_context();
+      auto s = MakeSubRequest(client, *client_context, range);
+      std::lock_guard<std::mutex> lk(mu);
+      if (status.ok() and not s.ok()) {
+        status = std::move(s);
+      }
+    }
+  };
+  auto const thread_count = (std::min)(policy.max_concurrency(), ranges.size());
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  // The calling thread is one of the workers.
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+  FinishRequest();
+  return status;
+}
+
+std::size_t BulkMutator::pending_mutations_count() const {
+  return MutationCount(pending_mutations_);
+}
+
+std::vector<std::pair<int, int>> BulkMutator::SplitRequest(
+    BulkApplySplitPolicy const& policy) const {
+  std::vector<std::pair<int, int>> ranges;
+  int begin = 0;
+  std::size_t mutations = 0;
+  std::size_t bytes = 0;
+  for (int i = 0; i != mutations_.entries_size(); ++i) {
+    auto const& entry = mutations_.entries(i);
+    auto entry_mutations = EntryMutationCount(entry);
+    auto entry_bytes = static_cast<std::size_t>(entry.ByteSizeLong());
+    if (i != begin and
+        (mutations + entry_mutations > policy.max_mutations_per_request() or
+         bytes + entry_bytes > policy.max_bytes_per_request())) {
+      ranges.emplace_back(begin, i);
+      begin = i;
+      mutations = 0;
+      bytes = 0;
+    }
+    mutations += entry_mutations;
+    bytes += entry_bytes;
+  }
+  if (begin != mutations_.entries_size()) {
+    ranges.emplace_back(begin, mutations_.entries_size());
+  }
+  return ranges;
+}
+
+grpc::Status BulkMutator::MakeSubRequest(bigtable::DataClient& client,
+                                         grpc::ClientContext& client_context,
+                                         std::pair<int, int> range) {
+  // Move the entries to the sub-request, the responses move them again to the
+  // pending mutations or to the failures.  The entries of `mutations_` are not
+  // resized, so each thread only touches its own range.
+  btproto::MutateRowsRequest request;
+  request.set_table_name(mutations_.table_name());
+  request.set_app_profile_id(mutations_.app_profile_id());
+  request.mutable_entries()->Reserve(range.second - range.first);
+  for (int i = range.first; i != range.second; ++i) {
+    request.add_entries()->Swap(mutations_.mutable_entries(i));
+  }
+
+  auto stream = client.MutateRows(&client_context, request);
+  btproto::MutateRowsResponse response;
+  while (stream->Read(&response)) {
+    std::lock_guard<std::mutex> lk(mu_);
+    ProcessResponse(response, request, range.first);
+  }
+  auto status = stream->Finish();
+
+  // Return the entries without a result, `FinishRequest()` handles them.
+  for (int i = range.first; i != range.second; ++i) {
+    mutations_.mutable_entries(i)->Swap(
+        request.mutable_entries(i - range.first));
+  }
+  return status;
+}
+
+btproto::MutateRowsRequest const& BulkMutator::BeforeStart() {
+  PrepareForRequest();
+  return mutations_;
+}
+
+void BulkMutator::OnRead(btproto::MutateRowsResponse& response) {
+  ProcessResponse(response);
+}
+
+void BulkMutator::OnFinish() { FinishRequest(); }
+
 void BulkMutator::PrepareForRequest() {
   mutations_.Swap(&pending_mutations_);
   annotations_.swap(pending_annotations_);
@@ -79,16 +287,22 @@ void BulkMutator::PrepareForRequest() {
       btproto::MutateRowsRequest>(
       pending_mutations_, mutations_.app_profile_id(), mutations_.table_name());
   pending_annotations_ = {};
+  // Count the mutations now, processing the responses moves them out of the
+  // request.
+  last_request_count_ = MutationCount(mutations_);
+  last_request_throttled_count_ = 0;
 }
 
 void BulkMutator::ProcessResponse(
-    google::bigtable::v2::MutateRowsResponse& response) {
+    google::bigtable::v2::MutateRowsResponse& response,
+    google::bigtable::v2::MutateRowsRequest& request, int offset) {
   for (auto& entry : *response.mutable_entries()) {
-    auto index = entry.index();
-    if (index < 0 or annotations_.size() <= std::size_t(index)) {
+    auto request_index = entry.index();
+    if (request_index < 0 or request.entries_size() <= request_index) {
       // TODO(#72) - decide how this is logged.
       continue;
     }
+    auto index = request_index + offset;
     auto& annotation = annotations_[index];
     annotation.has_mutation_result = true;
     auto& status = entry.status();
@@ -99,7 +313,10 @@ void BulkMutator::ProcessResponse(
     if (grpc::StatusCode::OK == code) {
       continue;
     }
-    auto& original = *mutations_.mutable_entries(index);
+    auto& original = *request.mutable_entries(request_index);
+    if (BulkApplyRateLimiter::IsThrottlingError(code)) {
+      last_request_throttled_count_ += EntryMutationCount(original);
+    }
     // Failed responses are handled according to the current policies.
     if (SafeGrpcRetry::IsTransientFailure(code) and annotation.is_idempotent) {
       // Retryable requests are saved in the pending mutations, along with the
@@ -110,10 +327,10 @@ void BulkMutator::ProcessResponse(
     } else {
       // Failures are saved for reporting, notice that we avoid copying, and
       // we use the original index in the first request, not the one where it
-      // failed.
-      failures_.emplace_back(SingleRowMutation(std::move(original)),
-                             std::move(*entry.mutable_status()),
-                             annotation.original_index);
+      // failed.  Merged entries are reported once for each original entry.
+      for (auto& part : SplitMergedEntry(original, annotation)) {
+        failures_.emplace_back(std::move(part.second), status, part.first);
+      }
     }
   }
 }
@@ -137,9 +354,10 @@ void BulkMutator::FinishRequest() {
       // cannot retry them.  Report them as OK in the failure list.
       google::rpc::Status ok_status;
       ok_status.set_code(grpc::StatusCode::OK);
-      failures_.emplace_back(
-          FailedMutation(SingleRowMutation(std::move(original)), ok_status,
-                         annotation.original_index));
+      for (auto& part : SplitMergedEntry(original, annotation)) {
+        failures_.emplace_back(
+            FailedMutation(std::move(part.second), ok_status, part.first));
+      }
     }
     ++index;
   }
@@ -149,9 +367,12 @@ std::vector<FailedMutation> BulkMutator::ExtractFinalFailures() {
   std::vector<FailedMutation> result(std::move(failures_));
   google::rpc::Status ok_status;
   ok_status.set_code(grpc::StatusCode::OK);
-  for (auto& mutation : *pending_mutations_.mutable_entries()) {
-    result.emplace_back(
-        FailedMutation(SingleRowMutation(std::move(mutation)), ok_status));
+  for (int i = 0; i != pending_mutations_.entries_size(); ++i) {
+    auto& mutation = *pending_mutations_.mutable_entries(i);
+    for (auto& part : SplitMergedEntry(mutation, pending_annotations_[i])) {
+      result.emplace_back(
+          FailedMutation(std::move(part.second), ok_status, part.first));
+    }
   }
   return result;
 }
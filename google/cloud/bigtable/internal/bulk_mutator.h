@@ -16,9 +16,15 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_BULK_MUTATOR_H_
 
 #include "google/cloud/bigtable/bigtable_strong_types.h"
+#include "google/cloud/bigtable/bulk_apply_split_policy.h"
 #include "google/cloud/bigtable/data_client.h"
 #include "google/cloud/bigtable/idempotent_mutation_policy.h"
 #include "google/cloud/bigtable/table_strong_types.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -28,28 +34,119 @@ namespace internal {
 /// Keep the state in the Table::BulkApply() member function.
 class BulkMutator {
  public:
+  /**
+   * Take ownership of the mutations in @p mut.
+   *
+   * If @p merge_same_row is true the entries for the same row are merged into
+   * a single entry, in their original order.  Failures are still reported
+   * once for each entry in @p mut, using its original index.
+   */
   BulkMutator(bigtable::AppProfileId const& app_profile_id,
               bigtable::TableId const& table_name,
-              IdempotentMutationPolicy& idempotent_policy, BulkMutation&& mut);
+              IdempotentMutationPolicy& idempotent_policy, BulkMutation&& mut,
+              bool merge_same_row = false);
 
   /// Return true if there are pending mutations in the mutator
   bool HasPendingMutations() const {
     return pending_mutations_.entries_size() != 0;
   }
 
+  /**
+   * The number of mutations in the next request.
+   *
+   * Each entry counts as the number of mutations it contains, and at least
+   * one, as in the limits used by `MakeRequests()`.
+   */
+  std::size_t pending_mutations_count() const;
+
+  /// The size of the next request, in bytes.
+  std::size_t pending_mutations_bytes() const {
+    return static_cast<std::size_t>(pending_mutations_.ByteSizeLong());
+  }
+
+  /// The number of mutations in the last request, see
+  /// `pending_mutations_count()`.
+  std::size_t last_request_count() const { return last_request_count_; }
+
+  /// The number of mutations rejected with a throttling error in the last
+  /// request.
+  std::size_t last_request_throttled_count() const {
+    return last_request_throttled_count_;
+  }
+
   /// Send one batch request to the given stub.
   grpc::Status MakeOneRequest(bigtable::DataClient& client,
                               grpc::ClientContext& client_context);
 
+  /**
+   * Send the pending mutations, split into several concurrent requests.
+   *
+   * The mutations are split as described in @p policy, each request uses a new
+   * context created by @p make_context.  If the mutations fit in a single
+   * request this is equivalent to `MakeOneRequest()`.
+   *
+   * @return the first error returned by any of the requests, or OK.
+   */
+  grpc::Status MakeRequests(
+      bigtable::DataClient& client,
+      std::function<std::unique_ptr<grpc::ClientContext>()> const&
+          make_context,
+      BulkApplySplitPolicy const& policy);
+
   /// Give up on any pending mutations, move them to the failures array.
   std::vector<FailedMutation> ExtractFinalFailures();
 
+  //@{
+  /**
+   * @name Asynchronous requests.
+   *
+   * When the request is made asynchronously the caller drives the stream, these
+   * functions split `MakeOneRequest()` in its three phases.
+   */
+  /// Get ready for a new request, return the request to send.
+  google::bigtable::v2::MutateRowsRequest const& BeforeStart();
+
+  /// Process a single response.
+  void OnRead(google::bigtable::v2::MutateRowsResponse& response);
+
+  /// The stream has finished, any mutations without a result are pending.
+  void OnFinish();
+  //@}
+
  private:
+  /// Merge the pending entries that have the same row key.
+  void MergeSameRowEntries();
+
   /// Get ready for a new request.
   void PrepareForRequest();
 
   /// Process a single response.
-  void ProcessResponse(google::bigtable::v2::MutateRowsResponse& response);
+  void ProcessResponse(google::bigtable::v2::MutateRowsResponse& response) {
+    ProcessResponse(response, mutations_, 0);
+  }
+
+  /**
+   * Process a single response for a request holding a subset of `mutations_`.
+   *
+   * The request in @p request holds the entries starting at @p offset in
+   * `mutations_`, the indices in the response are relative to that request.
+   */
+  void ProcessResponse(google::bigtable::v2::MutateRowsResponse& response,
+                       google::bigtable::v2::MutateRowsRequest& request,
+                       int offset);
+
+  /// Send `mutations_` as a single request, after `PrepareForRequest()`.
+  grpc::Status SendRequest(bigtable::DataClient& client,
+                           grpc::ClientContext& client_context);
+
+  /// Return the [begin, end) ranges of `mutations_` for each request.
+  std::vector<std::pair<int, int>> SplitRequest(
+      BulkApplySplitPolicy const& policy) const;
+
+  /// Send the entries in @p range as a separate request.
+  grpc::Status MakeSubRequest(bigtable::DataClient& client,
+                              grpc::ClientContext& client_context,
+                              std::pair<int, int> range);
 
   /// A request has finished and we have processed all the responses.
   void FinishRequest();
@@ -76,11 +173,32 @@ class BulkMutator {
      * request provided by the application.
      */
     int original_index;
+    /// The index in `merged_entries_`, or -1 if the entry was not merged.
+    int merged_index;
     bool is_idempotent;
     /// Set to false if the result is unknown.
     bool has_mutation_result;
   };
 
+  /// One of the entries provided by the application, in a merged entry.
+  struct MergedPart {
+    int original_index;
+    int mutations_count;
+  };
+
+  /**
+   * Split a (possibly merged) entry into the entries provided by the
+   * application.
+   *
+   * @return the original index and mutation for each entry.
+   */
+  std::vector<std::pair<int, SingleRowMutation>> SplitMergedEntry(
+      google::bigtable::v2::MutateRowsRequest::Entry& entry,
+      Annotations const& annotation) const;
+
+  /// The parts of each merged entry, in order, they never change once created.
+  std::vector<std::vector<MergedPart>> merged_entries_;
+
   /// The annotations about the current bulk request.
   std::vector<Annotations> annotations_;
 
@@ -89,6 +207,15 @@ class BulkMutator {
 
   /// Accumulate annotations for the next request.
   std::vector<Annotations> pending_annotations_;
+
+  /// The number of mutations in the current request.
+  std::size_t last_request_count_;
+
+  /// Mutations in the current request rejected with a throttling error.
+  std::size_t last_request_throttled_count_;
+
+  /// Serialize the processing of responses from concurrent requests.
+  std::mutex mu_;
 };
 }  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
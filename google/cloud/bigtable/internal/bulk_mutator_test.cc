@@ -17,6 +17,9 @@
 #include "google/cloud/bigtable/testing/mock_mutate_rows_reader.h"
 #include "google/cloud/internal/make_unique.h"
 #include "google/cloud/testing_util/chrono_literals.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 /// Define types and functions used in the tests.
 namespace {
@@ -414,3 +417,285 @@ TEST(MultipleRowsMutatorTest, RetryOnlyIdempotent) {
   EXPECT_EQ("baz", failures[1].mutation().row_key());
   EXPECT_EQ(grpc::StatusCode::OK, failures[1].status().error_code());
 }
+
+/// @test Verify that MultipleRowsMutator splits large requests.
+TEST(MultipleRowsMutatorTest, SplitRequests) {
+  bt::BulkMutation mut(
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "col", 0_ms, "baz")}),
+      bt::SingleRowMutation("bar", {bt::SetCell("fam", "col", 0_ms, "qux"),
+                                    bt::SetCell("fam", "col", 1_ms, "qux")}),
+      bt::SingleRowMutation("baz", {bt::SetCell("fam", "col", 0_ms, "v")}),
+      bt::SingleRowMutation("qux", {bt::SetCell("fam", "col", 0_ms, "v")}));
+
+  // Each request fails the "bar" row, and succeeds for all other rows.
+  std::mutex mu;
+  std::vector<std::vector<std::string>> requests;
+  bigtable::testing::MockDataClient client;
+  EXPECT_CALL(client, MutateRows(_, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&mu, &requests](
+                                 grpc::ClientContext*,
+                                 btproto::MutateRowsRequest const& request) {
+        EXPECT_EQ("foo/bar/baz/table", request.table_name());
+        std::vector<std::string> keys;
+        btproto::MutateRowsResponse response;
+        for (int i = 0; i != request.entries_size(); ++i) {
+          keys.push_back(request.entries(i).row_key());
+          auto& e = *response.add_entries();
+          e.set_index(i);
+          e.mutable_status()->set_code(
+              keys.back() == "bar" ? grpc::StatusCode::OUT_OF_RANGE
+                                   : grpc::StatusCode::OK);
+        }
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          requests.push_back(std::move(keys));
+        }
+        auto reader = new MockMutateRowsReader;
+        EXPECT_CALL(*reader, Read(_))
+            .WillOnce(Invoke([response](btproto::MutateRowsResponse* r) {
+              *r = response;
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+        return MockMutateRowsReader::UniquePtr(reader);
+      }));
+
+  auto policy = bt::DefaultIdempotentMutationPolicy();
+  bt::internal::BulkMutator mutator(bigtable::AppProfileId(""),
+                                    bigtable::TableId("foo/bar/baz/table"),
+                                    *policy, std::move(mut));
+
+  // At most two mutations per request: ["foo"], ["bar"], ["baz", "qux"].
+  bt::BulkApplySplitPolicy split(2, 1024 * 1024, 2);
+  auto status = mutator.MakeRequests(
+      client,
+      [] {
+        return google::cloud::internal::make_unique<grpc::ClientContext>();
+      },
+      split);
+  EXPECT_TRUE(status.ok());
+  EXPECT_FALSE(mutator.HasPendingMutations());
+
+  std::sort(requests.begin(), requests.end());
+  std::vector<std::vector<std::string>> expected{
+      {"bar"}, {"baz", "qux"}, {"foo"}};
+  EXPECT_EQ(expected, requests);
+
+  auto failures = mutator.ExtractFinalFailures();
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ(1, failures[0].original_index());
+  EXPECT_EQ("bar", failures[0].mutation().row_key());
+  EXPECT_EQ(grpc::StatusCode::OUT_OF_RANGE, failures[0].status().error_code());
+}
+
+/// @test Verify that MultipleRowsMutator splits requests by size.
+TEST(MultipleRowsMutatorTest, SplitRequestsBySize) {
+  std::string const value(1024, 'x');
+  bt::BulkMutation mut;
+  for (int i = 0; i != 4; ++i) {
+    mut.emplace_back(bt::SingleRowMutation(
+        "row-" + std::to_string(i), {bt::SetCell("fam", "col", 0_ms, value)}));
+  }
+
+  std::atomic<int> entries(0);
+  bigtable::testing::MockDataClient client;
+  EXPECT_CALL(client, MutateRows(_, _))
+      .Times(4)
+      .WillRepeatedly(Invoke([&entries](
+                                 grpc::ClientContext*,
+                                 btproto::MutateRowsRequest const& request) {
+        EXPECT_EQ(1, request.entries_size());
+        entries += request.entries_size();
+        auto reader = new MockMutateRowsReader;
+        EXPECT_CALL(*reader, Read(_))
+            .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+              auto& e = *r->add_entries();
+              e.set_index(0);
+              e.mutable_status()->set_code(grpc::StatusCode::OK);
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+        return MockMutateRowsReader::UniquePtr(reader);
+      }));
+
+  auto policy = bt::DefaultIdempotentMutationPolicy();
+  bt::internal::BulkMutator mutator(bigtable::AppProfileId(""),
+                                    bigtable::TableId("foo/bar/baz/table"),
+                                    *policy, std::move(mut));
+
+  // Each entry is slightly larger than 1KiB, only one fits in each request.
+  bt::BulkApplySplitPolicy split(100, 1500, 3);
+  auto status = mutator.MakeRequests(
+      client,
+      [] {
+        return google::cloud::internal::make_unique<grpc::ClientContext>();
+      },
+      split);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(4, entries.load());
+  EXPECT_FALSE(mutator.HasPendingMutations());
+  EXPECT_TRUE(mutator.ExtractFinalFailures().empty());
+}
+
+/// @test Verify that MultipleRowsMutator merges the entries for the same row.
+TEST(MultipleRowsMutatorTest, MergeSameRow) {
+  bt::BulkMutation mut(
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "c0", 0_ms, "v0")}),
+      bt::SingleRowMutation("bar", {bt::SetCell("fam", "c0", 0_ms, "v0")}),
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "c1", 0_ms, "v1"),
+                                    bt::SetCell("fam", "c2", 0_ms, "v2")}));
+
+  // The request has one entry per row, fail the entry for "foo".
+  auto reader = google::cloud::internal::make_unique<MockMutateRowsReader>();
+  EXPECT_CALL(*reader, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+        {
+          auto& e = *r->add_entries();
+          e.set_index(0);
+          e.mutable_status()->set_code(grpc::StatusCode::OUT_OF_RANGE);
+        }
+        {
+          auto& e = *r->add_entries();
+          e.set_index(1);
+          e.mutable_status()->set_code(grpc::StatusCode::OK);
+        }
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  bigtable::testing::MockDataClient client;
+  EXPECT_CALL(client, MutateRows(_, _))
+      .WillOnce(Invoke([&reader](grpc::ClientContext*,
+                                 btproto::MutateRowsRequest const& req) {
+        EXPECT_EQ(2, req.entries_size());
+        EXPECT_EQ("foo", req.entries(0).row_key());
+        EXPECT_EQ(3, req.entries(0).mutations_size());
+        for (int i = 0; i != req.entries(0).mutations_size(); ++i) {
+          EXPECT_EQ("c" + std::to_string(i),
+                    req.entries(0).mutations(i).set_cell().column_qualifier());
+        }
+        EXPECT_EQ("bar", req.entries(1).row_key());
+        EXPECT_EQ(1, req.entries(1).mutations_size());
+        return reader.release()->AsUniqueMocked();
+      }));
+
+  auto policy = bt::DefaultIdempotentMutationPolicy();
+  bt::internal::BulkMutator mutator(bigtable::AppProfileId(""),
+                                    bigtable::TableId("foo/bar/baz/table"),
+                                    *policy, std::move(mut), true);
+
+  grpc::ClientContext context;
+  auto status = mutator.MakeOneRequest(client, context);
+  EXPECT_TRUE(status.ok());
+  EXPECT_FALSE(mutator.HasPendingMutations());
+
+  // The failure is reported for each of the original entries.
+  auto failures = mutator.ExtractFinalFailures();
+  ASSERT_EQ(2UL, failures.size());
+  EXPECT_EQ(0, failures[0].original_index());
+  EXPECT_EQ("foo", failures[0].mutation().row_key());
+  btproto::MutateRowsRequest::Entry e0;
+  bt::SingleRowMutation(failures[0].mutation()).MoveTo(&e0);
+  EXPECT_EQ(1, e0.mutations_size());
+  EXPECT_EQ(grpc::StatusCode::OUT_OF_RANGE, failures[0].status().error_code());
+  EXPECT_EQ(2, failures[1].original_index());
+  EXPECT_EQ("foo", failures[1].mutation().row_key());
+  btproto::MutateRowsRequest::Entry e1;
+  bt::SingleRowMutation(failures[1].mutation()).MoveTo(&e1);
+  EXPECT_EQ(2, e1.mutations_size());
+  EXPECT_EQ(grpc::StatusCode::OUT_OF_RANGE, failures[1].status().error_code());
+}
+
+/// @test Verify that pending mutations are reported with their original index.
+TEST(MultipleRowsMutatorTest, PendingFailuresKeepOriginalIndex) {
+  bt::BulkMutation mut(
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "c0", 0_ms, "v0")}),
+      bt::SingleRowMutation("bar", {bt::SetCell("fam", "c0", 0_ms, "v0")}),
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "c1", 0_ms, "v1")}));
+
+  // Both entries fail with a transient error, and the caller gives up.
+  auto reader = google::cloud::internal::make_unique<MockMutateRowsReader>();
+  EXPECT_CALL(*reader, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+        for (int i = 0; i != 2; ++i) {
+          auto& e = *r->add_entries();
+          e.set_index(i);
+          e.mutable_status()->set_code(grpc::StatusCode::UNAVAILABLE);
+        }
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  bigtable::testing::MockDataClient client;
+  EXPECT_CALL(client, MutateRows(_, _))
+      .WillOnce(Invoke(reader.release()->MakeMockReturner()));
+
+  auto policy = bt::DefaultIdempotentMutationPolicy();
+  bt::internal::BulkMutator mutator(bigtable::AppProfileId(""),
+                                    bigtable::TableId("foo/bar/baz/table"),
+                                    *policy, std::move(mut), true);
+
+  grpc::ClientContext context;
+  auto status = mutator.MakeOneRequest(client, context);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(mutator.HasPendingMutations());
+
+  auto failures = mutator.ExtractFinalFailures();
+  ASSERT_EQ(3UL, failures.size());
+  EXPECT_EQ(0, failures[0].original_index());
+  EXPECT_EQ("foo", failures[0].mutation().row_key());
+  EXPECT_EQ(2, failures[1].original_index());
+  EXPECT_EQ("foo", failures[1].mutation().row_key());
+  EXPECT_EQ(1, failures[2].original_index());
+  EXPECT_EQ("bar", failures[2].mutation().row_key());
+}
+
+/// @test Verify that the request sizes count mutations, not entries.
+TEST(MultipleRowsMutatorTest, CountMutations) {
+  bt::BulkMutation mut(
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "c1", 0_ms, "v1"),
+                                    bt::SetCell("fam", "c2", 0_ms, "v2"),
+                                    bt::SetCell("fam", "c3", 0_ms, "v3")}),
+      bt::SingleRowMutation("bar", {bt::SetCell("fam", "col", 0_ms, "qux")}));
+
+  auto reader = google::cloud::internal::make_unique<MockMutateRowsReader>();
+  EXPECT_CALL(*reader, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+        {
+          auto& e = *r->add_entries();
+          e.set_index(0);
+          e.mutable_status()->set_code(grpc::StatusCode::UNAVAILABLE);
+        }
+        {
+          auto& e = *r->add_entries();
+          e.set_index(1);
+          e.mutable_status()->set_code(grpc::StatusCode::OK);
+        }
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  bigtable::testing::MockDataClient client;
+  EXPECT_CALL(client, MutateRows(_, _))
+      .WillOnce(Invoke(reader.release()->MakeMockReturner()));
+
+  auto policy = bt::DefaultIdempotentMutationPolicy();
+  bt::internal::BulkMutator mutator(bigtable::AppProfileId(""),
+                                    bigtable::TableId("foo/bar/baz/table"),
+                                    *policy, std::move(mut));
+  EXPECT_EQ(4U, mutator.pending_mutations_count());
+
+  grpc::ClientContext context;
+  auto status = mutator.MakeOneRequest(client, context);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(4U, mutator.last_request_count());
+  EXPECT_EQ(3U, mutator.last_request_throttled_count());
+  // Only the failed row is pending.
+  EXPECT_EQ(3U, mutator.pending_mutations_count());
+}
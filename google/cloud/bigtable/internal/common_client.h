@@ -17,6 +17,11 @@
 
 #include "google/cloud/bigtable/client_options.h"
 #include <grpcpp/grpcpp.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -24,10 +29,60 @@ namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
 namespace internal {
 
+/// Create the channel with id @p pool_id in a pool.
+std::shared_ptr<grpc::Channel> CreateChannel(
+    std::string const& endpoint, bigtable::ClientOptions const& options,
+    int pool_id);
+
 /// Create a pool of grpc::Channel objects based on the client options.
 std::vector<std::shared_ptr<grpc::Channel>> CreateChannelPool(
     std::string const& endpoint, bigtable::ClientOptions const& options);
 
+/**
+ * Count an in-flight RPC on one of the channels of a `CommonClient`.
+ *
+ * The counter is incremented when the guard is created by
+ * `CommonClient::Stub(CallGuard&)` and decremented when the guard is
+ * destroyed.  Streaming RPCs should keep the guard alive as long as the stream.
+ * The guard shares ownership of the counter, so it remains valid even if the
+ * client discards its channels while the call is in progress.
+ */
+class CallGuard {
+ public:
+  CallGuard() = default;
+  /// Count a call on @p counter, the caller must keep it alive.
+  explicit CallGuard(std::atomic<long>* counter)
+      : CallGuard(std::shared_ptr<std::atomic<long>>(std::shared_ptr<void>(),
+                                                     counter)) {}
+  explicit CallGuard(std::shared_ptr<std::atomic<long>> counter)
+      : counter_(std::move(counter)) {
+    counter_->fetch_add(1, std::memory_order_relaxed);
+  }
+  ~CallGuard() { Release(); }
+
+  CallGuard(CallGuard&& rhs) noexcept : counter_(std::move(rhs.counter_)) {}
+  CallGuard& operator=(CallGuard&& rhs) noexcept {
+    if (this != &rhs) {
+      Release();
+      counter_ = std::move(rhs.counter_);
+    }
+    return *this;
+  }
+
+  CallGuard(CallGuard const&) = delete;
+  CallGuard& operator=(CallGuard const&) = delete;
+
+ private:
+  void Release() {
+    if (counter_) {
+      counter_->fetch_sub(1, std::memory_order_relaxed);
+      counter_.reset();
+    }
+  }
+
+  std::shared_ptr<std::atomic<long>> counter_;
+};
+
 /**
  * Refactor implementation of `bigtable::{Data,Admin,InstanceAdmin}Client`.
  *
@@ -36,6 +91,23 @@ std::vector<std::shared_ptr<grpc::Channel>> CreateChannelPool(
  * channels. At least `bigtable::DataClient` needs to optimize the creation of
  * the stub objects.
  *
+ * Selecting a stub does not acquire any lock once the channels are created:
+ * the channels and stubs are immutable after they are published, the current
+ * pool is read through an atomic pointer, and the round-robin index is an
+ * atomic counter.  If `ClientOptions::load_aware_channel_selection()` is set, `Stub()` picks the
+ * channel with the fewest in-flight calls instead, as counted by `CallGuard`.
+ * The synchronous calls and the asynchronous streaming calls are counted.
+ *
+ * If `ClientOptions::max_connection_pool_size()` is larger than
+ * `ClientOptions::connection_pool_size()` the pool grows, one channel at a
+ * time, when the average number of in-flight calls per channel reaches
+ * `ClientOptions::max_calls_per_channel()`.  It shrinks back when the load
+ * drops below half that threshold.  The load is only checked once every
+ * `ResizeCheckInterval()` selections, so the cost of adding up the counters is
+ * not paid on every call.  Resizing publishes a new pool that shares the
+ * remaining channels with the previous one.  A removed channel stops receiving
+ * new calls, and it is released once the calls already using it complete.
+ *
  * The class exposes the channels because they are needed for clients that
  * use more than one type of Stub.
  *
@@ -53,7 +125,19 @@ class CommonClient {
   //@}
 
   CommonClient(bigtable::ClientOptions options)
-      : options_(std::move(options)), current_index_(0) {}
+      : options_(std::move(options)),
+        pool_(nullptr),
+        next_index_(0),
+        epoch_(0),
+        resizing_(false),
+        has_retired_(false) {
+    readers_[0].store(0);
+    readers_[1].store(0);
+    seen_idle_[0] = false;
+    seen_idle_[1] = false;
+  }
+
+  ~CommonClient() { delete pool_.load(); }
 
   /**
    * Reset the channel and stub.
@@ -61,75 +145,383 @@ class CommonClient {
    * This is just used for testing at the moment.  In the future, we expect that
    * the channel and stub will need to be reset under some error conditions
    * and/or when the credentials require explicit refresh.
+   *
+   * The previous channels are released once the calls using them complete.
    */
   void reset() {
     std::lock_guard<std::mutex> lk(mu_);
-    stubs_.clear();
+    auto pool = pool_.exchange(nullptr);
+    if (pool != nullptr) {
+      Retire(pool);
+    }
+    ReclaimRetired();
   }
 
   /// Return the next Stub to make a call.
   StubPtr Stub() {
-    std::unique_lock<std::mutex> lk(mu_);
-    CheckConnections(lk);
-    auto stub = stubs_[GetIndex(lk)];
-    return stub;
+    auto const ticket = NextTicket();
+    ReadGuard reading(*this);
+    auto const& pool = *CheckConnections();
+    return pool.stubs[SelectIndex(pool, ticket)];
+  }
+
+  /// Return the next Stub to make a call, and count the call on its channel.
+  StubPtr Stub(CallGuard& guard) {
+    auto const ticket = NextTicket();
+    ReadGuard reading(*this);
+    auto const& pool = *CheckConnections();
+    auto const index = SelectIndex(pool, ticket);
+    guard = CallGuard(pool.in_flight[index]);
+    return pool.stubs[index];
+  }
+
+  /**
+   * Select the channel for the next call.
+   *
+   * Use the result with `Stub(CallGuard&, std::size_t)` to make the call, for
+   * example, to send a second call on a different channel.
+   */
+  std::size_t SelectChannel() {
+    auto const ticket = NextTicket();
+    ReadGuard reading(*this);
+    return SelectIndex(*CheckConnections(), ticket);
+  }
+
+  /**
+   * Return the Stub for the channel at @p index, and count the call on it.
+   *
+   * The index is taken modulo the current size of the pool, as the pool may
+   * shrink after the index was selected.
+   */
+  StubPtr Stub(CallGuard& guard, std::size_t index) {
+    ReadGuard reading(*this);
+    auto const& pool = *CheckConnections();
+    index %= pool.size();
+    guard = CallGuard(pool.in_flight[index]);
+    return pool.stubs[index];
   }
 
   /// Return the next Channel to make a call.
   ChannelPtr Channel() {
-    std::unique_lock<std::mutex> lk(mu_);
-    CheckConnections(lk);
-    auto channel = channels_[GetIndex(lk)];
-    return channel;
+    auto const ticket = NextTicket();
+    ReadGuard reading(*this);
+    auto const& pool = *CheckConnections();
+    return pool.channels[SelectIndex(pool, ticket)];
+  }
+
+  /// The number of selections between checks of the pool load.
+  static std::size_t ResizeCheckInterval() { return 16; }
+
+  /**
+   * Connect all the channels in the pool, and wait until they are ready.
+   *
+   * Without this function the channels connect during their first call, and
+   * the TCP, TLS and HTTP/2 handshakes add to the latency of that call.  The
+   * channels connect in parallel, this function returns when all of them are
+   * connected or at @p deadline, whichever happens first.
+   *
+   * @return OK if all the channels are connected, `DEADLINE_EXCEEDED` with a
+   *     message describing how many connected otherwise.
+   */
+  grpc::Status PrimeConnections(
+      std::chrono::system_clock::time_point deadline) {
+    std::vector<ChannelPtr> channels;
+    {
+      // Do not block the release of old pools while waiting.
+      ReadGuard reading(*this);
+      channels = CheckConnections()->channels;
+    }
+    // Start connecting all the channels before waiting for any of them.
+    for (auto const& channel : channels) {
+      (void)channel->GetState(true);
+    }
+    std::size_t connected = 0;
+    for (auto const& channel : channels) {
+      if (channel->WaitForConnected(deadline)) {
+        ++connected;
+      }
+    }
+    if (connected == channels.size()) {
+      return grpc::Status::OK;
+    }
+    return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED,
+                        "only " + std::to_string(connected) + " of " +
+                            std::to_string(channels.size()) +
+                            " channels connected");
+  }
+
+  /**
+   * Return the number of in-flight calls for each channel in the pool.
+   *
+   * The size of the result is the current size of the pool.  The values are
+   * a snapshot, they may be out of date as soon as this function returns.
+   */
+  std::vector<long> ChannelLoad() {
+    ReadGuard reading(*this);
+    auto const& pool = *CheckConnections();
+    std::vector<long> result(pool.size());
+    for (std::size_t i = 0; i != pool.size(); ++i) {
+      result[i] = pool.in_flight[i]->load(std::memory_order_relaxed);
+    }
+    return result;
   }
 
  private:
-  /// Make sure the connections exit, and create them if needed.
-  void CheckConnections(std::unique_lock<std::mutex>& lk) {
-    if (not stubs_.empty()) {
-      return;
+  /**
+   * The channels, and the stubs and counters for each channel.
+   *
+   * A pool does not change after it is published, resizing the pool creates a
+   * new one sharing the channels, stubs and counters that remain in use.
+   */
+  struct Pool {
+    Pool() = default;
+    explicit Pool(std::vector<ChannelPtr> initial) {
+      for (auto& channel : initial) {
+        Add(std::move(channel));
+      }
     }
-    // Release the lock while making remote calls.  gRPC uses the current
+
+    std::size_t size() const { return channels.size(); }
+
+    void Add(ChannelPtr channel) {
+      stubs.push_back(Interface::NewStub(channel));
+      channels.push_back(std::move(channel));
+      in_flight.push_back(std::make_shared<std::atomic<long>>(0));
+    }
+
+    std::vector<ChannelPtr> channels;
+    std::vector<StubPtr> stubs;
+    std::vector<std::shared_ptr<std::atomic<long>>> in_flight;
+  };
+
+  /**
+   * Count a thread that may use the pool it reads from `pool_`.
+   *
+   * The guard increments one of the two `readers_` counters, selected by
+   * `epoch_`, before `pool_` is read and decrements it when the thread no
+   * longer uses the pool.  See `ReclaimRetired()`.
+   */
+  class ReadGuard {
+   public:
+    explicit ReadGuard(CommonClient& client)
+        : counter_(client.CurrentReaders()) {
+      counter_.fetch_add(1);
+    }
+    ~ReadGuard() { counter_.fetch_sub(1); }
+
+    ReadGuard(ReadGuard const&) = delete;
+    ReadGuard& operator=(ReadGuard const&) = delete;
+
+   private:
+    std::atomic<long>& counter_;
+  };
+
+  /// The `readers_` counter used by new readers.
+  std::atomic<long>& CurrentReaders() {
+    return readers_[epoch_.load(std::memory_order_relaxed) % 2];
+  }
+
+  /**
+   * Make sure the connections exit, and create them if needed.
+   *
+   * The caller must hold a `ReadGuard` while it uses the result.
+   */
+  Pool* CheckConnections() {
+    auto pool = pool_.load();
+    if (pool != nullptr) {
+      return pool;
+    }
+    // Do not hold a lock while creating the channels.  gRPC uses the current
     // thread to make remote connections (and probably authenticate), holding
-    // a lock for long operations like that is a bad practice.  Releasing
-    // the lock here can result in wasted work, but that is a smaller problem
-    // than a deadlock or an unbounded priority inversion.
+    // a lock for long operations like that is a bad practice.  If multiple
+    // threads get here at the same time only one pool is published, the others
+    // are discarded.  That is wasted work, but a smaller problem than a
+    // deadlock or an unbounded priority inversion.
     // Note that only one connection per application is created by gRPC, even
     // if multiple threads are calling this function at the same time. gRPC
     // only opens one socket per destination+attributes combo, we artificially
     // introduce attributes in the implementation of CreateChannelPool() to
     // create one socket per element in the pool.
-    lk.unlock();
-    auto channels = CreateChannelPool(Traits::Endpoint(options_), options_);
-    std::vector<StubPtr> tmp;
-    std::transform(channels.begin(), channels.end(), std::back_inserter(tmp),
-                   [](std::shared_ptr<grpc::Channel> ch) {
-                     return Interface::NewStub(ch);
-                   });
-    lk.lock();
-    if (stubs_.empty()) {
-      channels.swap(channels_);
-      tmp.swap(stubs_);
-      current_index_ = 0;
+    std::unique_ptr<Pool> tmp(
+        new Pool(CreateChannelPool(Traits::Endpoint(options_), options_)));
+    if (pool_.compare_exchange_strong(pool, tmp.get())) {
+      return tmp.release();
+    }
+    return pool;
+  }
+
+  /// Return the round-robin position for the next call, check the pool size.
+  std::size_t NextTicket() {
+    // The counter may wrap around, that only causes a small glitch in the
+    // distribution.
+    auto const ticket = next_index_.fetch_add(1, std::memory_order_relaxed);
+    if (ticket % ResizeCheckInterval() == 0) {
+      Maintain();
+    }
+    return ticket;
+  }
+
+  /// Select the channel in @p pool for the call with the given @p ticket.
+  std::size_t SelectIndex(Pool const& pool, std::size_t ticket) {
+    auto const size = pool.size();
+    auto start = ticket % size;
+    if (not options_.load_aware_channel_selection()) {
+      return start;
+    }
+    // Pick the least loaded channel, starting at the round-robin position to
+    // spread the calls across channels with the same load.
+    auto best = start;
+    auto best_load = pool.in_flight[start]->load(std::memory_order_relaxed);
+    for (std::size_t i = 1; i != size and best_load != 0; ++i) {
+      auto candidate = (start + i) % size;
+      auto load = pool.in_flight[candidate]->load(std::memory_order_relaxed);
+      if (load < best_load) {
+        best = candidate;
+        best_load = load;
+      }
+    }
+    return best;
+  }
+
+  /// Resize the pool if needed, and release the pools that are no longer used.
+  void Maintain() {
+    if (options_.max_connection_pool_size() <=
+            options_.connection_pool_size() and
+        not has_retired_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    // Only one thread needs to check the pool, the others keep using the
+    // current one.
+    if (resizing_.exchange(true)) {
+      return;
+    }
+    std::unique_lock<std::mutex> lk(mu_, std::defer_lock);
+    {
+      ReadGuard reading(*this);
+      auto pool = CheckConnections();
+      // Create any new channel before locking `mu_`, CreateChannel() does
+      // not connect, but it is not trivial either.
+      auto resized = Resize(*pool);
+      if (resized or has_retired_.load(std::memory_order_relaxed)) {
+        lk.lock();
+      }
+      // `pool` cannot be released while this thread holds `reading`, so the
+      // comparison is not fooled by a new pool at the same address.
+      if (resized and pool_.compare_exchange_strong(pool, resized.get())) {
+        resized.release();
+        Retire(pool);
+      }
+    }
+    if (lk.owns_lock()) {
+      ReclaimRetired();
+    }
+    resizing_.store(false);
+  }
+
+  /// Return a resized copy of @p pool based on its load, or `nullptr`.
+  std::unique_ptr<Pool> Resize(Pool const& pool) {
+    auto const size = pool.size();
+    auto const min_size = options_.connection_pool_size();
+    auto const max_size = options_.max_connection_pool_size();
+    if (max_size <= min_size) {
+      return std::unique_ptr<Pool>();
+    }
+    auto const threshold = static_cast<long>(options_.max_calls_per_channel());
+    long total = 0;
+    for (auto const& counter : pool.in_flight) {
+      total += counter->load(std::memory_order_relaxed);
+    }
+    auto const count = static_cast<long>(size);
+    auto const last_load =
+        pool.in_flight.back()->load(std::memory_order_relaxed);
+    bool grow = size < max_size and total >= count * threshold;
+    bool shrink = size > min_size and last_load == 0 and
+                  total <= (count - 1) * threshold / 2;
+    if (not grow and not shrink) {
+      return std::unique_ptr<Pool>();
+    }
+    std::unique_ptr<Pool> resized(new Pool);
+    auto const new_size = shrink ? size - 1 : size;
+    for (std::size_t i = 0; i != new_size; ++i) {
+      resized->channels.push_back(pool.channels[i]);
+      resized->stubs.push_back(pool.stubs[i]);
+      resized->in_flight.push_back(pool.in_flight[i]);
     }
+    if (grow) {
+      resized->Add(CreateChannel(Traits::Endpoint(options_), options_,
+                                 static_cast<int>(size)));
+    }
+    return resized;
+  }
+
+  /// Keep @p pool until no thread can use it, the caller must hold `mu_`.
+  void Retire(Pool* pool) {
+    retired_.emplace_back(pool);
+    has_retired_.store(true, std::memory_order_relaxed);
+    // Start a new grace period, new readers use the other counter.
+    seen_idle_[0] = false;
+    seen_idle_[1] = false;
+    epoch_.fetch_add(1);
   }
 
-  /// Get the current index for round-robin over connections.
-  std::size_t GetIndex(std::unique_lock<std::mutex>& lk) {
-    std::size_t current = current_index_++;
-    // Round robin through the connections.
-    if (current_index_ >= stubs_.size()) {
-      current_index_ = 0;
+  /**
+   * Release the retired pools if no thread can be using them.
+   *
+   * A thread increments one of the `readers_` counters before reading `pool_`,
+   * so any thread using a retired pool has incremented its counter before the
+   * pool was retired.  Once each counter has been seen at zero after that, all
+   * those threads are done.  New readers use the counter selected by `epoch_`;
+   * moving them to the other counter lets a busy counter drain.
+   *
+   * The caller must hold `mu_`, and must not hold a `ReadGuard`.
+   */
+  void ReclaimRetired() {
+    if (retired_.empty()) {
+      return;
+    }
+    for (int i = 0; i != 2; ++i) {
+      if (not seen_idle_[i] and readers_[i].load() == 0) {
+        seen_idle_[i] = true;
+      }
+    }
+    if (seen_idle_[0] and seen_idle_[1]) {
+      retired_.clear();
+      has_retired_.store(false, std::memory_order_relaxed);
+      return;
+    }
+    auto const current = epoch_.load() % 2;
+    if (not seen_idle_[current] and seen_idle_[1 - current]) {
+      epoch_.fetch_add(1);
     }
-    return current;
   }
 
  private:
-  std::mutex mu_;
   ClientOptions options_;
-  std::vector<ChannelPtr> channels_;
-  std::vector<StubPtr> stubs_;
-  std::size_t current_index_;
+  /**
+   * The current pool.
+   *
+   * Selecting a channel reads the pool without a lock, and without changing
+   * any reference count on the pool.  Pools discarded by `reset()` or by a
+   * resize are kept in `retired_` until no thread can be reading them.  The
+   * calls hold the stub (and therefore the channel) they use, and each
+   * `CallGuard` holds its counter, so the channels of a discarded pool are
+   * released once those calls complete.
+   */
+  std::atomic<Pool*> pool_;
+  std::atomic<std::size_t> next_index_;
+  /// The number of threads reading `pool_`, see `ReadGuard`.
+  std::atomic<long> readers_[2];
+  /// Selects the `readers_` counter used by new readers.
+  std::atomic<std::size_t> epoch_;
+  /// Set while a thread checks the pool size, see `Maintain()`.
+  std::atomic<bool> resizing_;
+  /// A hint that `retired_` is not empty, to avoid locking `mu_`.
+  std::atomic<bool> has_retired_;
+  /// Serializes the changes to `pool_` and `retired_`.
+  std::mutex mu_;
+  std::vector<std::unique_ptr<Pool>> retired_;
+  /// The `readers_` counters seen at zero since the last pool was retired.
+  bool seen_idle_[2];
 };
 
 }  // namespace internal
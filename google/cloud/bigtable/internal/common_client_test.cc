@@ -0,0 +1,220 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/common_client.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <gtest/gtest.h>
+#include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <set>
+
+namespace bigtable = google::cloud::bigtable;
+namespace btproto = google::bigtable::v2;
+
+namespace {
+struct TestTraits {
+  static std::string const& Endpoint(bigtable::ClientOptions& options) {
+    return options.data_endpoint();
+  }
+};
+
+using TestClient =
+    bigtable::internal::CommonClient<TestTraits, btproto::Bigtable>;
+
+bigtable::ClientOptions TestOptions(std::size_t pool_size) {
+  // The channels connect lazily, the endpoint is never used in these tests.
+  return bigtable::ClientOptions(grpc::InsecureChannelCredentials())
+      .set_data_endpoint("localhost:1")
+      .set_connection_pool_size(pool_size);
+}
+}  // anonymous namespace
+
+/// @test Verify that CommonClient round-robins across the channels.
+TEST(CommonClientTest, RoundRobin) {
+  TestClient client(TestOptions(3));
+  std::vector<TestClient::StubPtr> stubs;
+  for (int i = 0; i != 6; ++i) {
+    stubs.push_back(client.Stub());
+  }
+  std::set<TestClient::StubPtr> unique(stubs.begin(), stubs.end());
+  EXPECT_EQ(3U, unique.size());
+  EXPECT_EQ(stubs[0], stubs[3]);
+  EXPECT_EQ(stubs[1], stubs[4]);
+  EXPECT_EQ(stubs[2], stubs[5]);
+}
+
+/// @test Verify that reset() creates new channels.
+TEST(CommonClientTest, Reset) {
+  TestClient client(TestOptions(1));
+  auto before = client.Channel();
+  EXPECT_EQ(before, client.Channel());
+  client.reset();
+  auto after = client.Channel();
+  EXPECT_NE(before, after);
+  EXPECT_EQ(after, client.Channel());
+}
+
+/// @test Verify that reset() releases the old channels once the calls end.
+TEST(CommonClientTest, ResetReleasesChannels) {
+  TestClient client(TestOptions(1));
+  bigtable::internal::CallGuard guard;
+  (void)client.Stub(guard);
+  auto channel = client.Channel();
+  // The pool and its stub also hold a reference to the channel.
+  auto const in_pool = channel.use_count();
+  EXPECT_LT(1, in_pool);
+
+  // The in-flight call keeps the old pool alive.
+  client.reset();
+  EXPECT_EQ(in_pool, channel.use_count());
+  EXPECT_NE(channel, client.Channel());
+
+  guard = bigtable::internal::CallGuard();
+  EXPECT_EQ(1, channel.use_count());
+}
+
+/// @test Verify that load-aware selection avoids busy channels.
+TEST(CommonClientTest, LoadAware) {
+  TestClient client(TestOptions(3).set_load_aware_channel_selection(true));
+  std::vector<bigtable::internal::CallGuard> guards(3);
+  std::vector<TestClient::StubPtr> busy;
+  for (auto& g : guards) {
+    busy.push_back(client.Stub(g));
+  }
+  // Each call went to a different channel.
+  EXPECT_EQ(3U, std::set<TestClient::StubPtr>(busy.begin(), busy.end()).size());
+
+  // Complete one of the calls, all new calls should use its channel.
+  guards[1] = bigtable::internal::CallGuard();
+  for (int i = 0; i != 4; ++i) {
+    bigtable::internal::CallGuard g;
+    EXPECT_EQ(busy[1], client.Stub(g));
+  }
+}
+
+/// @test Verify that a call can be sent on a selected channel.
+TEST(CommonClientTest, SelectedChannel) {
+  TestClient client(TestOptions(3));
+  auto const primary = client.SelectChannel();
+  auto const other = (primary + 1) % 3;
+  bigtable::internal::CallGuard g1;
+  bigtable::internal::CallGuard g2;
+  auto s1 = client.Stub(g1, primary);
+  auto s2 = client.Stub(g2, other);
+  EXPECT_NE(s1, s2);
+  auto load = client.ChannelLoad();
+  ASSERT_EQ(3U, load.size());
+  EXPECT_EQ(1, load[primary]);
+  EXPECT_EQ(1, load[other]);
+
+  // The index wraps around the size of the pool.
+  bigtable::internal::CallGuard g3;
+  EXPECT_EQ(s2, client.Stub(g3, other + 3));
+  EXPECT_EQ(2, client.ChannelLoad()[other]);
+}
+
+/// @test Verify that the pool grows with the load, and shrinks when idle.
+TEST(CommonClientTest, DynamicPoolSize) {
+  TestClient client(TestOptions(1)
+                        .set_max_connection_pool_size(3)
+                        .set_max_calls_per_channel(2));
+  EXPECT_EQ(1U, client.ChannelLoad().size());
+
+  // The load is checked on the first selection, and then once per interval.
+  auto const interval = TestClient::ResizeCheckInterval();
+  std::vector<bigtable::internal::CallGuard> guards(2 * interval + 1);
+  std::set<TestClient::StubPtr> stubs;
+  for (auto& g : guards) {
+    stubs.insert(client.Stub(g));
+  }
+  // The pool grows when the calls per channel reach the threshold, and it
+  // stops growing at the maximum size.
+  auto load = client.ChannelLoad();
+  ASSERT_EQ(3U, load.size());
+  EXPECT_EQ(3U, stubs.size());
+  EXPECT_EQ(static_cast<long>(guards.size()),
+            std::accumulate(load.begin(), load.end(), 0L));
+
+  // Once the calls complete the pool shrinks, one channel at a time.
+  using WeakStub = std::weak_ptr<TestClient::StubPtr::element_type>;
+  std::vector<WeakStub> released(stubs.begin(), stubs.end());
+  stubs.clear();
+  guards.clear();
+  auto make_calls = [&client, interval] {
+    for (std::size_t i = 0; i != interval; ++i) {
+      (void)client.Stub();
+    }
+  };
+  make_calls();
+  EXPECT_EQ(2U, client.ChannelLoad().size());
+  make_calls();
+  EXPECT_EQ(1U, client.ChannelLoad().size());
+  make_calls();
+  EXPECT_EQ(1U, client.ChannelLoad().size());
+
+  // The channels removed from the pool are released.
+  EXPECT_EQ(2, std::count_if(released.begin(), released.end(),
+                             [](WeakStub const& w) { return w.expired(); }));
+}
+
+/// @test Verify that CallGuard counts the calls while it is alive.
+TEST(CommonClientTest, CallGuard) {
+  std::atomic<long> counter(0);
+  {
+    bigtable::internal::CallGuard g1(&counter);
+    EXPECT_EQ(1, counter.load());
+    bigtable::internal::CallGuard g2(std::move(g1));
+    EXPECT_EQ(1, counter.load());
+    bigtable::internal::CallGuard g3(&counter);
+    EXPECT_EQ(2, counter.load());
+    g3 = std::move(g2);
+    EXPECT_EQ(1, counter.load());
+  }
+  EXPECT_EQ(0, counter.load());
+}
+
+/// @test Verify that PrimeConnections() reports channels that cannot connect.
+TEST(CommonClientTest, PrimeConnectionsTimeout) {
+  TestClient client(TestOptions(2));
+  auto status = client.PrimeConnections(std::chrono::system_clock::now() +
+                                        std::chrono::milliseconds(50));
+  EXPECT_FALSE(status.ok());
+  EXPECT_EQ(grpc::StatusCode::DEADLINE_EXCEEDED, status.error_code());
+}
+
+/// @test Verify that PrimeConnections() connects all the channels.
+TEST(CommonClientTest, PrimeConnections) {
+  // All the RPCs are unimplemented, the test only needs the connections.
+  btproto::Bigtable::Service service;
+  int port = 0;
+  grpc::ServerBuilder builder;
+  builder.RegisterService(&service);
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  auto server = builder.BuildAndStart();
+  ASSERT_TRUE(server);
+  ASSERT_NE(0, port);
+
+  TestClient client(
+      TestOptions(3).set_data_endpoint("localhost:" + std::to_string(port)));
+  auto status = client.PrimeConnections(std::chrono::system_clock::now() +
+                                        std::chrono::seconds(10));
+  EXPECT_TRUE(status.ok()) << status.error_message();
+  auto channel = client.Channel();
+  EXPECT_EQ(GRPC_CHANNEL_READY, channel->GetState(false));
+
+  server->Shutdown();
+}
@@ -0,0 +1,114 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/completion_queue_impl.h"
+#include "google/cloud/bigtable/completion_queue.h"
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+
+CompletionQueueImpl::~CompletionQueueImpl() {
+  Shutdown();
+  // Cancel any pending operations, otherwise the loop below would block until
+  // all the timers expire and all the RPCs complete.
+  std::unordered_map<std::intptr_t, std::shared_ptr<AsyncGrpcOperation>> ops;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    ops.swap(pending_ops_);
+  }
+  for (auto& kv : ops) {
+    kv.second->Cancel();
+  }
+  // gRPC requires draining the queue before it is destroyed, the operations
+  // must remain alive until then, as gRPC may still write into them.
+  void* tag;
+  bool ok;
+  while (cq_.Next(&tag, &ok)) {
+  }
+}
+
+void CompletionQueueImpl::Run(CompletionQueue& cq) {
+  void* tag;
+  bool ok;
+  while (cq_.Next(&tag, &ok)) {
+    auto op = FindOperation(tag);
+    if (not op) {
+      // The operation was already discarded, this happens with cancelled
+      // timers in the unit tests and during shutdown.
+      continue;
+    }
+    if (op->Notify(cq, ok)) {
+      ForgetOperation(tag);
+    }
+  }
+}
+
+void CompletionQueueImpl::Shutdown() {
+  if (shutdown_.exchange(true)) {
+    return;
+  }
+  cq_.Shutdown();
+}
+
+void* CompletionQueueImpl::RegisterOperation(
+    std::shared_ptr<AsyncGrpcOperation> op) {
+  void* tag = op.get();
+  std::lock_guard<std::mutex> lk(mu_);
+  pending_ops_.emplace(reinterpret_cast<std::intptr_t>(tag), std::move(op));
+  return tag;
+}
+
+void CompletionQueueImpl::SimulateCompletion(CompletionQueue& cq, bool ok) {
+  std::vector<std::pair<std::intptr_t, std::shared_ptr<AsyncGrpcOperation>>>
+      ops;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    ops.assign(pending_ops_.begin(), pending_ops_.end());
+  }
+  for (auto& kv : ops) {
+    if (kv.second->Notify(cq, ok)) {
+      ForgetOperation(reinterpret_cast<void*>(kv.first));
+    }
+  }
+}
+
+std::size_t CompletionQueueImpl::size() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return pending_ops_.size();
+}
+
+std::shared_ptr<AsyncGrpcOperation> CompletionQueueImpl::FindOperation(
+    void* tag) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto loc = pending_ops_.find(reinterpret_cast<std::intptr_t>(tag));
+  if (pending_ops_.end() == loc) {
+    return nullptr;
+  }
+  return loc->second;
+}
+
+void CompletionQueueImpl::ForgetOperation(void* tag) {
+  std::lock_guard<std::mutex> lk(mu_);
+  pending_ops_.erase(reinterpret_cast<std::intptr_t>(tag));
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,279 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_COMPLETION_QUEUE_IMPL_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_COMPLETION_QUEUE_IMPL_H_
+
+#include "google/cloud/bigtable/async_operation.h"
+#include "google/cloud/bigtable/version.h"
+#include <grpcpp/alarm.h>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/impl/codegen/async_stream.h>
+#include <grpcpp/impl/codegen/async_unary_call.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+class CompletionQueue;
+namespace internal {
+/**
+ * The interface between `CompletionQueueImpl` and the pending operations.
+ *
+ * Each operation registered with a `CompletionQueueImpl` receives a
+ * notification when the underlying gRPC operation completes.
+ */
+class AsyncGrpcOperation : public AsyncOperation {
+ public:
+  /**
+   * Notifies the operation that the underlying gRPC operation has completed.
+   *
+   * @param cq the completion queue sending the notification, this is useful in
+   *     case the callback needs to start more asynchronous operations.
+   * @param ok the value of the `ok` flag returned by the
+   *     `grpc::CompletionQueue`.
+   * @return true if the operation is finished and should be discarded, false
+   *     if the operation has started another gRPC operation using the same tag.
+   */
+  virtual bool Notify(CompletionQueue& cq, bool ok) = 0;
+};
+
+/**
+ * The implementation details for `CompletionQueue`.
+ *
+ * `CompletionQueue` is implemented using the PImpl idiom, this is the
+ * implementation class.  It is also a dependency injection point: the unit
+ * tests replace it with a version that can simulate completions without
+ * running a real `grpc::CompletionQueue` loop.
+ */
+class CompletionQueueImpl {
+ public:
+  CompletionQueueImpl() : cq_(), shutdown_(false) {}
+  virtual ~CompletionQueueImpl();
+
+  /**
+   * Run the event loop until `Shutdown()` is called.
+   *
+   * @param cq the wrapping completion queue, passed to any callbacks.
+   */
+  void Run(CompletionQueue& cq);
+
+  /// Terminate the event loop.
+  void Shutdown();
+
+  /// The underlying gRPC completion queue.
+  grpc::CompletionQueue& cq() { return cq_; }
+
+  /**
+   * Register @p op as a pending operation.
+   *
+   * @return the tag that must be used in the gRPC calls associated with @p op.
+   */
+  void* RegisterOperation(std::shared_ptr<AsyncGrpcOperation> op);
+
+ protected:
+  /**
+   * Simulate the completion of all the pending operations.
+   *
+   * Only used in the unit tests, where no real gRPC events are generated. Any
+   * operation that is not finished after the notification remains registered.
+   */
+  void SimulateCompletion(CompletionQueue& cq, bool ok);
+
+  /// The number of pending operations, only used in the unit tests.
+  std::size_t size() const;
+
+  /// Return true if there are no pending operations.
+  bool empty() const { return size() == 0; }
+
+ private:
+  /// Return the operation associated with @p tag, if any.
+  std::shared_ptr<AsyncGrpcOperation> FindOperation(void* tag);
+
+  /// Remove @p tag from the pending operations.
+  void ForgetOperation(void* tag);
+
+  grpc::CompletionQueue cq_;
+  std::atomic<bool> shutdown_;
+  mutable std::mutex mu_;
+  std::unordered_map<std::intptr_t, std::shared_ptr<AsyncGrpcOperation>>
+      pending_ops_;
+};
+
+/**
+ * Wrap a timer and its callback in an `AsyncGrpcOperation`.
+ *
+ * @tparam Functor the callback type, it must be invocable as
+ *     `void(CompletionQueue&, AsyncTimerResult&)`.
+ */
+template <typename Functor>
+class AsyncTimerFunctor : public AsyncGrpcOperation {
+ public:
+  explicit AsyncTimerFunctor(Functor functor) : functor_(std::move(functor)) {}
+
+  void Set(grpc::CompletionQueue& cq,
+           std::chrono::system_clock::time_point deadline, void* tag) {
+    result_.deadline = deadline;
+    result_.cancelled = false;
+    alarm_.Set(&cq, deadline, tag);
+  }
+
+  void Cancel() override { alarm_.Cancel(); }
+
+  bool Notify(CompletionQueue& cq, bool ok) override {
+    result_.cancelled = not ok;
+    functor_(cq, result_);
+    return true;
+  }
+
+ private:
+  Functor functor_;
+  AsyncTimerResult result_;
+  grpc::Alarm alarm_;
+};
+
+/**
+ * Wrap a unary RPC and its callback in an `AsyncGrpcOperation`.
+ *
+ * @tparam Response the response type for the RPC.
+ * @tparam Functor the callback type, it must be invocable as
+ *     `void(CompletionQueue&, Response&, grpc::Status&)`.
+ */
+template <typename Response, typename Functor>
+class AsyncUnaryRpcFunctor : public AsyncGrpcOperation {
+ public:
+  AsyncUnaryRpcFunctor(std::unique_ptr<grpc::ClientContext> context,
+                       Functor functor)
+      : context_(std::move(context)), functor_(std::move(functor)) {}
+
+  /// Start the RPC, the @p reader must already be associated with a call.
+  void Set(std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<Response>>
+               reader,
+           void* tag) {
+    reader_ = std::move(reader);
+    reader_->Finish(&response_, &status_, tag);
+  }
+
+  grpc::ClientContext* context() { return context_.get(); }
+
+  void Cancel() override { context_->TryCancel(); }
+
+  bool Notify(CompletionQueue& cq, bool ok) override {
+    if (not ok) {
+      // This would mean a bug in gRPC, the documentation states that Finish()
+      // always returns `true`.
+      status_ = grpc::Status(grpc::StatusCode::UNKNOWN,
+                             "Finish() returned false in Notify()");
+    }
+    functor_(cq, response_, status_);
+    return true;
+  }
+
+ private:
+  std::unique_ptr<grpc::ClientContext> context_;
+  Functor functor_;
+  grpc::Status status_;
+  Response response_;
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<Response>> reader_;
+};
+
+/**
+ * Wrap a streaming read RPC and its callbacks in an `AsyncGrpcOperation`.
+ *
+ * The RPC goes through three states: waiting for the call to start, reading
+ * responses, and waiting for the final status.  Only one gRPC operation is
+ * pending at a time, so the same tag is reused in all the states.
+ *
+ * @tparam Response the response type for the RPC.
+ * @tparam ReadFunctor the callback for each response, it must be invocable as
+ *     `void(CompletionQueue&, Response&)`.
+ * @tparam FinishFunctor the callback for the final status, it must be
+ *     invocable as `void(CompletionQueue&, grpc::Status&)`.
+ */
+template <typename Response, typename ReadFunctor, typename FinishFunctor>
+class AsyncReadStreamFunctor : public AsyncGrpcOperation {
+ public:
+  AsyncReadStreamFunctor(std::unique_ptr<grpc::ClientContext> context,
+                         ReadFunctor on_read, FinishFunctor on_finish)
+      : context_(std::move(context)),
+        on_read_(std::move(on_read)),
+        on_finish_(std::move(on_finish)),
+        state_(State::kStarting) {}
+
+  /// Start the RPC, the @p reader must be created with `PrepareAsync*()`.
+  void Set(std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> reader,
+           void* tag) {
+    tag_ = tag;
+    reader_ = std::move(reader);
+    reader_->StartCall(tag_);
+  }
+
+  grpc::ClientContext* context() { return context_.get(); }
+
+  void Cancel() override { context_->TryCancel(); }
+
+  bool Notify(CompletionQueue& cq, bool ok) override {
+    switch (state_) {
+      case State::kStarting:
+        if (not ok) {
+          return Finish();
+        }
+        state_ = State::kReading;
+        reader_->Read(&response_, tag_);
+        return false;
+      case State::kReading:
+        if (not ok) {
+          return Finish();
+        }
+        on_read_(cq, response_);
+        response_ = {};
+        reader_->Read(&response_, tag_);
+        return false;
+      case State::kFinishing:
+        on_finish_(cq, status_);
+        return true;
+    }
+    return true;
+  }
+
+ private:
+  bool Finish() {
+    state_ = State::kFinishing;
+    reader_->Finish(&status_, tag_);
+    return false;
+  }
+
+  enum class State { kStarting, kReading, kFinishing };
+
+  std::unique_ptr<grpc::ClientContext> context_;
+  ReadFunctor on_read_;
+  FinishFunctor on_finish_;
+  State state_;
+  void* tag_;
+  Response response_;
+  grpc::Status status_;
+  std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> reader_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_COMPLETION_QUEUE_IMPL_H_
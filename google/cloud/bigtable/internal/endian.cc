@@ -24,6 +24,9 @@
 #elif defined(__GNUC__) || defined(__clang__)
 #include <byteswap.h>
 #endif
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
 
 namespace google {
 namespace cloud {
@@ -102,8 +105,45 @@ std::string AsBigEndian64(bigtable::bigendian64_t value) {
   return bigtable::internal::Encoder<bigtable::bigendian64_t>::Encode(value);
 }
 
-}  // namespace internal
+void ByteSwap64Array(char const* source, std::size_t count,
+                     char* destination) {
+  constexpr std::size_t kSize = sizeof(std::int64_t);
+  if (IsBigEndian()) {
+    std::memmove(destination, source, count * kSize);
+    return;
+  }
+  std::size_t i = 0;
+#if defined(__AVX2__)
+  // Reverse the bytes in each 64-bit lane, 4 values at a time.
+  __m256i const avx2_mask = _mm256_setr_epi8(
+      7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1,
+      0, 15, 14, 13, 12, 11, 10, 9, 8);
+  for (; i + 4 <= count; i += 4) {
+    auto v = _mm256_loadu_si256(
+        reinterpret_cast<__m256i const*>(source + i * kSize));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * kSize),
+                        _mm256_shuffle_epi8(v, avx2_mask));
+  }
+#endif  // __AVX2__
+#if defined(__SSSE3__)
+  __m128i const sse_mask =
+      _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  for (; i + 2 <= count; i += 2) {
+    auto v =
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i * kSize));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * kSize),
+                     _mm_shuffle_epi8(v, sse_mask));
+  }
+#endif  // __SSSE3__
+  for (; i != count; ++i) {
+    bigtable::bigendian64_t value(0);
+    std::memcpy(&value, source + i * kSize, kSize);
+    value = ByteSwap64(value);
+    std::memcpy(destination + i * kSize, &value, kSize);
+  }
+}
 
+}  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
 }  // namespace cloud
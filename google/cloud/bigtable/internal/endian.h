@@ -17,6 +17,7 @@
 
 #include "google/cloud/bigtable/internal/encoder.h"
 #include "google/cloud/bigtable/internal/strong_type.h"
+#include <cstddef>
 
 namespace google {
 namespace cloud {
@@ -35,6 +36,18 @@ struct Encoder<bigtable::bigendian64_t> {
 bigtable::bigendian64_t ByteSwap64(bigtable::bigendian64_t value);
 std::string AsBigEndian64(bigtable::bigendian64_t value);
 
+/**
+ * Convert @p count 64-bit integers between big-endian and native byte order.
+ *
+ * Reads `8 * count` bytes from @p source and writes them to @p destination,
+ * reversing the bytes in each 8-byte group on little-endian platforms.  The
+ * conversion is symmetric, the same function encodes and decodes.  It uses
+ * AVX2 or SSSE3 byte shuffles when the library is compiled with support for
+ * them, and `ByteSwap64()` otherwise.  The buffers may be the same, but must
+ * not otherwise overlap.
+ */
+void ByteSwap64Array(char const* source, std::size_t count, char* destination);
+
 }  // namespace internal
 
 }  // namespace BIGTABLE_CLIENT_NS
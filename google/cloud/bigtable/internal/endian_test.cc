@@ -0,0 +1,53 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/endian.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace bigtable = google::cloud::bigtable;
+
+namespace {
+/// Make values where every byte is different, so any misplaced byte shows.
+std::vector<std::int64_t> MakeValues(std::size_t count) {
+  std::vector<std::int64_t> values;
+  for (std::size_t i = 0; i != count; ++i) {
+    std::uint64_t v = 0;
+    for (std::uint64_t b = 0; b != 8; ++b) {
+      v = (v << 8U) | ((i * 8 + b + 1) & 0xFFU);
+    }
+    values.push_back(static_cast<std::int64_t>(v));
+  }
+  return values;
+}
+}  // anonymous namespace
+
+/// @test Verify that ByteSwap64Array() matches ByteSwap64() for all sizes.
+TEST(EndianTest, ByteSwap64Array) {
+  // Cover the SIMD blocks and the scalar tail.
+  for (std::size_t count = 0; count != 11; ++count) {
+    auto values = MakeValues(count);
+    std::vector<std::int64_t> swapped(count);
+    bigtable::internal::ByteSwap64Array(
+        reinterpret_cast<char const*>(values.data()), count,
+        reinterpret_cast<char*>(swapped.data()));
+    for (std::size_t i = 0; i != count; ++i) {
+      EXPECT_EQ(bigtable::internal::AsBigEndian64(
+                    bigtable::bigendian64_t(values[i])),
+                std::string(reinterpret_cast<char const*>(&swapped[i]),
+                            sizeof(std::int64_t)))
+          << "count=" << count << ", i=" << i;
+    }
+  }
+}
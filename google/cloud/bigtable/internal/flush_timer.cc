@@ -0,0 +1,79 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/flush_timer.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+FlushTimer::FlushTimer(CompletionQueue cq, ExpiredCallback on_expired)
+    : cq_(std::move(cq)),
+      on_expired_(std::move(on_expired)),
+      pending_(false),
+      running_(false),
+      shutdown_(false),
+      generation_(0) {}
+
+void FlushTimer::StartIfNeeded(std::chrono::system_clock::time_point deadline,
+                               std::uint64_t generation) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (pending_ or shutdown_) {
+    return;
+  }
+  pending_ = true;
+  generation_ = generation;
+  // Hold the lock while the timer starts, so a (very fast) expiration in a
+  // different thread cannot reset `timer_` before it is set.
+  timer_ = cq_.MakeDeadlineTimer(
+      deadline,
+      [this](CompletionQueue&, AsyncTimerResult& timer) { OnTimer(timer); });
+}
+
+void FlushTimer::Shutdown() {
+  std::unique_lock<std::mutex> lk(mu_);
+  shutdown_ = true;
+  if (pending_) {
+    auto timer = timer_;
+    lk.unlock();
+    timer->Cancel();
+    lk.lock();
+  }
+  cv_.wait(lk, [this] { return not pending_ and not running_; });
+}
+
+void FlushTimer::OnTimer(AsyncTimerResult& timer) {
+  std::unique_lock<std::mutex> lk(mu_);
+  pending_ = false;
+  timer_.reset();
+  if (not timer.cancelled) {
+    running_ = true;
+    auto generation = generation_;
+    lk.unlock();
+    // The callback may restart the timer, do not hold the lock.
+    on_expired_(generation);
+    lk.lock();
+    running_ = false;
+  }
+  // Notify while holding the lock, `Shutdown()` may be waiting for this
+  // callback and `this` must not be used after the lock is released.
+  cv_.notify_all();
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
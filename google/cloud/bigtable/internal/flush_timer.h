@@ -0,0 +1,88 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_FLUSH_TIMER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_FLUSH_TIMER_H_
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * The deadline timer used by `MutationBatcher` and `IncrementAggregator`.
+ *
+ * Both classes accumulate requests and send them when a deadline expires.  At
+ * most one timer is pending, it is started for a *generation* of accumulated
+ * requests (a batch id, for example), and the owner receives that generation
+ * when the timer expires.  If the owner has sent that generation already it
+ * restarts the timer for the current one.
+ *
+ * The timer callback uses the owner, so the owner must call `Shutdown()` in
+ * its destructor, before any of the state used by the callback is destroyed.
+ */
+class FlushTimer {
+ public:
+  /// Called when the timer expires (but not if it is cancelled).
+  using ExpiredCallback = std::function<void(std::uint64_t generation)>;
+
+  FlushTimer(CompletionQueue cq, ExpiredCallback on_expired);
+
+  FlushTimer(FlushTimer const&) = delete;
+  FlushTimer& operator=(FlushTimer const&) = delete;
+
+  /**
+   * Start a timer for @p generation, unless a timer is already pending.
+   *
+   * The owner may call this function while holding its own mutex, and from
+   * the `ExpiredCallback`.  It does nothing after `Shutdown()`.
+   */
+  void StartIfNeeded(std::chrono::system_clock::time_point deadline,
+                     std::uint64_t generation);
+
+  /// Cancel the pending timer (if any) and wait until its callback returns.
+  void Shutdown();
+
+ private:
+  void OnTimer(AsyncTimerResult& timer);
+
+  CompletionQueue cq_;
+  ExpiredCallback on_expired_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::shared_ptr<AsyncOperation> timer_;
+  /// A timer was started and has not expired (or been cancelled) yet.
+  bool pending_;
+  /// The timer expired and `on_expired_` is running.
+  bool running_;
+  bool shutdown_;
+  std::uint64_t generation_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_FLUSH_TIMER_H_
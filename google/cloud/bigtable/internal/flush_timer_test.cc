@@ -0,0 +1,111 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/flush_timer.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include <gmock/gmock.h>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::internal::FlushTimer;
+using namespace ::testing;
+
+namespace {
+class FlushTimerTest : public ::testing::Test {
+ protected:
+  FlushTimerTest()
+      : cq_impl_(std::make_shared<bigtable::testing::MockCompletionQueue>()),
+        cq_(cq_impl_) {}
+
+  std::shared_ptr<bigtable::testing::MockCompletionQueue> cq_impl_;
+  bigtable::CompletionQueue cq_;
+};
+}  // anonymous namespace
+
+/// @test Verify that FlushTimer reports the generation when it expires.
+TEST_F(FlushTimerTest, Expires) {
+  std::vector<std::uint64_t> expired;
+  FlushTimer timer(cq_, [&expired](std::uint64_t g) { expired.push_back(g); });
+  timer.StartIfNeeded(std::chrono::system_clock::now(), 7);
+  EXPECT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_THAT(expired, ElementsAre(7U));
+  EXPECT_TRUE(cq_impl_->empty());
+  timer.Shutdown();
+}
+
+/// @test Verify that FlushTimer keeps at most one timer pending.
+TEST_F(FlushTimerTest, AtMostOnePending) {
+  std::vector<std::uint64_t> expired;
+  FlushTimer timer(cq_, [&expired](std::uint64_t g) { expired.push_back(g); });
+  timer.StartIfNeeded(std::chrono::system_clock::now(), 1);
+  timer.StartIfNeeded(std::chrono::system_clock::now(), 2);
+  EXPECT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_THAT(expired, ElementsAre(1U));
+  EXPECT_TRUE(cq_impl_->empty());
+  timer.Shutdown();
+}
+
+/// @test Verify that the callback can restart the timer.
+TEST_F(FlushTimerTest, RestartFromCallback) {
+  std::vector<std::uint64_t> expired;
+  std::unique_ptr<FlushTimer> timer;
+  timer.reset(new FlushTimer(cq_, [&expired, &timer](std::uint64_t g) {
+    expired.push_back(g);
+    if (g == 1) {
+      timer->StartIfNeeded(std::chrono::system_clock::now(), 2);
+    }
+  }));
+  timer->StartIfNeeded(std::chrono::system_clock::now(), 1);
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_THAT(expired, ElementsAre(1U, 2U));
+  EXPECT_TRUE(cq_impl_->empty());
+  timer->Shutdown();
+}
+
+/// @test Verify that the timer does not start after Shutdown().
+TEST_F(FlushTimerTest, NoTimerAfterShutdown) {
+  int count = 0;
+  FlushTimer timer(cq_, [&count](std::uint64_t) { ++count; });
+  timer.Shutdown();
+  timer.StartIfNeeded(std::chrono::system_clock::now(), 1);
+  EXPECT_TRUE(cq_impl_->empty());
+  EXPECT_EQ(0, count);
+}
+
+/// @test Verify that Shutdown() waits until the cancelled timer completes.
+TEST_F(FlushTimerTest, ShutdownWaitsForTimer) {
+  int count = 0;
+  FlushTimer timer(cq_, [&count](std::uint64_t) { ++count; });
+  timer.StartIfNeeded(std::chrono::system_clock::now() + std::chrono::hours(1),
+                      1);
+  std::promise<void> done;
+  std::thread t([&timer, &done] {
+    timer.Shutdown();
+    done.set_value();
+  });
+  auto f = done.get_future();
+  EXPECT_EQ(std::future_status::timeout,
+            f.wait_for(std::chrono::milliseconds(10)));
+  // Deliver the cancelled timer.
+  cq_impl_->SimulateCompletion(cq_, false);
+  t.join();
+  EXPECT_EQ(0, count);
+  EXPECT_TRUE(cq_impl_->empty());
+}
@@ -0,0 +1,122 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/hedged_read_row.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+HedgedReadRow::HedgedReadRow(std::shared_ptr<HedgingPolicy> policy,
+                             AttemptFactory start_attempt,
+                             DoneCallback on_done)
+    : policy_(std::move(policy)),
+      start_attempt_(std::move(start_attempt)),
+      on_done_(std::move(on_done)),
+      outstanding_(0),
+      running_(0),
+      done_(false),
+      result_(false, Row("", {})) {}
+
+void HedgedReadRow::Start(CompletionQueue& cq) {
+  start_ = std::chrono::steady_clock::now();
+  outstanding_ = 2;
+  running_ = 1;
+  attempts_[0] = start_attempt_(cq, MakeCallback(0), 0);
+  timer_ = cq.MakeRelativeTimer(
+      policy_->hedge_delay(),
+      [this](CompletionQueue& cq, AsyncTimerResult& timer) {
+        OnTimer(cq, timer);
+      });
+}
+
+void HedgedReadRow::OnAttempt(CompletionQueue& cq, int attempt,
+                              std::pair<bool, Row> result,
+                              grpc::Status& status) {
+  --running_;
+  if (not done_) {
+    if (status.ok()) {
+      // The first successful attempt wins, cancel everything else.
+      done_ = true;
+      result_ = std::move(result);
+      status_ = status;
+      if (running_ != 0) {
+        attempts_[1 - attempt]->Cancel();
+      }
+      timer_->Cancel();
+      if (attempt == 1) {
+        policy_->OnHedgeWon();
+      }
+      policy_->OnCompletion(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start_));
+    } else {
+      // Keep waiting if the other attempt is still running, otherwise the
+      // last error is the result.
+      status_ = status;
+      if (running_ == 0) {
+        done_ = true;
+        timer_->Cancel();
+      }
+    }
+  }
+  Release(cq);
+}
+
+void HedgedReadRow::OnTimer(CompletionQueue& cq, AsyncTimerResult& timer) {
+  if (not timer.cancelled and not done_) {
+    ++outstanding_;
+    ++running_;
+    policy_->OnHedgeSent();
+    attempts_[1] = start_attempt_(cq, MakeCallback(1), 1);
+  }
+  Release(cq);
+}
+
+HedgedReadRow::AttemptCallback HedgedReadRow::MakeCallback(int attempt) {
+  return [this, attempt](CompletionQueue& cq, std::pair<bool, Row> result,
+                         grpc::Status& status) {
+    OnAttempt(cq, attempt, std::move(result), status);
+  };
+}
+
+void HedgedReadRow::Release(CompletionQueue& cq) {
+  if (--outstanding_ == 0) {
+    on_done_(cq);
+  }
+}
+
+std::size_t HedgeChannel(std::size_t primary, std::vector<long> const& load) {
+  auto const size = load.size();
+  if (size < 2) {
+    return primary;
+  }
+  // The pool may have shrunk since the first attempt selected its channel.
+  primary %= size;
+  auto best = (primary + 1) % size;
+  for (std::size_t i = 2; i != size; ++i) {
+    auto candidate = (primary + i) % size;
+    if (load[candidate] < load[best]) {
+      best = candidate;
+    }
+  }
+  return best;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,115 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_HEDGED_READ_ROW_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_HEDGED_READ_ROW_H_
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/hedging_policy.h"
+#include "google/cloud/bigtable/row.h"
+#include <grpcpp/grpcpp.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Implement the hedged version of `Table::ReadRow()`.
+ *
+ * The first attempt starts right away, the second attempt starts when the
+ * delay from the `HedgingPolicy` expires, unless the first attempt has
+ * completed by then.  The first successful attempt wins, and the other
+ * attempt is cancelled.  If an attempt fails (i.e., it exhausted its retry
+ * policy) the result is that of the other attempt.
+ *
+ * This class is not thread-safe, all the callbacks must run in the same
+ * thread.  `Table::ReadRow()` runs them in a private completion queue, in the
+ * calling thread.
+ */
+class HedgedReadRow {
+ public:
+  using AttemptCallback = std::function<void(
+      CompletionQueue&, std::pair<bool, Row>, grpc::Status&)>;
+  using AttemptFactory = std::function<std::shared_ptr<AsyncOperation>(
+      CompletionQueue&, AttemptCallback, int)>;
+  using DoneCallback = std::function<void(CompletionQueue&)>;
+
+  /**
+   * Create the operation.
+   *
+   * @param policy controls the delay and receives the counters and latencies.
+   * @param start_attempt starts one attempt of the read in the given queue,
+   *     the last argument is 0 for the first attempt and 1 for the hedge.
+   * @param on_done called once all the attempts and the timer completed, the
+   *     result is available at that point.
+   */
+  HedgedReadRow(std::shared_ptr<HedgingPolicy> policy,
+                AttemptFactory start_attempt, DoneCallback on_done);
+
+  /// Start the first attempt and the hedging timer.
+  void Start(CompletionQueue& cq);
+
+  grpc::Status const& status() const { return status_; }
+  std::pair<bool, Row>& result() { return result_; }
+
+ private:
+  void OnAttempt(CompletionQueue& cq, int attempt, std::pair<bool, Row> result,
+                 grpc::Status& status);
+  void OnTimer(CompletionQueue& cq, AsyncTimerResult& timer);
+  AttemptCallback MakeCallback(int attempt);
+  void Release(CompletionQueue& cq);
+
+  std::shared_ptr<HedgingPolicy> policy_;
+  AttemptFactory start_attempt_;
+  DoneCallback on_done_;
+  std::chrono::steady_clock::time_point start_;
+
+  /// The number of attempts and timers that have not called back yet.
+  int outstanding_;
+  /// The number of attempts that have not called back yet.
+  int running_;
+  bool done_;
+  std::shared_ptr<AsyncOperation> attempts_[2];
+  std::shared_ptr<AsyncOperation> timer_;
+
+  std::pair<bool, Row> result_;
+  grpc::Status status_;
+};
+
+/**
+ * Select the channel for the hedge, given the channel of the first attempt.
+ *
+ * Returns the least loaded channel other than @p primary, ties go to the
+ * first channel after @p primary.  If the pool has a single channel (or the
+ * client does not report its load) there is no other choice and the result
+ * is @p primary.
+ *
+ * @param primary the channel used by the first attempt.
+ * @param load the in-flight calls on each channel, see
+ *     `DataClient::ChannelLoad()`.
+ */
+std::size_t HedgeChannel(std::size_t primary, std::vector<long> const& load);
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_HEDGED_READ_ROW_H_
@@ -0,0 +1,179 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/hedged_read_row.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include <gtest/gtest.h>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::internal::HedgedReadRow;
+
+namespace {
+class FakeAttempt : public bigtable::AsyncOperation {
+ public:
+  FakeAttempt() : cancelled(false) {}
+  void Cancel() override { cancelled = true; }
+  bool cancelled;
+};
+
+class HedgedReadRowTest : public ::testing::Test {
+ protected:
+  HedgedReadRowTest()
+      : cq_impl_(std::make_shared<bigtable::testing::MockCompletionQueue>()),
+        cq_(cq_impl_),
+        policy_(std::make_shared<bigtable::FixedDelayHedgingPolicy>(
+            std::chrono::milliseconds(10))),
+        done_(false),
+        op_(policy_,
+            [this](bigtable::CompletionQueue&,
+                   HedgedReadRow::AttemptCallback callback, int attempt) {
+              EXPECT_EQ(callbacks_.size(), static_cast<std::size_t>(attempt));
+              callbacks_.push_back(std::move(callback));
+              attempts_.push_back(std::make_shared<FakeAttempt>());
+              return attempts_.back();
+            },
+            [this](bigtable::CompletionQueue&) { done_ = true; }) {}
+
+  void Complete(int attempt, grpc::Status status) {
+    bigtable::Row row("r1", {});
+    callbacks_.at(attempt)(cq_, std::make_pair(status.ok(), std::move(row)),
+                           status);
+  }
+
+  std::shared_ptr<bigtable::testing::MockCompletionQueue> cq_impl_;
+  bigtable::CompletionQueue cq_;
+  std::shared_ptr<bigtable::HedgingPolicy> policy_;
+  std::vector<HedgedReadRow::AttemptCallback> callbacks_;
+  std::vector<std::shared_ptr<FakeAttempt>> attempts_;
+  bool done_;
+  HedgedReadRow op_;
+};
+
+grpc::Status const kUnavailable(grpc::StatusCode::UNAVAILABLE, "try-again");
+grpc::Status const kCancelled(grpc::StatusCode::CANCELLED, "cancelled");
+}  // anonymous namespace
+
+/// @test Verify that no hedge is sent if the first attempt is fast.
+TEST_F(HedgedReadRowTest, NoHedge) {
+  op_.Start(cq_);
+  ASSERT_EQ(1U, callbacks_.size());
+  Complete(0, grpc::Status::OK);
+  EXPECT_FALSE(done_);
+
+  // The timer is cancelled.
+  cq_impl_->SimulateCompletion(cq_, false);
+  EXPECT_TRUE(done_);
+  EXPECT_EQ(1U, callbacks_.size());
+  EXPECT_TRUE(op_.status().ok());
+  EXPECT_TRUE(op_.result().first);
+  EXPECT_EQ("r1", op_.result().second.row_key());
+  EXPECT_EQ(0, policy_->hedges_sent());
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that the hedge can win, and the first attempt is cancelled.
+TEST_F(HedgedReadRowTest, HedgeWins) {
+  op_.Start(cq_);
+  cq_impl_->SimulateCompletion(cq_, true);
+  ASSERT_EQ(2U, callbacks_.size());
+  EXPECT_EQ(1, policy_->hedges_sent());
+
+  Complete(1, grpc::Status::OK);
+  EXPECT_TRUE(attempts_[0]->cancelled);
+  EXPECT_FALSE(done_);
+  Complete(0, kCancelled);
+  EXPECT_TRUE(done_);
+  EXPECT_TRUE(op_.status().ok());
+  EXPECT_TRUE(op_.result().first);
+  EXPECT_EQ(1, policy_->hedges_won());
+}
+
+/// @test Verify that the first attempt can win after the hedge is sent.
+TEST_F(HedgedReadRowTest, FirstAttemptWinsAfterHedge) {
+  op_.Start(cq_);
+  cq_impl_->SimulateCompletion(cq_, true);
+  ASSERT_EQ(2U, callbacks_.size());
+
+  Complete(0, grpc::Status::OK);
+  EXPECT_TRUE(attempts_[1]->cancelled);
+  Complete(1, kCancelled);
+  EXPECT_TRUE(done_);
+  EXPECT_TRUE(op_.status().ok());
+  EXPECT_EQ(1, policy_->hedges_sent());
+  EXPECT_EQ(0, policy_->hedges_won());
+}
+
+/// @test Verify that a failed attempt does not hide a successful hedge.
+TEST_F(HedgedReadRowTest, FailedAttemptUsesHedge) {
+  op_.Start(cq_);
+  cq_impl_->SimulateCompletion(cq_, true);
+  ASSERT_EQ(2U, callbacks_.size());
+
+  Complete(0, kUnavailable);
+  EXPECT_FALSE(attempts_[1]->cancelled);
+  Complete(1, grpc::Status::OK);
+  EXPECT_TRUE(done_);
+  EXPECT_TRUE(op_.status().ok());
+  EXPECT_TRUE(op_.result().first);
+}
+
+/// @test Verify that the error is reported if both attempts fail.
+TEST_F(HedgedReadRowTest, BothAttemptsFail) {
+  op_.Start(cq_);
+  cq_impl_->SimulateCompletion(cq_, true);
+  ASSERT_EQ(2U, callbacks_.size());
+
+  Complete(0, kUnavailable);
+  Complete(1, kUnavailable);
+  EXPECT_TRUE(done_);
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, op_.status().error_code());
+}
+
+/// @test Verify that no hedge is sent after the first attempt fails.
+TEST_F(HedgedReadRowTest, FailureBeforeHedge) {
+  op_.Start(cq_);
+  Complete(0, kUnavailable);
+  cq_impl_->SimulateCompletion(cq_, false);
+  EXPECT_TRUE(done_);
+  EXPECT_EQ(1U, callbacks_.size());
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, op_.status().error_code());
+  EXPECT_EQ(0, policy_->hedges_sent());
+}
+
+/// @test Verify that the hedge uses a different channel than the first attempt.
+TEST(HedgeChannelTest, DifferentChannel) {
+  using bigtable::internal::HedgeChannel;
+  EXPECT_EQ(1U, HedgeChannel(0, {0, 0}));
+  EXPECT_EQ(0U, HedgeChannel(1, {0, 0}));
+  EXPECT_EQ(2U, HedgeChannel(1, {0, 0, 0}));
+  EXPECT_EQ(0U, HedgeChannel(2, {0, 0, 0}));
+  // The first attempt is counted in the load of its channel.
+  EXPECT_EQ(1U, HedgeChannel(0, {1, 0, 0, 0}));
+}
+
+/// @test Verify that the hedge uses the least loaded of the other channels.
+TEST(HedgeChannelTest, LeastLoaded) {
+  using bigtable::internal::HedgeChannel;
+  EXPECT_EQ(3U, HedgeChannel(0, {0, 2, 3, 1}));
+  EXPECT_EQ(0U, HedgeChannel(2, {1, 2, 0, 4}));
+  // The pool may shrink after the first attempt selected its channel.
+  EXPECT_EQ(1U, HedgeChannel(3, {5, 5, 7}));
+}
+
+/// @test Verify that a pool with a single channel uses it for the hedge.
+TEST(HedgeChannelTest, SingleChannel) {
+  using bigtable::internal::HedgeChannel;
+  EXPECT_EQ(0U, HedgeChannel(0, {3}));
+  EXPECT_EQ(0U, HedgeChannel(0, {}));
+}
@@ -0,0 +1,264 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/normalized_row_set.h"
+#include <algorithm>
+
+namespace btproto = ::google::bigtable::v2;
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace {
+/// One end of a range, `infinite` means -infinity for starts and +infinity
+/// for ends.
+struct Bound {
+  std::string const* key;
+  bool open;
+  bool infinite;
+};
+
+Bound StartOf(btproto::RowRange const& r) {
+  switch (r.start_key_case()) {
+    case btproto::RowRange::kStartKeyClosed:
+      return Bound{&r.start_key_closed(), false, false};
+    case btproto::RowRange::kStartKeyOpen:
+      return Bound{&r.start_key_open(), true, false};
+    case btproto::RowRange::START_KEY_NOT_SET:
+      break;
+  }
+  return Bound{nullptr, false, true};
+}
+
+Bound EndOf(btproto::RowRange const& r) {
+  // An empty end key means "end of the table".
+  switch (r.end_key_case()) {
+    case btproto::RowRange::kEndKeyClosed:
+      if (not r.end_key_closed().empty()) {
+        return Bound{&r.end_key_closed(), false, false};
+      }
+      break;
+    case btproto::RowRange::kEndKeyOpen:
+      if (not r.end_key_open().empty()) {
+        return Bound{&r.end_key_open(), true, false};
+      }
+      break;
+    case btproto::RowRange::END_KEY_NOT_SET:
+      break;
+  }
+  return Bound{nullptr, false, true};
+}
+
+bool StartLess(Bound const& a, Bound const& b) {
+  if (a.infinite or b.infinite) {
+    return a.infinite and not b.infinite;
+  }
+  int cmp = a.key->compare(*b.key);
+  if (cmp != 0) {
+    return cmp < 0;
+  }
+  return not a.open and b.open;
+}
+
+bool EndLess(Bound const& a, Bound const& b) {
+  if (a.infinite or b.infinite) {
+    return b.infinite and not a.infinite;
+  }
+  int cmp = a.key->compare(*b.key);
+  if (cmp != 0) {
+    return cmp < 0;
+  }
+  return a.open and not b.open;
+}
+
+/// Return true if a range starting at @p start overlaps or touches a range
+/// ending at @p end, assuming it does not start before that range.
+bool Touches(Bound const& end, Bound const& start) {
+  if (end.infinite or start.infinite) {
+    return true;
+  }
+  int cmp = start.key->compare(*end.key);
+  if (cmp != 0) {
+    return cmp < 0;
+  }
+  return not(end.open and start.open);
+}
+
+/// Return true if the range ending at @p end has keys above @p key.
+bool EndsAfter(Bound const& end, std::string const& key) {
+  return end.infinite or key < *end.key;
+}
+
+void SetEnd(btproto::RowRange& r, btproto::RowRange const& source) {
+  switch (source.end_key_case()) {
+    case btproto::RowRange::kEndKeyClosed:
+      r.set_end_key_closed(source.end_key_closed());
+      break;
+    case btproto::RowRange::kEndKeyOpen:
+      r.set_end_key_open(source.end_key_open());
+      break;
+    case btproto::RowRange::END_KEY_NOT_SET:
+      r.clear_end_key_closed();
+      r.clear_end_key_open();
+      break;
+  }
+}
+}  // anonymous namespace
+
+NormalizedRowSet::NormalizedRowSet(RowSet const& row_set)
+    : all_rows_(false), first_key_(0), first_range_(0), resumed_(false) {
+  auto proto = row_set.as_proto();
+  if (proto.row_keys().empty() and proto.row_ranges().empty()) {
+    all_rows_ = true;
+    row_ranges_.emplace_back(RowRange::InfiniteRange().as_proto_move());
+    return;
+  }
+
+  std::vector<btproto::RowRange> ranges;
+  ranges.reserve(proto.row_ranges_size());
+  for (auto& r : *proto.mutable_row_ranges()) {
+    if (not RowRange(r).IsEmpty()) {
+      ranges.emplace_back(std::move(r));
+    }
+  }
+  std::sort(ranges.begin(), ranges.end(),
+            [](btproto::RowRange const& a, btproto::RowRange const& b) {
+              return StartLess(StartOf(a), StartOf(b));
+            });
+  for (auto& r : ranges) {
+    if (not row_ranges_.empty() and
+        Touches(EndOf(row_ranges_.back()), StartOf(r))) {
+      if (EndLess(EndOf(row_ranges_.back()), EndOf(r))) {
+        SetEnd(row_ranges_.back(), r);
+      }
+      continue;
+    }
+    row_ranges_.emplace_back(std::move(r));
+  }
+
+  row_keys_.reserve(proto.row_keys_size());
+  for (auto& key : *proto.mutable_row_keys()) {
+    row_keys_.emplace_back(std::move(key));
+  }
+  std::sort(row_keys_.begin(), row_keys_.end());
+  row_keys_.erase(std::unique(row_keys_.begin(), row_keys_.end()),
+                  row_keys_.end());
+  if (row_ranges_.empty()) {
+    return;
+  }
+  // Remove the keys already included in a range. The ranges are disjoint and
+  // sorted, so the first range that ends after the key is the only candidate.
+  row_keys_.erase(
+      std::remove_if(row_keys_.begin(), row_keys_.end(),
+                     [this](std::string const& key) {
+                       auto r = std::partition_point(
+                           row_ranges_.begin(), row_ranges_.end(),
+                           [&key](btproto::RowRange const& range) {
+                             auto end = EndOf(range);
+                             return not end.infinite and
+                                    (*end.key < key or
+                                     (*end.key == key and end.open));
+                           });
+                       return r != row_ranges_.end() and
+                              RowRange(*r).Contains(key);
+                     }),
+      row_keys_.end());
+}
+
+void NormalizedRowSet::ResumeAfter(std::string const& row_key) {
+  first_key_ = static_cast<std::size_t>(
+      std::upper_bound(row_keys_.begin() + first_key_, row_keys_.end(),
+                       row_key) -
+      row_keys_.begin());
+  first_range_ = static_cast<std::size_t>(
+      std::partition_point(row_ranges_.begin() + first_range_,
+                           row_ranges_.end(),
+                           [&row_key](btproto::RowRange const& r) {
+                             return not EndsAfter(EndOf(r), row_key);
+                           }) -
+      row_ranges_.begin());
+  resumed_ = true;
+  resume_key_ = row_key;
+}
+
+bool NormalizedRowSet::IsEmpty() const {
+  if (first_key_ != row_keys_.size()) {
+    return false;
+  }
+  auto const remaining = row_ranges_.size() - first_range_;
+  if (remaining == 0) {
+    return true;
+  }
+  // Only the first range may have been clipped, the others are not empty.
+  return remaining == 1 and RowRange(FirstRange()).IsEmpty();
+}
+
+btproto::RowRange NormalizedRowSet::FirstRange() const {
+  auto range = row_ranges_[first_range_];
+  if (not resumed_) {
+    return range;
+  }
+  auto start = StartOf(range);
+  if (start.infinite or *start.key <= resume_key_) {
+    range.set_start_key_open(resume_key_);
+  }
+  return range;
+}
+
+void NormalizedRowSet::CopyTo(btproto::RowSet& row_set) const {
+  row_set.Clear();
+  if (all_rows_ and not resumed_) {
+    // Keep the canonical representation for "all rows".
+    return;
+  }
+  row_set.mutable_row_keys()->Reserve(
+      static_cast<int>(row_keys_.size() - first_key_));
+  for (auto i = first_key_; i != row_keys_.size(); ++i) {
+    *row_set.add_row_keys() = row_keys_[i];
+  }
+  if (first_range_ == row_ranges_.size()) {
+    if (row_set.row_keys().empty()) {
+      // An empty proto means "all rows", use an empty range instead.
+      *row_set.add_row_ranges() = RowRange::Empty().as_proto_move();
+    }
+    return;
+  }
+  row_set.mutable_row_ranges()->Reserve(
+      static_cast<int>(row_ranges_.size() - first_range_));
+  *row_set.add_row_ranges() = FirstRange();
+  for (auto i = first_range_ + 1; i != row_ranges_.size(); ++i) {
+    *row_set.add_row_ranges() = row_ranges_[i];
+  }
+}
+
+RowSet NormalizedRowSet::ToRowSet() const {
+  btproto::RowSet proto;
+  CopyTo(proto);
+  RowSet result;
+  for (auto& key : *proto.mutable_row_keys()) {
+    result.Append(std::move(key));
+  }
+  for (auto& range : *proto.mutable_row_ranges()) {
+    result.Append(RowRange(std::move(range)));
+  }
+  return result;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,85 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_NORMALIZED_ROW_SET_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_NORMALIZED_ROW_SET_H_
+
+#include "google/cloud/bigtable/row_set.h"
+#include <google/bigtable/v2/data.pb.h>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * A sorted, deduplicated representation of a `RowSet` for resumable scans.
+ *
+ * The row keys are sorted and deduplicated, and the ranges are sorted and
+ * merged, so they do not overlap.  Keys contained in a range are removed.
+ * With this representation resuming a scan after the last row received
+ * (`ResumeAfter()`) is a binary search, instead of a copy of all the keys and
+ * ranges, which matters for row sets with many keys.
+ *
+ * The readers keep one of these objects and call `ResumeAfter()` on each
+ * retry, then `CopyTo()` builds the request with the remaining keys and
+ * ranges.
+ */
+class NormalizedRowSet {
+ public:
+  explicit NormalizedRowSet(RowSet const& row_set);
+
+  /// Remove all the keys and ranges (or parts of ranges) up to @p row_key.
+  void ResumeAfter(std::string const& row_key);
+
+  /// Return true if no row key can match the remaining set.
+  bool IsEmpty() const;
+
+  /// Set @p row_set to the remaining keys and ranges.
+  void CopyTo(google::bigtable::v2::RowSet& row_set) const;
+
+  /// Return the remaining keys and ranges as a `RowSet`.
+  RowSet ToRowSet() const;
+
+  //@{
+  /// @name Accessors for testing.
+  std::vector<std::string> const& row_keys() const { return row_keys_; }
+  std::vector<google::bigtable::v2::RowRange> const& row_ranges() const {
+    return row_ranges_;
+  }
+  //@}
+
+ private:
+  /// Return the first remaining range, clipped to start after the resume key.
+  google::bigtable::v2::RowRange FirstRange() const;
+
+  std::vector<std::string> row_keys_;
+  std::vector<google::bigtable::v2::RowRange> row_ranges_;
+  /// The original set was empty, i.e., it matched all the rows.
+  bool all_rows_;
+  std::size_t first_key_;
+  std::size_t first_range_;
+  bool resumed_;
+  std::string resume_key_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_NORMALIZED_ROW_SET_H_
@@ -0,0 +1,146 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/normalized_row_set.h"
+#include <gmock/gmock.h>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::internal::NormalizedRowSet;
+
+TEST(NormalizedRowSetTest, SortsAndDeduplicatesKeys) {
+  NormalizedRowSet tested(bigtable::RowSet("c", "a", "b", "a", "c"));
+  EXPECT_THAT(tested.row_keys(), ::testing::ElementsAre("a", "b", "c"));
+  EXPECT_TRUE(tested.row_ranges().empty());
+  EXPECT_FALSE(tested.IsEmpty());
+}
+
+TEST(NormalizedRowSetTest, MergesOverlappingRanges) {
+  NormalizedRowSet tested(bigtable::RowSet(
+      bigtable::RowRange::Range("m", "p"), bigtable::RowRange::Range("a", "d"),
+      bigtable::RowRange::Range("b", "f"),
+      bigtable::RowRange::Range("n", "o")));
+  ASSERT_EQ(2U, tested.row_ranges().size());
+  EXPECT_EQ("a", tested.row_ranges()[0].start_key_closed());
+  EXPECT_EQ("f", tested.row_ranges()[0].end_key_open());
+  EXPECT_EQ("m", tested.row_ranges()[1].start_key_closed());
+  EXPECT_EQ("p", tested.row_ranges()[1].end_key_open());
+}
+
+TEST(NormalizedRowSetTest, MergesAdjacentRanges) {
+  NormalizedRowSet tested(bigtable::RowSet(
+      bigtable::RowRange::Range("a", "c"), bigtable::RowRange::Range("c", "e"),
+      bigtable::RowRange::Open("f", "h"), bigtable::RowRange::Open("h", "k")));
+  // [a,c) + [c,e) is contiguous, (f,h) + (h,k) is missing "h".
+  ASSERT_EQ(3U, tested.row_ranges().size());
+  EXPECT_EQ("a", tested.row_ranges()[0].start_key_closed());
+  EXPECT_EQ("e", tested.row_ranges()[0].end_key_open());
+  EXPECT_EQ("f", tested.row_ranges()[1].start_key_open());
+  EXPECT_EQ("h", tested.row_ranges()[1].end_key_open());
+  EXPECT_EQ("h", tested.row_ranges()[2].start_key_open());
+  EXPECT_EQ("k", tested.row_ranges()[2].end_key_open());
+}
+
+TEST(NormalizedRowSetTest, MergesIntoInfiniteRange) {
+  NormalizedRowSet tested(bigtable::RowSet(
+      bigtable::RowRange::StartingAt("c"), bigtable::RowRange::Range("a", "d"),
+      bigtable::RowRange::Range("x", "z")));
+  ASSERT_EQ(1U, tested.row_ranges().size());
+  EXPECT_EQ("a", tested.row_ranges()[0].start_key_closed());
+  EXPECT_TRUE(tested.row_ranges()[0].end_key_open().empty());
+}
+
+TEST(NormalizedRowSetTest, DropsEmptyRangesAndCoveredKeys) {
+  NormalizedRowSet tested(bigtable::RowSet(
+      bigtable::RowRange::Range("b", "d"), bigtable::RowRange::Empty(), "a",
+      "b", "c", "d", "e"));
+  EXPECT_THAT(tested.row_keys(), ::testing::ElementsAre("a", "d", "e"));
+  ASSERT_EQ(1U, tested.row_ranges().size());
+}
+
+TEST(NormalizedRowSetTest, ResumeAfterSkipsKeysAndClipsRanges) {
+  NormalizedRowSet tested(bigtable::RowSet(
+      "a", "c", "k", "z", bigtable::RowRange::Range("d", "g"),
+      bigtable::RowRange::Range("m", "p")));
+  tested.ResumeAfter("e");
+
+  google::bigtable::v2::RowSet proto;
+  tested.CopyTo(proto);
+  ASSERT_EQ(2, proto.row_keys_size());
+  EXPECT_EQ("k", proto.row_keys(0));
+  EXPECT_EQ("z", proto.row_keys(1));
+  ASSERT_EQ(2, proto.row_ranges_size());
+  EXPECT_EQ("e", proto.row_ranges(0).start_key_open());
+  EXPECT_EQ("g", proto.row_ranges(0).end_key_open());
+  EXPECT_EQ("m", proto.row_ranges(1).start_key_closed());
+
+  tested.ResumeAfter("n");
+  tested.CopyTo(proto);
+  ASSERT_EQ(1, proto.row_keys_size());
+  EXPECT_EQ("z", proto.row_keys(0));
+  ASSERT_EQ(1, proto.row_ranges_size());
+  EXPECT_EQ("n", proto.row_ranges(0).start_key_open());
+  EXPECT_EQ("p", proto.row_ranges(0).end_key_open());
+  EXPECT_FALSE(tested.IsEmpty());
+
+  tested.ResumeAfter("z");
+  EXPECT_TRUE(tested.IsEmpty());
+  tested.CopyTo(proto);
+  EXPECT_EQ(0, proto.row_keys_size());
+  ASSERT_EQ(1, proto.row_ranges_size());
+  EXPECT_TRUE(bigtable::RowRange(proto.row_ranges(0)).IsEmpty());
+}
+
+TEST(NormalizedRowSetTest, ResumeAtEndOfClosedRange) {
+  NormalizedRowSet tested(
+      bigtable::RowSet(bigtable::RowRange::Closed("a", "c")));
+  tested.ResumeAfter("b");
+  EXPECT_FALSE(tested.IsEmpty());
+  tested.ResumeAfter("c");
+  EXPECT_TRUE(tested.IsEmpty());
+}
+
+TEST(NormalizedRowSetTest, AllRows) {
+  NormalizedRowSet tested{bigtable::RowSet()};
+  EXPECT_FALSE(tested.IsEmpty());
+  google::bigtable::v2::RowSet proto;
+  tested.CopyTo(proto);
+  EXPECT_EQ(0, proto.row_keys_size());
+  EXPECT_EQ(0, proto.row_ranges_size());
+
+  tested.ResumeAfter("foo");
+  EXPECT_FALSE(tested.IsEmpty());
+  tested.CopyTo(proto);
+  EXPECT_EQ(0, proto.row_keys_size());
+  ASSERT_EQ(1, proto.row_ranges_size());
+  EXPECT_EQ("foo", proto.row_ranges(0).start_key_open());
+  EXPECT_TRUE(proto.row_ranges(0).end_key_open().empty());
+}
+
+TEST(NormalizedRowSetTest, OnlyEmptyRanges) {
+  NormalizedRowSet tested(bigtable::RowSet(bigtable::RowRange::Empty()));
+  EXPECT_TRUE(tested.IsEmpty());
+  google::bigtable::v2::RowSet proto;
+  tested.CopyTo(proto);
+  ASSERT_EQ(1, proto.row_ranges_size());
+  EXPECT_TRUE(bigtable::RowRange(proto.row_ranges(0)).IsEmpty());
+}
+
+TEST(NormalizedRowSetTest, ToRowSet) {
+  NormalizedRowSet tested(bigtable::RowSet("b", "a", "c"));
+  tested.ResumeAfter("a");
+  auto proto = tested.ToRowSet().as_proto();
+  ASSERT_EQ(2, proto.row_keys_size());
+  EXPECT_EQ("b", proto.row_keys(0));
+  EXPECT_EQ("c", proto.row_keys(1));
+}
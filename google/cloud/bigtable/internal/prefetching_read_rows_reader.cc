@@ -0,0 +1,123 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/prefetching_read_rows_reader.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+PrefetchingReadRowsReader::PrefetchingReadRowsReader(
+    grpc::ClientContext* context, std::unique_ptr<Stream> stream,
+    std::size_t max_responses, std::size_t max_bytes)
+    : context_(context),
+      stream_(std::move(stream)),
+      max_responses_(std::max<std::size_t>(1U, max_responses)),
+      max_bytes_(max_bytes),
+      buffered_bytes_(0),
+      done_(false),
+      shutdown_(false) {
+  reader_ = std::thread(&PrefetchingReadRowsReader::ReadLoop, this);
+}
+
+PrefetchingReadRowsReader::~PrefetchingReadRowsReader() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (not done_) {
+      // The stream is abandoned before reaching the end, unblock the thread.
+      context_->TryCancel();
+    }
+  }
+  Shutdown();
+}
+
+bool PrefetchingReadRowsReader::Read(
+    google::bigtable::v2::ReadRowsResponse* msg) {
+  std::unique_lock<std::mutex> lk(mu_);
+  has_data_.wait(lk, [this] { return not buffer_.empty() or done_; });
+  if (buffer_.empty()) {
+    return false;
+  }
+  buffered_bytes_ -= buffer_.front().ByteSizeLong();
+  msg->Swap(&buffer_.front());
+  buffer_.pop_front();
+  has_room_.notify_one();
+  return true;
+}
+
+grpc::Status PrefetchingReadRowsReader::Finish() {
+  Shutdown();
+  return stream_->Finish();
+}
+
+bool PrefetchingReadRowsReader::NextMessageSize(std::uint32_t* sz) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (buffer_.empty()) {
+    return false;
+  }
+  *sz = static_cast<std::uint32_t>(buffer_.front().ByteSizeLong());
+  return true;
+}
+
+void PrefetchingReadRowsReader::WaitForInitialMetadata() {
+  // The background thread owns the stream until it reaches the end, and the
+  // initial metadata is received with the first response anyway.
+}
+
+void PrefetchingReadRowsReader::ReadLoop() {
+  while (true) {
+    google::bigtable::v2::ReadRowsResponse response;
+    if (not stream_->Read(&response)) {
+      break;
+    }
+    auto size = response.ByteSizeLong();
+    std::unique_lock<std::mutex> lk(mu_);
+    has_room_.wait(lk, [this, size] {
+      return shutdown_ or buffer_.empty() or
+             (buffer_.size() < max_responses_ and
+              buffered_bytes_ + size <= max_bytes_);
+    });
+    if (shutdown_) {
+      // Keep reading, the stream must be drained before calling Finish().
+      continue;
+    }
+    buffered_bytes_ += size;
+    buffer_.emplace_back(std::move(response));
+    has_data_.notify_one();
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  done_ = true;
+  has_data_.notify_all();
+}
+
+void PrefetchingReadRowsReader::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+    buffer_.clear();
+    buffered_bytes_ = 0;
+    has_room_.notify_all();
+  }
+  if (reader_.joinable()) {
+    reader_.join();
+  }
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,105 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_PREFETCHING_READ_ROWS_READER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_PREFETCHING_READ_ROWS_READER_H_
+
+#include "google/cloud/bigtable/version.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Reads a `ReadRows()` stream ahead of the consumer in a background thread.
+ *
+ * This class wraps the stream returned by `DataClient::ReadRows()`.  A
+ * background thread reads the responses as soon as they arrive and buffers
+ * them, so the network reads overlap with the processing of the rows.  The
+ * buffer is bounded by both the number of responses and their total size, but
+ * at least one response is always buffered, even if it exceeds the size limit.
+ *
+ * The consumer uses this object like any other stream: `Read()` until it
+ * returns `false`, then `Finish()`.  Cancelling the `grpc::ClientContext`
+ * stops the background thread, the buffered responses are discarded.
+ */
+class PrefetchingReadRowsReader
+    : public grpc::ClientReaderInterface<
+          google::bigtable::v2::ReadRowsResponse> {
+ public:
+  using Stream =
+      grpc::ClientReaderInterface<google::bigtable::v2::ReadRowsResponse>;
+
+  /**
+   * Start reading @p stream in the background.
+   *
+   * @param context the context used to create @p stream, it must outlive this
+   *     object.
+   * @param max_responses the maximum number of responses buffered.
+   * @param max_bytes the maximum size of the responses buffered.
+   */
+  PrefetchingReadRowsReader(grpc::ClientContext* context,
+                            std::unique_ptr<Stream> stream,
+                            std::size_t max_responses, std::size_t max_bytes);
+
+  /// Cancels the stream if it is still running and waits for the thread.
+  ~PrefetchingReadRowsReader() override;
+
+  //@{
+  /// @name grpc::ClientReaderInterface implementation.
+  bool Read(google::bigtable::v2::ReadRowsResponse* msg) override;
+  grpc::Status Finish() override;
+  bool NextMessageSize(std::uint32_t* sz) override;
+  void WaitForInitialMetadata() override;
+  //@}
+
+ private:
+  /// The body of the background thread.
+  void ReadLoop();
+
+  /// Stop reading, and wait for the background thread.
+  void Shutdown();
+
+  grpc::ClientContext* context_;
+  std::unique_ptr<Stream> stream_;
+  std::size_t max_responses_;
+  std::size_t max_bytes_;
+
+  std::mutex mu_;
+  /// Signaled when the consumer removes a response or shuts down the reader.
+  std::condition_variable has_room_;
+  /// Signaled when a response is buffered or the stream ends.
+  std::condition_variable has_data_;
+  std::deque<google::bigtable::v2::ReadRowsResponse> buffer_;
+  std::size_t buffered_bytes_;
+  bool done_;
+  bool shutdown_;
+  std::thread reader_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_PREFETCHING_READ_ROWS_READER_H_
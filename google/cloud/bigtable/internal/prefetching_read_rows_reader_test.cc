@@ -0,0 +1,168 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/prefetching_read_rows_reader.h"
+#include "google/cloud/bigtable/testing/mock_read_rows_reader.h"
+#include "google/cloud/internal/make_unique.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace ::testing;
+using bigtable::internal::PrefetchingReadRowsReader;
+using bigtable::testing::MockReadRowsReader;
+
+namespace {
+/// Create a response with a single chunk for @p row_key.
+btproto::ReadRowsResponse MakeResponse(std::string const& row_key) {
+  btproto::ReadRowsResponse response;
+  auto& chunk = *response.add_chunks();
+  chunk.set_row_key(row_key);
+  chunk.set_value(std::string(100, 'x'));
+  chunk.set_commit_row(true);
+  return response;
+}
+
+/// Configure @p stream to return one response for each key in @p keys.
+void ExpectResponses(MockReadRowsReader& stream,
+                     std::vector<std::string> const& keys,
+                     std::atomic<int>& read_count) {
+  auto index = std::make_shared<std::size_t>(0);
+  EXPECT_CALL(stream, Read(_))
+      .WillRepeatedly(Invoke([keys, index, &read_count](
+                                 btproto::ReadRowsResponse* r) {
+        ++read_count;
+        if (*index == keys.size()) {
+          return false;
+        }
+        *r = MakeResponse(keys[(*index)++]);
+        return true;
+      }));
+}
+
+/// Wait until @p counter reaches @p expected, or a (generous) timeout.
+void WaitForCount(std::atomic<int> const& counter, int expected) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (counter.load() < expected and
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+}  // anonymous namespace
+
+/// @test Verify that all the responses are returned in order.
+TEST(PrefetchingReadRowsReaderTest, ReadAll) {
+  grpc::ClientContext context;
+  std::atomic<int> read_count(0);
+  auto stream = new MockReadRowsReader;
+  ExpectResponses(*stream, {"r1", "r2", "r3"}, read_count);
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  PrefetchingReadRowsReader reader(&context, stream->AsUniqueMocked(), 2,
+                                   1024 * 1024);
+  std::vector<std::string> keys;
+  btproto::ReadRowsResponse response;
+  while (reader.Read(&response)) {
+    keys.emplace_back(response.chunks(0).row_key());
+  }
+  EXPECT_THAT(keys, ElementsAre("r1", "r2", "r3"));
+  EXPECT_TRUE(reader.Finish().ok());
+}
+
+/// @test Verify that the status of the stream is returned by Finish().
+TEST(PrefetchingReadRowsReaderTest, FinishReturnsStreamStatus) {
+  grpc::ClientContext context;
+  std::atomic<int> read_count(0);
+  auto stream = new MockReadRowsReader;
+  ExpectResponses(*stream, {"r1"}, read_count);
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(grpc::Status(grpc::StatusCode::UNAVAILABLE, "retry")));
+
+  PrefetchingReadRowsReader reader(&context, stream->AsUniqueMocked(), 2,
+                                   1024 * 1024);
+  btproto::ReadRowsResponse response;
+  EXPECT_TRUE(reader.Read(&response));
+  EXPECT_FALSE(reader.Read(&response));
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, reader.Finish().error_code());
+}
+
+/// @test Verify that the number of buffered responses is bounded.
+TEST(PrefetchingReadRowsReaderTest, BoundedByResponses) {
+  grpc::ClientContext context;
+  std::atomic<int> read_count(0);
+  auto stream = new MockReadRowsReader;
+  ExpectResponses(*stream, {"r1", "r2", "r3", "r4", "r5"}, read_count);
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  PrefetchingReadRowsReader reader(&context, stream->AsUniqueMocked(), 2,
+                                   1024 * 1024);
+  // Two responses are buffered, and a third one waits for room.
+  WaitForCount(read_count, 3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(3, read_count.load());
+
+  btproto::ReadRowsResponse response;
+  ASSERT_TRUE(reader.Read(&response));
+  EXPECT_EQ("r1", response.chunks(0).row_key());
+  WaitForCount(read_count, 4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(4, read_count.load());
+
+  while (reader.Read(&response)) {
+  }
+  EXPECT_EQ("r5", response.chunks(0).row_key());
+  EXPECT_TRUE(reader.Finish().ok());
+}
+
+/// @test Verify that the size of the buffered responses is bounded.
+TEST(PrefetchingReadRowsReaderTest, BoundedByBytes) {
+  grpc::ClientContext context;
+  std::atomic<int> read_count(0);
+  auto stream = new MockReadRowsReader;
+  ExpectResponses(*stream, {"r1", "r2", "r3"}, read_count);
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  // Each response is larger than the limit, but one is always buffered.
+  PrefetchingReadRowsReader reader(&context, stream->AsUniqueMocked(), 10, 10);
+  WaitForCount(read_count, 2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(2, read_count.load());
+
+  std::vector<std::string> keys;
+  btproto::ReadRowsResponse response;
+  while (reader.Read(&response)) {
+    keys.emplace_back(response.chunks(0).row_key());
+  }
+  EXPECT_THAT(keys, ElementsAre("r1", "r2", "r3"));
+  EXPECT_TRUE(reader.Finish().ok());
+}
+
+/// @test Verify that Finish() works before consuming all the responses.
+TEST(PrefetchingReadRowsReaderTest, FinishDiscardsBuffer) {
+  grpc::ClientContext context;
+  std::atomic<int> read_count(0);
+  auto stream = new MockReadRowsReader;
+  ExpectResponses(*stream, {"r1", "r2", "r3", "r4"}, read_count);
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  PrefetchingReadRowsReader reader(&context, stream->AsUniqueMocked(), 1,
+                                   1024 * 1024);
+  btproto::ReadRowsResponse response;
+  ASSERT_TRUE(reader.Read(&response));
+  // The background thread drains the stream before calling Finish().
+  EXPECT_TRUE(reader.Finish().ok());
+  EXPECT_EQ(5, read_count.load());
+}
@@ -0,0 +1,82 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/read_row_coalescer.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+bool ReadRowCoalescer::ReadRow(std::string const& row_key,
+                               Filter const& filter,
+                               BatchFunction const& read_batch,
+                               std::pair<bool, Row>& result) {
+  auto const filter_key = filter.as_proto().SerializeAsString();
+  std::unique_lock<std::mutex> lk(mu_);
+  auto& slot = open_batches_[filter_key];
+  bool const is_leader = not slot;
+  if (is_leader) {
+    slot = std::make_shared<Batch>();
+  }
+  auto batch = slot;
+  if (batch->unique_keys.insert(row_key).second) {
+    batch->row_keys.push_back(row_key);
+  }
+  if (++batch->callers >= policy_.max_batch_size()) {
+    // Close the batch, new calls go to a new batch.
+    open_batches_.erase(filter_key);
+    batch->full = true;
+    batch->cv.notify_all();
+  }
+
+  if (is_leader) {
+    auto const deadline = std::chrono::steady_clock::now() + policy_.window();
+    batch->cv.wait_until(lk, deadline, [&batch] { return batch->full; });
+    if (not batch->full) {
+      open_batches_.erase(filter_key);
+    }
+    // The batch is closed, nobody else modifies the row keys.
+    lk.unlock();
+    std::map<std::string, Row> rows;
+    auto status = read_batch(batch->row_keys, filter, [&rows](Row row) {
+      auto key = row.row_key();
+      rows.emplace(std::move(key), std::move(row));
+    });
+    lk.lock();
+    batch->rows = std::move(rows);
+    batch->status = std::move(status);
+    batch->done = true;
+    batch->cv.notify_all();
+  } else {
+    batch->cv.wait(lk, [&batch] { return batch->done; });
+  }
+
+  auto it = batch->rows.find(row_key);
+  if (it != batch->rows.end()) {
+    result = std::make_pair(true, it->second);
+    return true;
+  }
+  if (batch->status.ok()) {
+    result = std::make_pair(false, Row("", {}));
+    return true;
+  }
+  return false;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
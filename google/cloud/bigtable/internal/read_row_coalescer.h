@@ -0,0 +1,94 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READ_ROW_COALESCER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READ_ROW_COALESCER_H_
+
+#include "google/cloud/bigtable/filters.h"
+#include "google/cloud/bigtable/read_row_coalescing_policy.h"
+#include "google/cloud/bigtable/row.h"
+#include <grpcpp/grpcpp.h>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Group concurrent `ReadRow()` calls into batches.
+ *
+ * The first caller for a given filter becomes the leader of a new batch, it
+ * waits until the batch is full or the window expires, and then reads all the
+ * rows in the batch using a function provided by the caller.  The other
+ * callers wait until the leader delivers the results.  No background threads
+ * are used.
+ */
+class ReadRowCoalescer {
+ public:
+  explicit ReadRowCoalescer(ReadRowCoalescingPolicy policy)
+      : policy_(std::move(policy)) {}
+
+  /**
+   * Read the rows in @p row_keys, calling @p on_row for each row received.
+   *
+   * @return the final status of the read.
+   */
+  using BatchFunction = std::function<grpc::Status(
+      std::vector<std::string> const& row_keys, Filter const& filter,
+      std::function<void(Row)> const& on_row)>;
+
+  /**
+   * Read a row as part of a batch.
+   *
+   * @return true if @p result has the outcome of the read, false if the
+   *     batched read failed before receiving this row, in that case the caller
+   *     should read the row with a separate request.
+   */
+  bool ReadRow(std::string const& row_key, Filter const& filter,
+               BatchFunction const& read_batch, std::pair<bool, Row>& result);
+
+ private:
+  struct Batch {
+    Batch() : callers(0), full(false), done(false) {}
+    std::vector<std::string> row_keys;
+    std::set<std::string> unique_keys;
+    std::size_t callers;
+    bool full;
+    bool done;
+    std::condition_variable cv;
+    std::map<std::string, Row> rows;
+    grpc::Status status;
+  };
+
+  ReadRowCoalescingPolicy const policy_;
+  std::mutex mu_;
+  /// The batches accepting new calls, by serialized filter.
+  std::map<std::string, std::shared_ptr<Batch>> open_batches_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READ_ROW_COALESCER_H_
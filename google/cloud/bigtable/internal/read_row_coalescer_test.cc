@@ -0,0 +1,164 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/read_row_coalescer.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <thread>
+
+namespace bigtable = google::cloud::bigtable;
+using bigtable::internal::ReadRowCoalescer;
+using namespace ::testing;
+
+namespace {
+/// A batch function that returns a row for every key except "missing".
+class FakeBatchReader {
+ public:
+  FakeBatchReader() : calls(0) {}
+
+  ReadRowCoalescer::BatchFunction Function(grpc::Status status) {
+    return [this, status](std::vector<std::string> const& row_keys,
+                          bigtable::Filter const&,
+                          std::function<void(bigtable::Row)> const& on_row) {
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        ++calls;
+        batches.push_back(row_keys);
+      }
+      // Simulate a failure after the first row, if status is not OK.
+      for (auto const& key : row_keys) {
+        if (key != "missing") {
+          on_row(bigtable::Row(key, {}));
+        }
+        if (not status.ok()) {
+          break;
+        }
+      }
+      return status;
+    };
+  }
+
+  std::mutex mu;
+  int calls;
+  std::vector<std::vector<std::string>> batches;
+};
+}  // anonymous namespace
+
+/// @test Verify that a single call is read after the window expires.
+TEST(ReadRowCoalescerTest, SingleCall) {
+  ReadRowCoalescer tested(bigtable::ReadRowCoalescingPolicy(
+      std::chrono::milliseconds(1), 100));
+  FakeBatchReader reader;
+  std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+  ASSERT_TRUE(tested.ReadRow("r1", bigtable::Filter::PassAllFilter(),
+                             reader.Function(grpc::Status::OK), result));
+  EXPECT_TRUE(result.first);
+  EXPECT_EQ("r1", result.second.row_key());
+  EXPECT_EQ(1, reader.calls);
+
+  ASSERT_TRUE(tested.ReadRow("missing", bigtable::Filter::PassAllFilter(),
+                             reader.Function(grpc::Status::OK), result));
+  EXPECT_FALSE(result.first);
+  EXPECT_EQ(2, reader.calls);
+}
+
+/// @test Verify that concurrent calls are combined in a single batch.
+TEST(ReadRowCoalescerTest, ConcurrentCalls) {
+  int const thread_count = 8;
+  // A long window, the batch is sent when it is full.
+  ReadRowCoalescer tested(bigtable::ReadRowCoalescingPolicy(
+      std::chrono::minutes(10), thread_count));
+  FakeBatchReader reader;
+  auto function = reader.Function(grpc::Status::OK);
+
+  std::atomic<int> found(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i != thread_count; ++i) {
+    // Two threads read each key.
+    auto key = "r" + std::to_string(i / 2);
+    threads.emplace_back([&, key] {
+      std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+      bool ok = tested.ReadRow(key, bigtable::Filter::PassAllFilter(),
+                               function, result);
+      if (ok and result.first and result.second.row_key() == key) {
+        ++found;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(thread_count, found.load());
+  EXPECT_EQ(1, reader.calls);
+  ASSERT_EQ(1U, reader.batches.size());
+  EXPECT_THAT(reader.batches[0],
+              UnorderedElementsAre("r0", "r1", "r2", "r3"));
+}
+
+/// @test Verify that calls with different filters use different batches.
+TEST(ReadRowCoalescerTest, DifferentFilters) {
+  ReadRowCoalescer tested(bigtable::ReadRowCoalescingPolicy(
+      std::chrono::minutes(10), 2));
+  FakeBatchReader reader;
+  auto function = reader.Function(grpc::Status::OK);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i != 4; ++i) {
+    auto filter = i % 2 == 0 ? bigtable::Filter::PassAllFilter()
+                             : bigtable::Filter::Latest(1);
+    threads.emplace_back([&, filter, i] {
+      std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+      EXPECT_TRUE(
+          tested.ReadRow("r" + std::to_string(i), filter, function, result));
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(2, reader.calls);
+  ASSERT_EQ(2U, reader.batches.size());
+  EXPECT_EQ(2U, reader.batches[0].size());
+  EXPECT_EQ(2U, reader.batches[1].size());
+}
+
+/// @test Verify that callers that did not receive their row fall back.
+TEST(ReadRowCoalescerTest, BatchFailure) {
+  ReadRowCoalescer tested(bigtable::ReadRowCoalescingPolicy(
+      std::chrono::minutes(10), 2));
+  FakeBatchReader reader;
+  auto function =
+      reader.Function(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"));
+
+  std::atomic<int> completed(0);
+  std::atomic<int> fallback(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i != 2; ++i) {
+    threads.emplace_back([&, i] {
+      std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+      if (tested.ReadRow("r" + std::to_string(i),
+                         bigtable::Filter::PassAllFilter(), function, result)) {
+        EXPECT_TRUE(result.first);
+        ++completed;
+      } else {
+        ++fallback;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(1, reader.calls);
+  EXPECT_EQ(1, completed.load());
+  EXPECT_EQ(1, fallback.load());
+}
@@ -0,0 +1,228 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/readrows_view_parser.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+using google::bigtable::v2::ReadRowsResponse_CellChunk;
+
+namespace {
+std::string const& EmptyString() {
+  static std::string const* const kEmpty = new std::string;
+  return *kEmpty;
+}
+
+google::protobuf::RepeatedPtrField<std::string> const& EmptyLabels() {
+  static auto const* const kEmpty =
+      new google::protobuf::RepeatedPtrField<std::string>;
+  return *kEmpty;
+}
+}  // anonymous namespace
+
+ReadRowsViewParser::ReadRowsViewParser()
+    : next_chunk_(0),
+      cell_row_key_(&EmptyString()),
+      cell_family_(&EmptyString()),
+      cell_column_(&EmptyString()),
+      cell_timestamp_(0),
+      cell_value_(&EmptyString()),
+      cell_labels_(&EmptyLabels()),
+      cell_first_chunk_(true),
+      row_ready_(false),
+      end_of_stream_(false) {}
+
+void ReadRowsViewParser::HandleResponse(
+    google::bigtable::v2::ReadRowsResponse response) {
+  if (row_ready_) {
+    ReleaseRow();
+  } else if (row_.cells_.empty() and cell_first_chunk_) {
+    ReleaseResponses();
+  }
+  responses_.emplace_back(std::move(response));
+  next_chunk_ = 0;
+}
+
+bool ReadRowsViewParser::NextRow(grpc::Status& status) {
+  if (row_ready_) {
+    ReleaseRow();
+  }
+  if (responses_.empty()) {
+    return false;
+  }
+  auto const& response = responses_.back();
+  while (next_chunk_ < response.chunks_size()) {
+    HandleChunk(response.chunks(next_chunk_++), status);
+    if (not status.ok()) {
+      return false;
+    }
+    if (row_ready_) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ReadRowsViewParser::HandleEndOfStream(grpc::Status& status) {
+  if (end_of_stream_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "HandleEndOfStream called twice");
+    return;
+  }
+  end_of_stream_ = true;
+
+  if (not cell_first_chunk_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "end of stream with unfinished cell");
+    return;
+  }
+
+  if (not row_.cells_.empty() and not row_ready_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "end of stream with unfinished row");
+    return;
+  }
+}
+
+void ReadRowsViewParser::HandleChunk(ReadRowsResponse_CellChunk const& chunk,
+                                     grpc::Status& status) {
+  if (end_of_stream_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "HandleChunk after end of stream");
+    return;
+  }
+
+  if (not chunk.row_key().empty()) {
+    if (last_seen_row_key_.compare(chunk.row_key()) >= 0) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Row keys are expected in increasing order");
+      return;
+    }
+    cell_row_key_ = &chunk.row_key();
+  }
+
+  if (chunk.has_family_name()) {
+    if (not chunk.has_qualifier()) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "New column family must specify qualifier");
+      return;
+    }
+    cell_family_ = &chunk.family_name().value();
+  }
+
+  if (chunk.has_qualifier()) {
+    cell_column_ = &chunk.qualifier().value();
+  }
+
+  if (cell_first_chunk_) {
+    cell_timestamp_ = chunk.timestamp_micros();
+    cell_labels_ = &chunk.labels();
+    if (chunk.value_size() == 0) {
+      // Most common case, the value is in a single chunk, refer to it.
+      cell_value_ = &chunk.value();
+    } else {
+      // The value size is a hint about the total size.
+      values_.emplace_back();
+      values_.back().reserve(chunk.value_size());
+      values_.back().append(chunk.value());
+      cell_value_ = &values_.back();
+    }
+  } else {
+    values_.back().append(chunk.value());
+  }
+
+  cell_first_chunk_ = false;
+
+  // Last chunk in the cell has zero for value size
+  if (chunk.value_size() == 0) {
+    if (row_.cells_.empty()) {
+      if (cell_row_key_->empty()) {
+        status = grpc::Status(grpc::StatusCode::INTERNAL,
+                              "Missing row key at last chunk in cell");
+        return;
+      }
+      row_.row_key_ = cell_row_key_;
+    } else if (*row_.row_key_ != *cell_row_key_) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Different row key in cell chunk");
+      return;
+    }
+    row_.cells_.emplace_back(CellView(cell_row_key_, cell_family_,
+                                      cell_column_, cell_timestamp_,
+                                      cell_value_, cell_labels_));
+    cell_first_chunk_ = true;
+  }
+
+  if (chunk.reset_row()) {
+    row_.cells_.clear();
+    cell_row_key_ = &EmptyString();
+    cell_family_ = &EmptyString();
+    cell_column_ = &EmptyString();
+    if (not cell_first_chunk_) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Reset row with an unfinished cell");
+      return;
+    }
+  } else if (chunk.commit_row()) {
+    if (not cell_first_chunk_) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Commit row with an unfinished cell");
+      return;
+    }
+    if (row_.cells_.empty()) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Commit row missing the row key");
+      return;
+    }
+    row_ready_ = true;
+    last_seen_row_key_ = *row_.row_key_;
+    cell_row_key_ = &EmptyString();
+  }
+}
+
+void ReadRowsViewParser::ReleaseRow() {
+  row_ready_ = false;
+  row_.cells_.clear();
+  row_.row_key_ = nullptr;
+  values_.clear();
+  ReleaseResponses();
+}
+
+void ReadRowsViewParser::ReleaseResponses() {
+  // Keep the last response if it still has chunks to parse.
+  std::size_t keep =
+      not responses_.empty() and next_chunk_ < responses_.back().chunks_size()
+          ? 1
+          : 0;
+  if (responses_.size() <= keep) {
+    return;
+  }
+  // The following chunks may omit the family and column, copy them before
+  // releasing the memory they live in.
+  carried_family_ = *cell_family_;
+  cell_family_ = &carried_family_;
+  carried_column_ = *cell_column_;
+  cell_column_ = &carried_column_;
+  responses_.erase(responses_.begin(),
+                   responses_.end() - static_cast<std::ptrdiff_t>(keep));
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
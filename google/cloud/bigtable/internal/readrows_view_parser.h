@@ -0,0 +1,120 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READROWS_VIEW_PARSER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READROWS_VIEW_PARSER_H_
+
+#include "google/cloud/bigtable/row_view.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <deque>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Transforms a stream of `ReadRowsResponse` messages into `RowView` objects.
+ *
+ * This is the zero-copy version of `ReadRowsParser`.  Instead of moving each
+ * chunk into a `Cell`, the parser keeps the responses and creates `CellView`
+ * objects pointing into them.  Only values split across multiple chunks are
+ * copied, to concatenate them.  The responses are released once all the rows
+ * that refer to them have been consumed.
+ *
+ * A simplified example of correctly using this class:
+ *
+ * @code
+ * while (true) {
+ *   while (parser.NextRow(status)) {
+ *     Use(parser.row());  // valid until the next call to NextRow()
+ *   }
+ *   if (not status.ok() or not stream.Read(&response)) break;
+ *   parser.HandleResponse(std::move(response));
+ * }
+ * parser.HandleEndOfStream(status);
+ * @endcode
+ *
+ * Like `ReadRowsParser`, a new parser must be used for each stream.
+ */
+class ReadRowsViewParser {
+ public:
+  ReadRowsViewParser();
+
+  /// Take ownership of @p response, its chunks are parsed by `NextRow()`.
+  void HandleResponse(google::bigtable::v2::ReadRowsResponse response);
+
+  /**
+   * Parse the chunks received so far until a row is complete.
+   *
+   * Invalidates the previous value of `row()`.
+   *
+   * @return true if `row()` contains a new row, false if more data is needed
+   *     or if there was an error, in which case @p status is not OK.
+   */
+  bool NextRow(grpc::Status& status);
+
+  /// The last row returned by `NextRow()`.
+  RowView const& row() const { return row_; }
+
+  /// Signal that the input stream reached the end.
+  void HandleEndOfStream(grpc::Status& status);
+
+ private:
+  void HandleChunk(
+      google::bigtable::v2::ReadRowsResponse_CellChunk const& chunk,
+      grpc::Status& status);
+
+  /// Release the data of the last row returned by `NextRow()`.
+  void ReleaseRow();
+
+  /// Release the responses that are no longer referenced.
+  void ReleaseResponses();
+
+  /// The responses referenced by the current row, and the next chunk to parse.
+  std::deque<google::bigtable::v2::ReadRowsResponse> responses_;
+  int next_chunk_;
+
+  /// Values split across multiple chunks are concatenated here.
+  std::deque<std::string> values_;
+
+  /// The family and column may be omitted in chunks, they are copied here
+  /// when the responses containing them are released.
+  std::string carried_family_;
+  std::string carried_column_;
+
+  /// The fields of the current (maybe partial) cell.
+  std::string const* cell_row_key_;
+  std::string const* cell_family_;
+  std::string const* cell_column_;
+  std::int64_t cell_timestamp_;
+  std::string const* cell_value_;
+  google::protobuf::RepeatedPtrField<std::string> const* cell_labels_;
+  bool cell_first_chunk_;
+
+  /// The current (maybe partial) row.
+  RowView row_;
+  std::string last_seen_row_key_;
+  bool row_ready_;
+  bool end_of_stream_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READROWS_VIEW_PARSER_H_
@@ -0,0 +1,297 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/readrows_view_parser.h"
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+
+using google::bigtable::v2::ReadRowsResponse;
+using google::cloud::bigtable::internal::ReadRowsViewParser;
+
+namespace {
+ReadRowsResponse MakeResponse(std::string const& text) {
+  ReadRowsResponse response;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(text, &response));
+  return response;
+}
+}  // anonymous namespace
+
+TEST(ReadRowsViewParserTest, NoChunksNoRowsSucceeds) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+
+  EXPECT_FALSE(parser.NextRow(status));
+  EXPECT_TRUE(status.ok());
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+}
+
+TEST(ReadRowsViewParserTest, HandleEndOfStreamCalledTwiceFails) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+  parser.HandleEndOfStream(status);
+  EXPECT_FALSE(status.ok());
+}
+
+TEST(ReadRowsViewParserTest, SingleChunkSucceeds) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      timestamp_micros: 42
+      value: "V"
+      labels: "L"
+      commit_row: true
+    >)"));
+
+  ASSERT_TRUE(parser.NextRow(status));
+  EXPECT_TRUE(status.ok());
+  auto const& row = parser.row();
+  EXPECT_EQ("RK", row.row_key());
+  ASSERT_EQ(1U, row.cells().size());
+  auto const& cell = row.cells()[0];
+  EXPECT_EQ("RK", cell.row_key());
+  EXPECT_EQ("F", cell.family_name());
+  EXPECT_EQ("C", cell.column_qualifier());
+  EXPECT_EQ(42, cell.timestamp().count());
+  EXPECT_EQ("V", cell.value());
+  ASSERT_EQ(1, cell.labels().size());
+  EXPECT_EQ("L", cell.labels().Get(0));
+
+  auto copy = row.ToRow();
+  EXPECT_EQ("RK", copy.row_key());
+  ASSERT_EQ(1U, copy.cells().size());
+  EXPECT_EQ("V", copy.cells()[0].value());
+  EXPECT_EQ(42, copy.cells()[0].timestamp().count());
+
+  EXPECT_FALSE(parser.NextRow(status));
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+}
+
+TEST(ReadRowsViewParserTest, CellsShareFamilyAndColumn) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      timestamp_micros: 42
+      value: "V1"
+    >
+    chunks: <
+      timestamp_micros: 41
+      value: "V2"
+    >
+    chunks: <
+      qualifier: < value: "D">
+      timestamp_micros: 40
+      value: "V3"
+      commit_row: true
+    >)"));
+
+  ASSERT_TRUE(parser.NextRow(status));
+  auto const& cells = parser.row().cells();
+  ASSERT_EQ(3U, cells.size());
+  EXPECT_EQ("C", cells[1].column_qualifier());
+  EXPECT_EQ("V2", cells[1].value());
+  EXPECT_EQ("D", cells[2].column_qualifier());
+  EXPECT_EQ("F", cells[2].family_name());
+  // The strings are not copied for each cell.
+  EXPECT_EQ(&cells[0].family_name(), &cells[2].family_name());
+  EXPECT_EQ(&cells[0].column_qualifier(), &cells[1].column_qualifier());
+  EXPECT_EQ(&cells[0].row_key(), &cells[2].row_key());
+}
+
+TEST(ReadRowsViewParserTest, MultipleRowsInOneResponse) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK1"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V1"
+      commit_row: true
+    >
+    chunks: <
+      row_key: "RK2"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V2"
+      commit_row: true
+    >)"));
+
+  ASSERT_TRUE(parser.NextRow(status));
+  EXPECT_EQ("RK1", parser.row().row_key());
+  ASSERT_TRUE(parser.NextRow(status));
+  EXPECT_EQ("RK2", parser.row().row_key());
+  EXPECT_EQ("V2", parser.row().cells().at(0).value());
+  EXPECT_FALSE(parser.NextRow(status));
+  EXPECT_TRUE(status.ok());
+}
+
+TEST(ReadRowsViewParserTest, RowAndValueSpanResponses) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V1"
+    >
+    chunks: <
+      timestamp_micros: 10
+      value: "a"
+      value_size: 3
+    >)"));
+  EXPECT_FALSE(parser.NextRow(status));
+  EXPECT_TRUE(status.ok());
+
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      value: "b"
+      value_size: 3
+    >)"));
+  EXPECT_FALSE(parser.NextRow(status));
+  EXPECT_TRUE(status.ok());
+
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      value: "c"
+      commit_row: true
+    >)"));
+  ASSERT_TRUE(parser.NextRow(status));
+  auto const& cells = parser.row().cells();
+  ASSERT_EQ(2U, cells.size());
+  EXPECT_EQ("V1", cells[0].value());
+  EXPECT_EQ("abc", cells[1].value());
+  EXPECT_EQ("RK", cells[1].row_key());
+  EXPECT_EQ("C", cells[1].column_qualifier());
+  EXPECT_EQ(10, cells[1].timestamp().count());
+}
+
+TEST(ReadRowsViewParserTest, ColumnCarriedAcrossResponses) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK1"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V1"
+      commit_row: true
+    >)"));
+  ASSERT_TRUE(parser.NextRow(status));
+  EXPECT_FALSE(parser.NextRow(status));
+
+  // The family and column are omitted when they do not change, even if the
+  // response that contained them was released.
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK2"
+      value: "V2"
+      commit_row: true
+    >)"));
+  ASSERT_TRUE(parser.NextRow(status));
+  ASSERT_EQ(1U, parser.row().cells().size());
+  EXPECT_EQ("F", parser.row().cells()[0].family_name());
+  EXPECT_EQ("C", parser.row().cells()[0].column_qualifier());
+  EXPECT_EQ("V2", parser.row().cells()[0].value());
+}
+
+TEST(ReadRowsViewParserTest, ResetRowDiscardsCells) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V1"
+    >
+    chunks: <
+      reset_row: true
+    >
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V2"
+      commit_row: true
+    >)"));
+  ASSERT_TRUE(parser.NextRow(status));
+  ASSERT_EQ(1U, parser.row().cells().size());
+  EXPECT_EQ("V2", parser.row().cells()[0].value());
+}
+
+TEST(ReadRowsViewParserTest, RowKeysOutOfOrderFails) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK2"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V"
+      commit_row: true
+    >
+    chunks: <
+      row_key: "RK1"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V"
+      commit_row: true
+    >)"));
+  ASSERT_TRUE(parser.NextRow(status));
+  EXPECT_FALSE(parser.NextRow(status));
+  EXPECT_FALSE(status.ok());
+}
+
+TEST(ReadRowsViewParserTest, EndOfStreamWithUnfinishedRowFails) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V"
+    >)"));
+  EXPECT_FALSE(parser.NextRow(status));
+  EXPECT_TRUE(status.ok());
+  parser.HandleEndOfStream(status);
+  EXPECT_FALSE(status.ok());
+}
+
+TEST(ReadRowsViewParserTest, NewFamilyWithoutQualifierFails) {
+  grpc::Status status;
+  ReadRowsViewParser parser;
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      value: "V"
+      commit_row: true
+    >)"));
+  EXPECT_FALSE(parser.NextRow(status));
+  EXPECT_FALSE(status.ok());
+}
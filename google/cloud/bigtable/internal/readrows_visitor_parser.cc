@@ -0,0 +1,203 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/readrows_visitor_parser.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+using google::bigtable::v2::ReadRowsResponse_CellChunk;
+
+ReadRowsVisitorParser::ReadRowsVisitorParser(RowVisitor& visitor)
+    : visitor_(visitor),
+      cell_family_(&carried_family_),
+      cell_column_(&carried_column_),
+      cell_timestamp_(0),
+      cell_value_(&value_buffer_),
+      cell_labels_(&carried_labels_),
+      cell_first_chunk_(true),
+      has_row_key_(false),
+      row_started_(false),
+      rows_count_(0),
+      end_of_stream_(false) {}
+
+void ReadRowsVisitorParser::HandleResponse(
+    google::bigtable::v2::ReadRowsResponse const& response,
+    grpc::Status& status) {
+  for (auto const& chunk : response.chunks()) {
+    HandleChunk(chunk, status);
+    if (not status.ok()) {
+      return;
+    }
+  }
+  // The following chunks may omit the family and column, or continue a cell,
+  // copy any data they need before the caller releases the response.
+  if (cell_family_ != &carried_family_) {
+    carried_family_ = *cell_family_;
+    cell_family_ = &carried_family_;
+  }
+  if (cell_column_ != &carried_column_) {
+    carried_column_ = *cell_column_;
+    cell_column_ = &carried_column_;
+  }
+  if (not cell_first_chunk_ and cell_labels_ != &carried_labels_) {
+    carried_labels_ = *cell_labels_;
+    cell_labels_ = &carried_labels_;
+  }
+}
+
+void ReadRowsVisitorParser::HandleEndOfStream(grpc::Status& status) {
+  if (end_of_stream_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "HandleEndOfStream called twice");
+    return;
+  }
+  end_of_stream_ = true;
+
+  if (not cell_first_chunk_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "end of stream with unfinished cell");
+    return;
+  }
+
+  if (row_started_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "end of stream with unfinished row");
+    return;
+  }
+}
+
+void ReadRowsVisitorParser::Abort() {
+  if (row_started_) {
+    row_started_ = false;
+    visitor_.OnRowReset();
+  }
+}
+
+void ReadRowsVisitorParser::HandleChunk(ReadRowsResponse_CellChunk const& chunk,
+                                        grpc::Status& status) {
+  if (end_of_stream_) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL,
+                          "HandleChunk after end of stream");
+    return;
+  }
+
+  if (not chunk.row_key().empty()) {
+    if (last_seen_row_key_.compare(chunk.row_key()) >= 0) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Row keys are expected in increasing order");
+      return;
+    }
+    if (row_started_) {
+      if (row_key_ != chunk.row_key()) {
+        status = grpc::Status(grpc::StatusCode::INTERNAL,
+                              "Different row key in cell chunk");
+        return;
+      }
+    } else {
+      row_key_ = chunk.row_key();
+      has_row_key_ = true;
+    }
+  }
+
+  if (chunk.has_family_name()) {
+    if (not chunk.has_qualifier()) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "New column family must specify qualifier");
+      return;
+    }
+    cell_family_ = &chunk.family_name().value();
+  }
+
+  if (chunk.has_qualifier()) {
+    cell_column_ = &chunk.qualifier().value();
+  }
+
+  if (cell_first_chunk_) {
+    cell_timestamp_ = chunk.timestamp_micros();
+    cell_labels_ = &chunk.labels();
+    if (chunk.value_size() == 0) {
+      // Most common case, the value is in a single chunk, refer to it.
+      cell_value_ = &chunk.value();
+    } else {
+      // The value size is a hint about the total size.
+      value_buffer_.clear();
+      value_buffer_.reserve(chunk.value_size());
+      value_buffer_.append(chunk.value());
+      cell_value_ = &value_buffer_;
+    }
+  } else {
+    value_buffer_.append(chunk.value());
+  }
+
+  cell_first_chunk_ = false;
+
+  // Last chunk in the cell has zero for value size
+  if (chunk.value_size() == 0) {
+    if (not has_row_key_) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Missing row key at last chunk in cell");
+      return;
+    }
+    // A reset chunk would complete an empty cell, the other parsers discard
+    // it with the rest of the row, do not deliver it.
+    if (not chunk.reset_row()) {
+      if (not row_started_) {
+        row_started_ = true;
+        visitor_.OnRowStart(row_key_);
+      }
+      visitor_.OnCell(CellView(&row_key_, cell_family_, cell_column_,
+                               cell_timestamp_, cell_value_, cell_labels_));
+    }
+    cell_first_chunk_ = true;
+  }
+
+  if (chunk.reset_row()) {
+    Abort();
+    has_row_key_ = false;
+    carried_family_.clear();
+    cell_family_ = &carried_family_;
+    carried_column_.clear();
+    cell_column_ = &carried_column_;
+    if (not cell_first_chunk_) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Reset row with an unfinished cell");
+      return;
+    }
+  } else if (chunk.commit_row()) {
+    if (not cell_first_chunk_) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Commit row with an unfinished cell");
+      return;
+    }
+    if (not row_started_) {
+      status = grpc::Status(grpc::StatusCode::INTERNAL,
+                            "Commit row missing the row key");
+      return;
+    }
+    row_started_ = false;
+    has_row_key_ = false;
+    ++rows_count_;
+    last_seen_row_key_ = row_key_;
+    visitor_.OnRowEnd();
+  }
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,100 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READROWS_VISITOR_PARSER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READROWS_VISITOR_PARSER_H_
+
+#include "google/cloud/bigtable/row_visitor.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <cstdint>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Transforms a stream of `ReadRowsResponse` messages into `RowVisitor` calls.
+ *
+ * This parser applies the same validation as `ReadRowsParser` and
+ * `ReadRowsViewParser`, but it does not accumulate the cells of a row.  Each
+ * cell is passed to the visitor as soon as its last chunk is parsed, as a
+ * `CellView` pointing into the response.  Only values split across multiple
+ * chunks are copied, into a buffer reused for all the cells.
+ *
+ * Like `ReadRowsParser`, a new parser must be used for each stream.
+ */
+class ReadRowsVisitorParser {
+ public:
+  explicit ReadRowsVisitorParser(RowVisitor& visitor);
+
+  /// Parse all the chunks in @p response, calling the visitor as needed.
+  void HandleResponse(google::bigtable::v2::ReadRowsResponse const& response,
+                      grpc::Status& status);
+
+  /// Signal that the input stream reached the end.
+  void HandleEndOfStream(grpc::Status& status);
+
+  /// Call `OnRowReset()` if a row was started but not committed.
+  void Abort();
+
+  /// The key of the last committed row, empty if there is none.
+  std::string const& last_row_key() const { return last_seen_row_key_; }
+
+  /// The number of committed rows.
+  std::int64_t rows_count() const { return rows_count_; }
+
+ private:
+  void HandleChunk(
+      google::bigtable::v2::ReadRowsResponse_CellChunk const& chunk,
+      grpc::Status& status);
+
+  RowVisitor& visitor_;
+
+  /// The family and column may be omitted in chunks, they are copied here
+  /// before the response containing them is released.
+  std::string carried_family_;
+  std::string carried_column_;
+  google::protobuf::RepeatedPtrField<std::string> carried_labels_;
+
+  /// Values split across multiple chunks are concatenated here.
+  std::string value_buffer_;
+
+  /// The fields of the current (maybe partial) cell.
+  std::string const* cell_family_;
+  std::string const* cell_column_;
+  std::int64_t cell_timestamp_;
+  std::string const* cell_value_;
+  google::protobuf::RepeatedPtrField<std::string> const* cell_labels_;
+  bool cell_first_chunk_;
+
+  /// The key of the current row, valid if `has_row_key_` is true.
+  std::string row_key_;
+  bool has_row_key_;
+  /// True if `OnRowStart()` was called for the current row.
+  bool row_started_;
+
+  std::string last_seen_row_key_;
+  std::int64_t rows_count_;
+  bool end_of_stream_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_READROWS_VISITOR_PARSER_H_
@@ -0,0 +1,309 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/internal/readrows_visitor_parser.h"
+#include "google/cloud/bigtable/row.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <google/protobuf/text_format.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+using google::bigtable::v2::ReadRowsResponse;
+using google::bigtable::v2::ReadRowsResponse_CellChunk;
+using google::cloud::bigtable::internal::ReadRowsVisitorParser;
+
+namespace {
+ReadRowsResponse MakeResponse(std::string const& text) {
+  ReadRowsResponse response;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(text, &response));
+  return response;
+}
+
+/// Record the visitor calls, and build the committed rows.
+class RecordingVisitor : public google::cloud::bigtable::RowVisitor {
+ public:
+  void OnRowStart(std::string const& row_key) override {
+    events.emplace_back("start " + row_key);
+    row_key_ = row_key;
+  }
+  void OnCell(google::cloud::bigtable::CellView const& cell) override {
+    events.emplace_back("cell " + cell.value());
+    cells_.emplace_back(cell.ToCell());
+  }
+  void OnRowEnd() override {
+    events.emplace_back("end");
+    rows.emplace_back(row_key_, std::move(cells_));
+    cells_.clear();
+  }
+  void OnRowReset() override {
+    events.emplace_back("reset");
+    cells_.clear();
+  }
+
+  std::vector<std::string> events;
+  std::vector<google::cloud::bigtable::Row> rows;
+
+ private:
+  std::string row_key_;
+  std::vector<google::cloud::bigtable::Cell> cells_;
+};
+}  // anonymous namespace
+
+TEST(ReadRowsVisitorParserTest, NoChunksNoRowsSucceeds) {
+  grpc::Status status;
+  RecordingVisitor visitor;
+  ReadRowsVisitorParser parser(visitor);
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(visitor.events.empty());
+  EXPECT_EQ(0, parser.rows_count());
+}
+
+TEST(ReadRowsVisitorParserTest, HandleEndOfStreamCalledTwiceFails) {
+  grpc::Status status;
+  RecordingVisitor visitor;
+  ReadRowsVisitorParser parser(visitor);
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+  parser.HandleEndOfStream(status);
+  EXPECT_FALSE(status.ok());
+}
+
+TEST(ReadRowsVisitorParserTest, CellsAreVisitedInOrder) {
+  grpc::Status status;
+  RecordingVisitor visitor;
+  ReadRowsVisitorParser parser(visitor);
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK1"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      timestamp_micros: 42
+      value: "V1"
+      labels: "L"
+    >
+    chunks: <
+      qualifier: < value: "D">
+      value: "V2"
+      commit_row: true
+    >
+    chunks: <
+      row_key: "RK2"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V3"
+      commit_row: true
+    >)"),
+                        status);
+  EXPECT_TRUE(status.ok());
+  parser.HandleEndOfStream(status);
+  EXPECT_TRUE(status.ok());
+
+  EXPECT_THAT(visitor.events,
+              ::testing::ElementsAre("start RK1", "cell V1", "cell V2", "end",
+                                     "start RK2", "cell V3", "end"));
+  ASSERT_EQ(2U, visitor.rows.size());
+  auto const& cells = visitor.rows[0].cells();
+  ASSERT_EQ(2U, cells.size());
+  EXPECT_EQ("RK1", cells[0].row_key());
+  EXPECT_EQ("F", cells[0].family_name());
+  EXPECT_EQ("C", cells[0].column_qualifier());
+  EXPECT_EQ(42, cells[0].timestamp().count());
+  EXPECT_THAT(cells[0].labels(), ::testing::ElementsAre("L"));
+  EXPECT_EQ("F", cells[1].family_name());
+  EXPECT_EQ("D", cells[1].column_qualifier());
+  EXPECT_EQ(2, parser.rows_count());
+  EXPECT_EQ("RK2", parser.last_row_key());
+}
+
+TEST(ReadRowsVisitorParserTest, CellSplitAcrossResponses) {
+  grpc::Status status;
+  RecordingVisitor visitor;
+  ReadRowsVisitorParser parser(visitor);
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      timestamp_micros: 42
+      value: "V1-"
+      value_size: 6
+      labels: "L"
+    >)"),
+                        status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(visitor.events.empty());
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      value: "V2"
+    >
+    chunks: <
+      timestamp_micros: 41
+      value: "V3"
+      commit_row: true
+    >)"),
+                        status);
+  EXPECT_TRUE(status.ok());
+
+  EXPECT_THAT(visitor.events, ::testing::ElementsAre("start RK", "cell V1-V2",
+                                                     "cell V3", "end"));
+  ASSERT_EQ(1U, visitor.rows.size());
+  auto const& cells = visitor.rows[0].cells();
+  ASSERT_EQ(2U, cells.size());
+  EXPECT_THAT(cells[0].labels(), ::testing::ElementsAre("L"));
+  // The family and column were carried from the first response.
+  EXPECT_EQ("F", cells[1].family_name());
+  EXPECT_EQ("C", cells[1].column_qualifier());
+}
+
+TEST(ReadRowsVisitorParserTest, ResetRowCallsOnRowReset) {
+  grpc::Status status;
+  RecordingVisitor visitor;
+  ReadRowsVisitorParser parser(visitor);
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V1"
+    >
+    chunks: <
+      reset_row: true
+    >
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V2"
+      commit_row: true
+    >)"),
+                        status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_THAT(visitor.events,
+              ::testing::ElementsAre("start RK", "cell V1", "reset",
+                                     "start RK", "cell V2", "end"));
+  ASSERT_EQ(1U, visitor.rows.size());
+  EXPECT_EQ(1U, visitor.rows[0].cells().size());
+}
+
+TEST(ReadRowsVisitorParserTest, AbortResetsStartedRow) {
+  grpc::Status status;
+  RecordingVisitor visitor;
+  ReadRowsVisitorParser parser(visitor);
+  parser.HandleResponse(MakeResponse(R"(
+    chunks: <
+      row_key: "RK"
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      value: "V1"
+    >)"),
+                        status);
+  EXPECT_TRUE(status.ok());
+  parser.Abort();
+  parser.Abort();
+  EXPECT_THAT(visitor.events,
+              ::testing::ElementsAre("start RK", "cell V1", "reset"));
+  EXPECT_TRUE(parser.last_row_key().empty());
+}
+
+// **** Acceptance tests helpers ****
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+
+// Can also be used by gtest to print Cell values
+void PrintTo(Cell const& c, std::ostream* os) {
+  *os << "rk: " << std::string(c.row_key()) << "\n";
+  *os << "fm: " << std::string(c.family_name()) << "\n";
+  *os << "qual: " << std::string(c.column_qualifier()) << "\n";
+  *os << "ts: " << c.timestamp().count() << "\n";
+  *os << "value: " << std::string(c.value()) << "\n";
+  *os << "label: ";
+  char const* del = "";
+  for (auto const& label : c.labels()) {
+    *os << del << label;
+    del = ",";
+  }
+  *os << "\n";
+}
+
+std::string CellToString(Cell const& cell) {
+  std::stringstream ss;
+  PrintTo(cell, &ss);
+  return ss.str();
+}
+
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+/// Run the `ReadRowsParser` acceptance tests, with one chunk per response.
+class AcceptanceTest : public ::testing::Test {
+ protected:
+  AcceptanceTest() : parser_(visitor_) {}
+
+  std::vector<std::string> ExtractCells() {
+    std::vector<std::string> cells;
+
+    for (auto const& r : visitor_.rows) {
+      std::transform(r.cells().begin(), r.cells().end(),
+                     std::back_inserter(cells),
+                     google::cloud::bigtable::CellToString);
+    }
+    return cells;
+  }
+
+  std::vector<ReadRowsResponse_CellChunk> ConvertChunks(
+      std::vector<std::string> chunk_strings) {
+    using google::protobuf::TextFormat;
+
+    std::vector<ReadRowsResponse_CellChunk> chunks;
+    for (std::string const& chunk_string : chunk_strings) {
+      ReadRowsResponse_CellChunk chunk;
+      if (not TextFormat::ParseFromString(chunk_string, &chunk)) {
+        return {};
+      }
+      chunks.emplace_back(std::move(chunk));
+    }
+
+    return chunks;
+  }
+
+  void FeedChunks(std::vector<ReadRowsResponse_CellChunk> chunks) {
+    grpc::Status status;
+    for (auto& chunk : chunks) {
+      ReadRowsResponse response;
+      *response.add_chunks() = std::move(chunk);
+      parser_.HandleResponse(response, status);
+      if (not status.ok()) {
+        google::cloud::internal::RaiseRuntimeError(status.error_message());
+      }
+    }
+    parser_.HandleEndOfStream(status);
+    if (not status.ok()) {
+      google::cloud::internal::RaiseRuntimeError(status.error_message());
+    }
+  }
+
+ private:
+  RecordingVisitor visitor_;
+  ReadRowsVisitorParser parser_;
+};
+
+// Auto-generated acceptance tests
+#include "google/cloud/bigtable/internal/readrowsparser_acceptance_tests.inc"
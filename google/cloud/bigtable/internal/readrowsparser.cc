@@ -22,6 +22,19 @@ inline namespace BIGTABLE_CLIENT_NS {
 namespace internal {
 using google::bigtable::v2::ReadRowsResponse_CellChunk;
 
+namespace {
+/// The approximate memory used by @p cell, including its own footprint.
+std::size_t CellBytes(Cell const& cell) {
+  std::size_t bytes = sizeof(Cell) + cell.row_key().size() +
+                      cell.family_name().size() +
+                      cell.column_qualifier().size() + cell.value().size();
+  for (auto const& label : cell.labels()) {
+    bytes += sizeof(label) + label.size();
+  }
+  return bytes;
+}
+}  // namespace
+
 void ReadRowsParser::HandleChunk(ReadRowsResponse_CellChunk chunk,
                                  grpc::Status& status) {
   if (end_of_stream_) {
@@ -95,11 +108,13 @@ void ReadRowsParser::HandleChunk(ReadRowsResponse_CellChunk chunk,
       }
     }
     cells_.emplace_back(MovePartialToCell());
+    cells_bytes_ += CellBytes(cells_.back());
     cell_first_chunk_ = true;
   }
 
   if (chunk.reset_row()) {
     cells_.clear();
+    cells_bytes_ = 0;
     cell_ = {};
     if (not cell_first_chunk_) {
       status = grpc::Status(grpc::StatusCode::INTERNAL,
@@ -156,6 +171,7 @@ Row ReadRowsParser::Next(grpc::Status& status) {
 
   Row row(std::move(row_key_), std::move(cells_));
   row_key_.clear();
+  cells_bytes_ = 0;
 
   return row;
 }
@@ -53,6 +53,7 @@ class ReadRowsParser {
   ReadRowsParser()
       : row_key_(""),
         cells_(),
+        cells_bytes_(0),
         cell_first_chunk_(true),
         cell_(),
         last_seen_row_key_(""),
@@ -97,6 +98,16 @@ class ReadRowsParser {
    */
   virtual Row Next(grpc::Status& status);
 
+  /**
+   * The approximate memory used by the row being assembled, in bytes.
+   *
+   * Includes the completed cells and the partial value of the current cell,
+   * but not the row returned by Next(), which is owned by the caller.
+   */
+  virtual std::size_t buffered_bytes() const {
+    return cells_bytes_ + cell_.value.size();
+  }
+
  private:
   /// Holds partially formed data until a full Row is ready.
   struct ParseCell {
@@ -123,6 +134,9 @@ class ReadRowsParser {
   /// Parsed cells of a yet unfinished row.
   std::vector<Cell> cells_;
 
+  /// The approximate size of `cells_`, in bytes.
+  std::size_t cells_bytes_;
+
   /// Is the next incoming chunk the first in a cell?
   bool cell_first_chunk_;
 
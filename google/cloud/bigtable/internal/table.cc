@@ -14,6 +14,8 @@
 
 #include "google/cloud/bigtable/internal/table.h"
 #include "google/cloud/bigtable/internal/bulk_mutator.h"
+#include "google/cloud/bigtable/internal/normalized_row_set.h"
+#include "google/cloud/bigtable/internal/readrows_visitor_parser.h"
 #include "google/cloud/bigtable/internal/unary_client_utils.h"
 #include "google/cloud/internal/make_unique.h"
 #include <thread>
@@ -25,12 +27,67 @@ namespace google {
 namespace cloud {
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+Row TransformReadModifyWriteRowResponse(
+    btproto::ReadModifyWriteRowResponse& response) {
+  std::vector<bigtable::Cell> cells;
+  auto& row = *response.mutable_row();
+  for (auto& family : *row.mutable_families()) {
+    for (auto& column : *family.mutable_columns()) {
+      for (auto& cell : *column.mutable_cells()) {
+        std::vector<std::string> labels;
+        std::move(cell.mutable_labels()->begin(), cell.mutable_labels()->end(),
+                  std::back_inserter(labels));
+        bigtable::Cell new_cell(row.key(), family.name(), column.qualifier(),
+                                cell.timestamp_micros(),
+                                std::move(*cell.mutable_value()),
+                                std::move(labels));
+
+        cells.emplace_back(std::move(new_cell));
+      }
+    }
+  }
+
+  return Row(std::move(*row.mutable_key()), std::move(cells));
+}
+}  // namespace internal
+
 namespace noex {
 using ClientUtils = bigtable::internal::noex::UnaryClientUtils<DataClient>;
 
 static_assert(std::is_copy_assignable<bigtable::noex::Table>::value,
               "bigtable::noex::Table must be CopyAssignable");
 
+namespace {
+/**
+ * Invalidate the cached copies of the modified rows when a write completes.
+ *
+ * The rows are invalidated even if the write fails, as it may have been
+ * partially applied.
+ */
+class CachedRowInvalidator {
+ public:
+  CachedRowInvalidator(RowCache* cache, std::string const& table_name)
+      : cache_(cache), table_name_(table_name) {}
+  ~CachedRowInvalidator() {
+    for (auto const& key : row_keys_) {
+      cache_->Invalidate(table_name_, key);
+    }
+  }
+
+  void Add(std::string const& row_key) {
+    if (cache_ != nullptr) {
+      row_keys_.push_back(row_key);
+    }
+  }
+
+ private:
+  RowCache* cache_;
+  std::string const& table_name_;
+  std::vector<std::string> row_keys_;
+};
+}  // anonymous namespace
+
 // Call the `google.bigtable.v2.Bigtable.MutateRow` RPC repeatedly until
 // successful, or until the policies in effect tell us to stop.
 std::vector<FailedMutation> Table::Apply(SingleRowMutation&& mut) {
@@ -41,6 +98,12 @@ std::vector<FailedMutation> Table::Apply(SingleRowMutation&& mut) {
   auto backoff_policy = rpc_backoff_policy_->clone();
   auto idempotent_policy = idempotent_mutation_policy_->clone();
 
+  CachedRowInvalidator invalidator(row_cache_.get(), table_name());
+  invalidator.Add(mut.row_key());
+  if (client_timestamp_policy_) {
+    mut.AssignClientTimestamps(client_timestamp_policy_->Now());
+  }
+
   // Build the RPC request, try to minimize copying.
   btproto::MutateRowRequest request;
   bigtable::internal::SetCommonTableOperationRequest<btproto::MutateRowRequest>(
@@ -96,15 +159,45 @@ std::vector<FailedMutation> Table::BulkApply(BulkMutation&& mut,
   auto retry_policy = rpc_retry_policy_->clone();
   auto idemponent_policy = idempotent_mutation_policy_->clone();
 
-  bigtable::internal::BulkMutator mutator(app_profile_id_, table_name_,
-                                          *idemponent_policy,
-                                          std::forward<BulkMutation>(mut));
+  CachedRowInvalidator invalidator(row_cache_.get(), table_name());
+  if (client_timestamp_policy_) {
+    mut.AssignClientTimestamps(client_timestamp_policy_->Now());
+  }
+  if (row_cache_) {
+    // BulkMutation does not expose the row keys, take the entries out to
+    // record them.
+    btproto::MutateRowsRequest entries;
+    mut.MoveTo(&entries);
+    for (auto& entry : *entries.mutable_entries()) {
+      invalidator.Add(entry.row_key());
+      mut.emplace_back(SingleRowMutation(std::move(entry)));
+    }
+  }
+
+  bigtable::internal::BulkMutator mutator(
+      app_profile_id_, table_name_, *idemponent_policy,
+      std::forward<BulkMutation>(mut),
+      bulk_apply_merge_policy_.merge_same_row());
+  // Large batches are split into several concurrent requests, each one needs
+  // its own context.
+  auto make_context = [&backoff_policy, &retry_policy, this]() {
+    auto client_context =
+        google::cloud::internal::make_unique<grpc::ClientContext>();
+    backoff_policy->Setup(*client_context);
+    retry_policy->Setup(*client_context);
+    metadata_update_policy_.Setup(*client_context);
+    return client_context;
+  };
+  auto send = [&mutator, &make_context, this]() {
+    return mutator.MakeRequests(*client_, make_context,
+                                bulk_apply_split_policy_);
+  };
   while (mutator.HasPendingMutations()) {
-    grpc::ClientContext client_context;
-    backoff_policy->Setup(client_context);
-    retry_policy->Setup(client_context);
-    metadata_update_policy_.Setup(client_context);
-    status = mutator.MakeOneRequest(*client_, client_context);
+    if (not bulk_apply_rate_limiter_) {
+      status = send();
+    } else {
+      status = RateLimitedBulkRequest(mutator, send);
+    }
     if (not status.ok() and not retry_policy->OnFailure(status)) {
       break;
     }
@@ -123,6 +216,28 @@ std::vector<FailedMutation> Table::BulkApply(BulkMutation&& mut,
   return failures;
 }
 
+grpc::Status Table::RateLimitedBulkRequest(
+    bigtable::internal::BulkMutator& mutator,
+    std::function<grpc::Status()> const& send) {
+  auto& limiter = *bulk_apply_rate_limiter_;
+  std::this_thread::sleep_for(limiter.Reserve(
+      mutator.pending_mutations_count(), mutator.pending_mutations_bytes(),
+      std::chrono::steady_clock::now()));
+
+  auto start = std::chrono::steady_clock::now();
+  auto status = send();
+  auto now = std::chrono::steady_clock::now();
+  auto throttled = mutator.last_request_throttled_count();
+  if (BulkApplyRateLimiter::IsThrottlingError(status.error_code())) {
+    // The whole request was rejected.
+    throttled = mutator.last_request_count();
+  }
+  limiter.OnResult(
+      mutator.last_request_count(), throttled,
+      std::chrono::duration_cast<std::chrono::microseconds>(now - start), now);
+  return status;
+}
+
 RowReader Table::ReadRows(RowSet row_set, Filter filter, bool raise_on_error) {
   return RowReader(client_, app_profile_id_, table_name_, std::move(row_set),
                    RowReader::NO_ROWS_LIMIT, std::move(filter),
@@ -143,8 +258,137 @@ RowReader Table::ReadRows(RowSet row_set, std::int64_t rows_limit,
                    raise_on_error);
 }
 
+RowViewReader Table::ReadRowViews(RowSet row_set, std::int64_t rows_limit,
+                                  Filter filter, bool raise_on_error) {
+  return RowViewReader(client_, app_profile_id_, table_name_,
+                       std::move(row_set), rows_limit, std::move(filter),
+                       rpc_retry_policy_->clone(), rpc_backoff_policy_->clone(),
+                       metadata_update_policy_, raise_on_error);
+}
+
+grpc::Status Table::VisitRows(RowSet row_set, std::int64_t rows_limit,
+                              Filter filter, RowVisitor& visitor) {
+  auto retry_policy = rpc_retry_policy_->clone();
+  auto backoff_policy = rpc_backoff_policy_->clone();
+  internal::NormalizedRowSet remaining(row_set);
+  auto const filter_proto = filter.as_proto();
+  std::int64_t rows_count = 0;
+  std::string last_read_row_key;
+  while (true) {
+    btproto::ReadRowsRequest request;
+    internal::SetCommonTableOperationRequest<btproto::ReadRowsRequest>(
+        request, app_profile_id_.get(), table_name_.get());
+    remaining.CopyTo(*request.mutable_rows());
+    *request.mutable_filter() = filter_proto;
+    if (rows_limit != RowReader::NO_ROWS_LIMIT) {
+      request.set_rows_limit(rows_limit - rows_count);
+    }
+
+    grpc::ClientContext context;
+    retry_policy->Setup(context);
+    backoff_policy->Setup(context);
+    metadata_update_policy_.Setup(context);
+    auto stream = client_->ReadRows(&context, request);
+
+    // The responses are parsed as they arrive, the visitor is called directly
+    // from the parser and no `Row` or `RowView` objects are created.
+    internal::ReadRowsVisitorParser parser(visitor);
+    btproto::ReadRowsResponse response;
+    grpc::Status status;
+    while (status.ok() and stream->Read(&response)) {
+      parser.HandleResponse(response, status);
+    }
+    if (status.ok()) {
+      status = stream->Finish();
+      if (status.ok()) {
+        parser.HandleEndOfStream(status);
+      }
+    } else {
+      context.TryCancel();
+      while (stream->Read(&response)) {
+      }
+      (void)stream->Finish();  // ignore errors, report the parser error
+    }
+    rows_count += parser.rows_count();
+    if (not parser.last_row_key().empty()) {
+      last_read_row_key = parser.last_row_key();
+    }
+    if (status.ok()) {
+      return status;
+    }
+    // Any partially delivered row is delivered again on the next attempt.
+    parser.Abort();
+
+    // Same as `RowReader::Advance()`: there is nothing to retry if all the
+    // requested rows have been received.
+    if (rows_limit != RowReader::NO_ROWS_LIMIT and rows_limit <= rows_count) {
+      return status;
+    }
+    if (not last_read_row_key.empty()) {
+      remaining.ResumeAfter(last_read_row_key);
+    }
+    if (remaining.IsEmpty()) {
+      return status;
+    }
+    if (not retry_policy->OnFailure(status)) {
+      return status;
+    }
+    auto delay = backoff_policy->OnCompletion(status);
+    std::this_thread::sleep_for(delay);
+  }
+}
+
 std::pair<bool, Row> Table::ReadRow(std::string row_key, Filter filter,
                                     grpc::Status& status) {
+  if (not row_cache_) {
+    return ReadRowImpl(std::move(row_key), std::move(filter), status);
+  }
+  auto key = RowCache::MakeKey(table_name(), row_key, filter);
+  std::pair<bool, Row> result(false, Row("", {}));
+  std::uint64_t generation;
+  if (row_cache_->Lookup(key, result, generation)) {
+    status = grpc::Status::OK;
+    return result;
+  }
+  result = ReadRowImpl(std::move(row_key), std::move(filter), status);
+  if (status.ok()) {
+    row_cache_->Insert(std::move(key), result, generation);
+  }
+  return result;
+}
+
+std::pair<bool, Row> Table::ReadRowImpl(std::string row_key, Filter filter,
+                                        grpc::Status& status) {
+  if (read_row_coalescer_) {
+    std::pair<bool, Row> result(false, Row("", {}));
+    auto read_batch = [this](std::vector<std::string> const& row_keys,
+                             Filter const& filter,
+                             std::function<void(Row)> const& on_row) {
+      RowSet row_set;
+      for (auto const& key : row_keys) {
+        row_set.Append(key);
+      }
+      auto reader = ReadRows(std::move(row_set), filter);
+      for (auto& row : reader) {
+        on_row(std::move(row));
+      }
+      return reader.Finish();
+    };
+    if (read_row_coalescer_->ReadRow(row_key, filter, read_batch, result)) {
+      status = grpc::Status::OK;
+      return result;
+    }
+    // The batch failed before receiving this row, use a separate request with
+    // its own retry policies.
+  }
+  return ReadRowSingle(std::move(row_key), std::move(filter), status);
+}
+
+std::pair<bool, Row> Table::ReadRowSingle(std::string row_key, Filter filter,
+                                          grpc::Status& status) {
+  if (hedging_policy_) {
+    return HedgedReadRow(std::move(row_key), std::move(filter), status);
+  }
   RowSet row_set(std::move(row_key));
   std::int64_t const rows_limit = 1;
   RowReader reader =
@@ -164,10 +408,43 @@ std::pair<bool, Row> Table::ReadRow(std::string row_key, Filter filter,
   return result;
 }
 
+std::pair<bool, Row> Table::HedgedReadRow(std::string row_key, Filter filter,
+                                          grpc::Status& status) {
+  // Run the attempts in a private completion queue, in this thread.
+  CompletionQueue cq;
+  // The hedge is sent on a different channel than the first attempt, so a
+  // slow or broken connection does not delay both.
+  auto const primary = client_->SelectChannel();
+  internal::HedgedReadRow op(
+      hedging_policy_,
+      [this, primary, &row_key, &filter](
+          CompletionQueue& cq, internal::HedgedReadRow::AttemptCallback cb,
+          int attempt) {
+        auto channel = attempt == 0 ? primary
+                                    : internal::HedgeChannel(
+                                          primary, client_->ChannelLoad());
+        return StartAsyncReadRow(
+            cq, std::move(cb), row_key, filter,
+            google::cloud::internal::optional<std::size_t>(channel));
+      },
+      [](CompletionQueue& cq) { cq.Shutdown(); });
+  op.Start(cq);
+  cq.Run();
+
+  status = op.status();
+  if (not status.ok()) {
+    return std::make_pair(false, Row("", {}));
+  }
+  return std::move(op.result());
+}
+
 bool Table::CheckAndMutateRow(std::string row_key, Filter filter,
                               std::vector<Mutation> true_mutations,
                               std::vector<Mutation> false_mutations,
                               grpc::Status& status) {
+  CachedRowInvalidator invalidator(row_cache_.get(), table_name());
+  invalidator.Add(row_key);
+
   btproto::CheckAndMutateRowRequest request;
   request.set_row_key(std::move(row_key));
   bigtable::internal::SetCommonTableOperationRequest<
@@ -190,6 +467,9 @@ bool Table::CheckAndMutateRow(std::string row_key, Filter filter,
 
 Row Table::CallReadModifyWriteRowRequest(
     btproto::ReadModifyWriteRowRequest const& request, grpc::Status& status) {
+  CachedRowInvalidator invalidator(row_cache_.get(), table_name());
+  invalidator.Add(request.row_key());
+
   auto response = ClientUtils::MakeNonIdemponentCall(
       *client_, rpc_retry_policy_->clone(), metadata_update_policy_,
       &DataClient::ReadModifyWriteRow, request, "ReadModifyWriteRowRequest",
@@ -197,26 +477,7 @@ Row Table::CallReadModifyWriteRowRequest(
   if (not status.ok()) {
     return Row("", {});
   }
-
-  std::vector<bigtable::Cell> cells;
-  auto& row = *response.mutable_row();
-  for (auto& family : *row.mutable_families()) {
-    for (auto& column : *family.mutable_columns()) {
-      for (auto& cell : *column.mutable_cells()) {
-        std::vector<std::string> labels;
-        std::move(cell.mutable_labels()->begin(), cell.mutable_labels()->end(),
-                  std::back_inserter(labels));
-        bigtable::Cell new_cell(row.key(), family.name(), column.qualifier(),
-                                cell.timestamp_micros(),
-                                std::move(*cell.mutable_value()),
-                                std::move(labels));
-
-        cells.emplace_back(std::move(new_cell));
-      }
-    }
-  }
-
-  return Row(std::move(*row.mutable_key()), std::move(cells));
+  return bigtable::internal::TransformReadModifyWriteRowResponse(response);
 }
 
 // Call the `google.bigtable.v2.Bigtable.SampleRowKeys` RPC until
@@ -16,18 +16,37 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_INTERNAL_TABLE_H_
 
 #include "google/cloud/bigtable/bigtable_strong_types.h"
+#include "google/cloud/bigtable/bulk_apply_merge_policy.h"
+#include "google/cloud/bigtable/bulk_apply_rate_limiter.h"
+#include "google/cloud/bigtable/bulk_apply_split_policy.h"
+#include "google/cloud/bigtable/client_timestamp_policy.h"
+#include "google/cloud/bigtable/completion_queue.h"
 #include "google/cloud/bigtable/data_client.h"
 #include "google/cloud/bigtable/filters.h"
+#include "google/cloud/bigtable/hedging_policy.h"
 #include "google/cloud/bigtable/idempotent_mutation_policy.h"
+#include "google/cloud/bigtable/internal/async_bulk_apply.h"
+#include "google/cloud/bigtable/internal/async_read_rows.h"
+#include "google/cloud/bigtable/internal/async_retry_unary_rpc.h"
+#include "google/cloud/bigtable/internal/bulk_mutator.h"
+#include "google/cloud/bigtable/internal/hedged_read_row.h"
+#include "google/cloud/bigtable/internal/read_row_coalescer.h"
 #include "google/cloud/bigtable/metadata_update_policy.h"
 #include "google/cloud/bigtable/mutations.h"
 #include "google/cloud/bigtable/read_modify_write_rule.h"
+#include "google/cloud/bigtable/read_row_coalescing_policy.h"
+#include "google/cloud/bigtable/row_cache.h"
 #include "google/cloud/bigtable/row_reader.h"
+#include "google/cloud/bigtable/row_view_reader.h"
+#include "google/cloud/bigtable/row_visitor.h"
 #include "google/cloud/bigtable/row_set.h"
 #include "google/cloud/bigtable/rpc_backoff_policy.h"
 #include "google/cloud/bigtable/rpc_retry_policy.h"
 #include "google/cloud/bigtable/table_strong_types.h"
+#include "google/cloud/internal/optional.h"
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <algorithm>
+#include <functional>
 
 namespace google {
 namespace cloud {
@@ -56,6 +75,46 @@ void SetCommonTableOperationRequest(Request& request,
   request.set_table_name(table_name);
 }
 
+/// Convert the row returned by `ReadModifyWriteRow` to a `bigtable::Row`.
+Row TransformReadModifyWriteRowResponse(
+    google::bigtable::v2::ReadModifyWriteRowResponse& response);
+
+/**
+ * Adapt the callback for `Table::AsyncCheckAndMutateRow()`.
+ *
+ * The application callback receives the `predicate_matched` field, instead of
+ * the full response proto.
+ */
+template <typename Functor>
+struct AsyncCheckAndMutateRowAdapter {
+  void operator()(CompletionQueue& cq,
+                  google::bigtable::v2::CheckAndMutateRowResponse& response,
+                  grpc::Status& status) {
+    callback(cq, response.predicate_matched(), status);
+  }
+  Functor callback;
+};
+
+/**
+ * Adapt the callback for `Table::AsyncReadModifyWriteRow()`.
+ *
+ * The application callback receives a `bigtable::Row`, instead of the full
+ * response proto.
+ */
+template <typename Functor>
+struct AsyncReadModifyWriteRowAdapter {
+  void operator()(CompletionQueue& cq,
+                  google::bigtable::v2::ReadModifyWriteRowResponse& response,
+                  grpc::Status& status) {
+    if (not status.ok()) {
+      callback(cq, Row("", {}), status);
+      return;
+    }
+    callback(cq, TransformReadModifyWriteRowResponse(response), status);
+  }
+  Functor callback;
+};
+
 }  // namespace internal
 
 /// A simple wrapper to represent the response from `Table::SampleRowKeys()`.
@@ -85,7 +144,8 @@ class Table {
             bigtable::DefaultRPCBackoffPolicy(internal::kBigtableLimits)),
         metadata_update_policy_(table_name(), MetadataParamTypes::TABLE_NAME),
         idempotent_mutation_policy_(
-            bigtable::DefaultIdempotentMutationPolicy()) {}
+            bigtable::DefaultIdempotentMutationPolicy()),
+        bulk_apply_merge_policy_(false) {}
 
   Table(std::shared_ptr<DataClient> client, std::string const& table_id)
       : Table(std::move(client), bigtable::AppProfileId(""), table_id) {}
@@ -127,6 +187,12 @@ class Table {
   RowReader ReadRows(RowSet row_set, std::int64_t rows_limit, Filter filter,
                      bool raise_on_error = false);
 
+  RowViewReader ReadRowViews(RowSet row_set, std::int64_t rows_limit,
+                             Filter filter, bool raise_on_error = false);
+
+  grpc::Status VisitRows(RowSet row_set, std::int64_t rows_limit,
+                         Filter filter, RowVisitor& visitor);
+
   std::pair<bool, Row> ReadRow(std::string row_key, Filter filter,
                                grpc::Status& status);
 
@@ -171,6 +237,189 @@ class Table {
 
   //@}
 
+  //@{
+  /**
+   * @name Asynchronous versions of Table::*
+   *
+   * These functions start the operation and return immediately, the result is
+   * delivered to a callback in one of the threads running `cq.Run()`.  They
+   * use the same retry, backoff and idempotency policies as their synchronous
+   * counterparts, but the backoff is implemented with timers in @p cq, so no
+   * thread is blocked while the operation is pending.  The returned
+   * `AsyncOperation` can be used to cancel the operation.
+   */
+  /**
+   * Asynchronously apply a single row mutation.
+   *
+   * @tparam Functor the callback type, it must be invocable as
+   *     `void(CompletionQueue&, google::bigtable::v2::MutateRowResponse&,
+   *     grpc::Status&)`.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncApply(SingleRowMutation&& mut,
+                                             CompletionQueue& cq,
+                                             Functor&& callback) {
+    google::bigtable::v2::MutateRowRequest request;
+    bigtable::internal::SetCommonTableOperationRequest<
+        google::bigtable::v2::MutateRowRequest>(request, app_profile_id_.get(),
+                                                table_name_.get());
+    mut.MoveTo(request);
+    auto idempotent_policy = idempotent_mutation_policy_->clone();
+    bool const is_idempotent = std::all_of(
+        request.mutations().begin(), request.mutations().end(),
+        [&idempotent_policy](google::bigtable::v2::Mutation const& m) {
+          return idempotent_policy->is_idempotent(m);
+        });
+    return bigtable::internal::StartAsyncRetryUnaryRpc(
+        cq, "Table::AsyncApply", rpc_retry_policy_->clone(),
+        rpc_backoff_policy_->clone(), is_idempotent, metadata_update_policy_,
+        client_, &DataClient::AsyncMutateRow, std::move(request),
+        std::forward<Functor>(callback));
+  }
+
+  /**
+   * Asynchronously apply mutations to multiple rows.
+   *
+   * @tparam Functor the callback type, it must be invocable as
+   *     `void(CompletionQueue&, std::vector<FailedMutation>&, grpc::Status&)`.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncBulkApply(BulkMutation&& mut,
+                                                 CompletionQueue& cq,
+                                                 Functor&& callback) {
+    auto idempotent_policy = idempotent_mutation_policy_->clone();
+    auto op = std::make_shared<bigtable::internal::AsyncRetryBulkApply<
+        typename std::decay<Functor>::type>>(
+        rpc_retry_policy_->clone(), rpc_backoff_policy_->clone(),
+        *idempotent_policy, metadata_update_policy_, client_, app_profile_id_,
+        table_name_, std::forward<BulkMutation>(mut),
+        std::forward<Functor>(callback));
+    return op->Start(cq);
+  }
+
+  /**
+   * Asynchronously read a set of rows from the table.
+   *
+   * @tparam RowFunctor the type of the callback for each row, it must be
+   *     invocable as `void(CompletionQueue&, Row)`.
+   * @tparam FinishFunctor the type of the callback for the final status, it
+   *     must be invocable as `void(CompletionQueue&, grpc::Status&)`.
+   */
+  template <typename RowFunctor, typename FinishFunctor>
+  std::shared_ptr<AsyncOperation> AsyncReadRows(CompletionQueue& cq,
+                                                RowFunctor&& on_row,
+                                                FinishFunctor&& on_finish,
+                                                RowSet row_set,
+                                                std::int64_t rows_limit,
+                                                Filter filter) {
+    return MakeAsyncRowReader(std::forward<RowFunctor>(on_row),
+                              std::forward<FinishFunctor>(on_finish),
+                              std::move(row_set), rows_limit, std::move(filter))
+        ->Start(cq);
+  }
+
+  /**
+   * Asynchronously read a single row from the table.
+   *
+   * @tparam Functor the callback type, it must be invocable as
+   *     `void(CompletionQueue&, std::pair<bool, Row>, grpc::Status&)`.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncReadRow(CompletionQueue& cq,
+                                               Functor&& callback,
+                                               std::string row_key,
+                                               Filter filter) {
+    return StartAsyncReadRow(cq, std::forward<Functor>(callback),
+                             std::move(row_key), std::move(filter),
+                             google::cloud::internal::optional<std::size_t>());
+  }
+
+  /**
+   * Asynchronous atomic test-and-set for a row using filter expressions.
+   *
+   * The operation is not idempotent, therefore it is never retried.
+   *
+   * @tparam Functor the callback type, it must be invocable as
+   *     `void(CompletionQueue&, bool, grpc::Status&)`, the second argument
+   *     is true if the predicate matched.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncCheckAndMutateRow(
+      std::string row_key, Filter filter, std::vector<Mutation> true_mutations,
+      std::vector<Mutation> false_mutations, CompletionQueue& cq,
+      Functor&& callback) {
+    google::bigtable::v2::CheckAndMutateRowRequest request;
+    request.set_row_key(std::move(row_key));
+    bigtable::internal::SetCommonTableOperationRequest<
+        google::bigtable::v2::CheckAndMutateRowRequest>(
+        request, app_profile_id_.get(), table_name_.get());
+    *request.mutable_predicate_filter() = filter.as_proto_move();
+    for (auto& m : true_mutations) {
+      *request.add_true_mutations() = std::move(m.op);
+    }
+    for (auto& m : false_mutations) {
+      *request.add_false_mutations() = std::move(m.op);
+    }
+    using Adapter = bigtable::internal::AsyncCheckAndMutateRowAdapter<
+        typename std::decay<Functor>::type>;
+    return bigtable::internal::StartAsyncRetryUnaryRpc(
+        cq, "Table::AsyncCheckAndMutateRow", rpc_retry_policy_->clone(),
+        rpc_backoff_policy_->clone(), false, metadata_update_policy_, client_,
+        &DataClient::AsyncCheckAndMutateRow, std::move(request),
+        Adapter{std::forward<Functor>(callback)});
+  }
+
+  /**
+   * Asynchronously read and modify a row in the server.
+   *
+   * The operation is not idempotent, therefore it is never retried.
+   *
+   * @tparam Functor the callback type, it must be invocable as
+   *     `void(CompletionQueue&, Row, grpc::Status&)`.
+   */
+  template <typename Functor, typename... Args>
+  std::shared_ptr<AsyncOperation> AsyncReadModifyWriteRow(
+      std::string row_key, CompletionQueue& cq, Functor&& callback,
+      bigtable::ReadModifyWriteRule rule, Args&&... rules) {
+    ::google::bigtable::v2::ReadModifyWriteRowRequest request;
+    request.set_row_key(std::move(row_key));
+    bigtable::internal::SetCommonTableOperationRequest<
+        ::google::bigtable::v2::ReadModifyWriteRowRequest>(
+        request, app_profile_id_.get(), table_name_.get());
+    static_assert(
+        bigtable::internal::conjunction<
+            std::is_convertible<Args, bigtable::ReadModifyWriteRule>...>::value,
+        "The arguments passed to AsyncReadModifyWriteRow(row_key,...) must be "
+        "convertible to bigtable::ReadModifyWriteRule");
+    *request.add_rules() = rule.as_proto_move();
+    AddRules(request, std::forward<Args>(rules)...);
+    return StartAsyncReadModifyWriteRow(std::move(request), cq,
+                                        std::forward<Functor>(callback));
+  }
+
+  /**
+   * Asynchronously read and modify a row, with rules known only at run-time.
+   *
+   * @tparam Functor the callback type, it must be invocable as
+   *     `void(CompletionQueue&, Row, grpc::Status&)`.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncReadModifyWriteRow(
+      std::string row_key, CompletionQueue& cq, Functor&& callback,
+      std::vector<bigtable::ReadModifyWriteRule> rules) {
+    ::google::bigtable::v2::ReadModifyWriteRowRequest request;
+    request.set_row_key(std::move(row_key));
+    bigtable::internal::SetCommonTableOperationRequest<
+        ::google::bigtable::v2::ReadModifyWriteRowRequest>(
+        request, app_profile_id_.get(), table_name_.get());
+    for (auto& rule : rules) {
+      *request.add_rules() = rule.as_proto_move();
+    }
+    return StartAsyncReadModifyWriteRow(std::move(request), cq,
+                                        std::forward<Functor>(callback));
+  }
+  //@}
+
  private:
   //@{
   /// @name Helper functions to implement constructors with changed policies.
@@ -186,6 +435,35 @@ class Table {
     idempotent_mutation_policy_ = policy.clone();
   }
 
+  void ChangePolicy(HedgingPolicy& policy) {
+    hedging_policy_ = policy.clone();
+  }
+
+  void ChangePolicy(RowCache& cache) {
+    row_cache_ = std::make_shared<RowCache>(cache);
+  }
+
+  void ChangePolicy(BulkApplyRateLimiter& limiter) {
+    bulk_apply_rate_limiter_ = std::make_shared<BulkApplyRateLimiter>(limiter);
+  }
+
+  void ChangePolicy(BulkApplySplitPolicy& policy) {
+    bulk_apply_split_policy_ = policy;
+  }
+
+  void ChangePolicy(BulkApplyMergePolicy& policy) {
+    bulk_apply_merge_policy_ = policy;
+  }
+
+  void ChangePolicy(ClientTimestampPolicy& policy) {
+    client_timestamp_policy_ = std::make_shared<ClientTimestampPolicy>(policy);
+  }
+
+  void ChangePolicy(ReadRowCoalescingPolicy& policy) {
+    read_row_coalescer_ =
+        std::make_shared<bigtable::internal::ReadRowCoalescer>(policy);
+  }
+
   template <typename Policy, typename... Policies>
   void ChangePolicies(Policy&& policy, Policies&&... policies) {
     ChangePolicy(policy);
@@ -194,6 +472,65 @@ class Table {
   void ChangePolicies() {}
   //@}
 
+  /// Implement `ReadRow()` without the cache, maybe coalescing the calls.
+  std::pair<bool, Row> ReadRowImpl(std::string row_key, Filter filter,
+                                   grpc::Status& status);
+
+  /// Implement `ReadRow()` without coalescing or caching.
+  std::pair<bool, Row> ReadRowSingle(std::string row_key, Filter filter,
+                                     grpc::Status& status);
+
+  /// Implement `ReadRow()` when the table has a hedging policy.
+  std::pair<bool, Row> HedgedReadRow(std::string row_key, Filter filter,
+                                     grpc::Status& status);
+
+  /// Create the operation for `AsyncReadRows()`, without starting it.
+  template <typename RowFunctor, typename FinishFunctor>
+  std::shared_ptr<bigtable::internal::AsyncRowReader<
+      typename std::decay<RowFunctor>::type,
+      typename std::decay<FinishFunctor>::type>>
+  MakeAsyncRowReader(RowFunctor&& on_row, FinishFunctor&& on_finish,
+                     RowSet row_set, std::int64_t rows_limit, Filter filter) {
+    return std::make_shared<bigtable::internal::AsyncRowReader<
+        typename std::decay<RowFunctor>::type,
+        typename std::decay<FinishFunctor>::type>>(
+        client_, app_profile_id_, table_name_, std::move(row_set), rows_limit,
+        std::move(filter), rpc_retry_policy_->clone(),
+        rpc_backoff_policy_->clone(), metadata_update_policy_,
+        google::cloud::internal::make_unique<
+            bigtable::internal::ReadRowsParserFactory>(),
+        std::forward<RowFunctor>(on_row),
+        std::forward<FinishFunctor>(on_finish));
+  }
+
+  /// Implement `AsyncReadRow()`, on the channel at @p channel if set.
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> StartAsyncReadRow(
+      CompletionQueue& cq, Functor&& callback, std::string row_key,
+      Filter filter, google::cloud::internal::optional<std::size_t> channel) {
+    using Adapter = bigtable::internal::AsyncReadRowAdapter<
+        typename std::decay<Functor>::type>;
+    auto adapter = std::make_shared<Adapter>(std::forward<Functor>(callback));
+    std::int64_t const rows_limit = 1;
+    auto op = MakeAsyncRowReader(
+        [adapter](CompletionQueue&, Row row) {
+          adapter->OnRow(std::move(row));
+        },
+        [adapter](CompletionQueue& cq, grpc::Status& status) {
+          adapter->OnFinish(cq, status);
+        },
+        RowSet(std::move(row_key)), rows_limit, std::move(filter));
+    if (channel) {
+      op->PinToChannel(*channel);
+    }
+    return op->Start(cq);
+  }
+
+  /// Make one `BulkApply()` request, paced by the rate limiter.
+  grpc::Status RateLimitedBulkRequest(
+      bigtable::internal::BulkMutator& mutator,
+      std::function<grpc::Status()> const& send);
+
   /**
    * Send request ReadModifyWriteRowRequest to modify the row and get it back
    */
@@ -214,6 +551,19 @@ class Table {
       std::function<void(bigtable::RowKeySample)> const& inserter,
       std::function<void()> const& clearer, grpc::Status& status);
 
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> StartAsyncReadModifyWriteRow(
+      ::google::bigtable::v2::ReadModifyWriteRowRequest request,
+      CompletionQueue& cq, Functor&& callback) {
+    using Adapter = bigtable::internal::AsyncReadModifyWriteRowAdapter<
+        typename std::decay<Functor>::type>;
+    return bigtable::internal::StartAsyncRetryUnaryRpc(
+        cq, "Table::AsyncReadModifyWriteRow", rpc_retry_policy_->clone(),
+        rpc_backoff_policy_->clone(), false, metadata_update_policy_, client_,
+        &DataClient::AsyncReadModifyWriteRow, std::move(request),
+        Adapter{std::forward<Functor>(callback)});
+  }
+
   void AddRules(google::bigtable::v2::ReadModifyWriteRowRequest& request) {
     // no-op for empty list
   }
@@ -232,6 +582,13 @@ class Table {
   std::shared_ptr<RPCBackoffPolicy> rpc_backoff_policy_;
   MetadataUpdatePolicy metadata_update_policy_;
   std::shared_ptr<IdempotentMutationPolicy> idempotent_mutation_policy_;
+  std::shared_ptr<HedgingPolicy> hedging_policy_;
+  std::shared_ptr<RowCache> row_cache_;
+  std::shared_ptr<bigtable::internal::ReadRowCoalescer> read_row_coalescer_;
+  std::shared_ptr<BulkApplyRateLimiter> bulk_apply_rate_limiter_;
+  BulkApplySplitPolicy bulk_apply_split_policy_;
+  BulkApplyMergePolicy bulk_apply_merge_policy_;
+  std::shared_ptr<ClientTimestampPolicy> client_timestamp_policy_;
 };
 
 }  // namespace noex
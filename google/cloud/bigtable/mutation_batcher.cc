@@ -0,0 +1,268 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/mutation_batcher.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+// Cloud Bigtable accepts up to 100,000 mutations in a single MutateRows()
+// request, but smaller batches retry faster and spread better across servers.
+std::size_t constexpr DEFAULT_MUTATIONS_PER_BATCH = 1000;
+// Stay well below the default gRPC limit for message sizes (4MiB).
+std::size_t constexpr DEFAULT_SIZE_PER_BATCH = 1024 * 1024;
+auto constexpr DEFAULT_MAX_BATCH_DELAY = std::chrono::milliseconds(10);
+std::size_t constexpr DEFAULT_MAX_BATCHES = 8;
+std::size_t constexpr DEFAULT_MAX_OUTSTANDING_SIZE = 64 * 1024 * 1024;
+}  // anonymous namespace
+
+MutationBatcher::Options::Options()
+    : max_mutations_per_batch_(DEFAULT_MUTATIONS_PER_BATCH),
+      max_size_per_batch_(DEFAULT_SIZE_PER_BATCH),
+      max_batch_delay_(DEFAULT_MAX_BATCH_DELAY),
+      max_batches_(DEFAULT_MAX_BATCHES),
+      max_outstanding_size_(DEFAULT_MAX_OUTSTANDING_SIZE) {}
+
+MutationBatcher::Options& MutationBatcher::Options::SetMaxMutationsPerBatch(
+    std::size_t value) {
+  max_mutations_per_batch_ = std::max<std::size_t>(1U, value);
+  return *this;
+}
+
+MutationBatcher::Options& MutationBatcher::Options::SetMaxSizePerBatch(
+    std::size_t value) {
+  max_size_per_batch_ = std::max<std::size_t>(1U, value);
+  return *this;
+}
+
+MutationBatcher::Options& MutationBatcher::Options::SetMaxBatchDelay(
+    std::chrono::milliseconds value) {
+  max_batch_delay_ = std::max(std::chrono::milliseconds(0), value);
+  return *this;
+}
+
+MutationBatcher::Options& MutationBatcher::Options::SetMaxBatches(
+    std::size_t value) {
+  max_batches_ = std::max<std::size_t>(1U, value);
+  return *this;
+}
+
+MutationBatcher::Options& MutationBatcher::Options::SetMaxOutstandingSize(
+    std::size_t value) {
+  max_outstanding_size_ = std::max<std::size_t>(1U, value);
+  return *this;
+}
+
+MutationBatcher::MutationBatcher(Table table, CompletionQueue cq,
+                                 Options options)
+    : table_(std::move(table)),
+      cq_(std::move(cq)),
+      options_(std::move(options)),
+      current_(0),
+      next_batch_id_(1),
+      outstanding_batches_(0),
+      outstanding_size_(0),
+      timer_(cq_, [this](std::uint64_t batch_id) { OnTimer(batch_id); }) {}
+
+MutationBatcher::~MutationBatcher() {
+  WaitForNoPendingMutations();
+  // The timer callback uses `this`, wait until it runs.
+  timer_.Shutdown();
+}
+
+void MutationBatcher::Apply(SingleRowMutation mut,
+                            CompletionCallback callback) {
+  google::bigtable::v2::MutateRowsRequest::Entry entry;
+  mut.MoveTo(&entry);
+  auto size = static_cast<std::size_t>(entry.ByteSizeLong());
+
+  std::unique_lock<std::mutex> lk(mu_);
+  while (not HasRoomFor(size)) {
+    if (not current_.callbacks.empty() and
+        outstanding_batches_ < options_.max_batches()) {
+      // The current batch cannot take this mutation, but it can be sent.
+      auto batch = TakeCurrentBatch();
+      lk.unlock();
+      SendBatch(std::move(batch));
+      lk.lock();
+      continue;
+    }
+    cv_.wait(lk);
+  }
+
+  if (current_.callbacks.empty()) {
+    current_.deadline =
+        std::chrono::system_clock::now() + options_.max_batch_delay();
+  }
+  current_.mutations.emplace_back(SingleRowMutation(std::move(entry)));
+  current_.callbacks.emplace_back(std::move(callback));
+  current_.size += size;
+  outstanding_size_ += size;
+
+  if (ShouldSendCurrentBatch()) {
+    auto batch = TakeCurrentBatch();
+    lk.unlock();
+    SendBatch(std::move(batch));
+    return;
+  }
+  StartTimerIfNeeded();
+}
+
+void MutationBatcher::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (current_.callbacks.empty()) {
+    return;
+  }
+  current_.flush_requested = true;
+  if (not ShouldSendCurrentBatch()) {
+    // The batch is sent as soon as an outstanding batch completes.
+    return;
+  }
+  auto batch = TakeCurrentBatch();
+  lk.unlock();
+  SendBatch(std::move(batch));
+}
+
+void MutationBatcher::WaitForNoPendingMutations() {
+  Flush();
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] {
+    return outstanding_batches_ == 0 and current_.callbacks.empty();
+  });
+}
+
+bool MutationBatcher::HasRoomFor(std::size_t size) const {
+  // Always accept a mutation when the batcher is empty, otherwise a mutation
+  // larger than the limits would block forever.
+  bool within_budget =
+      outstanding_size_ == 0 or
+      outstanding_size_ + size <= options_.max_outstanding_size();
+  if (current_.callbacks.empty()) {
+    return within_budget;
+  }
+  return within_budget and
+         current_.callbacks.size() < options_.max_mutations_per_batch() and
+         current_.size + size <= options_.max_size_per_batch();
+}
+
+bool MutationBatcher::ShouldSendCurrentBatch() const {
+  if (current_.callbacks.empty() or
+      outstanding_batches_ >= options_.max_batches()) {
+    return false;
+  }
+  return current_.flush_requested or
+         current_.callbacks.size() >= options_.max_mutations_per_batch() or
+         current_.size >= options_.max_size_per_batch();
+}
+
+std::shared_ptr<MutationBatcher::Batch> MutationBatcher::TakeCurrentBatch() {
+  auto batch = std::make_shared<Batch>(std::move(current_));
+  current_ = Batch(next_batch_id_++);
+  ++outstanding_batches_;
+  return batch;
+}
+
+void MutationBatcher::StartTimerIfNeeded() {
+  if (current_.callbacks.empty()) {
+    return;
+  }
+  timer_.StartIfNeeded(current_.deadline, current_.id);
+}
+
+void MutationBatcher::SendBatch(std::shared_ptr<Batch> batch) {
+  table_.AsyncBulkApply(
+      std::move(batch->mutations), cq_,
+      [this, batch](CompletionQueue& cq,
+                    std::vector<FailedMutation>& failures,
+                    grpc::Status& status) {
+        OnBatchComplete(cq, *batch, failures, status);
+      });
+}
+
+void MutationBatcher::OnTimer(std::uint64_t batch_id) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (current_.callbacks.empty()) {
+    return;
+  }
+  if (current_.id != batch_id) {
+    // The batch was sent already, restart the timer for the current batch.
+    StartTimerIfNeeded();
+    return;
+  }
+  current_.flush_requested = true;
+  if (not ShouldSendCurrentBatch()) {
+    return;
+  }
+  auto batch = TakeCurrentBatch();
+  lk.unlock();
+  SendBatch(std::move(batch));
+}
+
+void MutationBatcher::OnBatchComplete(CompletionQueue& cq, Batch& batch,
+                                      std::vector<FailedMutation>& failures,
+                                      grpc::Status& status) {
+  // Mutations that fail with an unknown state are reported with an OK status,
+  // use the status of the request for them, and never report them as OK.
+  auto const unknown =
+      status.ok() ? grpc::Status(grpc::StatusCode::UNKNOWN,
+                                 "the result of the mutation is unknown")
+                  : status;
+  std::vector<grpc::Status> results(batch.callbacks.size());
+  std::vector<bool> failed(batch.callbacks.size());
+  bool unmatched = false;
+  for (auto const& f : failures) {
+    auto index = f.original_index();
+    if (index < 0 or static_cast<std::size_t>(index) >= results.size()) {
+      unmatched = true;
+      continue;
+    }
+    results[static_cast<std::size_t>(index)] =
+        f.status().ok() ? unknown : f.status();
+    failed[static_cast<std::size_t>(index)] = true;
+  }
+  if (unmatched) {
+    // A failure we cannot assign to a callback may belong to any of the
+    // mutations without a reported failure, none of them can be reported as
+    // successful.
+    for (std::size_t i = 0; i != results.size(); ++i) {
+      if (not failed[i]) {
+        results[i] = unknown;
+      }
+    }
+  }
+  for (std::size_t i = 0; i != results.size(); ++i) {
+    batch.callbacks[i](cq, results[i]);
+  }
+
+  std::unique_lock<std::mutex> lk(mu_);
+  --outstanding_batches_;
+  outstanding_size_ -= batch.size;
+  std::shared_ptr<Batch> next;
+  if (ShouldSendCurrentBatch()) {
+    next = TakeCurrentBatch();
+  }
+  cv_.notify_all();
+  lk.unlock();
+  if (next) {
+    SendBatch(std::move(next));
+  }
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,200 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_MUTATION_BATCHER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_MUTATION_BATCHER_H_
+
+#include "google/cloud/bigtable/completion_queue.h"
+#include "google/cloud/bigtable/internal/flush_timer.h"
+#include "google/cloud/bigtable/mutations.h"
+#include "google/cloud/bigtable/table.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Batch single row mutations into `MutateRows()` requests in the background.
+ *
+ * Applications that write many independent rows get much better throughput by
+ * sending them in `BulkApply()` requests, but the code to accumulate the
+ * mutations, decide when to send them, and keep track of the results is
+ * tedious.  This class accepts `SingleRowMutation`s from any number of threads,
+ * coalesces them into batches, and sends each batch with
+ * `Table::AsyncBulkApply()` when:
+ *
+ * - the batch has `max_mutations_per_batch()` mutations, or
+ * - the batch has `max_size_per_batch()` bytes, or
+ * - the oldest mutation in the batch has waited for `max_batch_delay()`.
+ *
+ * To bound the resources used by the batcher, at most `max_batches()` batches
+ * are outstanding at a time, and at most `max_outstanding_size()` bytes of
+ * mutations are held by the batcher.  `Apply()` blocks the calling thread until
+ * there is room for the new mutation.
+ *
+ * The result of each mutation is reported to its own callback, invoked from one
+ * of the threads running the `CompletionQueue`.
+ *
+ * @par Example
+ * @code
+ * bigtable::CompletionQueue cq;
+ * std::thread t([&cq]() { cq.Run(); });
+ * {
+ *   bigtable::MutationBatcher batcher(table, cq);
+ *   for (auto& m : mutations) {
+ *     batcher.Apply(std::move(m), [](bigtable::CompletionQueue&,
+ *                                    grpc::Status& status) {
+ *       if (not status.ok()) { ... }
+ *     });
+ *   }
+ * }  // The destructor waits until all the mutations complete.
+ * cq.Shutdown();
+ * t.join();
+ * @endcode
+ *
+ * @warning The batcher depends on the completion queue to send the batches and
+ *     to receive the results, the application must have one or more threads
+ *     running `cq.Run()`.  For the same reason, calling `Apply()` or
+ *     `WaitForNoPendingMutations()` from a callback running in the completion
+ *     queue may deadlock.
+ */
+class MutationBatcher {
+ public:
+  /// Configure the thresholds used by `MutationBatcher`.
+  class Options {
+   public:
+    Options();
+
+    /// The maximum number of mutations in a single batch.
+    std::size_t max_mutations_per_batch() const {
+      return max_mutations_per_batch_;
+    }
+    Options& SetMaxMutationsPerBatch(std::size_t value);
+
+    /// The maximum size (in bytes) of a single batch.
+    std::size_t max_size_per_batch() const { return max_size_per_batch_; }
+    Options& SetMaxSizePerBatch(std::size_t value);
+
+    /// How long a mutation can wait in an incomplete batch.
+    std::chrono::milliseconds max_batch_delay() const {
+      return max_batch_delay_;
+    }
+    Options& SetMaxBatchDelay(std::chrono::milliseconds value);
+
+    /// The maximum number of batches sent but not completed.
+    std::size_t max_batches() const { return max_batches_; }
+    Options& SetMaxBatches(std::size_t value);
+
+    /// The maximum size (in bytes) of the mutations held by the batcher.
+    std::size_t max_outstanding_size() const { return max_outstanding_size_; }
+    Options& SetMaxOutstandingSize(std::size_t value);
+
+   private:
+    std::size_t max_mutations_per_batch_;
+    std::size_t max_size_per_batch_;
+    std::chrono::milliseconds max_batch_delay_;
+    std::size_t max_batches_;
+    std::size_t max_outstanding_size_;
+  };
+
+  /// The callback invoked with the result of each mutation.
+  using CompletionCallback =
+      std::function<void(CompletionQueue&, grpc::Status&)>;
+
+  MutationBatcher(Table table, CompletionQueue cq, Options options = Options());
+
+  /// Flush any pending mutations and wait until they complete.
+  ~MutationBatcher();
+
+  MutationBatcher(MutationBatcher const&) = delete;
+  MutationBatcher& operator=(MutationBatcher const&) = delete;
+
+  /**
+   * Add @p mut to the current batch.
+   *
+   * Blocks if the batcher already holds `max_outstanding_size()` bytes of
+   * mutations, or if the current batch is full and cannot be sent because
+   * there are `max_batches()` outstanding batches.
+   *
+   * @param mut the mutation, note that this function takes ownership (and then
+   *     discards) the data in the mutation.
+   * @param callback invoked when the mutation completes. The status is OK if
+   *     the mutation was applied, otherwise it contains the error for this
+   *     mutation.
+   */
+  void Apply(SingleRowMutation mut, CompletionCallback callback);
+
+  /// Send the current batch (if any) as soon as possible.
+  void Flush();
+
+  /// Flush the current batch and wait until all the mutations complete.
+  void WaitForNoPendingMutations();
+
+ private:
+  /// The mutations (and their callbacks) accumulated in a single request.
+  struct Batch {
+    explicit Batch(std::uint64_t i) : id(i), size(0), flush_requested(false) {}
+
+    std::uint64_t id;
+    BulkMutation mutations;
+    std::vector<CompletionCallback> callbacks;
+    std::size_t size;
+    std::chrono::system_clock::time_point deadline;
+    bool flush_requested;
+  };
+
+  /// Return true if a mutation of @p size bytes can be added right now.
+  bool HasRoomFor(std::size_t size) const;
+
+  /// Return true if the current batch should be (and can be) sent.
+  bool ShouldSendCurrentBatch() const;
+
+  /// Remove the current batch, the caller must send it.
+  std::shared_ptr<Batch> TakeCurrentBatch();
+
+  /// Start the timer to flush the current batch, if needed.
+  void StartTimerIfNeeded();
+
+  void SendBatch(std::shared_ptr<Batch> batch);
+  void OnTimer(std::uint64_t batch_id);
+  void OnBatchComplete(CompletionQueue& cq, Batch& batch,
+                       std::vector<FailedMutation>& failures,
+                       grpc::Status& status);
+
+  Table table_;
+  CompletionQueue cq_;
+  Options options_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  Batch current_;
+  std::uint64_t next_batch_id_;
+  std::size_t outstanding_batches_;
+  std::size_t outstanding_size_;
+  internal::FlushTimer timer_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_MUTATION_BATCHER_H_
@@ -0,0 +1,233 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/mutation_batcher.h"
+#include "google/cloud/bigtable/testing/mock_async_response_reader.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace google::cloud::testing_util::chrono_literals;
+using namespace ::testing;
+namespace bt = google::cloud::bigtable;
+
+/// Define types and functions used in the tests.
+namespace {
+class MutationBatcherTest : public bigtable::testing::TableTestFixture {
+ protected:
+  MutationBatcherTest()
+      : cq_impl_(std::make_shared<bigtable::testing::MockCompletionQueue>()),
+        cq_(cq_impl_) {}
+
+  /// Simulate a complete MutateRows stream with @p response_count responses.
+  void SimulateStream(int response_count) {
+    cq_impl_->SimulateCompletion(cq_, true);
+    for (int i = 0; i != response_count; ++i) {
+      cq_impl_->SimulateCompletion(cq_, true);
+    }
+    cq_impl_->SimulateCompletion(cq_, false);
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+
+  /// Return a callback that stores the result of a mutation in @p status.
+  bt::MutationBatcher::CompletionCallback Capture(grpc::Status& status,
+                                                  int& count) {
+    return [&status, &count](bigtable::CompletionQueue&, grpc::Status& s) {
+      status = s;
+      ++count;
+    };
+  }
+
+  std::shared_ptr<bigtable::testing::MockCompletionQueue> cq_impl_;
+  bigtable::CompletionQueue cq_;
+};
+
+btproto::MutateRowsResponse MakeResponse(
+    std::vector<std::pair<int, grpc::StatusCode>> const& entries) {
+  btproto::MutateRowsResponse response;
+  for (auto const& kv : entries) {
+    auto& e = *response.add_entries();
+    e.set_index(kv.first);
+    e.mutable_status()->set_code(kv.second);
+  }
+  return response;
+}
+
+auto const MakeReader =
+    bigtable::testing::MakeMockAsyncReader<btproto::MutateRowsResponse,
+                                           btproto::MutateRowsRequest>;
+
+bt::SingleRowMutation MakeMutation(std::string row_key) {
+  return bt::SingleRowMutation(std::move(row_key),
+                               {bt::SetCell("fam", "col", 0_ms, "val")});
+}
+}  // anonymous namespace
+
+/// @test Verify that MutationBatcher sends a batch when it is full.
+TEST_F(MutationBatcherTest, FlushOnMutationCount) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext* context,
+                          btproto::MutateRowsRequest const& request,
+                          grpc::CompletionQueue* cq) {
+        EXPECT_EQ(2, request.entries_size());
+        return MakeReader({MakeResponse({{0, grpc::StatusCode::OK},
+                                         {1, grpc::StatusCode::OK}})},
+                          grpc::Status::OK)(context, request, cq);
+      }));
+
+  grpc::Status s0(grpc::StatusCode::UNKNOWN, "not-set");
+  grpc::Status s1(grpc::StatusCode::UNKNOWN, "not-set");
+  int count = 0;
+  {
+    bt::MutationBatcher batcher(table_, cq_,
+                                bt::MutationBatcher::Options()
+                                    .SetMaxMutationsPerBatch(2)
+                                    .SetMaxBatchDelay(std::chrono::minutes(1)));
+    batcher.Apply(MakeMutation("foo"), Capture(s0, count));
+    batcher.Apply(MakeMutation("bar"), Capture(s1, count));
+    EXPECT_EQ(0, count);
+    SimulateStream(1);
+    EXPECT_EQ(2, count);
+  }
+  EXPECT_TRUE(s0.ok());
+  EXPECT_TRUE(s1.ok());
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that MutationBatcher reports the result of each mutation.
+TEST_F(MutationBatcherTest, PerMutationFailures) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader(
+          {MakeResponse({{0, grpc::StatusCode::OK},
+                         {1, grpc::StatusCode::PERMISSION_DENIED}})},
+          grpc::Status::OK)));
+
+  grpc::Status s0(grpc::StatusCode::UNKNOWN, "not-set");
+  grpc::Status s1(grpc::StatusCode::UNKNOWN, "not-set");
+  int count = 0;
+  {
+    bt::MutationBatcher batcher(
+        table_, cq_, bt::MutationBatcher::Options().SetMaxMutationsPerBatch(2));
+    batcher.Apply(MakeMutation("foo"), Capture(s0, count));
+    batcher.Apply(MakeMutation("bar"), Capture(s1, count));
+    SimulateStream(1);
+  }
+  EXPECT_EQ(2, count);
+  EXPECT_TRUE(s0.ok());
+  EXPECT_EQ(grpc::StatusCode::PERMISSION_DENIED, s1.error_code());
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that mutations that exhaust their retries are not successful.
+TEST_F(MutationBatcherTest, RetriesExhausted) {
+  // Each request fails, the retry policy gives up after the second one.
+  auto const unavailable =
+      grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(MakeReader(
+          {MakeResponse({{0, grpc::StatusCode::UNAVAILABLE},
+                         {1, grpc::StatusCode::UNAVAILABLE}})},
+          unavailable)));
+
+  bt::Table table(client_, kTableId, bt::LimitedErrorCountRetryPolicy(1));
+  grpc::Status s0;
+  grpc::Status s1;
+  int count = 0;
+  {
+    bt::MutationBatcher batcher(
+        table, cq_, bt::MutationBatcher::Options().SetMaxMutationsPerBatch(2));
+    batcher.Apply(MakeMutation("foo"), Capture(s0, count));
+    batcher.Apply(MakeMutation("bar"), Capture(s1, count));
+    SimulateStream(1);
+    // Fire the backoff timer, starting the second request.
+    cq_impl_->SimulateCompletion(cq_, true);
+    SimulateStream(1);
+  }
+  EXPECT_EQ(2, count);
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, s0.error_code());
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, s1.error_code());
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that MutationBatcher sends incomplete batches after a delay.
+TEST_F(MutationBatcherTest, FlushOnDelay) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader({MakeResponse({{0, grpc::StatusCode::OK}})},
+                                  grpc::Status::OK)));
+
+  grpc::Status s0(grpc::StatusCode::UNKNOWN, "not-set");
+  int count = 0;
+  {
+    bt::MutationBatcher batcher(
+        table_, cq_,
+        bt::MutationBatcher::Options().SetMaxMutationsPerBatch(10));
+    batcher.Apply(MakeMutation("foo"), Capture(s0, count));
+    // Only the timer is pending.
+    EXPECT_EQ(1U, cq_impl_->size());
+    // The timer expires and the batch is sent.
+    cq_impl_->SimulateCompletion(cq_, true);
+    SimulateStream(1);
+    EXPECT_EQ(1, count);
+  }
+  EXPECT_TRUE(s0.ok());
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that MutationBatcher limits the number of outstanding batches.
+TEST_F(MutationBatcherTest, LimitOutstandingBatches) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader({MakeResponse({{0, grpc::StatusCode::OK}})},
+                                  grpc::Status::OK)))
+      .WillOnce(Invoke(MakeReader({MakeResponse({{0, grpc::StatusCode::OK}})},
+                                  grpc::Status::OK)));
+
+  grpc::Status s0(grpc::StatusCode::UNKNOWN, "not-set");
+  grpc::Status s1(grpc::StatusCode::UNKNOWN, "not-set");
+  int count = 0;
+  {
+    bt::MutationBatcher batcher(table_, cq_,
+                                bt::MutationBatcher::Options()
+                                    .SetMaxMutationsPerBatch(1)
+                                    .SetMaxBatches(1));
+    batcher.Apply(MakeMutation("foo"), Capture(s0, count));
+    // The second batch is full, but it must wait for the first one.
+    batcher.Apply(MakeMutation("bar"), Capture(s1, count));
+    // The first stream and the timer for the second batch are pending.
+    EXPECT_EQ(2U, cq_impl_->size());
+    SimulateStream(1);
+    EXPECT_EQ(1, count);
+    EXPECT_TRUE(s0.ok());
+    // Completing the first batch sends the second one.
+    SimulateStream(1);
+    EXPECT_EQ(2, count);
+  }
+  EXPECT_TRUE(s1.ok());
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that MutationBatcher::Options rejects zero-sized limits.
+TEST(MutationBatcherOptionsTest, ClampLimits) {
+  auto options = bt::MutationBatcher::Options()
+                     .SetMaxMutationsPerBatch(0)
+                     .SetMaxSizePerBatch(0)
+                     .SetMaxBatches(0)
+                     .SetMaxOutstandingSize(0);
+  EXPECT_EQ(1U, options.max_mutations_per_batch());
+  EXPECT_EQ(1U, options.max_size_per_batch());
+  EXPECT_EQ(1U, options.max_batches());
+  EXPECT_EQ(1U, options.max_outstanding_size());
+}
@@ -41,6 +41,20 @@ Mutation SetCell(std::string family, std::string column, std::string value) {
   return m;
 }
 
+void AssignClientTimestamps(
+    google::protobuf::RepeatedPtrField<google::bigtable::v2::Mutation>&
+        mutations,
+    std::chrono::milliseconds timestamp) {
+  auto const micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(timestamp).count();
+  for (auto& m : mutations) {
+    if (m.has_set_cell() and
+        m.set_cell().timestamp_micros() == ServerSetTimestamp()) {
+      m.mutable_set_cell()->set_timestamp_micros(micros);
+    }
+  }
+}
+
 Mutation DeleteFromColumn(std::string family, std::string column) {
   Mutation m;
   auto& d = *m.op.mutable_delete_from_column();
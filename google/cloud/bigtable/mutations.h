@@ -56,6 +56,18 @@ Mutation SetCell(std::string family, std::string column, std::string value);
  */
 constexpr std::int64_t ServerSetTimestamp() { return -1; }
 
+/**
+ * Replace the server-assigned timestamps in @p mutations with @p timestamp.
+ *
+ * `SetCell()` mutations using `ServerSetTimestamp()` are not idempotent,
+ * assigning the timestamp in the client makes them safe to retry.  The other
+ * mutations are not modified.
+ */
+void AssignClientTimestamps(
+    google::protobuf::RepeatedPtrField<google::bigtable::v2::Mutation>&
+        mutations,
+    std::chrono::milliseconds timestamp);
+
 //@{
 /**
  * @name Create mutations to delete a range of cells from a column.
@@ -256,6 +268,18 @@ class SingleRowMutation {
   // Get the row key.
   std::string const& row_key() const { return row_key_; }
 
+  /**
+   * Set the timestamp of any `SetCell()` mutations that use
+   * `ServerSetTimestamp()` to @p timestamp.
+   *
+   * @see AssignClientTimestamps()
+   */
+  SingleRowMutation& AssignClientTimestamps(
+      std::chrono::milliseconds timestamp) {
+    bigtable::AssignClientTimestamps(ops_, timestamp);
+    return *this;
+  }
+
   friend class Table;
 
   SingleRowMutation(SingleRowMutation&& rhs) = default;
@@ -449,6 +473,22 @@ class BulkMutation {
   /// Return true if there are no mutations in this set.
   bool empty() const { return request_.entries().empty(); }
 
+  /**
+   * Set the timestamp of any `SetCell()` mutations that use
+   * `ServerSetTimestamp()` to @p timestamp.
+   *
+   * This makes the mutations idempotent, so `Table::BulkApply()` retries them
+   * after transient failures.  All the rows receive the same timestamp.
+   *
+   * @see AssignClientTimestamps()
+   */
+  BulkMutation& AssignClientTimestamps(std::chrono::milliseconds timestamp) {
+    for (auto& entry : *request_.mutable_entries()) {
+      bigtable::AssignClientTimestamps(*entry.mutable_mutations(), timestamp);
+    }
+    return *this;
+  }
+
  private:
   template <typename... M>
   void emplace_many(SingleRowMutation&& first, M&&... tail) {
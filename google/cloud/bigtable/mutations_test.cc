@@ -221,6 +221,30 @@ TEST(MutationsTest, MutipleRowMutations) {
   EXPECT_EQ("foo3", request.entries(1).row_key());
 }
 
+/// @test Verify that AssignClientTimestamps() only changes server timestamps.
+TEST(MutationsTest, AssignClientTimestamps) {
+  bigtable::BulkMutation mut(
+      bigtable::SingleRowMutation("foo1",
+                                  {bigtable::SetCell("f", "c", "v1"),
+                                   bigtable::SetCell("f", "c", 2_ms, "v2"),
+                                   bigtable::DeleteFromRow()}),
+      bigtable::SingleRowMutation("foo2", {bigtable::SetCell("f", "c", "v3")}));
+  mut.AssignClientTimestamps(std::chrono::milliseconds(1234));
+
+  google::bigtable::v2::MutateRowsRequest request;
+  mut.MoveTo(&request);
+  ASSERT_EQ(2, request.entries_size());
+  ASSERT_EQ(3, request.entries(0).mutations_size());
+  EXPECT_EQ(1234000,
+            request.entries(0).mutations(0).set_cell().timestamp_micros());
+  EXPECT_EQ(2000,
+            request.entries(0).mutations(1).set_cell().timestamp_micros());
+  EXPECT_TRUE(request.entries(0).mutations(2).has_delete_from_row());
+  ASSERT_EQ(1, request.entries(1).mutations_size());
+  EXPECT_EQ(1234000,
+            request.entries(1).mutations(0).set_cell().timestamp_micros());
+}
+
 /// @test Verify variadic Mutations for SingleRowMutations.
 TEST(MutationsTest, SingleRowMutationMultipleVariadic) {
   std::string const row_key = "row-key-1";
@@ -0,0 +1,355 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/parallel_row_reader.h"
+#include "google/cloud/internal/port_platform.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/**
+ * Read all the rows in @p shard, stop early if @p on_row returns `false`.
+ *
+ * @return the exception raised while reading the rows (if any), the caller
+ *     reports it in a different thread.
+ */
+std::exception_ptr ReadShardRows(Table table, RowSet const& shard,
+                                 Filter const& filter,
+                                 std::function<bool(Row)> const& on_row) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  try {
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    auto reader = table.ReadRows(shard, filter);
+    for (auto& row : reader) {
+      if (not on_row(std::move(row))) {
+        reader.Cancel();
+        break;
+      }
+    }
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  } catch (...) {
+    return std::current_exception();
+  }
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  return nullptr;
+}
+
+/**
+ * Call `work(i)` for each `i` in `[0, count)` using at most @p max_concurrency
+ * threads, including the calling thread.
+ *
+ * A fixed number of workers pick the next index, so the concurrency is bounded
+ * regardless of @p count.  No new work is started after an error.
+ *
+ * @return the first error returned by @p work, if any.
+ */
+std::exception_ptr RunWorkers(
+    std::size_t count, std::size_t max_concurrency,
+    std::function<std::exception_ptr(std::size_t)> const& work) {
+  std::mutex mu;
+  std::size_t next_index = 0;
+  std::exception_ptr error;
+  auto worker = [&] {
+    while (true) {
+      std::size_t index;
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        if (error or next_index == count) {
+          return;
+        }
+        index = next_index++;
+      }
+      auto e = work(index);
+      if (e) {
+        std::lock_guard<std::mutex> lk(mu);
+        if (not error) {
+          error = std::move(e);
+        }
+        return;
+      }
+    }
+  };
+
+  auto const thread_count = (std::min)(max_concurrency, count);
+  std::vector<std::thread> threads;
+  // The calling thread is one of the workers.
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return error;
+}
+}  // anonymous namespace
+
+std::vector<RowSet> ShardRowSet(RowSet const& row_set,
+                                std::vector<RowKeySample> const& samples,
+                                std::size_t shard_count) {
+  // The last sample is typically the empty key, meaning "end of table", it
+  // cannot be used as a split point.
+  std::vector<std::string> keys;
+  keys.reserve(samples.size());
+  for (auto const& sample : samples) {
+    if (not sample.row_key.empty()) {
+      keys.push_back(sample.row_key);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  // Pick evenly spaced samples, the samples are (roughly) evenly spaced by
+  // data size, so the shards are (roughly) the same size.
+  std::vector<std::string> splits;
+  if (not keys.empty()) {
+    for (std::size_t i = 1; i < shard_count; ++i) {
+      auto const& key = keys[i * keys.size() / shard_count];
+      if (splits.empty() or splits.back() != key) {
+        splits.push_back(key);
+      }
+    }
+  }
+
+  std::vector<RowSet> shards;
+  auto add_shard = [&shards, &row_set](RowRange const& range) {
+    auto shard = row_set.Intersect(range);
+    if (not shard.IsEmpty()) {
+      shards.emplace_back(std::move(shard));
+    }
+  };
+  std::string start;
+  for (auto& split : splits) {
+    add_shard(RowRange::RightOpen(start, split));
+    start = std::move(split);
+  }
+  add_shard(RowRange::StartingAt(std::move(start)));
+  return shards;
+}
+
+std::vector<RowSet> ShardRowSet(RowSet const& row_set,
+                                SplitPoints const& split_points) {
+  std::vector<RowSet> shards;
+  for (std::size_t i = 0; i != split_points.shard_count(); ++i) {
+    auto shard = row_set.Intersect(split_points.ShardRange(i));
+    if (not shard.IsEmpty()) {
+      shards.emplace_back(std::move(shard));
+    }
+  }
+  return shards;
+}
+
+void ReadRowsParallel(Table const& table, std::vector<RowSet> const& shards,
+                      Filter const& filter,
+                      std::function<void(std::size_t, Row)> const& on_row,
+                      std::size_t max_concurrency) {
+  auto error = RunWorkers(
+      shards.size(), (std::max)(max_concurrency, std::size_t(1)),
+      [&table, &shards, &filter, &on_row](std::size_t i) {
+        return ReadShardRows(table, shards[i], filter, [&on_row, i](Row r) {
+          on_row(i, std::move(r));
+          return true;
+        });
+      });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+std::size_t constexpr MultiGetOptions::DEFAULT_MAX_KEYS_PER_REQUEST;
+std::size_t constexpr MultiGetOptions::DEFAULT_MAX_BYTES_PER_REQUEST;
+std::size_t constexpr MultiGetOptions::DEFAULT_MAX_CONCURRENCY;
+
+std::vector<std::vector<std::string>> SplitRowKeys(
+    std::vector<std::string> row_keys, MultiGetOptions const& options) {
+  std::sort(row_keys.begin(), row_keys.end());
+  row_keys.erase(std::unique(row_keys.begin(), row_keys.end()),
+                 row_keys.end());
+
+  std::vector<std::vector<std::string>> batches;
+  std::size_t batch_bytes = 0;
+  for (auto& key : row_keys) {
+    bool const full =
+        not batches.empty() and
+        (batches.back().size() >= options.max_keys_per_request() or
+         batch_bytes + key.size() > options.max_bytes_per_request());
+    if (batches.empty() or full) {
+      batches.emplace_back();
+      batch_bytes = 0;
+    }
+    batch_bytes += key.size();
+    batches.back().emplace_back(std::move(key));
+  }
+  return batches;
+}
+
+std::vector<Row> MultiGet(Table const& table, std::vector<std::string> row_keys,
+                          Filter const& filter,
+                          MultiGetOptions const& options) {
+  auto const batches = SplitRowKeys(std::move(row_keys), options);
+  std::vector<std::vector<Row>> results(batches.size());
+
+  auto error = RunWorkers(
+      batches.size(), options.max_concurrency(),
+      [&table, &filter, &batches, &results](std::size_t index) {
+        RowSet row_set;
+        for (auto const& key : batches[index]) {
+          row_set.Append(key);
+        }
+        auto& rows = results[index];
+        rows.reserve(batches[index].size());
+        return ReadShardRows(table, row_set, filter, [&rows](Row r) {
+          rows.emplace_back(std::move(r));
+          return true;
+        });
+      });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  std::vector<Row> result;
+  std::size_t total = 0;
+  for (auto const& rows : results) {
+    total += rows.size();
+  }
+  result.reserve(total);
+  for (auto& rows : results) {
+    std::move(rows.begin(), rows.end(), std::back_inserter(result));
+  }
+  return result;
+}
+
+std::map<std::string, Row> MultiGetMap(Table const& table,
+                                       std::vector<std::string> row_keys,
+                                       Filter const& filter,
+                                       MultiGetOptions const& options) {
+  std::map<std::string, Row> result;
+  for (auto& row : MultiGet(table, std::move(row_keys), filter, options)) {
+    // The rows are sorted, insert them at the end of the map.
+    auto key = row.row_key();
+    result.emplace_hint(result.end(), std::move(key), std::move(row));
+  }
+  return result;
+}
+
+std::size_t constexpr ParallelRowReader::DEFAULT_MAX_BUFFERED_ROWS;
+std::size_t constexpr ParallelRowReader::DEFAULT_MAX_CONCURRENCY;
+
+ParallelRowReader::ParallelRowReader(Table const& table,
+                                     std::vector<RowSet> shards, Filter filter,
+                                     std::size_t max_buffered_rows,
+                                     std::size_t max_concurrency)
+    : shards_(std::move(shards)),
+      filter_(std::move(filter)),
+      max_buffered_rows_(std::max<std::size_t>(1U, max_buffered_rows)),
+      state_(shards_.size()),
+      current_shard_(0),
+      next_shard_(0),
+      cancelled_(false) {
+  auto const thread_count =
+      (std::min)(std::max<std::size_t>(1U, max_concurrency), shards_.size());
+  threads_.reserve(thread_count);
+  for (std::size_t i = 0; i != thread_count; ++i) {
+    threads_.emplace_back(&ParallelRowReader::Worker, this, table);
+  }
+}
+
+ParallelRowReader::ParallelRowReader(Table table, RowSet const& row_set,
+                                     std::size_t shard_count, Filter filter,
+                                     std::size_t max_concurrency)
+    : ParallelRowReader(table,
+                        ShardRowSet(row_set, table.SampleRows(), shard_count),
+                        std::move(filter), DEFAULT_MAX_BUFFERED_ROWS,
+                        max_concurrency) {}
+
+ParallelRowReader::~ParallelRowReader() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    cancelled_ = true;
+    for (auto& shard : state_) {
+      shard.has_room.notify_all();
+    }
+  }
+  for (auto& t : threads_) {
+    t.join();
+  }
+}
+
+void ParallelRowReader::Worker(Table const& table) {
+  while (true) {
+    std::size_t index;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (cancelled_ or next_shard_ == shards_.size()) {
+        return;
+      }
+      index = next_shard_++;
+    }
+    ReadShard(table, index);
+  }
+}
+
+void ParallelRowReader::ReadShard(Table const& table, std::size_t index) {
+  auto& shard = state_[index];
+  auto error = ReadShardRows(
+      table, shards_[index], filter_, [this, index, &shard](Row r) {
+        std::unique_lock<std::mutex> lk(mu_);
+        shard.has_room.wait(lk, [this, &shard] {
+          return cancelled_ or shard.rows.size() < max_buffered_rows_;
+        });
+        if (cancelled_) {
+          return false;
+        }
+        shard.rows.emplace_back(std::move(r));
+        if (index == current_shard_) {
+          cv_.notify_one();
+        }
+        return true;
+      });
+  std::lock_guard<std::mutex> lk(mu_);
+  shard.done = true;
+  shard.error = std::move(error);
+  cv_.notify_one();
+}
+
+internal::OptionalRow ParallelRowReader::Next() {
+  std::unique_lock<std::mutex> lk(mu_);
+  while (current_shard_ < state_.size()) {
+    auto& shard = state_[current_shard_];
+    cv_.wait(lk, [&shard] { return not shard.rows.empty() or shard.done; });
+    if (not shard.rows.empty()) {
+      internal::OptionalRow row(std::move(shard.rows.front()));
+      shard.rows.pop_front();
+      shard.has_room.notify_one();
+      return row;
+    }
+    // The shard is done, move to the next one, reporting any errors.
+    ++current_shard_;
+    if (shard.error) {
+      auto error = std::move(shard.error);
+      shard.error = nullptr;
+      lk.unlock();
+      std::rethrow_exception(error);
+    }
+  }
+  return internal::OptionalRow();
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,305 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_PARALLEL_ROW_READER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_PARALLEL_ROW_READER_H_
+
+#include "google/cloud/bigtable/split_point_cache.h"
+#include "google/cloud/bigtable/table.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Split @p row_set into (at most) @p shard_count disjoint row sets.
+ *
+ * The split points are chosen from the row keys returned by
+ * `Table::SampleRows()`, so each shard covers roughly the same amount of data.
+ * The shards are returned in row key order, i.e., all the rows in a shard sort
+ * before all the rows in the next shard.  Shards that would not contain any
+ * rows are omitted, so the result may have fewer than @p shard_count elements.
+ */
+std::vector<RowSet> ShardRowSet(RowSet const& row_set,
+                                std::vector<RowKeySample> const& samples,
+                                std::size_t shard_count);
+
+/**
+ * Split @p row_set at each of the split points in @p split_points.
+ *
+ * Use this overload with a `SplitPointCache::snapshot()` to create one shard
+ * per tablet without calling `Table::SampleRows()`.  Shards that would not
+ * contain any rows are omitted.
+ */
+std::vector<RowSet> ShardRowSet(RowSet const& row_set,
+                                SplitPoints const& split_points);
+
+/**
+ * Control how `MultiGet()` splits the row keys into requests.
+ */
+class MultiGetOptions {
+ public:
+  /// The default maximum number of row keys in each request.
+  static std::size_t constexpr DEFAULT_MAX_KEYS_PER_REQUEST = 1000;
+  /// The default maximum size of the row keys in each request.
+  static std::size_t constexpr DEFAULT_MAX_BYTES_PER_REQUEST = 256 * 1024;
+  /// The default maximum number of requests running at the same time.
+  static std::size_t constexpr DEFAULT_MAX_CONCURRENCY = 8;
+
+  MultiGetOptions()
+      : max_keys_per_request_(DEFAULT_MAX_KEYS_PER_REQUEST),
+        max_bytes_per_request_(DEFAULT_MAX_BYTES_PER_REQUEST),
+        max_concurrency_(DEFAULT_MAX_CONCURRENCY) {}
+
+  std::size_t max_keys_per_request() const { return max_keys_per_request_; }
+  MultiGetOptions& set_max_keys_per_request(std::size_t v) {
+    max_keys_per_request_ = (std::max)(v, std::size_t(1));
+    return *this;
+  }
+
+  /**
+   * The maximum total size of the row keys in each request.
+   *
+   * A request always contains at least one key, even if it is larger than
+   * this limit.
+   */
+  std::size_t max_bytes_per_request() const { return max_bytes_per_request_; }
+  MultiGetOptions& set_max_bytes_per_request(std::size_t v) {
+    max_bytes_per_request_ = v;
+    return *this;
+  }
+
+  std::size_t max_concurrency() const { return max_concurrency_; }
+  MultiGetOptions& set_max_concurrency(std::size_t v) {
+    max_concurrency_ = (std::max)(v, std::size_t(1));
+    return *this;
+  }
+
+ private:
+  std::size_t max_keys_per_request_;
+  std::size_t max_bytes_per_request_;
+  std::size_t max_concurrency_;
+};
+
+/**
+ * Sort and deduplicate @p row_keys, and split them into batches.
+ *
+ * Each batch respects the per-request limits in @p options, and the batches
+ * are returned in row key order.
+ */
+std::vector<std::vector<std::string>> SplitRowKeys(
+    std::vector<std::string> row_keys, MultiGetOptions const& options);
+
+/**
+ * Read the rows with the given keys, returning them in row key order.
+ *
+ * The keys are sorted, deduplicated and split into batches (see
+ * `SplitRowKeys()`).  Each batch is read using a separate `ReadRows` request,
+ * with at most `options.max_concurrency()` requests running at the same time.
+ * Because each batch is a separate RPC, the `DataClient` spreads them across
+ * its channels.  Rows that do not exist are omitted from the result.
+ *
+ * @par Example
+ * @code
+ * std::vector<std::string> keys = ...;  // Maybe thousands of keys.
+ * for (auto const& row : bigtable::MultiGet(table, keys, filter)) {
+ *   // ... rows are received in row key order ...
+ * }
+ * @endcode
+ *
+ * @throws std::exception the first exception raised while reading any batch,
+ *     no new batches are started after an error.
+ */
+std::vector<Row> MultiGet(Table const& table, std::vector<std::string> row_keys,
+                          Filter const& filter,
+                          MultiGetOptions const& options = MultiGetOptions());
+
+/**
+ * Read the rows with the given keys, returning a map from key to row.
+ *
+ * @see `MultiGet()` for the details.
+ */
+std::map<std::string, Row> MultiGetMap(
+    Table const& table, std::vector<std::string> row_keys, Filter const& filter,
+    MultiGetOptions const& options = MultiGetOptions());
+
+/**
+ * Scan a set of rows using one stream per shard, returning the rows in order.
+ *
+ * This class reads up to `max_concurrency` shards concurrently, keeping at
+ * most `max_buffered_rows` rows for each shard.  The shards are assigned to
+ * the threads in order, so the shard being iterated is always being read or
+ * complete.  Because the shards are disjoint and sorted, iterating over the
+ * shards in order returns the rows in the same order as `Table::ReadRows()`.
+ *
+ * @par Example
+ * @code
+ * bigtable::ParallelRowReader reader(table, bigtable::RowSet(), 8,
+ *                                    bigtable::Filter::PassAllFilter());
+ * for (auto& row : reader) {
+ *   // ... rows are received in row key order ...
+ * }
+ * @endcode
+ */
+class ParallelRowReader {
+ public:
+  /// The default number of rows buffered for each shard.
+  static std::size_t constexpr DEFAULT_MAX_BUFFERED_ROWS = 1024;
+  /// The default maximum number of shards read at the same time.
+  static std::size_t constexpr DEFAULT_MAX_CONCURRENCY = 8;
+
+  /// Read the shards in @p shards, which must be disjoint and sorted.
+  ParallelRowReader(Table const& table, std::vector<RowSet> shards,
+                    Filter filter,
+                    std::size_t max_buffered_rows = DEFAULT_MAX_BUFFERED_ROWS,
+                    std::size_t max_concurrency = DEFAULT_MAX_CONCURRENCY);
+
+  /**
+   * Split @p row_set into @p shard_count shards and read them.
+   *
+   * @throws bigtable::GRpcError if `Table::SampleRows()` fails.
+   */
+  ParallelRowReader(Table table, RowSet const& row_set,
+                    std::size_t shard_count, Filter filter,
+                    std::size_t max_concurrency = DEFAULT_MAX_CONCURRENCY);
+
+  /// Stop reading any pending shards and wait for the threads to exit.
+  ~ParallelRowReader();
+
+  ParallelRowReader(ParallelRowReader const&) = delete;
+  ParallelRowReader& operator=(ParallelRowReader const&) = delete;
+
+  /// The input iterator used to scan the rows in a `ParallelRowReader`.
+  class iterator {
+   public:
+    //@{
+    /// @name Iterator traits
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Row;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Row*;
+    using reference = Row&;
+    //@}
+
+    iterator(ParallelRowReader* owner, internal::OptionalRow row)
+        : owner_(owner), row_(std::move(row)) {}
+
+    iterator& operator++() {
+      row_ = owner_->Next();
+      return *this;
+    }
+
+    Row const* operator->() const { return row_.operator->(); }
+    Row* operator->() { return row_.operator->(); }
+    Row const& operator*() const { return *row_; }
+    Row& operator*() { return *row_; }
+
+    bool operator==(iterator const& that) const {
+      // All non-end iterators are equal.
+      return owner_ == that.owner_ and
+             row_.has_value() == that.row_.has_value();
+    }
+    bool operator!=(iterator const& that) const { return !(*this == that); }
+
+   private:
+    ParallelRowReader* owner_;
+    internal::OptionalRow row_;
+  };
+
+  /**
+   * Return an iterator to the first row.
+   *
+   * @throws std::exception the error raised while reading a shard, when the
+   *     iteration reaches that shard.
+   */
+  iterator begin() { return iterator(this, Next()); }
+  iterator end() { return iterator(this, internal::OptionalRow()); }
+
+  /// The number of shards.
+  std::size_t shard_count() const { return shards_.size(); }
+
+ private:
+  struct ShardState {
+    ShardState() : done(false) {}
+
+    std::deque<Row> rows;
+    bool done;
+    std::exception_ptr error;
+    /// Signaled when the consumer removes rows from this shard.
+    std::condition_variable has_room;
+  };
+
+  /// Read the shards in order until all are assigned, runs in its own thread.
+  void Worker(Table const& table);
+
+  /// Read one shard.
+  void ReadShard(Table const& table, std::size_t index);
+
+  /// Return the next row in order, or an empty value at the end of the scan.
+  internal::OptionalRow Next();
+
+  std::vector<RowSet> shards_;
+  Filter filter_;
+  std::size_t max_buffered_rows_;
+
+  std::mutex mu_;
+  /// Signaled when the shard being consumed has new rows or is done.
+  std::condition_variable cv_;
+  std::vector<ShardState> state_;
+  std::size_t current_shard_;
+  /// The next shard to assign to a thread.
+  std::size_t next_shard_;
+  bool cancelled_;
+  std::vector<std::thread> threads_;
+};
+
+/**
+ * Read the rows in @p shards concurrently.
+ *
+ * Each shard is read using a separate `RowReader` (and therefore a separate
+ * streaming RPC), which retries and resumes after the last row received, just
+ * like `Table::ReadRows()`.  Because each stream is a separate RPC, the
+ * `DataClient` spreads them across its channels.  A fixed pool of at most
+ * @p max_concurrency threads, including the calling thread, reads the shards
+ * in order, so the number of threads and streams is bounded regardless of the
+ * number of shards.
+ *
+ * @param on_row invoked as `on_row(shard_index, row)` for each row, from the
+ *     thread reading that shard.  Calls for the same shard are serialized and
+ *     in row key order, calls for different shards run concurrently.
+ *
+ * @throws std::exception the first exception raised while reading any shard,
+ *     no new shards are started after an error.
+ */
+void ReadRowsParallel(
+    Table const& table, std::vector<RowSet> const& shards, Filter const& filter,
+    std::function<void(std::size_t, Row)> const& on_row,
+    std::size_t max_concurrency = ParallelRowReader::DEFAULT_MAX_CONCURRENCY);
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_PARALLEL_ROW_READER_H_
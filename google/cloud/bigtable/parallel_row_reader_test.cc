@@ -0,0 +1,361 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/parallel_row_reader.h"
+#include "google/cloud/bigtable/testing/mock_read_rows_reader.h"
+#include "google/cloud/bigtable/testing/mock_sample_row_keys_reader.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+#include <atomic>
+#include <set>
+#include <thread>
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace ::testing;
+
+/// Define helper types and functions for this test.
+namespace {
+class ParallelRowReaderTest : public bigtable::testing::TableTestFixture {};
+using bigtable::testing::MockReadRowsReader;
+using bigtable::testing::MockSampleRowKeysReader;
+
+/// Create a stream that returns one row for each key in @p request.
+std::unique_ptr<grpc::ClientReaderInterface<btproto::ReadRowsResponse>>
+EchoRowKeys(grpc::ClientContext*, btproto::ReadRowsRequest const& request) {
+  btproto::ReadRowsResponse response;
+  for (auto const& key : request.rows().row_keys()) {
+    auto& chunk = *response.add_chunks();
+    chunk.set_row_key(key);
+    chunk.mutable_family_name()->set_value("fam");
+    chunk.mutable_qualifier()->set_value("col");
+    chunk.set_value("value");
+    chunk.set_commit_row(true);
+  }
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  return stream->AsUniqueMocked();
+}
+
+std::vector<bigtable::RowKeySample> MakeSamples(
+    std::vector<std::string> const& keys) {
+  std::vector<bigtable::RowKeySample> samples;
+  std::int64_t offset = 0;
+  for (auto const& k : keys) {
+    offset += 1000;
+    samples.push_back(bigtable::RowKeySample{k, offset});
+  }
+  return samples;
+}
+}  // anonymous namespace
+
+/// @test Verify that ShardRowSet() splits the full table at the samples.
+TEST(ShardRowSetTest, SplitAllRows) {
+  auto shards = bigtable::ShardRowSet(bigtable::RowSet(),
+                                      MakeSamples({"a", "m", "t", ""}), 2);
+  ASSERT_EQ(2U, shards.size());
+  ASSERT_EQ(1, shards[0].as_proto().row_ranges_size());
+  EXPECT_EQ(bigtable::RowRange::RightOpen("", "m"),
+            bigtable::RowRange(shards[0].as_proto().row_ranges(0)));
+  ASSERT_EQ(1, shards[1].as_proto().row_ranges_size());
+  EXPECT_EQ(bigtable::RowRange::StartingAt("m"),
+            bigtable::RowRange(shards[1].as_proto().row_ranges(0)));
+}
+
+/// @test Verify that ShardRowSet() handles more shards than samples.
+TEST(ShardRowSetTest, FewSamples) {
+  auto shards =
+      bigtable::ShardRowSet(bigtable::RowSet(), MakeSamples({"m", ""}), 4);
+  EXPECT_EQ(2U, shards.size());
+
+  shards = bigtable::ShardRowSet(bigtable::RowSet(), MakeSamples({""}), 4);
+  EXPECT_EQ(1U, shards.size());
+}
+
+/// @test Verify that ShardRowSet() splits row keys and omits empty shards.
+TEST(ShardRowSetTest, SplitKeysAndRanges) {
+  auto shards =
+      bigtable::ShardRowSet(bigtable::RowSet("b", "z"), MakeSamples({"m"}), 2);
+  ASSERT_EQ(2U, shards.size());
+  ASSERT_EQ(1, shards[0].as_proto().row_keys_size());
+  EXPECT_EQ("b", shards[0].as_proto().row_keys(0));
+  ASSERT_EQ(1, shards[1].as_proto().row_keys_size());
+  EXPECT_EQ("z", shards[1].as_proto().row_keys(0));
+
+  shards = bigtable::ShardRowSet(
+      bigtable::RowSet(bigtable::RowRange::Range("a", "c")),
+      MakeSamples({"m", "t"}), 3);
+  ASSERT_EQ(1U, shards.size());
+  EXPECT_EQ(bigtable::RowRange::Range("a", "c"),
+            bigtable::RowRange(shards[0].as_proto().row_ranges(0)));
+}
+
+/// @test Verify that ReadRowsParallel() delivers the rows of each shard.
+TEST_F(ParallelRowReaderTest, ReadRowsParallel) {
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(EchoRowKeys));
+
+  std::mutex mu;
+  std::vector<std::vector<std::string>> keys(2);
+  bigtable::ReadRowsParallel(
+      table_, {bigtable::RowSet("a", "b"), bigtable::RowSet("x", "y", "z")},
+      bigtable::Filter::PassAllFilter(),
+      [&mu, &keys](std::size_t shard, bigtable::Row row) {
+        std::lock_guard<std::mutex> lk(mu);
+        keys.at(shard).emplace_back(row.row_key());
+      });
+  EXPECT_THAT(keys[0], ElementsAre("a", "b"));
+  EXPECT_THAT(keys[1], ElementsAre("x", "y", "z"));
+}
+
+/// @test Verify that ReadRowsParallel() bounds the number of threads.
+TEST_F(ParallelRowReaderTest, ReadRowsParallelMaxConcurrency) {
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .Times(5)
+      .WillRepeatedly(Invoke(EchoRowKeys));
+
+  std::mutex mu;
+  std::set<std::thread::id> threads;
+  std::vector<std::vector<std::string>> keys(5);
+  bigtable::ReadRowsParallel(
+      table_,
+      {bigtable::RowSet("a"), bigtable::RowSet("b"), bigtable::RowSet("c"),
+       bigtable::RowSet("d"), bigtable::RowSet("e")},
+      bigtable::Filter::PassAllFilter(),
+      [&mu, &threads, &keys](std::size_t shard, bigtable::Row row) {
+        std::lock_guard<std::mutex> lk(mu);
+        threads.insert(std::this_thread::get_id());
+        keys.at(shard).emplace_back(row.row_key());
+      },
+      2);
+  EXPECT_GE(2U, threads.size());
+  EXPECT_THAT(keys, ElementsAre(ElementsAre("a"), ElementsAre("b"),
+                                ElementsAre("c"), ElementsAre("d"),
+                                ElementsAre("e")));
+}
+
+/// @test Verify that ParallelRowReader returns the rows in order.
+TEST_F(ParallelRowReaderTest, OrderedIteration) {
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .Times(3)
+      .WillRepeatedly(Invoke(EchoRowKeys));
+
+  bigtable::ParallelRowReader reader(
+      table_,
+      {bigtable::RowSet("a", "b"), bigtable::RowSet("m"),
+       bigtable::RowSet("x", "y")},
+      bigtable::Filter::PassAllFilter(), 1);
+  EXPECT_EQ(3U, reader.shard_count());
+  std::vector<std::string> keys;
+  for (auto& row : reader) {
+    keys.emplace_back(row.row_key());
+  }
+  EXPECT_THAT(keys, ElementsAre("a", "b", "m", "x", "y"));
+}
+
+/// @test Verify that ParallelRowReader bounds the number of threads.
+TEST_F(ParallelRowReaderTest, MaxConcurrency) {
+  std::mutex mu;
+  std::set<std::thread::id> threads;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .Times(4)
+      .WillRepeatedly(Invoke([&mu, &threads](
+                                 grpc::ClientContext* context,
+                                 btproto::ReadRowsRequest const& request) {
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          threads.insert(std::this_thread::get_id());
+        }
+        return EchoRowKeys(context, request);
+      }));
+
+  std::vector<std::string> keys;
+  {
+    bigtable::ParallelRowReader reader(
+        table_,
+        {bigtable::RowSet("a", "b"), bigtable::RowSet("c"),
+         bigtable::RowSet("m", "n"), bigtable::RowSet("x", "y")},
+        bigtable::Filter::PassAllFilter(), 1, 2);
+    for (auto& row : reader) {
+      keys.emplace_back(row.row_key());
+    }
+  }
+  EXPECT_THAT(keys, ElementsAre("a", "b", "c", "m", "n", "x", "y"));
+  EXPECT_GE(2U, threads.size());
+}
+
+/// @test Verify that ParallelRowReader can stop before reading all the rows.
+TEST_F(ParallelRowReaderTest, EarlyExit) {
+  // The destructor may run before the thread for the second shard starts, in
+  // that case the shard is never read.
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .Times(Between(1, 2))
+      .WillRepeatedly(Invoke(EchoRowKeys));
+
+  bigtable::ParallelRowReader reader(
+      table_, {bigtable::RowSet("a", "b", "c"), bigtable::RowSet("x", "y")},
+      bigtable::Filter::PassAllFilter(), 1);
+  auto it = reader.begin();
+  ASSERT_NE(reader.end(), it);
+  EXPECT_EQ("a", it->row_key());
+  // The destructor stops the threads blocked on the full buffers.
+}
+
+/// @test Verify that ParallelRowReader uses SampleRows() to create shards.
+TEST_F(ParallelRowReaderTest, ShardWithSamples) {
+  auto samples = new MockSampleRowKeysReader;
+  EXPECT_CALL(*client_, SampleRowKeys(_, _))
+      .WillOnce(Invoke(samples->MakeMockReturner()));
+  EXPECT_CALL(*samples, Read(_))
+      .WillOnce(Invoke([](btproto::SampleRowKeysResponse* r) {
+        r->set_row_key("m");
+        r->set_offset_bytes(1000);
+        return true;
+      }))
+      .WillOnce(Invoke([](btproto::SampleRowKeysResponse* r) {
+        r->set_row_key("");
+        r->set_offset_bytes(2000);
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*samples, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(EchoRowKeys));
+
+  bigtable::ParallelRowReader reader(table_, bigtable::RowSet("a", "z"), 2,
+                                     bigtable::Filter::PassAllFilter());
+  EXPECT_EQ(2U, reader.shard_count());
+  std::vector<std::string> keys;
+  for (auto& row : reader) {
+    keys.emplace_back(row.row_key());
+  }
+  EXPECT_THAT(keys, ElementsAre("a", "z"));
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that ParallelRowReader reports errors in the shards.
+TEST_F(ParallelRowReaderTest, ErrorInShard) {
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillRepeatedly(Invoke([](grpc::ClientContext* context,
+                                btproto::ReadRowsRequest const& request) {
+        if (request.rows().row_keys(0) == "a") {
+          return EchoRowKeys(context, request);
+        }
+        auto stream = new MockReadRowsReader;
+        EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+        return stream->AsUniqueMocked();
+      }));
+
+  bigtable::ParallelRowReader reader(
+      table_, {bigtable::RowSet("a"), bigtable::RowSet("x")},
+      bigtable::Filter::PassAllFilter());
+  auto it = reader.begin();
+  ASSERT_NE(reader.end(), it);
+  EXPECT_EQ("a", it->row_key());
+  EXPECT_THROW(++it, std::exception);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+/// @test Verify that SplitRowKeys() sorts, deduplicates and splits the keys.
+TEST(SplitRowKeysTest, Simple) {
+  auto batches = bigtable::SplitRowKeys(
+      {"d", "b", "a", "c", "b", "e"},
+      bigtable::MultiGetOptions().set_max_keys_per_request(2));
+  ASSERT_EQ(3U, batches.size());
+  EXPECT_THAT(batches[0], ElementsAre("a", "b"));
+  EXPECT_THAT(batches[1], ElementsAre("c", "d"));
+  EXPECT_THAT(batches[2], ElementsAre("e"));
+
+  EXPECT_TRUE(bigtable::SplitRowKeys({}, bigtable::MultiGetOptions()).empty());
+}
+
+/// @test Verify that SplitRowKeys() respects the byte limit.
+TEST(SplitRowKeysTest, ByteLimit) {
+  auto batches = bigtable::SplitRowKeys(
+      {"aaaa", "bbbb", "cccccccccc", "dd"},
+      bigtable::MultiGetOptions().set_max_bytes_per_request(8));
+  ASSERT_EQ(3U, batches.size());
+  EXPECT_THAT(batches[0], ElementsAre("aaaa", "bbbb"));
+  // Keys larger than the limit get their own batch.
+  EXPECT_THAT(batches[1], ElementsAre("cccccccccc"));
+  EXPECT_THAT(batches[2], ElementsAre("dd"));
+}
+
+/// @test Verify that MultiGet() returns the rows in order.
+TEST_F(ParallelRowReaderTest, MultiGet) {
+  std::atomic<int> requests(0);
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillRepeatedly(Invoke([&requests](grpc::ClientContext* context,
+                                         btproto::ReadRowsRequest const& r) {
+        ++requests;
+        EXPECT_GE(2, r.rows().row_keys_size());
+        return EchoRowKeys(context, r);
+      }));
+
+  auto rows = bigtable::MultiGet(
+      table_, {"k4", "k2", "k0", "k3", "k1", "k2"},
+      bigtable::Filter::PassAllFilter(),
+      bigtable::MultiGetOptions()
+          .set_max_keys_per_request(2)
+          .set_max_concurrency(2));
+  std::vector<std::string> keys;
+  for (auto const& row : rows) {
+    keys.push_back(row.row_key());
+  }
+  EXPECT_THAT(keys, ElementsAre("k0", "k1", "k2", "k3", "k4"));
+  EXPECT_EQ(3, requests.load());
+}
+
+/// @test Verify that MultiGetMap() returns all the rows.
+TEST_F(ParallelRowReaderTest, MultiGetMap) {
+  EXPECT_CALL(*client_, ReadRows(_, _)).WillRepeatedly(Invoke(EchoRowKeys));
+
+  auto rows = bigtable::MultiGetMap(
+      table_, {"b", "a", "c"}, bigtable::Filter::PassAllFilter(),
+      bigtable::MultiGetOptions().set_max_keys_per_request(1));
+  ASSERT_EQ(3U, rows.size());
+  EXPECT_EQ("a", rows.at("a").row_key());
+  EXPECT_EQ("c", rows.at("c").row_key());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that MultiGet() reports errors.
+TEST_F(ParallelRowReaderTest, MultiGetError) {
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillRepeatedly(Invoke([](grpc::ClientContext* context,
+                                btproto::ReadRowsRequest const& request) {
+        if (request.rows().row_keys(0) == "a") {
+          return EchoRowKeys(context, request);
+        }
+        auto stream = new MockReadRowsReader;
+        EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+        EXPECT_CALL(*stream, Finish())
+            .WillOnce(Return(
+                grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+        return stream->AsUniqueMocked();
+      }));
+
+  EXPECT_THROW(bigtable::MultiGet(
+                   table_, {"a", "x"}, bigtable::Filter::PassAllFilter(),
+                   bigtable::MultiGetOptions().set_max_keys_per_request(1)),
+               std::exception);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,185 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/partitioned_bulk_writer.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <google/protobuf/text_format.h>
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/**
+ * Report @p failure using its position in the original `BulkMutation`.
+ *
+ * @throws std::logic_error if the index of @p failure is not a valid position
+ *     in @p partition, reporting it would blame the wrong mutation.
+ */
+FailedMutation RemapFailure(FailedMutation const& failure,
+                            MutationPartition const& partition) {
+  // FailedMutation keeps the google::rpc::Status in text format, recover it
+  // to preserve the details.
+  google::rpc::Status status;
+  if (not google::protobuf::TextFormat::ParseFromString(
+          failure.status().error_details(), &status)) {
+    status.set_code(failure.status().error_code());
+    status.set_message(failure.status().error_message());
+  }
+  auto const index = failure.original_index();
+  if (index < 0 or
+      static_cast<std::size_t>(index) >= partition.original_indices.size()) {
+    google::cloud::internal::RaiseLogicError(
+        "PartitionedBulkWriter::BulkApply() - the failed mutation index (" +
+        std::to_string(index) + ") is out of range for a partition with " +
+        std::to_string(partition.original_indices.size()) + " mutations");
+  }
+  return FailedMutation(failure.mutation(), std::move(status),
+                        partition.original_indices[index]);
+}
+}  // namespace
+
+std::vector<MutationPartition> PartitionMutations(
+    BulkMutation&& mut, SplitPoints const& split_points) {
+  google::bigtable::v2::MutateRowsRequest request;
+  mut.MoveTo(&request);
+
+  std::map<std::size_t, MutationPartition> partitions;
+  for (int i = 0; i != request.entries_size(); ++i) {
+    auto& entry = *request.mutable_entries(i);
+    auto const shard = split_points.ShardIndex(entry.row_key());
+    auto& partition = partitions[shard];
+    partition.shard_index = shard;
+    partition.mutations.emplace_back(SingleRowMutation(std::move(entry)));
+    partition.original_indices.push_back(i);
+  }
+
+  std::vector<MutationPartition> result;
+  result.reserve(partitions.size());
+  for (auto& kv : partitions) {
+    result.emplace_back(std::move(kv.second));
+  }
+  return result;
+}
+
+std::size_t constexpr PartitionedBulkWriter::DEFAULT_MAX_CONCURRENCY;
+
+PartitionedBulkWriter::PartitionedBulkWriter(
+    Table table, std::shared_ptr<SplitPointCache> splits,
+    std::size_t max_concurrency)
+    : table_(std::move(table)),
+      splits_(std::move(splits)),
+      max_concurrency_((std::max)(max_concurrency, std::size_t(1))) {}
+
+void PartitionedBulkWriter::BulkApply(BulkMutation&& mut) {
+  auto partitions = PartitionMutations(std::move(mut), *splits_->snapshot());
+  if (partitions.size() == 1U) {
+    // Nothing to remap, the indices in the only partition are the original
+    // ones.
+    table_.BulkApply(std::move(partitions.front().mutations));
+    return;
+  }
+
+  // A fixed number of workers pick the next partition, so the concurrency is
+  // bounded regardless of the number of tablets.
+  std::mutex mu;
+  std::size_t next_partition = 0;
+  std::vector<FailedMutation> failures;
+  grpc::Status status;
+  std::exception_ptr error;
+  auto worker = [&] {
+    while (true) {
+      std::size_t index;
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        if (next_partition == partitions.size()) {
+          return;
+        }
+        index = next_partition++;
+      }
+      auto& partition = partitions[index];
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+      try {
+        try {
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+          table_.BulkApply(std::move(partition.mutations));
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+        } catch (PermanentMutationFailure const& ex) {
+          // Remap before taking the lock, the outer handler reports any
+          // failures that cannot be remapped.
+          std::vector<FailedMutation> remapped;
+          remapped.reserve(ex.failures().size());
+          for (auto const& f : ex.failures()) {
+            remapped.emplace_back(RemapFailure(f, partition));
+          }
+          std::lock_guard<std::mutex> lk(mu);
+          if (status.ok()) {
+            status = ex.status();
+          }
+          std::move(remapped.begin(), remapped.end(),
+                    std::back_inserter(failures));
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lk(mu);
+        if (not error) {
+          error = std::current_exception();
+        }
+      }
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    }
+  };
+
+  auto const thread_count = (std::min)(max_concurrency_, partitions.size());
+  std::vector<std::thread> threads;
+  // The calling thread is one of the workers.
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if (failures.empty()) {
+    return;
+  }
+  std::sort(failures.begin(), failures.end(),
+            [](FailedMutation const& a, FailedMutation const& b) {
+              return a.original_index() < b.original_index();
+            });
+  if (status.ok()) {
+    status = grpc::Status(
+        grpc::StatusCode::INTERNAL,
+        "Permanent (or too many transient) errors in "
+        "PartitionedBulkWriter::BulkApply()");
+  }
+  throw PermanentMutationFailure(status.error_message().c_str(), status,
+                                 std::move(failures));
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,106 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_PARTITIONED_BULK_WRITER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_PARTITIONED_BULK_WRITER_H_
+
+#include "google/cloud/bigtable/split_point_cache.h"
+#include "google/cloud/bigtable/table.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * The mutations in a `BulkMutation` that fall in a single shard.
+ *
+ * @see PartitionMutations()
+ */
+struct MutationPartition {
+  /// The index of the shard, as in `SplitPoints::ShardIndex()`.
+  std::size_t shard_index;
+  /// The mutations for rows in the shard, in their original order.
+  BulkMutation mutations;
+  /// The position of each mutation in the original `BulkMutation`.
+  std::vector<int> original_indices;
+};
+
+/**
+ * Group the mutations in @p mut by the shard containing their row key.
+ *
+ * The partitions are returned in shard order, shards without any mutations are
+ * omitted.
+ */
+std::vector<MutationPartition> PartitionMutations(
+    BulkMutation&& mut, SplitPoints const& split_points);
+
+/**
+ * Apply bulk mutations with one `MutateRows` request per tablet.
+ *
+ * Applications often produce mutations in random row key order, so each
+ * `Table::BulkApply()` request touches many tablets, and the slowest tablet
+ * bounds the latency of the whole request.  This class groups the mutations
+ * by the tablet containing their row key, using the split points from a
+ * `SplitPointCache`, and applies each group with a separate
+ * `Table::BulkApply()` call.  At most `max_concurrency()` calls run at the
+ * same time, and because each call is a separate RPC the `DataClient` spreads
+ * them across its channels.
+ *
+ * The split points are only a hint, stale split points make the requests less
+ * efficient, but the mutations are applied correctly.  This class is
+ * thread-safe.
+ *
+ * @par Example
+ * @code
+ * auto splits = std::make_shared<bigtable::SplitPointCache>(
+ *     bigtable::noex::Table(client, "my-table"));
+ * bigtable::PartitionedBulkWriter writer(table, splits);
+ * writer.BulkApply(std::move(mutations));
+ * @endcode
+ */
+class PartitionedBulkWriter {
+ public:
+  /// The default maximum number of requests running at the same time.
+  static std::size_t constexpr DEFAULT_MAX_CONCURRENCY = 8;
+
+  PartitionedBulkWriter(Table table, std::shared_ptr<SplitPointCache> splits,
+                        std::size_t max_concurrency = DEFAULT_MAX_CONCURRENCY);
+
+  /**
+   * Apply the mutations in @p mut, one request per tablet.
+   *
+   * @throws PermanentMutationFailure if any mutation fails, after all the
+   *     requests complete.  The failures from all the requests are reported,
+   *     and `FailedMutation::original_index()` refers to the position in
+   *     @p mut.
+   */
+  void BulkApply(BulkMutation&& mut);
+
+  std::size_t max_concurrency() const { return max_concurrency_; }
+
+ private:
+  Table table_;
+  std::shared_ptr<SplitPointCache> splits_;
+  std::size_t max_concurrency_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_PARTITIONED_BULK_WRITER_H_
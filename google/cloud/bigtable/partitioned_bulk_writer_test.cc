@@ -0,0 +1,192 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/partitioned_bulk_writer.h"
+#include "google/cloud/bigtable/testing/mock_mutate_rows_reader.h"
+#include "google/cloud/bigtable/testing/mock_sample_row_keys_reader.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include <algorithm>
+#include <mutex>
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace ::testing;
+using namespace google::cloud::testing_util::chrono_literals;
+
+/// Define helper types and functions for this test.
+namespace {
+class PartitionedBulkWriterTest : public bigtable::testing::TableTestFixture {
+};
+using bigtable::testing::MockMutateRowsReader;
+using bigtable::testing::MockSampleRowKeysReader;
+
+/// Return a stream with the samples "f" and "m", i.e., three tablets.
+std::unique_ptr<grpc::ClientReaderInterface<btproto::SampleRowKeysResponse>>
+MakeSamples(grpc::ClientContext*, btproto::SampleRowKeysRequest const&) {
+  auto stream = new MockSampleRowKeysReader;
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(Invoke([](btproto::SampleRowKeysResponse* r) {
+        r->set_row_key("f");
+        return true;
+      }))
+      .WillOnce(Invoke([](btproto::SampleRowKeysResponse* r) {
+        r->set_row_key("m");
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  return stream->AsUniqueMocked();
+}
+
+bigtable::SingleRowMutation Mutation(std::string key) {
+  return bigtable::SingleRowMutation(
+      std::move(key), {bigtable::SetCell("fam", "col", 0_ms, "v")});
+}
+}  // anonymous namespace
+
+/// @test Verify that PartitionMutations() groups the rows by shard.
+TEST(PartitionMutationsTest, Simple) {
+  bigtable::SplitPoints split_points(std::vector<bigtable::RowKeySample>{
+      {"f", 0}, {"m", 0}});
+  bigtable::BulkMutation mut(Mutation("z"), Mutation("a"), Mutation("g"),
+                             Mutation("b"));
+  auto partitions =
+      bigtable::PartitionMutations(std::move(mut), split_points);
+  ASSERT_EQ(3U, partitions.size());
+  EXPECT_EQ(0U, partitions[0].shard_index);
+  EXPECT_THAT(partitions[0].original_indices, ElementsAre(1, 3));
+  EXPECT_EQ(1U, partitions[1].shard_index);
+  EXPECT_THAT(partitions[1].original_indices, ElementsAre(2));
+  EXPECT_EQ(2U, partitions[2].shard_index);
+  EXPECT_THAT(partitions[2].original_indices, ElementsAre(0));
+
+  btproto::MutateRowsRequest request;
+  partitions[0].mutations.MoveTo(&request);
+  ASSERT_EQ(2, request.entries_size());
+  EXPECT_EQ("a", request.entries(0).row_key());
+  EXPECT_EQ("b", request.entries(1).row_key());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that PartitionedBulkWriter sends one request per tablet.
+TEST_F(PartitionedBulkWriterTest, OneRequestPerTablet) {
+  EXPECT_CALL(*client_, SampleRowKeys(_, _)).WillOnce(Invoke(MakeSamples));
+
+  // Fail the "g" row, which is in the second tablet.
+  std::mutex mu;
+  std::vector<std::vector<std::string>> requests;
+  EXPECT_CALL(*client_, MutateRows(_, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&mu, &requests](
+                                 grpc::ClientContext*,
+                                 btproto::MutateRowsRequest const& request) {
+        std::vector<std::string> keys;
+        btproto::MutateRowsResponse response;
+        for (int i = 0; i != request.entries_size(); ++i) {
+          keys.push_back(request.entries(i).row_key());
+          auto& e = *response.add_entries();
+          e.set_index(i);
+          e.mutable_status()->set_code(keys.back() == "g"
+                                           ? grpc::StatusCode::OUT_OF_RANGE
+                                           : grpc::StatusCode::OK);
+        }
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          requests.push_back(std::move(keys));
+        }
+        auto reader = new MockMutateRowsReader;
+        EXPECT_CALL(*reader, Read(_))
+            .WillOnce(Invoke([response](btproto::MutateRowsResponse* r) {
+              *r = response;
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+        return reader->AsUniqueMocked();
+      }));
+
+  auto splits = std::make_shared<bigtable::SplitPointCache>(
+      bigtable::noex::Table(client_, kTableId), std::chrono::milliseconds(0));
+  bigtable::PartitionedBulkWriter writer(table_, splits, 2);
+  bigtable::BulkMutation mut(Mutation("z"), Mutation("a"), Mutation("g"),
+                             Mutation("b"), Mutation("h"));
+  try {
+    writer.BulkApply(std::move(mut));
+    FAIL() << "expected a PermanentMutationFailure";
+  } catch (bigtable::PermanentMutationFailure const& ex) {
+    ASSERT_EQ(1U, ex.failures().size());
+    EXPECT_EQ(2, ex.failures()[0].original_index());
+    EXPECT_EQ("g", ex.failures()[0].mutation().row_key());
+    EXPECT_EQ(grpc::StatusCode::OUT_OF_RANGE,
+              ex.failures()[0].status().error_code());
+  }
+
+  std::sort(requests.begin(), requests.end());
+  std::vector<std::vector<std::string>> expected{
+      {"a", "b"}, {"g", "h"}, {"z"}};
+  EXPECT_EQ(expected, requests);
+}
+
+/// @test Verify that failures after exhausting the retries are remapped.
+TEST_F(PartitionedBulkWriterTest, RetriesExhausted) {
+  EXPECT_CALL(*client_, SampleRowKeys(_, _)).WillOnce(Invoke(MakeSamples));
+
+  // The "h" row, in the second tablet, always fails with a transient error.
+  EXPECT_CALL(*client_, MutateRows(_, _))
+      .Times(4)
+      .WillRepeatedly(Invoke([](grpc::ClientContext*,
+                                btproto::MutateRowsRequest const& request) {
+        btproto::MutateRowsResponse response;
+        bool failed = false;
+        for (int i = 0; i != request.entries_size(); ++i) {
+          auto& e = *response.add_entries();
+          e.set_index(i);
+          if (request.entries(i).row_key() == "h") {
+            e.mutable_status()->set_code(grpc::StatusCode::UNAVAILABLE);
+            failed = true;
+          }
+        }
+        auto reader = new MockMutateRowsReader;
+        EXPECT_CALL(*reader, Read(_))
+            .WillOnce(Invoke([response](btproto::MutateRowsResponse* r) {
+              *r = response;
+              return true;
+            }))
+            .WillOnce(Return(false));
+        auto status = failed ? grpc::Status(grpc::StatusCode::UNAVAILABLE,
+                                            "try-again")
+                             : grpc::Status::OK;
+        EXPECT_CALL(*reader, Finish()).WillOnce(Return(status));
+        return reader->AsUniqueMocked();
+      }));
+
+  auto splits = std::make_shared<bigtable::SplitPointCache>(
+      bigtable::noex::Table(client_, kTableId), std::chrono::milliseconds(0));
+  bigtable::Table table(client_, "foo-table",
+                        bigtable::LimitedErrorCountRetryPolicy(1),
+                        bigtable::ExponentialBackoffPolicy(10_us, 40_us));
+  bigtable::PartitionedBulkWriter writer(table, splits, 2);
+  bigtable::BulkMutation mut(Mutation("z"), Mutation("a"), Mutation("g"),
+                             Mutation("b"), Mutation("h"));
+  try {
+    writer.BulkApply(std::move(mut));
+    FAIL() << "expected a PermanentMutationFailure";
+  } catch (bigtable::PermanentMutationFailure const& ex) {
+    ASSERT_EQ(1U, ex.failures().size());
+    EXPECT_EQ(4, ex.failures()[0].original_index());
+    EXPECT_EQ("h", ex.failures()[0].mutation().row_key());
+  }
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,60 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_READ_ROW_COALESCING_POLICY_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_READ_ROW_COALESCING_POLICY_H_
+
+#include "google/cloud/bigtable/version.h"
+#include <chrono>
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Combine concurrent `Table::ReadRow()` calls into a single `ReadRows` RPC.
+ *
+ * When a `Table` is configured with this policy, the first `ReadRow()` call
+ * waits up to @p window for other calls with the same filter, or until
+ * @p max_batch_size calls are waiting.  Then it sends a single `ReadRows` RPC
+ * for all the row keys, and returns the rows to each caller.
+ *
+ * This reduces the number of RPCs when many threads read different rows at
+ * the same time, at the cost of adding up to @p window to the latency of each
+ * call.  If the batched RPC fails, each caller that did not receive its row
+ * reads it with a separate request, using the retry policies of the table.
+ */
+class ReadRowCoalescingPolicy {
+ public:
+  template <typename Rep, typename Period>
+  ReadRowCoalescingPolicy(std::chrono::duration<Rep, Period> window,
+                          std::size_t max_batch_size)
+      : window_(std::chrono::duration_cast<std::chrono::microseconds>(window)),
+        max_batch_size_(max_batch_size == 0 ? 1 : max_batch_size) {}
+
+  std::chrono::microseconds window() const { return window_; }
+  std::size_t max_batch_size() const { return max_batch_size_; }
+
+ private:
+  std::chrono::microseconds window_;
+  std::size_t max_batch_size_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_READ_ROW_COALESCING_POLICY_H_
@@ -0,0 +1,191 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_cache.h"
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/// The entries in the cache are keyed by this prefix followed by the filter.
+std::string MakePrefix(std::string const& table_name,
+                       std::string const& row_key) {
+  // Table names never contain a NUL character, and the row key is length
+  // prefixed, so no prefix is a prefix of a different one.
+  std::string prefix = table_name;
+  prefix.push_back('\0');
+  prefix += std::to_string(row_key.size());
+  prefix.push_back(':');
+  prefix += row_key;
+  return prefix;
+}
+
+/// Estimate the memory used by an entry, including the bookkeeping.
+std::size_t EstimateSize(std::string const& key,
+                         std::pair<bool, Row> const& value) {
+  std::size_t constexpr kEntryOverhead = 128;
+  std::size_t constexpr kCellOverhead = 64;
+  // The key is stored twice, in the map and in the LRU list.
+  std::size_t size = kEntryOverhead + 2 * key.size();
+  size += value.second.row_key().size();
+  for (auto const& cell : value.second.cells()) {
+    size += kCellOverhead + cell.row_key().size() + cell.family_name().size() +
+            cell.column_qualifier().size() + cell.value().size();
+    for (auto const& label : cell.labels()) {
+      size += label.size();
+    }
+  }
+  return size;
+}
+}  // anonymous namespace
+
+struct RowCache::Impl {
+  Impl(std::size_t m, std::chrono::milliseconds t)
+      : max_bytes(m), ttl(t), bytes(0), generation(0), hits(0), misses(0) {}
+
+  struct Node {
+    std::string key;
+    std::pair<bool, Row> value;
+    std::chrono::steady_clock::time_point expires;
+    std::size_t bytes;
+  };
+  using Lru = std::list<Node>;
+  using Map = std::map<std::string, Lru::iterator>;
+
+  Map::iterator Erase(Map::iterator it) {
+    bytes -= it->second->bytes;
+    lru.erase(it->second);
+    return entries.erase(it);
+  }
+
+  std::size_t const max_bytes;
+  std::chrono::milliseconds const ttl;
+
+  std::mutex mu;
+  /// The most recently used entries are at the front.
+  Lru lru;
+  /// Ordered, so all the entries for a row are contiguous.
+  Map entries;
+  std::size_t bytes;
+  std::uint64_t generation;
+
+  std::atomic<std::int64_t> hits;
+  std::atomic<std::int64_t> misses;
+};
+
+RowCache::RowCache(std::size_t max_bytes, std::chrono::milliseconds ttl)
+    : impl_(std::make_shared<Impl>(max_bytes, ttl)) {}
+
+std::size_t RowCache::max_bytes() const { return impl_->max_bytes; }
+
+std::chrono::milliseconds RowCache::ttl() const { return impl_->ttl; }
+
+std::size_t RowCache::size_bytes() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->bytes;
+}
+
+std::size_t RowCache::size() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->entries.size();
+}
+
+std::int64_t RowCache::hits() const { return impl_->hits.load(); }
+
+std::int64_t RowCache::misses() const { return impl_->misses.load(); }
+
+void RowCache::Clear() {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  ++impl_->generation;
+  impl_->entries.clear();
+  impl_->lru.clear();
+  impl_->bytes = 0;
+}
+
+std::string RowCache::MakeKey(std::string const& table_name,
+                              std::string const& row_key,
+                              Filter const& filter) {
+  return MakePrefix(table_name, row_key) +
+         filter.as_proto().SerializeAsString();
+}
+
+bool RowCache::Lookup(std::string const& key, std::pair<bool, Row>& result,
+                      std::uint64_t& generation) {
+  auto& s = *impl_;
+  auto const now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(s.mu);
+  generation = s.generation;
+  auto it = s.entries.find(key);
+  if (it == s.entries.end()) {
+    ++s.misses;
+    return false;
+  }
+  if (it->second->expires <= now) {
+    s.Erase(it);
+    ++s.misses;
+    return false;
+  }
+  s.lru.splice(s.lru.begin(), s.lru, it->second);
+  result = it->second->value;
+  ++s.hits;
+  return true;
+}
+
+void RowCache::Insert(std::string key, std::pair<bool, Row> const& value,
+                      std::uint64_t generation) {
+  auto& s = *impl_;
+  auto const bytes = EstimateSize(key, value);
+  if (bytes > s.max_bytes) {
+    return;
+  }
+  Impl::Node node{key, value, std::chrono::steady_clock::now() + s.ttl, bytes};
+
+  std::lock_guard<std::mutex> lk(s.mu);
+  if (generation != s.generation) {
+    return;
+  }
+  auto it = s.entries.find(key);
+  if (it != s.entries.end()) {
+    s.Erase(it);
+  }
+  s.lru.push_front(std::move(node));
+  s.entries.emplace(std::move(key), s.lru.begin());
+  s.bytes += bytes;
+  while (s.bytes > s.max_bytes) {
+    s.Erase(s.entries.find(s.lru.back().key));
+  }
+}
+
+void RowCache::Invalidate(std::string const& table_name,
+                          std::string const& row_key) {
+  auto& s = *impl_;
+  auto const prefix = MakePrefix(table_name, row_key);
+  std::lock_guard<std::mutex> lk(s.mu);
+  ++s.generation;
+  auto it = s.entries.lower_bound(prefix);
+  while (it != s.entries.end() and
+         it->first.compare(0, prefix.size(), prefix) == 0) {
+    it = s.Erase(it);
+  }
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
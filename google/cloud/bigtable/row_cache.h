@@ -0,0 +1,107 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_CACHE_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_CACHE_H_
+
+#include "google/cloud/bigtable/filters.h"
+#include "google/cloud/bigtable/row.h"
+#include "google/cloud/bigtable/version.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * An in-process cache for the results of `Table::ReadRow()`.
+ *
+ * The cache is keyed by the table name, the row key and the filter, it is
+ * bounded by the (approximate) number of bytes in the cached rows, and evicts
+ * the least recently used rows first.  Each entry expires @p ttl after it was
+ * read from the service.  Rows that do not exist are also cached.
+ *
+ * Synchronous writes through a `Table` using this cache (`Apply()`,
+ * `BulkApply()`, `CheckAndMutateRow()` and `ReadModifyWriteRow()`) invalidate
+ * the cached copies of the modified rows.  Writes from other processes, or
+ * from tables not using this cache, are not visible until the entries expire.
+ *
+ * Copies of this object share the same storage, so the application can use
+ * the same cache for multiple tables, and keep a copy to examine the
+ * counters.  This class is thread-safe.
+ *
+ * @par Example
+ * @code
+ * bigtable::RowCache cache(64 * 1024 * 1024, std::chrono::seconds(5));
+ * bigtable::Table table(client, "my-table", cache);
+ * auto row = table.ReadRow("hot-row", bigtable::Filter::PassAllFilter());
+ * std::cout << cache.hits() << " hits, " << cache.misses() << " misses\n";
+ * @endcode
+ */
+class RowCache {
+ public:
+  RowCache(std::size_t max_bytes, std::chrono::milliseconds ttl);
+
+  std::size_t max_bytes() const;
+  std::chrono::milliseconds ttl() const;
+
+  /// The approximate number of bytes used by the cached rows.
+  std::size_t size_bytes() const;
+
+  /// The number of cached entries.
+  std::size_t size() const;
+
+  //@{
+  /// @name Counters to evaluate the effectiveness of the cache.
+  std::int64_t hits() const;
+  std::int64_t misses() const;
+  //@}
+
+  /// Remove all the entries.
+  void Clear();
+
+  //@{
+  /**
+   * @name Functions used by `Table` to populate and invalidate the cache.
+   *
+   * `Lookup()` returns a generation number, which must be passed back to
+   * `Insert()` when the row is fetched from the service.  Any invalidation in
+   * between rejects the insertion, so a read that races with a write cannot
+   * insert a stale row.
+   */
+  static std::string MakeKey(std::string const& table_name,
+                             std::string const& row_key, Filter const& filter);
+
+  bool Lookup(std::string const& key, std::pair<bool, Row>& result,
+              std::uint64_t& generation);
+  void Insert(std::string key, std::pair<bool, Row> const& value,
+              std::uint64_t generation);
+  void Invalidate(std::string const& table_name, std::string const& row_key);
+  //@}
+
+ private:
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_CACHE_H_
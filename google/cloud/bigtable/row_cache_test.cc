@@ -0,0 +1,148 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_cache.h"
+#include <gtest/gtest.h>
+
+namespace bigtable = google::cloud::bigtable;
+
+namespace {
+std::pair<bool, bigtable::Row> MakeRow(std::string const& row_key,
+                                       std::string const& value) {
+  return std::make_pair(
+      true, bigtable::Row(row_key, {bigtable::Cell(row_key, "fam", "col", 0,
+                                                   value, {})}));
+}
+
+std::string Key(std::string const& row_key,
+                bigtable::Filter filter = bigtable::Filter::PassAllFilter()) {
+  return bigtable::RowCache::MakeKey("test-table", row_key, filter);
+}
+
+/// Insert a row, as `Table::ReadRow()` would after a cache miss.
+void Fill(bigtable::RowCache& cache, std::string const& key,
+          std::pair<bool, bigtable::Row> const& value) {
+  std::pair<bool, bigtable::Row> unused(false, bigtable::Row("", {}));
+  std::uint64_t generation;
+  ASSERT_FALSE(cache.Lookup(key, unused, generation));
+  cache.Insert(key, value, generation);
+}
+}  // anonymous namespace
+
+/// @test Verify that RowCache returns the inserted rows.
+TEST(RowCacheTest, Simple) {
+  bigtable::RowCache cache(1024 * 1024, std::chrono::minutes(1));
+  Fill(cache, Key("r1"), MakeRow("r1", "v1"));
+  Fill(cache, Key("r2"), std::make_pair(false, bigtable::Row("", {})));
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_LT(0U, cache.size_bytes());
+
+  std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+  std::uint64_t generation;
+  ASSERT_TRUE(cache.Lookup(Key("r1"), result, generation));
+  EXPECT_TRUE(result.first);
+  EXPECT_EQ("v1", result.second.cells().at(0).value());
+  ASSERT_TRUE(cache.Lookup(Key("r2"), result, generation));
+  EXPECT_FALSE(result.first);
+
+  EXPECT_EQ(2, cache.hits());
+  EXPECT_EQ(2, cache.misses());
+
+  cache.Clear();
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_EQ(0U, cache.size_bytes());
+}
+
+/// @test Verify that the filter is part of the key.
+TEST(RowCacheTest, KeyIncludesFilter) {
+  EXPECT_NE(Key("r1"), Key("r1", bigtable::Filter::Latest(1)));
+  auto const filter = bigtable::Filter::Latest(1);
+  EXPECT_NE(bigtable::RowCache::MakeKey("t1", "r1", filter),
+            bigtable::RowCache::MakeKey("t2", "r1", filter));
+}
+
+/// @test Verify that RowCache evicts the least recently used entries.
+TEST(RowCacheTest, EvictLeastRecentlyUsed) {
+  std::string const value(1000, 'x');
+  // Enough space for about 3 rows.
+  bigtable::RowCache cache(4000, std::chrono::minutes(1));
+  Fill(cache, Key("r1"), MakeRow("r1", value));
+  Fill(cache, Key("r2"), MakeRow("r2", value));
+  Fill(cache, Key("r3"), MakeRow("r3", value));
+  EXPECT_EQ(3U, cache.size());
+
+  // Use r1, then r4 must evict r2.
+  std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+  std::uint64_t generation;
+  EXPECT_TRUE(cache.Lookup(Key("r1"), result, generation));
+  Fill(cache, Key("r4"), MakeRow("r4", value));
+  EXPECT_EQ(3U, cache.size());
+  EXPECT_LE(cache.size_bytes(), cache.max_bytes());
+  EXPECT_TRUE(cache.Lookup(Key("r1"), result, generation));
+  EXPECT_FALSE(cache.Lookup(Key("r2"), result, generation));
+  EXPECT_TRUE(cache.Lookup(Key("r3"), result, generation));
+  EXPECT_TRUE(cache.Lookup(Key("r4"), result, generation));
+
+  // Rows larger than the cache are never inserted.
+  Fill(cache, Key("r5"), MakeRow("r5", std::string(4000, 'x')));
+  EXPECT_FALSE(cache.Lookup(Key("r5"), result, generation));
+}
+
+/// @test Verify that RowCache entries expire.
+TEST(RowCacheTest, Expire) {
+  bigtable::RowCache cache(1024 * 1024, std::chrono::milliseconds(0));
+  Fill(cache, Key("r1"), MakeRow("r1", "v1"));
+  std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+  std::uint64_t generation;
+  EXPECT_FALSE(cache.Lookup(Key("r1"), result, generation));
+  EXPECT_EQ(0U, cache.size());
+}
+
+/// @test Verify that invalidating a row removes all its entries.
+TEST(RowCacheTest, Invalidate) {
+  bigtable::RowCache cache(1024 * 1024, std::chrono::minutes(1));
+  Fill(cache, Key("r1"), MakeRow("r1", "v1"));
+  Fill(cache, Key("r1", bigtable::Filter::Latest(1)), MakeRow("r1", "v1"));
+  Fill(cache, Key("r10"), MakeRow("r10", "v1"));
+  Fill(cache, Key(std::string("r1\0", 3)), MakeRow("r1", "v1"));
+  EXPECT_EQ(4U, cache.size());
+
+  cache.Invalidate("test-table", "r1");
+  EXPECT_EQ(2U, cache.size());
+  std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+  std::uint64_t generation;
+  EXPECT_FALSE(cache.Lookup(Key("r1"), result, generation));
+  EXPECT_TRUE(cache.Lookup(Key("r10"), result, generation));
+  EXPECT_TRUE(cache.Lookup(Key(std::string("r1\0", 3)), result, generation));
+}
+
+/// @test Verify that a fill racing with an invalidation is rejected.
+TEST(RowCacheTest, InvalidateRejectsStaleFill) {
+  bigtable::RowCache cache(1024 * 1024, std::chrono::minutes(1));
+  std::pair<bool, bigtable::Row> result(false, bigtable::Row("", {}));
+  std::uint64_t generation;
+  EXPECT_FALSE(cache.Lookup(Key("r1"), result, generation));
+  cache.Invalidate("test-table", "r1");
+  cache.Insert(Key("r1"), MakeRow("r1", "stale"), generation);
+  EXPECT_FALSE(cache.Lookup(Key("r1"), result, generation));
+}
+
+/// @test Verify that copies share the storage.
+TEST(RowCacheTest, CopiesShareStorage) {
+  bigtable::RowCache cache(1024 * 1024, std::chrono::minutes(1));
+  bigtable::RowCache copy = cache;
+  Fill(copy, Key("r1"), MakeRow("r1", "v1"));
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_EQ(1, cache.misses());
+}
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/bigtable/row_reader.h"
+#include "google/cloud/bigtable/internal/prefetching_read_rows_reader.h"
 #include "google/cloud/bigtable/internal/table.h"
 #include "google/cloud/internal/make_unique.h"
 #include "google/cloud/internal/throw_delegate.h"
@@ -57,6 +58,9 @@ static_assert(std::is_same<decltype(++std::declval<RowReader::iterator>()),
               "++it when it is of RowReader::iterator type must be a "
               "RowReader::iterator &>");
 
+std::size_t constexpr RowReader::DEFAULT_READ_AHEAD_RESPONSES;
+std::size_t constexpr RowReader::DEFAULT_READ_AHEAD_BYTES;
+
 RowReader::RowReader(
     std::shared_ptr<DataClient> client, bigtable::TableId table_name,
     RowSet row_set, std::int64_t rows_limit, Filter filter,
@@ -107,7 +111,7 @@ RowReader::RowReader(
     : client_(std::move(client)),
       app_profile_id_(std::move(app_profile_id)),
       table_name_(std::move(table_name)),
-      row_set_(std::move(row_set)),
+      row_set_(row_set),
       rows_limit_(rows_limit),
       filter_(std::move(filter)),
       retry_policy_(std::move(retry_policy)),
@@ -119,6 +123,11 @@ RowReader::RowReader(
       operation_cancelled_(false),
       processed_chunks_count_(0),
       rows_count_(0),
+      read_ahead_responses_(0),
+      read_ahead_bytes_(0),
+      memory_budget_(0),
+      memory_high_water_mark_(0),
+      budget_exceeded_(false),
       status_(grpc::Status::OK),
       raise_on_error_(raise_on_error),
       error_retrieved_(raise_on_error) {}
@@ -157,8 +166,7 @@ void RowReader::MakeRequest() {
   bigtable::internal::SetCommonTableOperationRequest<
       google::bigtable::v2::ReadRowsRequest>(request, app_profile_id_.get(),
                                              table_name_.get());
-  auto row_set_proto = row_set_.as_proto();
-  request.mutable_rows()->Swap(&row_set_proto);
+  row_set_.CopyTo(*request.mutable_rows());
 
   auto filter_proto = filter_.as_proto();
   request.mutable_filter()->Swap(&filter_proto);
@@ -167,11 +175,22 @@ void RowReader::MakeRequest() {
     request.set_rows_limit(rows_limit_ - rows_count_);
   }
 
+  // The previous stream (if any) may still use its context.
+  stream_.reset();
   context_ = google::cloud::internal::make_unique<grpc::ClientContext>();
   retry_policy_->Setup(*context_);
   backoff_policy_->Setup(*context_);
   metadata_update_policy_.Setup(*context_);
   stream_ = client_->ReadRows(context_.get(), request);
+  if (read_ahead_responses_ != 0) {
+    auto max_bytes = read_ahead_bytes_;
+    if (memory_budget_ != 0 and memory_budget_ < max_bytes) {
+      max_bytes = memory_budget_;
+    }
+    stream_ = google::cloud::internal::make_unique<
+        internal::PrefetchingReadRowsReader>(context_.get(), std::move(stream_),
+                                             read_ahead_responses_, max_bytes);
+  }
   stream_is_open_ = true;
 
   parser_ = parser_factory_->Create();
@@ -209,7 +228,7 @@ void RowReader::Advance(internal::OptionalRow& row) {
     if (not last_read_row_key_.empty()) {
       // We've returned some rows and need to make sure we don't
       // request them again.
-      row_set_ = row_set_.Intersect(RowRange::Open(last_read_row_key_, ""));
+      row_set_.ResumeAfter(last_read_row_key_);
     }
 
     // If we receive an error, but the retriable set is empty, stop.
@@ -217,7 +236,7 @@ void RowReader::Advance(internal::OptionalRow& row) {
       return;
     }
 
-    if (not status.ok() and not retry_policy_->OnFailure(status)) {
+    if (budget_exceeded_ or not retry_policy_->OnFailure(status)) {
       if (raise_on_error_) {
         google::cloud::internal::RaiseRuntimeError("Unretriable error: " +
                                                    status.error_message());
@@ -245,6 +264,10 @@ grpc::Status RowReader::AdvanceOrFail(internal::OptionalRow& row) {
       if (not status.ok()) {
         return status;
       }
+      status = CheckMemoryBudget();
+      if (not status.ok()) {
+        return status;
+      }
       continue;
     }
 
@@ -272,6 +295,22 @@ grpc::Status RowReader::AdvanceOrFail(internal::OptionalRow& row) {
   return status;
 }
 
+grpc::Status RowReader::CheckMemoryBudget() {
+  auto used = parser_->buffered_bytes();
+  if (used > memory_high_water_mark_) {
+    memory_high_water_mark_ = used;
+  }
+  if (memory_budget_ == 0 or used <= memory_budget_) {
+    return grpc::Status::OK;
+  }
+  budget_exceeded_ = true;
+  return grpc::Status(
+      grpc::StatusCode::RESOURCE_EXHAUSTED,
+      "RowReader memory budget exceeded, budget=" +
+          std::to_string(memory_budget_) + ", used=" + std::to_string(used) +
+          ". Consider Table::VisitRows() to stream wide rows.");
+}
+
 void RowReader::Cancel() {
   operation_cancelled_ = true;
   if (not stream_is_open_) {
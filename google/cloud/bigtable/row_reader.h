@@ -18,6 +18,7 @@
 #include "google/cloud/bigtable/bigtable_strong_types.h"
 #include "google/cloud/bigtable/data_client.h"
 #include "google/cloud/bigtable/filters.h"
+#include "google/cloud/bigtable/internal/normalized_row_set.h"
 #include "google/cloud/bigtable/internal/readrowsparser.h"
 #include "google/cloud/bigtable/internal/rowreaderiterator.h"
 #include "google/cloud/bigtable/metadata_update_policy.h"
@@ -50,6 +51,12 @@ class RowReader {
    */
   static std::int64_t constexpr NO_ROWS_LIMIT = 0;
 
+  /// The default number of responses buffered by `EnableReadAhead()`.
+  static std::size_t constexpr DEFAULT_READ_AHEAD_RESPONSES = 16;
+
+  /// The default size of the responses buffered by `EnableReadAhead()`.
+  static std::size_t constexpr DEFAULT_READ_AHEAD_BYTES = 16 * 1024 * 1024;
+
   RowReader(std::shared_ptr<DataClient> client, bigtable::TableId table_name,
             RowSet row_set, std::int64_t rows_limit, Filter filter,
             std::unique_ptr<RPCRetryPolicy> retry_policy,
@@ -121,6 +128,58 @@ class RowReader {
     return status_;
   }
 
+  /**
+   * Read the responses from the network while the application processes rows.
+   *
+   * By default the `RowReader` only reads a response from the stream when all
+   * the rows in the previous response have been consumed, so the processing
+   * of the rows alternates with waiting for the network.  With read-ahead
+   * enabled a background thread reads and buffers responses as they arrive.
+   *
+   * The buffer is bounded by @p max_responses and @p max_bytes, though one
+   * response is always buffered, even if it is larger than @p max_bytes.
+   * Retries resume after the last row returned to the application, just like
+   * they do without read-ahead.
+   *
+   * This must be called before `begin()` to affect the initial request, if
+   * called later it only affects the requests made by retries.
+   */
+  void EnableReadAhead(
+      std::size_t max_responses = DEFAULT_READ_AHEAD_RESPONSES,
+      std::size_t max_bytes = DEFAULT_READ_AHEAD_BYTES) {
+    read_ahead_responses_ = max_responses;
+    read_ahead_bytes_ = max_bytes;
+  }
+
+  /**
+   * Limit the memory used to receive and assemble rows.
+   *
+   * The budget covers the cells of the row being assembled, the response
+   * being parsed is not charged, so the budget only needs to be larger than
+   * the widest row.  If a single row does not fit, the reader stops with a
+   * `RESOURCE_EXHAUSTED` error, which is not retried, instead of growing
+   * without bounds.  Use `Table::VisitRows()` to consume rows that are too
+   * wide to be held in memory, it delivers the cells as they arrive.
+   *
+   * Responses are only read from the stream when the application needs more
+   * data, so gRPC flow control slows down the server while the application
+   * processes the rows.  If read-ahead is enabled its buffer is also limited
+   * to @p max_bytes.
+   *
+   * @param max_bytes the budget in bytes, zero (the default) means unlimited.
+   */
+  void SetMemoryBudget(std::size_t max_bytes) { memory_budget_ = max_bytes; }
+
+  /**
+   * The largest memory used to receive and assemble rows so far, in bytes.
+   *
+   * Measured as described in `SetMemoryBudget()`, the value is tracked even
+   * if no budget is set, so applications can use it to pick a budget.
+   */
+  std::size_t memory_high_water_mark() const {
+    return memory_high_water_mark_;
+  }
+
  private:
   /**
    * Read and parse the next row in the response.
@@ -135,6 +194,9 @@ class RowReader {
   /// Called by Advance(), does not handle retries.
   grpc::Status AdvanceOrFail(internal::OptionalRow& row);
 
+  /// Updates the high-water mark, fails if the memory budget is exceeded.
+  grpc::Status CheckMemoryBudget();
+
   /**
    * Move the `processed_chunks_count_` index to the next chunk,
    * reading data if needed.
@@ -154,7 +216,7 @@ class RowReader {
   std::shared_ptr<DataClient> client_;
   bigtable::AppProfileId app_profile_id_;
   bigtable::TableId table_name_;
-  RowSet row_set_;
+  internal::NormalizedRowSet row_set_;
   std::int64_t rows_limit_;
   Filter filter_;
   std::unique_ptr<RPCRetryPolicy> retry_policy_;
@@ -181,6 +243,17 @@ class RowReader {
   /// Holds the last read row key, for retries.
   std::string last_read_row_key_;
 
+  /// The read-ahead buffer limits, no read-ahead if zero.
+  std::size_t read_ahead_responses_;
+  std::size_t read_ahead_bytes_;
+
+  /// The memory budget, unlimited if zero.
+  std::size_t memory_budget_;
+  /// The largest memory usage observed so far.
+  std::size_t memory_high_water_mark_;
+  /// Set when the budget is exceeded, which is not retried.
+  bool budget_exceeded_;
+
   grpc::Status status_;
   bool raise_on_error_;
   bool error_retrieved_;
@@ -426,6 +426,155 @@ TEST_F(RowReaderTest, FailedStreamRetriesSkipAlreadyReadRows) {
   EXPECT_EQ(++it, reader.end());
 }
 
+TEST_F(RowReaderTest, ReadAheadRetriesSkipAlreadyReadRows) {
+  auto* stream = new MockReadRowsReader;  // wrapped in unique_ptr by ReadRows
+  auto parser = google::cloud::internal::make_unique<ReadRowsParserMock>();
+  parser->SetRows({"r1"});
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*client_, ReadRows(_, RequestWithRowKeysCount(2)))
+        .WillOnce(Invoke(stream->MakeMockReturner()));
+
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::StatusCode::INTERNAL, "retry")));
+
+    EXPECT_CALL(*retry_policy_, OnFailureHook(_)).WillOnce(Return(true));
+    EXPECT_CALL(*backoff_policy_, OnCompletionHook(_))
+        .WillOnce(Return(std::chrono::milliseconds(0)));
+
+    auto stream_retry = new MockReadRowsReader;  // the stub will free it
+    // The retry also reads ahead, and skips the rows already returned.
+    EXPECT_CALL(*client_, ReadRows(_, RequestWithRowKeysCount(1)))
+        .WillOnce(Invoke(stream_retry->MakeMockReturner()));
+    EXPECT_CALL(*stream_retry, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  parser_factory_->AddParser(std::move(parser));
+  bigtable::RowReader reader(
+      client_, bigtable::TableId(""), bigtable::RowSet("r1", "r2"),
+      bigtable::RowReader::NO_ROWS_LIMIT, bigtable::Filter::PassAllFilter(),
+      std::move(retry_policy_), std::move(backoff_policy_),
+      metadata_update_policy_, std::move(parser_factory_));
+  reader.EnableReadAhead(2, 1024);
+
+  auto it = reader.begin();
+  EXPECT_NE(it, reader.end());
+  EXPECT_EQ(it->row_key(), "r1");
+  EXPECT_EQ(++it, reader.end());
+}
+
+namespace {
+/// Create a response with a single row, holding a cell of @p value_size bytes.
+ReadRowsResponse MakeWideRowResponse(std::size_t value_size) {
+  ReadRowsResponse response;
+  auto& chunk = *response.add_chunks();
+  chunk.set_row_key("r1");
+  chunk.mutable_family_name()->set_value("fam");
+  chunk.mutable_qualifier()->set_value("qual");
+  chunk.set_value(std::string(value_size, 'x'));
+  chunk.set_commit_row(true);
+  return response;
+}
+}  // anonymous namespace
+
+TEST_F(RowReaderTest, MemoryHighWaterMarkIsTracked) {
+  auto* stream = new MockReadRowsReader;  // wrapped in unique_ptr by ReadRows
+  auto response = MakeWideRowResponse(1000);
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*client_, ReadRows(_, _))
+        .WillOnce(Invoke(stream->MakeMockReturner()));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  bigtable::RowReader reader(
+      client_, bigtable::TableId(""), bigtable::RowSet(),
+      bigtable::RowReader::NO_ROWS_LIMIT, bigtable::Filter::PassAllFilter(),
+      std::move(retry_policy_), std::move(backoff_policy_),
+      metadata_update_policy_, std::move(parser_factory_));
+  EXPECT_EQ(0U, reader.memory_high_water_mark());
+
+  auto it = reader.begin();
+  EXPECT_NE(it, reader.end());
+  EXPECT_EQ(it->row_key(), "r1");
+  EXPECT_EQ(++it, reader.end());
+  EXPECT_LE(1000U, reader.memory_high_water_mark());
+}
+
+TEST_F(RowReaderTest, MemoryBudgetExceededIsNotRetried) {
+  auto* stream = new MockReadRowsReader;  // wrapped in unique_ptr by ReadRows
+  auto response = MakeWideRowResponse(1000);
+  EXPECT_CALL(*retry_policy_, OnFailureHook(_)).Times(0);
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*client_, ReadRows(_, _))
+        .WillOnce(Invoke(stream->MakeMockReturner()));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)));
+    // The stream is drained and closed when the reader is cancelled.
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  bigtable::RowReader reader(
+      client_, bigtable::TableId(""), bigtable::RowSet(),
+      bigtable::RowReader::NO_ROWS_LIMIT, bigtable::Filter::PassAllFilter(),
+      std::move(retry_policy_), std::move(backoff_policy_),
+      metadata_update_policy_, std::move(parser_factory_), false);
+  reader.SetMemoryBudget(512);
+
+  EXPECT_EQ(reader.begin(), reader.end());
+  grpc::Status status = reader.Finish();
+  EXPECT_EQ(grpc::StatusCode::RESOURCE_EXHAUSTED, status.error_code());
+  EXPECT_LT(512U, reader.memory_high_water_mark());
+}
+
+TEST_F(RowReaderTest, MemoryBudgetSmallerThanResponse) {
+  auto* stream = new MockReadRowsReader;  // wrapped in unique_ptr by ReadRows
+  // A single response with several rows, each of them fits in the budget,
+  // but the response as a whole does not.
+  ReadRowsResponse response;
+  for (auto const& key : {"r1", "r2", "r3", "r4"}) {
+    auto& chunk = *response.add_chunks();
+    chunk.set_row_key(key);
+    chunk.mutable_family_name()->set_value("fam");
+    chunk.mutable_qualifier()->set_value("qual");
+    chunk.set_value(std::string(200, 'x'));
+    chunk.set_commit_row(true);
+  }
+  ASSERT_LT(512U, response.ByteSizeLong());
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*client_, ReadRows(_, _))
+        .WillOnce(Invoke(stream->MakeMockReturner()));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  bigtable::RowReader reader(
+      client_, bigtable::TableId(""), bigtable::RowSet(),
+      bigtable::RowReader::NO_ROWS_LIMIT, bigtable::Filter::PassAllFilter(),
+      std::move(retry_policy_), std::move(backoff_policy_),
+      metadata_update_policy_, std::move(parser_factory_), false);
+  reader.SetMemoryBudget(512);
+
+  std::vector<std::string> keys;
+  for (auto it = reader.begin(); it != reader.end(); ++it) {
+    keys.emplace_back(it->row_key());
+  }
+  EXPECT_THAT(keys, testing::ElementsAre("r1", "r2", "r3", "r4"));
+  EXPECT_TRUE(reader.Finish().ok());
+  EXPECT_GE(512U, reader.memory_high_water_mark());
+}
+
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 
 using testing::Throw;
@@ -0,0 +1,66 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VIEW_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VIEW_H_
+
+#include "google/cloud/bigtable/cell_view.h"
+#include "google/cloud/bigtable/row.h"
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * A non-owning view of a Bigtable row.
+ *
+ * This is the counterpart of `Row` for `RowViewReader`.  The row key and the
+ * cells refer to the buffers of the `ReadRowsResponse` messages received from
+ * the server, they are only valid until the `RowViewReader` iterator advances.
+ * Use `ToRow()` to keep a copy.
+ */
+class RowView {
+ public:
+  RowView() : row_key_(nullptr) {}
+
+  /// Return the row key.
+  std::string const& row_key() const { return *row_key_; }
+
+  /// Return all cells.
+  std::vector<CellView> const& cells() const { return cells_; }
+
+  /// Return a copy of the row that owns all its data.
+  Row ToRow() const {
+    std::vector<Cell> cells;
+    cells.reserve(cells_.size());
+    for (auto const& c : cells_) {
+      cells.emplace_back(c.ToCell());
+    }
+    return Row(*row_key_, std::move(cells));
+  }
+
+ private:
+  friend class internal::ReadRowsViewParser;
+
+  std::string const* row_key_;
+  std::vector<CellView> cells_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VIEW_H_
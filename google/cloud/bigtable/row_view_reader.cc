@@ -0,0 +1,204 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_view_reader.h"
+#include "google/cloud/bigtable/internal/table.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+std::int64_t constexpr RowViewReader::NO_ROWS_LIMIT;
+
+RowViewReader::RowViewReader(
+    std::shared_ptr<DataClient> client, bigtable::AppProfileId app_profile_id,
+    bigtable::TableId table_name, RowSet row_set, std::int64_t rows_limit,
+    Filter filter, std::unique_ptr<RPCRetryPolicy> retry_policy,
+    std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+    MetadataUpdatePolicy metadata_update_policy, bool raise_on_error)
+    : client_(std::move(client)),
+      app_profile_id_(std::move(app_profile_id)),
+      table_name_(std::move(table_name)),
+      row_set_(row_set),
+      rows_limit_(rows_limit),
+      filter_(std::move(filter)),
+      retry_policy_(std::move(retry_policy)),
+      backoff_policy_(std::move(backoff_policy)),
+      metadata_update_policy_(std::move(metadata_update_policy)),
+      stream_is_open_(false),
+      operation_cancelled_(false),
+      rows_count_(0),
+      status_(grpc::Status::OK),
+      raise_on_error_(raise_on_error),
+      error_retrieved_(raise_on_error) {}
+
+RowViewReader::~RowViewReader() {
+  // Make sure we don't leave open streams.
+  Cancel();
+  if (not raise_on_error_ and not error_retrieved_ and not status_.ok()) {
+    google::cloud::internal::RaiseRuntimeError(
+        "Exception is disabled and error is not retrieved");
+  }
+}
+
+// The name must be all lowercase to work with range-for loops.
+// NOLINTNEXTLINE(readability-identifier-naming)
+RowViewReader::iterator RowViewReader::begin() {
+  if (operation_cancelled_) {
+    if (raise_on_error_) {
+      google::cloud::internal::RaiseRuntimeError(
+          "Operation already cancelled.");
+    }
+    status_ = grpc::Status::CANCELLED;
+    return end();
+  }
+  if (not stream_) {
+    MakeRequest();
+  }
+  return iterator(this, Advance());
+}
+
+void RowViewReader::Cancel() {
+  operation_cancelled_ = true;
+  if (not stream_is_open_) {
+    return;
+  }
+  context_->TryCancel();
+
+  // Also drain any data left unread
+  google::bigtable::v2::ReadRowsResponse response;
+  while (stream_->Read(&response)) {
+  }
+
+  stream_is_open_ = false;
+  (void)stream_->Finish();  // ignore errors
+}
+
+RowView const* RowViewReader::Advance() {
+  while (true) {
+    bool has_row = false;
+    grpc::Status status;
+    status_ = status = AdvanceOrFail(has_row);
+    if (status.ok()) {
+      return has_row ? &parser_->row() : nullptr;
+    }
+
+    // Same as `RowReader::Advance()`: if all the requested rows have been
+    // received there is no need to retry, and there is no good value for the
+    // rows_limit anyway.
+    if (rows_limit_ != NO_ROWS_LIMIT and rows_limit_ <= rows_count_) {
+      return nullptr;
+    }
+
+    if (not last_read_row_key_.empty()) {
+      row_set_.ResumeAfter(last_read_row_key_);
+    }
+
+    // If we receive an error, but the retriable set is empty, stop.
+    if (row_set_.IsEmpty()) {
+      return nullptr;
+    }
+
+    if (not retry_policy_->OnFailure(status)) {
+      if (raise_on_error_) {
+        google::cloud::internal::RaiseRuntimeError("Unretriable error: " +
+                                                   status.error_message());
+        /*NOTREACHED*/
+      }
+      return nullptr;
+    }
+
+    auto delay = backoff_policy_->OnCompletion(status);
+    std::this_thread::sleep_for(delay);
+
+    // If we reach this place, we failed and need to restart the call.
+    MakeRequest();
+  }
+}
+
+grpc::Status RowViewReader::AdvanceOrFail(bool& has_row) {
+  grpc::Status status;
+  has_row = false;
+  while (not parser_->NextRow(status)) {
+    if (not status.ok()) {
+      return status;
+    }
+    google::bigtable::v2::ReadRowsResponse response;
+    if (stream_->Read(&response)) {
+      parser_->HandleResponse(std::move(response));
+      continue;
+    }
+
+    // Here, there are no more responses to look at. Close the stream,
+    // finalize the parser and return OK with no rows unless something
+    // fails during cleanup.
+    stream_is_open_ = false;
+    status = stream_->Finish();
+    if (not status.ok()) {
+      return status;
+    }
+    parser_->HandleEndOfStream(status);
+    return status;
+  }
+
+  has_row = true;
+  ++rows_count_;
+  last_read_row_key_ = parser_->row().row_key();
+  return status;
+}
+
+void RowViewReader::MakeRequest() {
+  google::bigtable::v2::ReadRowsRequest request;
+
+  bigtable::internal::SetCommonTableOperationRequest<
+      google::bigtable::v2::ReadRowsRequest>(request, app_profile_id_.get(),
+                                             table_name_.get());
+  row_set_.CopyTo(*request.mutable_rows());
+
+  auto filter_proto = filter_.as_proto();
+  request.mutable_filter()->Swap(&filter_proto);
+
+  if (rows_limit_ != NO_ROWS_LIMIT) {
+    request.set_rows_limit(rows_limit_ - rows_count_);
+  }
+
+  // The previous stream (if any) uses the old context. A stream that failed
+  // in the parser is still open, cancel and drain it before releasing both.
+  if (stream_is_open_) {
+    context_->TryCancel();
+    google::bigtable::v2::ReadRowsResponse response;
+    while (stream_->Read(&response)) {
+    }
+    stream_is_open_ = false;
+    (void)stream_->Finish();  // ignore errors
+  }
+  stream_.reset();
+  context_ = google::cloud::internal::make_unique<grpc::ClientContext>();
+  retry_policy_->Setup(*context_);
+  backoff_policy_->Setup(*context_);
+  metadata_update_policy_.Setup(*context_);
+  stream_ = client_->ReadRows(context_.get(), request);
+  stream_is_open_ = true;
+
+  parser_ =
+      google::cloud::internal::make_unique<internal::ReadRowsViewParser>();
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,172 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VIEW_READER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VIEW_READER_H_
+
+#include "google/cloud/bigtable/bigtable_strong_types.h"
+#include "google/cloud/bigtable/data_client.h"
+#include "google/cloud/bigtable/filters.h"
+#include "google/cloud/bigtable/internal/normalized_row_set.h"
+#include "google/cloud/bigtable/internal/readrows_view_parser.h"
+#include "google/cloud/bigtable/metadata_update_policy.h"
+#include "google/cloud/bigtable/row_set.h"
+#include "google/cloud/bigtable/row_view.h"
+#include "google/cloud/bigtable/rpc_backoff_policy.h"
+#include "google/cloud/bigtable/rpc_retry_policy.h"
+#include "google/cloud/bigtable/table_strong_types.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+#include <cinttypes>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Object returned by Table::ReadRowViews(), enumerates rows without copies.
+ *
+ * This class provides the same functionality as `RowReader`, including the
+ * retry and resume semantics, but the rows are returned as `RowView` objects
+ * that refer to the buffers of the responses received from the server.  For
+ * scans of wide rows with small values this avoids most of the memory
+ * allocations required to create `Row` and `Cell` objects.
+ *
+ * The `RowView` returned by the iterator is only valid until the iterator is
+ * incremented.  Applications that need to keep a row must copy it using
+ * `RowView::ToRow()`.
+ */
+class RowViewReader {
+ public:
+  /// A constant for the magic value that means "no limit, get all rows".
+  static std::int64_t constexpr NO_ROWS_LIMIT = 0;
+
+  RowViewReader(std::shared_ptr<DataClient> client,
+                bigtable::AppProfileId app_profile_id,
+                bigtable::TableId table_name, RowSet row_set,
+                std::int64_t rows_limit, Filter filter,
+                std::unique_ptr<RPCRetryPolicy> retry_policy,
+                std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+                MetadataUpdatePolicy metadata_update_policy,
+                bool raise_on_error = false);
+
+  RowViewReader(RowViewReader&& rhs) noexcept = default;
+
+  ~RowViewReader();
+
+  /// The input iterator used to scan the rows in a `RowViewReader`.
+  class iterator {
+   public:
+    //@{
+    /// @name Iterator traits
+    using iterator_category = std::input_iterator_tag;
+    using value_type = RowView;
+    using difference_type = std::ptrdiff_t;
+    using pointer = RowView const*;
+    using reference = RowView const&;
+    //@}
+
+    iterator(RowViewReader* owner, RowView const* row)
+        : owner_(owner), row_(row) {}
+
+    iterator& operator++() {
+      row_ = owner_->Advance();
+      return *this;
+    }
+
+    RowView const* operator->() const { return row_; }
+    RowView const& operator*() const { return *row_; }
+
+    bool operator==(iterator const& that) const {
+      // All non-end iterators are equal.
+      return owner_ == that.owner_ and
+             (row_ == nullptr) == (that.row_ == nullptr);
+    }
+    bool operator!=(iterator const& that) const { return !(*this == that); }
+
+   private:
+    RowViewReader* owner_;
+    RowView const* row_;
+  };
+
+  /**
+   * Input iterator over rows in the response.
+   *
+   * Retry and backoff policies are honored.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   */
+  iterator begin();
+
+  /// End iterator over the rows in the response.
+  iterator end() { return iterator(this, nullptr); }
+
+  /**
+   * Gracefully terminate a streaming read.
+   *
+   * Invalidates iterators.
+   */
+  void Cancel();
+
+  /// Return the status of the read, see `RowReader::Finish()`.
+  grpc::Status Finish() {
+    error_retrieved_ = true;
+    return status_;
+  }
+
+ private:
+  /// Read and parse the next row, return nullptr at the end of the stream.
+  RowView const* Advance();
+
+  /// Called by Advance(), does not handle retries.
+  grpc::Status AdvanceOrFail(bool& has_row);
+
+  /// Sends the ReadRows request to the stub.
+  void MakeRequest();
+
+  std::shared_ptr<DataClient> client_;
+  bigtable::AppProfileId app_profile_id_;
+  bigtable::TableId table_name_;
+  internal::NormalizedRowSet row_set_;
+  std::int64_t rows_limit_;
+  Filter filter_;
+  std::unique_ptr<RPCRetryPolicy> retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> backoff_policy_;
+  MetadataUpdatePolicy metadata_update_policy_;
+
+  std::unique_ptr<grpc::ClientContext> context_;
+  std::unique_ptr<internal::ReadRowsViewParser> parser_;
+  std::unique_ptr<
+      grpc::ClientReaderInterface<google::bigtable::v2::ReadRowsResponse>>
+      stream_;
+  bool stream_is_open_;
+  bool operation_cancelled_;
+
+  /// Number of rows read so far, used to set row_limit in retries.
+  std::int64_t rows_count_;
+  /// Holds the last read row key, for retries.
+  std::string last_read_row_key_;
+
+  grpc::Status status_;
+  bool raise_on_error_;
+  bool error_retrieved_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VIEW_READER_H_
@@ -0,0 +1,184 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/row_view_reader.h"
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/bigtable/testing/mock_read_rows_reader.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace ::testing;
+
+/// Define helper types and functions for this test.
+namespace {
+class RowViewReaderTest : public bigtable::testing::TableTestFixture {};
+using bigtable::testing::MockReadRowsReader;
+
+/// Create a response with one single-cell row for each key in @p keys.
+btproto::ReadRowsResponse MakeResponse(std::vector<std::string> const& keys) {
+  btproto::ReadRowsResponse response;
+  for (auto const& key : keys) {
+    auto& chunk = *response.add_chunks();
+    chunk.set_row_key(key);
+    chunk.mutable_family_name()->set_value("fam");
+    chunk.mutable_qualifier()->set_value("col");
+    chunk.set_value("value-" + key);
+    chunk.set_commit_row(true);
+  }
+  return response;
+}
+
+/// A retry policy that retries every error, including parser errors.
+class RetryAllPolicy : public bigtable::RPCRetryPolicy {
+ public:
+  std::unique_ptr<bigtable::RPCRetryPolicy> clone() const override {
+    return std::unique_ptr<bigtable::RPCRetryPolicy>(new RetryAllPolicy);
+  }
+  void Setup(grpc::ClientContext&) const override {}
+  bool OnFailure(grpc::Status const&) override { return true; }
+};
+}  // anonymous namespace
+
+/// @test Verify that RowViewReader returns the rows in the stream.
+TEST_F(RowViewReaderTest, ReadRows) {
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({"r1", "r2"})),
+                      Return(true)))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({"r3"})), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto reader = table_.ReadRowViews(bigtable::RowSet(),
+                                    bigtable::Filter::PassAllFilter());
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for (auto const& row : reader) {
+    keys.emplace_back(row.row_key());
+    for (auto const& cell : row.cells()) {
+      values.emplace_back(cell.value());
+    }
+  }
+  EXPECT_THAT(keys, ElementsAre("r1", "r2", "r3"));
+  EXPECT_THAT(values, ElementsAre("value-r1", "value-r2", "value-r3"));
+}
+
+/// @test Verify that RowViewReader resumes after the last row on retries.
+TEST_F(RowViewReaderTest, RetryResumesAfterLastRow) {
+  auto stream = new MockReadRowsReader;
+  auto stream_retry = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()))
+      .WillOnce(Invoke([stream_retry](grpc::ClientContext*,
+                                      btproto::ReadRowsRequest const& r) {
+        EXPECT_EQ(1, r.rows().row_ranges_size());
+        EXPECT_EQ("r1", r.rows().row_ranges(0).start_key_open());
+        return stream_retry->AsUniqueMocked();
+      }));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({"r1"})), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(grpc::Status(grpc::StatusCode::UNAVAILABLE, "retry")));
+  EXPECT_CALL(*stream_retry, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({"r2"})), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto reader = table_.ReadRowViews(bigtable::RowSet(),
+                                    bigtable::Filter::PassAllFilter());
+  std::vector<std::string> keys;
+  for (auto const& row : reader) {
+    keys.emplace_back(row.row_key());
+  }
+  EXPECT_THAT(keys, ElementsAre("r1", "r2"));
+}
+
+/// @test Verify that RowViewReader closes a stream that failed in the parser.
+TEST_F(RowViewReaderTest, RetryAfterParserError) {
+  auto stream = new MockReadRowsReader;
+  auto stream_retry = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()))
+      .WillOnce(Invoke([stream_retry](grpc::ClientContext*,
+                                      btproto::ReadRowsRequest const& r) {
+        EXPECT_EQ(1, r.rows().row_ranges_size());
+        EXPECT_EQ("r1", r.rows().row_ranges(0).start_key_open());
+        return stream_retry->AsUniqueMocked();
+      }));
+  // A new column family without a qualifier is a parser error.
+  btproto::ReadRowsResponse invalid;
+  auto& chunk = *invalid.add_chunks();
+  chunk.set_row_key("r2");
+  chunk.mutable_family_name()->set_value("fam");
+  // The failed stream is still open, it must be drained and finished before
+  // the retry replaces it.
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({"r1"})), Return(true)))
+      .WillOnce(DoAll(SetArgPointee<0>(invalid), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(grpc::Status(grpc::StatusCode::CANCELLED, "")));
+  EXPECT_CALL(*stream_retry, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({"r2"})), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  bigtable::Table table(client_, kTableId, RetryAllPolicy());
+  auto reader = table.ReadRowViews(bigtable::RowSet(),
+                                   bigtable::Filter::PassAllFilter());
+  std::vector<std::string> keys;
+  for (auto const& row : reader) {
+    keys.emplace_back(row.row_key());
+  }
+  EXPECT_THAT(keys, ElementsAre("r1", "r2"));
+}
+
+/// @test Verify that RowViewReader reports permanent errors via Finish().
+TEST_F(RowViewReaderTest, PermanentErrorNoRaise) {
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(
+          Return(grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+
+  bigtable::noex::Table table(client_, "foo-table");
+  auto reader = table.ReadRowViews(bigtable::RowSet(),
+                                   bigtable::RowViewReader::NO_ROWS_LIMIT,
+                                   bigtable::Filter::PassAllFilter());
+  EXPECT_EQ(reader.end(), reader.begin());
+  EXPECT_EQ(grpc::StatusCode::PERMISSION_DENIED, reader.Finish().error_code());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that RowViewReader raises permanent errors.
+TEST_F(RowViewReaderTest, PermanentErrorRaises) {
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(
+          Return(grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+
+  auto reader = table_.ReadRowViews(bigtable::RowSet(),
+                                    bigtable::Filter::PassAllFilter());
+  EXPECT_THROW(reader.begin(), std::exception);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,65 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VISITOR_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VISITOR_H_
+
+#include "google/cloud/bigtable/cell_view.h"
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Receive the rows of a `Table::VisitRows()` scan as a stream of callbacks.
+ *
+ * Scans that only aggregate values (counts, sums, maximum timestamps) do not
+ * need `Row` or `RowView` objects.  `Table::VisitRows()` parses the responses
+ * from the server and calls this interface for each row and cell as soon as
+ * they are complete, without creating any intermediate objects.
+ *
+ * For each row the calls are `OnRowStart()`, `OnCell()` once per cell, and
+ * then either `OnRowEnd()` or `OnRowReset()`.  `OnRowReset()` is called when
+ * the server resets the row, or when the stream fails before the row is
+ * committed.  The application must discard anything it accumulated for the
+ * row since `OnRowStart()`, the complete row is delivered again after the
+ * reset or the retry.  Rows are only counted as received (for the
+ * `rows_limit` and to resume the scan) once `OnRowEnd()` is called.
+ *
+ * The `CellView` and row key parameters are only valid during the call.
+ */
+class RowVisitor {
+ public:
+  virtual ~RowVisitor() = default;
+
+  /// A new row, its cells are delivered next.
+  virtual void OnRowStart(std::string const& /*row_key*/) {}
+
+  /// A complete cell in the current row.
+  virtual void OnCell(CellView const& cell) = 0;
+
+  /// The current row is complete.
+  virtual void OnRowEnd() {}
+
+  /// Discard the cells received for the current row.
+  virtual void OnRowReset() {}
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_ROW_VISITOR_H_
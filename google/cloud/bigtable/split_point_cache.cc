@@ -0,0 +1,130 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/split_point_cache.h"
+#include "google/cloud/bigtable/internal/grpc_error_delegate.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+SplitPoints::SplitPoints(std::vector<RowKeySample> const& samples) {
+  // The last sample is typically the empty key, meaning "end of table", it
+  // cannot be used as a split point.
+  keys_.reserve(samples.size());
+  for (auto const& sample : samples) {
+    if (not sample.row_key.empty()) {
+      keys_.push_back(sample.row_key);
+    }
+  }
+  std::sort(keys_.begin(), keys_.end());
+  keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+}
+
+std::size_t SplitPoints::ShardIndex(std::string const& row_key) const {
+  return static_cast<std::size_t>(
+      std::upper_bound(keys_.begin(), keys_.end(), row_key) - keys_.begin());
+}
+
+RowRange SplitPoints::ShardRange(std::size_t index) const {
+  if (index > keys_.size()) {
+    return RowRange::Empty();
+  }
+  if (index == keys_.size()) {
+    return RowRange::StartingAt(index == 0 ? std::string() : keys_.back());
+  }
+  return RowRange::RightOpen(index == 0 ? std::string() : keys_[index - 1],
+                             keys_[index]);
+}
+
+SplitPointCache::SplitPointCache(noex::Table table,
+                                 std::chrono::milliseconds refresh_interval)
+    : table_(std::move(table)),
+      refresh_interval_(refresh_interval),
+      refresh_count_(0),
+      refresh_failures_(0),
+      shutdown_(false) {
+  Refresh();
+  if (refresh_interval_.count() > 0) {
+    refresh_thread_ = std::thread(&SplitPointCache::RefreshLoop, this);
+  }
+}
+
+SplitPointCache::~SplitPointCache() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+    cv_.notify_all();
+  }
+  if (refresh_thread_.joinable()) {
+    refresh_thread_.join();
+  }
+}
+
+std::shared_ptr<SplitPoints const> SplitPointCache::snapshot() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return current_;
+}
+
+void SplitPointCache::Refresh() {
+  grpc::Status status;
+  Refresh(status);
+  if (not status.ok()) {
+    internal::RaiseRpcError(status, status.error_message());
+  }
+}
+
+void SplitPointCache::Refresh(grpc::Status& status) {
+  auto samples = table_.SampleRows<std::vector>(status);
+  if (not status.ok()) {
+    return;
+  }
+  // Parse the samples before taking the lock, readers are never blocked by
+  // the RPC or the sort.
+  auto split_points = std::make_shared<SplitPoints const>(samples);
+  std::lock_guard<std::mutex> lk(mu_);
+  current_ = std::move(split_points);
+  ++refresh_count_;
+}
+
+std::int64_t SplitPointCache::refresh_count() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return refresh_count_;
+}
+
+std::int64_t SplitPointCache::refresh_failures() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return refresh_failures_;
+}
+
+void SplitPointCache::RefreshLoop() {
+  std::unique_lock<std::mutex> lk(mu_);
+  while (not cv_.wait_for(lk, refresh_interval_,
+                          [this] { return shutdown_; })) {
+    lk.unlock();
+    grpc::Status status;
+    Refresh(status);
+    lk.lock();
+    if (not status.ok()) {
+      // Keep the previous split points, they are still a good approximation.
+      ++refresh_failures_;
+    }
+  }
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,164 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_SPLIT_POINT_CACHE_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_SPLIT_POINT_CACHE_H_
+
+#include "google/cloud/bigtable/internal/table.h"
+#include "google/cloud/bigtable/row_range.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * An immutable set of split points, dividing the row key space into shards.
+ *
+ * The split points are the row keys returned by `Table::SampleRows()`, which
+ * are (approximately) the tablet boundaries.  Shard `i` contains the keys in
+ * `[split[i - 1], split[i])`, the first shard starts at the beginning of the
+ * table and the last one ends at the end of the table.
+ */
+class SplitPoints {
+ public:
+  /// A single shard covering the whole table.
+  SplitPoints() = default;
+
+  /// Create the split points from the result of `Table::SampleRows()`.
+  explicit SplitPoints(std::vector<RowKeySample> const& samples);
+
+  /// The split points, sorted and without duplicates.
+  std::vector<std::string> const& keys() const { return keys_; }
+
+  /// The number of shards, always one more than the number of split points.
+  std::size_t shard_count() const { return keys_.size() + 1; }
+
+  /// The index of the shard containing @p row_key, uses a binary search.
+  std::size_t ShardIndex(std::string const& row_key) const;
+
+  /// The range of row keys in the shard at @p index.
+  RowRange ShardRange(std::size_t index) const;
+
+ private:
+  std::vector<std::string> keys_;
+};
+
+/**
+ * Share the split points of a table, refreshing them in the background.
+ *
+ * `Table::SampleRows()` is a streaming RPC, too expensive to call for every
+ * routing decision.  This class calls it once when created, and then every
+ * `refresh_interval` from a background thread.  The application can route
+ * row keys to shards with `ShardIndex()`, or take a consistent `snapshot()`
+ * to make several decisions using the same split points.
+ *
+ * Failures in the background refresh keep the previous split points, they are
+ * counted in `refresh_failures()`.  This class is thread-safe.
+ *
+ * The cache uses a `noex::Table` because the background thread must not raise
+ * (or, in builds without exceptions, abort on) errors.
+ *
+ * @par Example
+ * @code
+ * bigtable::SplitPointCache splits(bigtable::noex::Table(client, "my-table"),
+ *                                  std::chrono::minutes(5));
+ * for (auto& key : keys) {
+ *   queues[splits.ShardIndex(key) % queues.size()].push(key);
+ * }
+ * @endcode
+ */
+class SplitPointCache {
+ public:
+  /// The default interval between refreshes.
+  static std::chrono::milliseconds DefaultRefreshInterval() {
+    return std::chrono::minutes(5);
+  }
+
+  /**
+   * Load the split points of @p table and refresh them periodically.
+   *
+   * @param table the table to sample, its retry and backoff policies are used
+   *     for each refresh.
+   * @param refresh_interval how often the split points are refreshed, zero
+   *     disables the background refresh, the application can still call
+   *     `Refresh()`.
+   *
+   * @throws bigtable::GRpcError if the initial `SampleRows()` call fails.
+   */
+  explicit SplitPointCache(
+      noex::Table table,
+      std::chrono::milliseconds refresh_interval = DefaultRefreshInterval());
+
+  /// Stop the background refresh.
+  ~SplitPointCache();
+
+  SplitPointCache(SplitPointCache const&) = delete;
+  SplitPointCache& operator=(SplitPointCache const&) = delete;
+
+  /// The current split points, they do not change after they are returned.
+  std::shared_ptr<SplitPoints const> snapshot() const;
+
+  /// The number of shards in the current split points.
+  std::size_t shard_count() const { return snapshot()->shard_count(); }
+
+  /// The index of the shard containing @p row_key in the current split points.
+  std::size_t ShardIndex(std::string const& row_key) const {
+    return snapshot()->ShardIndex(row_key);
+  }
+
+  /**
+   * Reload the split points now.
+   *
+   * @throws bigtable::GRpcError if `SampleRows()` fails, the previous split
+   *     points are kept in that case.
+   */
+  void Refresh();
+
+  //@{
+  /// @name Counters to monitor the refresh.
+  std::int64_t refresh_count() const;
+  std::int64_t refresh_failures() const;
+  //@}
+
+ private:
+  /// Reload the split points, returning the error instead of raising it.
+  void Refresh(grpc::Status& status);
+  void RefreshLoop();
+
+  noex::Table table_;
+  std::chrono::milliseconds refresh_interval_;
+
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::shared_ptr<SplitPoints const> current_;
+  std::int64_t refresh_count_;
+  std::int64_t refresh_failures_;
+  bool shutdown_;
+  std::thread refresh_thread_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_SPLIT_POINT_CACHE_H_
@@ -0,0 +1,177 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/split_point_cache.h"
+#include "google/cloud/bigtable/parallel_row_reader.h"
+#include "google/cloud/bigtable/testing/mock_sample_row_keys_reader.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+#include <thread>
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace ::testing;
+
+/// Define helper types and functions for this test.
+namespace {
+class SplitPointCacheTest : public bigtable::testing::TableTestFixture {};
+using bigtable::testing::MockSampleRowKeysReader;
+
+using SampleStream = std::unique_ptr<
+    grpc::ClientReaderInterface<btproto::SampleRowKeysResponse>>;
+
+/// Return a functor that creates a stream returning @p keys as samples.
+std::function<SampleStream(grpc::ClientContext*,
+                           btproto::SampleRowKeysRequest const&)>
+MakeSamples(std::vector<std::string> keys) {
+  return [keys](grpc::ClientContext*, btproto::SampleRowKeysRequest const&) {
+    auto stream = new MockSampleRowKeysReader;
+    auto responses = std::make_shared<std::vector<std::string>>(keys);
+    responses->emplace_back("");
+    auto index = std::make_shared<std::size_t>(0);
+    EXPECT_CALL(*stream, Read(_))
+        .WillRepeatedly(
+            Invoke([responses, index](btproto::SampleRowKeysResponse* r) {
+              if (*index == responses->size()) {
+                return false;
+              }
+              r->set_row_key((*responses)[*index]);
+              r->set_offset_bytes(static_cast<std::int64_t>(*index) * 1000);
+              ++*index;
+              return true;
+            }));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+    return stream->AsUniqueMocked();
+  };
+}
+
+/// Return a functor that creates a stream failing with a permanent error.
+std::function<SampleStream(grpc::ClientContext*,
+                           btproto::SampleRowKeysRequest const&)>
+MakeFailure() {
+  return [](grpc::ClientContext*, btproto::SampleRowKeysRequest const&) {
+    auto stream = new MockSampleRowKeysReader;
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(
+            Return(grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh")));
+    return stream->AsUniqueMocked();
+  };
+}
+
+std::vector<bigtable::RowKeySample> Samples(
+    std::vector<std::string> const& keys) {
+  std::vector<bigtable::RowKeySample> samples;
+  for (auto const& k : keys) {
+    samples.push_back(bigtable::RowKeySample{k, 0});
+  }
+  return samples;
+}
+}  // anonymous namespace
+
+/// @test Verify that SplitPoints sorts the samples and drops the end marker.
+TEST(SplitPointsTest, FromSamples) {
+  bigtable::SplitPoints split_points(Samples({"m", "", "f", "m", "t"}));
+  EXPECT_THAT(split_points.keys(), ElementsAre("f", "m", "t"));
+  EXPECT_EQ(4U, split_points.shard_count());
+}
+
+/// @test Verify that SplitPoints finds the shard for each key.
+TEST(SplitPointsTest, ShardIndex) {
+  bigtable::SplitPoints split_points(Samples({"f", "m", "t"}));
+  EXPECT_EQ(0U, split_points.ShardIndex(""));
+  EXPECT_EQ(0U, split_points.ShardIndex("a"));
+  EXPECT_EQ(1U, split_points.ShardIndex("f"));
+  EXPECT_EQ(1U, split_points.ShardIndex("ff"));
+  EXPECT_EQ(2U, split_points.ShardIndex("m"));
+  EXPECT_EQ(3U, split_points.ShardIndex("z"));
+
+  bigtable::SplitPoints empty;
+  EXPECT_EQ(1U, empty.shard_count());
+  EXPECT_EQ(0U, empty.ShardIndex("any"));
+}
+
+/// @test Verify that the shard ranges match ShardIndex().
+TEST(SplitPointsTest, ShardRange) {
+  bigtable::SplitPoints split_points(Samples({"f", "m"}));
+  for (auto const& key : {"", "a", "f", "g", "m", "z"}) {
+    auto index = split_points.ShardIndex(key);
+    for (std::size_t i = 0; i != split_points.shard_count(); ++i) {
+      EXPECT_EQ(i == index, split_points.ShardRange(i).Contains(key))
+          << "key=" << key << ", i=" << i;
+    }
+  }
+  EXPECT_TRUE(split_points.ShardRange(3).IsEmpty());
+}
+
+/// @test Verify that ShardRowSet() creates a shard per non-empty range.
+TEST(SplitPointsTest, ShardRowSet) {
+  bigtable::SplitPoints split_points(Samples({"f", "m", "t"}));
+  auto shards =
+      bigtable::ShardRowSet(bigtable::RowSet("a", "b", "g"), split_points);
+  ASSERT_EQ(2U, shards.size());
+  EXPECT_EQ(2, shards[0].as_proto().row_keys_size());
+  EXPECT_EQ(1, shards[1].as_proto().row_keys_size());
+}
+
+/// @test Verify that SplitPointCache loads and refreshes the split points.
+TEST_F(SplitPointCacheTest, Refresh) {
+  EXPECT_CALL(*client_, SampleRowKeys(_, _))
+      .WillOnce(Invoke(MakeSamples({"m"})))
+      .WillOnce(Invoke(MakeSamples({"f", "m"})));
+
+  bigtable::SplitPointCache cache(bigtable::noex::Table(client_, kTableId),
+                                  std::chrono::milliseconds(0));
+  EXPECT_EQ(1, cache.refresh_count());
+  EXPECT_EQ(2U, cache.shard_count());
+  auto before = cache.snapshot();
+
+  cache.Refresh();
+  EXPECT_EQ(2, cache.refresh_count());
+  EXPECT_EQ(3U, cache.shard_count());
+  EXPECT_EQ(1U, cache.ShardIndex("g"));
+  // Existing snapshots do not change.
+  EXPECT_EQ(2U, before->shard_count());
+}
+
+/// @test Verify that SplitPointCache refreshes in the background.
+TEST_F(SplitPointCacheTest, BackgroundRefresh) {
+  EXPECT_CALL(*client_, SampleRowKeys(_, _))
+      .WillOnce(Invoke(MakeSamples({"m"})))
+      .WillRepeatedly(Invoke(MakeSamples({"f", "m"})));
+
+  bigtable::SplitPointCache cache(bigtable::noex::Table(client_, kTableId),
+                                  std::chrono::milliseconds(1));
+  for (int i = 0; i != 1000 and cache.refresh_count() < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_LE(2, cache.refresh_count());
+  EXPECT_EQ(3U, cache.shard_count());
+  EXPECT_EQ(0, cache.refresh_failures());
+}
+
+/// @test Verify that background refresh failures keep the split points.
+TEST_F(SplitPointCacheTest, BackgroundRefreshFailure) {
+  EXPECT_CALL(*client_, SampleRowKeys(_, _))
+      .WillOnce(Invoke(MakeSamples({"m"})))
+      .WillRepeatedly(Invoke(MakeFailure()));
+
+  bigtable::SplitPointCache cache(bigtable::noex::Table(client_, kTableId),
+                                  std::chrono::milliseconds(1));
+  for (int i = 0; i != 1000 and cache.refresh_failures() < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_LE(2, cache.refresh_failures());
+  EXPECT_EQ(1, cache.refresh_count());
+  EXPECT_EQ(2U, cache.shard_count());
+}
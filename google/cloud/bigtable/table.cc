@@ -75,6 +75,41 @@ RowReader Table::ReadRows(RowSet row_set, std::int64_t rows_limit,
                         true);
 }
 
+RowViewReader Table::ReadRowViews(RowSet row_set, Filter filter) {
+  return impl_.ReadRowViews(std::move(row_set), RowViewReader::NO_ROWS_LIMIT,
+                            std::move(filter), true);
+}
+
+RowViewReader Table::ReadRowViews(RowSet row_set, std::int64_t rows_limit,
+                                  Filter filter) {
+  return impl_.ReadRowViews(std::move(row_set), rows_limit, std::move(filter),
+                            true);
+}
+
+void Table::VisitRows(RowSet row_set, Filter filter, RowVisitor& visitor) {
+  VisitRows(std::move(row_set), RowReader::NO_ROWS_LIMIT, std::move(filter),
+            visitor);
+}
+
+void Table::VisitRows(RowSet row_set, std::int64_t rows_limit, Filter filter,
+                      RowVisitor& visitor) {
+  auto status = impl_.VisitRows(std::move(row_set), rows_limit,
+                                std::move(filter), visitor);
+  if (not status.ok()) {
+    google::cloud::internal::RaiseRuntimeError("Unretriable error: " +
+                                               status.error_message());
+  }
+}
+
+ColumnarReader Table::ReadColumns(RowSet row_set, ColumnProjection projection,
+                                  Filter filter, std::size_t batch_rows) {
+  auto projected = Filter::Chain(std::move(filter), projection.filter());
+  return ColumnarReader(
+      impl_.ReadRowViews(std::move(row_set), RowViewReader::NO_ROWS_LIMIT,
+                         std::move(projected), true),
+      std::move(projection), batch_rows);
+}
+
 std::pair<bool, Row> Table::ReadRow(std::string row_key, Filter filter) {
   grpc::Status status;
   auto result = impl_.ReadRow(std::move(row_key), std::move(filter), status);
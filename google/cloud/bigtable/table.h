@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TABLE_H_
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TABLE_H_
 
+#include "google/cloud/bigtable/columnar_reader.h"
 #include "google/cloud/bigtable/internal/grpc_error_delegate.h"
 #include "google/cloud/bigtable/internal/table.h"
 
@@ -32,6 +33,10 @@ inline namespace BIGTABLE_CLIENT_NS {
  * - update or modify multiple rows: `Table::BulkApply()`
  * - update a row based on previous values: `Table::CheckAndMutateRow()`
  *
+ * Most of these member functions have an asynchronous version, e.g.,
+ * `Table::AsyncApply()`, which returns immediately and delivers the result to
+ * a callback running in a `CompletionQueue`.
+ *
  * The class deals with the most common transient failures, and retries the
  * underlying RPC calls subject to the policies configured by the application.
  * These policies are documented in`Table::Table()`.
@@ -109,10 +114,30 @@ class Table {
    *       allowed. Use `LimitedTimeRetryPolicy` to bound the time for any
    *       request. You can also create your own policies that combine time and
    *       error counts.
+   *     - `HedgingPolicy` when to send a second request in `ReadRow()`. Use
+   *       `FixedDelayHedgingPolicy` or `PercentileHedgingPolicy`. By default
+   *       requests are not hedged.
+   *     - `RowCache` to cache the results of `ReadRow()`. By default the
+   *       results are not cached.
+   *     - `ReadRowCoalescingPolicy` to combine concurrent `ReadRow()` calls
+   *       into a single request. By default each call uses its own request.
+   *     - `BulkApplyRateLimiter` to adapt the rate of `BulkApply()` requests
+   *       to the server load. By default the requests are not paced.
+   *     - `BulkApplySplitPolicy` to split large `BulkApply()` calls into
+   *       concurrent requests. By default the calls are split at the server
+   *       limits.
+   *     - `BulkApplyMergePolicy` to merge the mutations for the same row in
+   *       `BulkApply()`. By default the mutations are not merged.
+   *     - `ClientTimestampPolicy` to assign the timestamp of `SetCell()`
+   *       mutations in the client, making them safe to retry in `Apply()`
+   *       and `BulkApply()`. By default the server assigns the timestamps.
    *
    * @see SafeIdempotentMutationPolicy, AlwaysRetryMutationPolicy,
    *     ExponentialBackoffPolicy, LimitedErrorCountRetryPolicy,
-   *     LimitedTimeRetryPolicy.
+   *     LimitedTimeRetryPolicy, FixedDelayHedgingPolicy,
+   *     PercentileHedgingPolicy, RowCache, ReadRowCoalescingPolicy,
+   *     BulkApplyRateLimiter, BulkApplySplitPolicy, BulkApplyMergePolicy,
+   *     ClientTimestampPolicy.
    */
   template <typename... Policies>
   Table(std::shared_ptr<DataClient> client, std::string const& table_id,
@@ -163,10 +188,30 @@ class Table {
    *       allowed. Use `LimitedTimeRetryPolicy` to bound the time for any
    *       request. You can also create your own policies that combine time and
    *       error counts.
+   *     - `HedgingPolicy` when to send a second request in `ReadRow()`. Use
+   *       `FixedDelayHedgingPolicy` or `PercentileHedgingPolicy`. By default
+   *       requests are not hedged.
+   *     - `RowCache` to cache the results of `ReadRow()`. By default the
+   *       results are not cached.
+   *     - `ReadRowCoalescingPolicy` to combine concurrent `ReadRow()` calls
+   *       into a single request. By default each call uses its own request.
+   *     - `BulkApplyRateLimiter` to adapt the rate of `BulkApply()` requests
+   *       to the server load. By default the requests are not paced.
+   *     - `BulkApplySplitPolicy` to split large `BulkApply()` calls into
+   *       concurrent requests. By default the calls are split at the server
+   *       limits.
+   *     - `BulkApplyMergePolicy` to merge the mutations for the same row in
+   *       `BulkApply()`. By default the mutations are not merged.
+   *     - `ClientTimestampPolicy` to assign the timestamp of `SetCell()`
+   *       mutations in the client, making them safe to retry in `Apply()`
+   *       and `BulkApply()`. By default the server assigns the timestamps.
    *
    * @see SafeIdempotentMutationPolicy, AlwaysRetryMutationPolicy,
    *     ExponentialBackoffPolicy, LimitedErrorCountRetryPolicy,
-   *     LimitedTimeRetryPolicy.
+   *     LimitedTimeRetryPolicy, FixedDelayHedgingPolicy,
+   *     PercentileHedgingPolicy, RowCache, ReadRowCoalescingPolicy,
+   *     BulkApplyRateLimiter, BulkApplySplitPolicy, BulkApplyMergePolicy,
+   *     ClientTimestampPolicy.
    */
   template <typename... Policies>
   Table(std::shared_ptr<DataClient> client,
@@ -245,6 +290,99 @@ class Table {
    */
   RowReader ReadRows(RowSet row_set, std::int64_t rows_limit, Filter filter);
 
+  /**
+   * Reads a set of rows from the table without copying the cells.
+   *
+   * This is a lower-overhead alternative to `ReadRows()` for large scans.  The
+   * rows are returned as `RowView` objects that refer to the buffers received
+   * from the server, and are only valid until the iterator is incremented.
+   *
+   * @param row_set the rows to read from.
+   * @param filter is applied on the server-side to data in the rows.
+   *
+   * @par Example
+   * @code
+   * auto reader = table.ReadRowViews(bigtable::RowSet(),
+   *                                  bigtable::Filter::PassAllFilter());
+   * for (auto const& row : reader) {
+   *   for (auto const& cell : row.cells()) {
+   *     // ... cell.value() is valid until the next iteration ...
+   *   }
+   * }
+   * @endcode
+   */
+  RowViewReader ReadRowViews(RowSet row_set, Filter filter);
+
+  /**
+   * Reads a limited set of rows from the table without copying the cells.
+   *
+   * @param row_set the rows to read from.
+   * @param rows_limit the maximum number of rows to read.
+   * @param filter is applied on the server-side to data in the rows.
+   *
+   * @see `ReadRowViews(RowSet, Filter)` for the lifetime of the rows.
+   */
+  RowViewReader ReadRowViews(RowSet row_set, std::int64_t rows_limit,
+                             Filter filter);
+
+  /**
+   * Reads a set of rows from the table, calling @p visitor for each cell.
+   *
+   * This is the lowest-overhead way to scan a table, intended for scans that
+   * aggregate the data instead of keeping it.  The cells are passed to the
+   * visitor as they are parsed, without creating `Row` or `RowView` objects.
+   * The retry and resume semantics are the same as in `ReadRows()`, see
+   * `RowVisitor` for how partially delivered rows are handled.
+   *
+   * @param row_set the rows to read from.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param visitor receives the rows and cells.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   *
+   * @par Example
+   * @code
+   * struct CountCells : public bigtable::RowVisitor {
+   *   void OnCell(bigtable::CellView const&) override { ++count; }
+   *   void OnRowReset() override { count = committed; }
+   *   void OnRowEnd() override { committed = count; }
+   *   long count = 0;
+   *   long committed = 0;
+   * } counter;
+   * table.VisitRows(bigtable::RowSet(), bigtable::Filter::PassAllFilter(),
+   *                 counter);
+   * @endcode
+   */
+  void VisitRows(RowSet row_set, Filter filter, RowVisitor& visitor);
+
+  /**
+   * Reads a limited set of rows from the table, calling @p visitor for each
+   * cell.
+   *
+   * @param row_set the rows to read from.
+   * @param rows_limit the maximum number of rows to read.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param visitor receives the rows and cells.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   */
+  void VisitRows(RowSet row_set, std::int64_t rows_limit, Filter filter,
+                 RowVisitor& visitor);
+
+  /**
+   * Reads a set of rows from the table into columnar batches.
+   *
+   * @param row_set the rows to read from.
+   * @param projection the columns to materialize, and their types.
+   * @param filter is applied on the server-side to data in the rows, the
+   *     projection filter is chained after it.
+   * @param batch_rows the maximum number of rows in each batch.
+   *
+   * @see `ColumnarReader` for an example.
+   */
+  ColumnarReader ReadColumns(RowSet row_set, ColumnProjection projection,
+                             Filter filter, std::size_t batch_rows);
+
   /**
    * Read and return a single row from the table.
    *
@@ -256,6 +394,13 @@ class Table {
    *     has the contents of the Row.  Note that the contents may be empty
    *     if the filter expression removes all column families and columns.
    *
+   * If the table has a `HedgingPolicy` and the request has not completed after
+   * the hedging delay, a second request is sent on a different channel, and
+   * the first successful response is returned.  If the table has a `RowCache`
+   * the row may be returned from the cache, without contacting the service.
+   * If the table has a `ReadRowCoalescingPolicy` the row may be read in the
+   * same request as the rows requested by concurrent calls.
+   *
    * @par Example
    * @snippet bigtable_samples.cc read row
    */
@@ -340,6 +485,205 @@ class Table {
     return row;
   }
 
+  /**
+   * Make an asynchronous request to mutate a single row.
+   *
+   * @param mut the mutation. Note that this function takes ownership (and
+   *     then discards) the data in the mutation.
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param callback a functor to be called when the operation completes. It
+   *     must satisfy (using C++17 types):
+   *     static_assert(std::is_invocable_v<
+   *         Functor, CompletionQueue&,
+   *         google::bigtable::v2::MutateRowResponse&, grpc::Status&>);
+   * @return a handle to the pending operation, it can be used to cancel it.
+   *
+   * @tparam Functor the type of the callback.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncApply(SingleRowMutation&& mut,
+                                             CompletionQueue& cq,
+                                             Functor&& callback) {
+    return impl_.AsyncApply(std::move(mut), cq,
+                            std::forward<Functor>(callback));
+  }
+
+  /**
+   * Make an asynchronous request to mutate multiple rows.
+   *
+   * @param mut the mutations, note that this function takes ownership (and
+   *     then discards) the data in the mutation.
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param callback a functor to be called when the operation completes. It
+   *     must satisfy (using C++17 types):
+   *     static_assert(std::is_invocable_v<
+   *         Functor, CompletionQueue&, std::vector<FailedMutation>&,
+   *         grpc::Status&>);
+   *     The vector contains the mutations that could not be applied, using the
+   *     same conventions as the exception raised by `BulkApply()`.
+   * @return a handle to the pending operation, it can be used to cancel it.
+   *
+   * @tparam Functor the type of the callback.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncBulkApply(BulkMutation&& mut,
+                                                 CompletionQueue& cq,
+                                                 Functor&& callback) {
+    return impl_.AsyncBulkApply(std::move(mut), cq,
+                                std::forward<Functor>(callback));
+  }
+
+  /**
+   * Asynchronously read a set of rows from the table.
+   *
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param on_row a functor called for each row, in order. It must satisfy
+   *     (using C++17 types):
+   *     static_assert(std::is_invocable_v<RowFunctor, CompletionQueue&, Row>);
+   * @param on_finish a functor called once, when the operation completes. It
+   *     must satisfy (using C++17 types):
+   *     static_assert(std::is_invocable_v<
+   *         FinishFunctor, CompletionQueue&, grpc::Status&>);
+   * @param row_set the rows to read from.
+   * @param rows_limit the maximum number of rows to read, use
+   *     `RowReader::NO_ROWS_LIMIT` to read all matching rows.
+   * @param filter is applied on the server-side to data in the rows.
+   * @return a handle to the pending operation, it can be used to cancel it.
+   *
+   * @tparam RowFunctor the type of the @p on_row callback.
+   * @tparam FinishFunctor the type of the @p on_finish callback.
+   */
+  template <typename RowFunctor, typename FinishFunctor>
+  std::shared_ptr<AsyncOperation> AsyncReadRows(
+      CompletionQueue& cq, RowFunctor&& on_row, FinishFunctor&& on_finish,
+      RowSet row_set, std::int64_t rows_limit, Filter filter) {
+    return impl_.AsyncReadRows(cq, std::forward<RowFunctor>(on_row),
+                               std::forward<FinishFunctor>(on_finish),
+                               std::move(row_set), rows_limit,
+                               std::move(filter));
+  }
+
+  /**
+   * Asynchronously read a single row from the table.
+   *
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param callback a functor to be called when the operation completes. It
+   *     must satisfy (using C++17 types):
+   *     static_assert(std::is_invocable_v<
+   *         Functor, CompletionQueue&, std::pair<bool, Row>, grpc::Status&>);
+   *     The first element of the pair is `false` if the row does not exist.
+   * @param row_key the row to read.
+   * @param filter a filter expression, can be used to select a subset of the
+   *     column families and columns in the row.
+   * @return a handle to the pending operation, it can be used to cancel it.
+   *
+   * @tparam Functor the type of the callback.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncReadRow(CompletionQueue& cq,
+                                               Functor&& callback,
+                                               std::string row_key,
+                                               Filter filter) {
+    return impl_.AsyncReadRow(cq, std::forward<Functor>(callback),
+                              std::move(row_key), std::move(filter));
+  }
+
+  /**
+   * Make an asynchronous atomic test-and-set request for a row.
+   *
+   * This operation is not idempotent, it is never retried.
+   *
+   * @param row_key the row to modify.
+   * @param filter the filter expression.
+   * @param true_mutations the mutations for the "filter passed" case.
+   * @param false_mutations the mutations for the "filter did not pass" case.
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param callback a functor to be called when the operation completes. It
+   *     must satisfy (using C++17 types):
+   *     static_assert(std::is_invocable_v<
+   *         Functor, CompletionQueue&, bool, grpc::Status&>);
+   *     The second argument is `true` if the filter passed.
+   * @return a handle to the pending operation, it can be used to cancel it.
+   *
+   * @tparam Functor the type of the callback.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncCheckAndMutateRow(
+      std::string row_key, Filter filter, std::vector<Mutation> true_mutations,
+      std::vector<Mutation> false_mutations, CompletionQueue& cq,
+      Functor&& callback) {
+    return impl_.AsyncCheckAndMutateRow(
+        std::move(row_key), std::move(filter), std::move(true_mutations),
+        std::move(false_mutations), cq, std::forward<Functor>(callback));
+  }
+
+  /**
+   * Make an asynchronous request to atomically read and modify a row.
+   *
+   * This operation is not idempotent, it is never retried.
+   *
+   * @param row_key the row to read
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param callback a functor to be called when the operation completes. It
+   *     must satisfy (using C++17 types):
+   *     static_assert(std::is_invocable_v<
+   *         Functor, CompletionQueue&, Row, grpc::Status&>);
+   * @param rule to modify the row.
+   * @param rules is the zero or more ReadModifyWriteRules to apply on a row.
+   * @return a handle to the pending operation, it can be used to cancel it.
+   *
+   * @tparam Functor the type of the callback.
+   * @tparam Args this is zero or more ReadModifyWriteRules to apply on a row
+   */
+  template <typename Functor, typename... Args>
+  std::shared_ptr<AsyncOperation> AsyncReadModifyWriteRow(
+      std::string row_key, CompletionQueue& cq, Functor&& callback,
+      bigtable::ReadModifyWriteRule rule, Args&&... rules) {
+    return impl_.AsyncReadModifyWriteRow(
+        std::move(row_key), cq, std::forward<Functor>(callback),
+        std::move(rule), std::forward<Args>(rules)...);
+  }
+
+  /**
+   * Make an asynchronous request to atomically read and modify a row.
+   *
+   * Use this overload when the rules are only known at run-time.
+   *
+   * @param row_key the row to read
+   * @param cq the completion queue that will execute the asynchronous calls,
+   *     the application must ensure that one or more threads are blocked on
+   *     `cq.Run()`.
+   * @param callback a functor to be called when the operation completes. It
+   *     must satisfy (using C++17 types):
+   *     static_assert(std::is_invocable_v<
+   *         Functor, CompletionQueue&, Row, grpc::Status&>);
+   * @param rules the ReadModifyWriteRules to apply on a row, must not be
+   *     empty.
+   * @return a handle to the pending operation, it can be used to cancel it.
+   *
+   * @tparam Functor the type of the callback.
+   */
+  template <typename Functor>
+  std::shared_ptr<AsyncOperation> AsyncReadModifyWriteRow(
+      std::string row_key, CompletionQueue& cq, Functor&& callback,
+      std::vector<bigtable::ReadModifyWriteRule> rules) {
+    return impl_.AsyncReadModifyWriteRow(std::move(row_key), cq,
+                                         std::forward<Functor>(callback),
+                                         std::move(rules));
+  }
+
  private:
   noex::Table impl_;
 };
@@ -100,3 +100,28 @@ TEST_F(TableApplyTest, RetryIdempotent) {
       "exceptions are disabled");
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 }
+
+/// @test Verify that Table::Apply() retries mutations with client timestamps.
+TEST_F(TableApplyTest, RetryClientTimestamps) {
+  using namespace ::testing;
+
+  bigtable::Table table(
+      client_, kTableId,
+      bigtable::ClientTimestampPolicy([] { return 1234_ms; }));
+
+  // The same timestamp is used in each retry.
+  auto check_timestamp = [](grpc::ClientContext*,
+                            google::bigtable::v2::MutateRowRequest const& r,
+                            google::bigtable::v2::MutateRowResponse*) {
+    EXPECT_EQ(1, r.mutations_size());
+    EXPECT_EQ(1234000, r.mutations(0).set_cell().timestamp_micros());
+  };
+  EXPECT_CALL(*client_, MutateRow(_, _, _))
+      .WillOnce(DoAll(
+          Invoke(check_timestamp),
+          Return(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))))
+      .WillOnce(DoAll(Invoke(check_timestamp), Return(grpc::Status::OK)));
+
+  table.Apply(bigtable::SingleRowMutation(
+      "server-timestamp", {bigtable::SetCell("fam", "col", "val")}));
+}
@@ -0,0 +1,310 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/bigtable/testing/mock_async_response_reader.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include "google/cloud/bigtable/testing/retry_policy_with_setup_hook.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+
+namespace bigtable = google::cloud::bigtable;
+namespace btproto = google::bigtable::v2;
+using namespace google::cloud::testing_util::chrono_literals;
+using namespace ::testing;
+
+/// Define helper types and functions for this test.
+namespace {
+class TableAsyncApplyTest : public bigtable::testing::TableTestFixture {
+ protected:
+  TableAsyncApplyTest()
+      : cq_impl_(std::make_shared<bigtable::testing::MockCompletionQueue>()),
+        cq_(cq_impl_) {}
+
+  /**
+   * Return a functor that creates a mock reader returning @p status.
+   *
+   * gRPC does not delete the objects returned by the asynchronous unary RPCs,
+   * the mock readers are owned by the test fixture.
+   */
+  template <typename Response, typename Request>
+  std::function<std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<Response>>(
+      grpc::ClientContext*, Request const&, grpc::CompletionQueue*)>
+  MakeReader(grpc::Status status, Response response = Response()) {
+    return [this, status, response](grpc::ClientContext*, Request const&,
+                                    grpc::CompletionQueue*) {
+      auto owner = std::make_shared<
+          bigtable::testing::MockAsyncResponseReader<Response>>();
+      readers_.push_back(owner);
+      auto reader = owner.get();
+      EXPECT_CALL(*reader, Finish(_, _, _))
+          .WillOnce(Invoke([status, response](Response* r, grpc::Status* s,
+                                              void*) {
+            *r = response;
+            *s = status;
+          }));
+      return std::unique_ptr<
+          grpc::ClientAsyncResponseReaderInterface<Response>>(reader);
+    };
+  }
+
+  std::shared_ptr<bigtable::testing::MockCompletionQueue> cq_impl_;
+  bigtable::CompletionQueue cq_;
+  std::vector<std::shared_ptr<void>> readers_;
+};
+}  // anonymous namespace
+
+/// @test Verify that Table::AsyncApply() works in a simplest case.
+TEST_F(TableAsyncApplyTest, Simple) {
+  EXPECT_CALL(*client_, AsyncMutateRow(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader<btproto::MutateRowResponse, btproto::MutateRowRequest>(
+              grpc::Status::OK)));
+
+  bool completed = false;
+  table_.AsyncApply(
+      bigtable::SingleRowMutation(
+          "bar", {bigtable::SetCell("fam", "col", 0_ms, "val")}),
+      cq_,
+      [&completed](bigtable::CompletionQueue&, btproto::MutateRowResponse&,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        completed = true;
+      });
+
+  EXPECT_FALSE(completed);
+  EXPECT_EQ(1U, cq_impl_->size());
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncApply() reports permanent failures.
+TEST_F(TableAsyncApplyTest, Failure) {
+  EXPECT_CALL(*client_, AsyncMutateRow(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader<btproto::MutateRowResponse, btproto::MutateRowRequest>(
+              grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "uh-oh"))));
+
+  bool completed = false;
+  table_.AsyncApply(
+      bigtable::SingleRowMutation(
+          "bar", {bigtable::SetCell("fam", "col", 0_ms, "val")}),
+      cq_,
+      [&completed](bigtable::CompletionQueue&, btproto::MutateRowResponse&,
+                   grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::FAILED_PRECONDITION, status.error_code());
+        completed = true;
+      });
+
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncApply() retries transient failures.
+TEST_F(TableAsyncApplyTest, Retry) {
+  EXPECT_CALL(*client_, AsyncMutateRow(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader<btproto::MutateRowResponse, btproto::MutateRowRequest>(
+              grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))))
+      .WillOnce(Invoke(
+          MakeReader<btproto::MutateRowResponse, btproto::MutateRowRequest>(
+              grpc::Status::OK)));
+
+  bool completed = false;
+  table_.AsyncApply(
+      bigtable::SingleRowMutation(
+          "bar", {bigtable::SetCell("fam", "col", 0_ms, "val")}),
+      cq_,
+      [&completed](bigtable::CompletionQueue&, btproto::MutateRowResponse&,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        completed = true;
+      });
+
+  // The first request fails, and the operation creates a backoff timer.
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_FALSE(completed);
+  EXPECT_EQ(1U, cq_impl_->size());
+  // The timer expires, and the operation starts a new request.
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_FALSE(completed);
+  EXPECT_EQ(1U, cq_impl_->size());
+  // The second request succeeds.
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncApply() does not retry non-idempotent ops.
+TEST_F(TableAsyncApplyTest, RetryIdempotent) {
+  EXPECT_CALL(*client_, AsyncMutateRow(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader<btproto::MutateRowResponse, btproto::MutateRowRequest>(
+              grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))));
+
+  bool completed = false;
+  table_.AsyncApply(
+      bigtable::SingleRowMutation("not-idempotent",
+                                  {bigtable::SetCell("fam", "col", "val")}),
+      cq_,
+      [&completed](bigtable::CompletionQueue&, btproto::MutateRowResponse&,
+                   grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, status.error_code());
+        completed = true;
+      });
+
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that cancelling Table::AsyncApply() stops the retry loop.
+TEST_F(TableAsyncApplyTest, CancelDuringBackoff) {
+  EXPECT_CALL(*client_, AsyncMutateRow(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader<btproto::MutateRowResponse, btproto::MutateRowRequest>(
+              grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))));
+
+  bool completed = false;
+  auto op = table_.AsyncApply(
+      bigtable::SingleRowMutation(
+          "bar", {bigtable::SetCell("fam", "col", 0_ms, "val")}),
+      cq_,
+      [&completed](bigtable::CompletionQueue&, btproto::MutateRowResponse&,
+                   grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::CANCELLED, status.error_code());
+        completed = true;
+      });
+
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_FALSE(completed);
+  op->Cancel();
+  // Simulate the cancelled timer.
+  cq_impl_->SimulateCompletion(cq_, false);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that a Cancel() before the next attempt starts is not lost.
+TEST_F(TableAsyncApplyTest, CancelBeforeRetry) {
+  bigtable::testing::RetryPolicyWithSetupHook retry(3);
+  bigtable::Table table(client_, kTableId, retry);
+  EXPECT_CALL(*client_, AsyncMutateRow(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader<btproto::MutateRowResponse, btproto::MutateRowRequest>(
+              grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))));
+
+  bool completed = false;
+  auto op = table.AsyncApply(
+      bigtable::SingleRowMutation(
+          "bar", {bigtable::SetCell("fam", "col", 0_ms, "val")}),
+      cq_,
+      [&completed](bigtable::CompletionQueue&, btproto::MutateRowResponse&,
+                   grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::CANCELLED, status.error_code());
+        completed = true;
+      });
+  // Cancel after the timer fires, but before the second attempt starts.
+  retry.set_hook([op] { op->Cancel(); });
+
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_FALSE(completed);
+  // The backoff timer expires, the retry must not start.
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+  retry.set_hook(nullptr);
+}
+
+/// @test Verify that Table::AsyncCheckAndMutateRow() works.
+TEST_F(TableAsyncApplyTest, CheckAndMutateRow) {
+  btproto::CheckAndMutateRowResponse response;
+  response.set_predicate_matched(true);
+  EXPECT_CALL(*client_, AsyncCheckAndMutateRow(_, _, _))
+      .WillOnce(Invoke(MakeReader<btproto::CheckAndMutateRowResponse,
+                                  btproto::CheckAndMutateRowRequest>(
+          grpc::Status::OK, response)));
+
+  bool completed = false;
+  table_.AsyncCheckAndMutateRow(
+      "foo", bigtable::Filter::PassAllFilter(),
+      {bigtable::SetCell("fam", "col", 0_ms, "it was true")},
+      {bigtable::SetCell("fam", "col", 0_ms, "it was false")}, cq_,
+      [&completed](bigtable::CompletionQueue&, bool predicate_matched,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        EXPECT_TRUE(predicate_matched);
+        completed = true;
+      });
+
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+}
+
+/// @test Verify that Table::AsyncCheckAndMutateRow() does not retry.
+TEST_F(TableAsyncApplyTest, CheckAndMutateRowNoRetry) {
+  EXPECT_CALL(*client_, AsyncCheckAndMutateRow(_, _, _))
+      .WillOnce(Invoke(MakeReader<btproto::CheckAndMutateRowResponse,
+                                  btproto::CheckAndMutateRowRequest>(
+          grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))));
+
+  bool completed = false;
+  table_.AsyncCheckAndMutateRow(
+      "foo", bigtable::Filter::PassAllFilter(),
+      {bigtable::SetCell("fam", "col", 0_ms, "it was true")}, {}, cq_,
+      [&completed](bigtable::CompletionQueue&, bool, grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, status.error_code());
+        completed = true;
+      });
+
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncReadModifyWriteRow() works.
+TEST_F(TableAsyncApplyTest, ReadModifyWriteRow) {
+  btproto::ReadModifyWriteRowResponse response;
+  auto& row = *response.mutable_row();
+  row.set_key("row-key");
+  auto& family = *row.add_families();
+  family.set_name("fam");
+  auto& column = *family.add_columns();
+  column.set_qualifier("col");
+  column.add_cells()->set_value("value1-value2");
+
+  EXPECT_CALL(*client_, AsyncReadModifyWriteRow(_, _, _))
+      .WillOnce(Invoke(MakeReader<btproto::ReadModifyWriteRowResponse,
+                                  btproto::ReadModifyWriteRowRequest>(
+          grpc::Status::OK, response)));
+
+  bool completed = false;
+  table_.AsyncReadModifyWriteRow(
+      "row-key", cq_,
+      [&completed](bigtable::CompletionQueue&, bigtable::Row row,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        EXPECT_EQ("row-key", row.row_key());
+        ASSERT_EQ(1U, row.cells().size());
+        EXPECT_EQ("value1-value2", row.cells().at(0).value());
+        completed = true;
+      },
+      bigtable::ReadModifyWriteRule::AppendValue("fam", "col", "-value2"));
+
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+}
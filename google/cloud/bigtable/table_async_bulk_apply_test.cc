@@ -0,0 +1,229 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/bigtable/testing/mock_async_response_reader.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include "google/cloud/bigtable/testing/retry_policy_with_setup_hook.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace google::cloud::testing_util::chrono_literals;
+using namespace ::testing;
+namespace bt = google::cloud::bigtable;
+
+/// Define types and functions used in the tests.
+namespace {
+class TableAsyncBulkApplyTest : public bigtable::testing::TableTestFixture {
+ protected:
+  TableAsyncBulkApplyTest()
+      : cq_impl_(std::make_shared<bigtable::testing::MockCompletionQueue>()),
+        cq_(cq_impl_) {}
+
+  /// Simulate a complete MutateRows stream with @p response_count responses.
+  void SimulateStream(int response_count) {
+    // The call starts.
+    cq_impl_->SimulateCompletion(cq_, true);
+    for (int i = 0; i != response_count; ++i) {
+      cq_impl_->SimulateCompletion(cq_, true);
+    }
+    // The stream is closed, and then the final status is received.
+    cq_impl_->SimulateCompletion(cq_, false);
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+
+  std::shared_ptr<bigtable::testing::MockCompletionQueue> cq_impl_;
+  bigtable::CompletionQueue cq_;
+};
+
+btproto::MutateRowsResponse MakeResponse(
+    std::vector<std::pair<int, grpc::StatusCode>> const& entries) {
+  btproto::MutateRowsResponse response;
+  for (auto const& kv : entries) {
+    auto& e = *response.add_entries();
+    e.set_index(kv.first);
+    e.mutable_status()->set_code(kv.second);
+  }
+  return response;
+}
+
+auto const MakeReader =
+    bigtable::testing::MakeMockAsyncReader<btproto::MutateRowsResponse,
+                                           btproto::MutateRowsRequest>;
+}  // anonymous namespace
+
+/// @test Verify that Table::AsyncBulkApply() works in the easy case.
+TEST_F(TableAsyncBulkApplyTest, Simple) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader(
+          {MakeResponse(
+              {{0, grpc::StatusCode::OK}, {1, grpc::StatusCode::OK}})},
+          grpc::Status::OK)));
+
+  bool completed = false;
+  table_.AsyncBulkApply(
+      bt::BulkMutation(
+          bt::SingleRowMutation("foo",
+                                {bt::SetCell("fam", "col", 0_ms, "baz")}),
+          bt::SingleRowMutation("bar",
+                                {bt::SetCell("fam", "col", 0_ms, "qux")})),
+      cq_,
+      [&completed](bigtable::CompletionQueue&,
+                   std::vector<bigtable::FailedMutation>& failures,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        EXPECT_TRUE(failures.empty());
+        completed = true;
+      });
+
+  SimulateStream(1);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncBulkApply() retries partial failures.
+TEST_F(TableAsyncBulkApplyTest, RetryPartialFailure) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader({MakeResponse(
+                                      {{0, grpc::StatusCode::UNAVAILABLE},
+                                       {1, grpc::StatusCode::OK}})},
+                                  grpc::Status::OK)))
+      .WillOnce(Invoke(
+          MakeReader({MakeResponse({{0, grpc::StatusCode::OK}})},
+                     grpc::Status::OK)));
+
+  bool completed = false;
+  table_.AsyncBulkApply(
+      bt::BulkMutation(
+          bt::SingleRowMutation("foo",
+                                {bt::SetCell("fam", "col", 0_ms, "baz")}),
+          bt::SingleRowMutation("bar",
+                                {bt::SetCell("fam", "col", 0_ms, "qux")})),
+      cq_,
+      [&completed](bigtable::CompletionQueue&,
+                   std::vector<bigtable::FailedMutation>& failures,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        EXPECT_TRUE(failures.empty());
+        completed = true;
+      });
+
+  SimulateStream(1);
+  EXPECT_FALSE(completed);
+  // The backoff timer.
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_FALSE(completed);
+  SimulateStream(1);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncBulkApply() reports permanent failures.
+TEST_F(TableAsyncBulkApplyTest, PermanentFailure) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader(
+          {MakeResponse({{0, grpc::StatusCode::OK},
+                         {1, grpc::StatusCode::OUT_OF_RANGE}})},
+          grpc::Status::OK)));
+
+  bool completed = false;
+  table_.AsyncBulkApply(
+      bt::BulkMutation(
+          bt::SingleRowMutation("foo",
+                                {bt::SetCell("fam", "col", 0_ms, "baz")}),
+          bt::SingleRowMutation("bar",
+                                {bt::SetCell("fam", "col", 0_ms, "qux")})),
+      cq_,
+      [&completed](bigtable::CompletionQueue&,
+                   std::vector<bigtable::FailedMutation>& failures,
+                   grpc::Status& status) {
+        EXPECT_FALSE(status.ok());
+        ASSERT_EQ(1U, failures.size());
+        EXPECT_EQ(1, failures[0].original_index());
+        EXPECT_EQ("bar", failures[0].mutation().row_key());
+        completed = true;
+      });
+
+  SimulateStream(1);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncBulkApply() retries failed streams.
+TEST_F(TableAsyncBulkApplyTest, RetryStreamFailure) {
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader(
+          {}, grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))))
+      .WillOnce(Invoke(MakeReader(
+          {MakeResponse(
+              {{0, grpc::StatusCode::OK}, {1, grpc::StatusCode::OK}})},
+          grpc::Status::OK)));
+
+  bool completed = false;
+  table_.AsyncBulkApply(
+      bt::BulkMutation(
+          bt::SingleRowMutation("foo",
+                                {bt::SetCell("fam", "col", 0_ms, "baz")}),
+          bt::SingleRowMutation("bar",
+                                {bt::SetCell("fam", "col", 0_ms, "qux")})),
+      cq_,
+      [&completed](bigtable::CompletionQueue&,
+                   std::vector<bigtable::FailedMutation>& failures,
+                   grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        EXPECT_TRUE(failures.empty());
+        completed = true;
+      });
+
+  SimulateStream(0);
+  EXPECT_FALSE(completed);
+  cq_impl_->SimulateCompletion(cq_, true);
+  SimulateStream(1);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that a Cancel() before the next attempt starts is not lost.
+TEST_F(TableAsyncBulkApplyTest, CancelBeforeRetry) {
+  bigtable::testing::RetryPolicyWithSetupHook retry(3);
+  bigtable::Table table(client_, kTableId, retry);
+  EXPECT_CALL(*client_, PrepareAsyncMutateRows(_, _, _))
+      .WillOnce(Invoke(MakeReader(
+          {}, grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))));
+
+  bool completed = false;
+  auto op = table.AsyncBulkApply(
+      bt::BulkMutation(bt::SingleRowMutation(
+          "foo", {bt::SetCell("fam", "col", 0_ms, "baz")})),
+      cq_,
+      [&completed](bigtable::CompletionQueue&,
+                   std::vector<bigtable::FailedMutation>& failures,
+                   grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::CANCELLED, status.error_code());
+        EXPECT_EQ(1U, failures.size());
+        completed = true;
+      });
+  // Cancel after the timer fires, but before the second attempt starts.
+  retry.set_hook([op] { op->Cancel(); });
+
+  SimulateStream(0);
+  EXPECT_FALSE(completed);
+  // The backoff timer expires, the retry must not start.
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(completed);
+  EXPECT_TRUE(cq_impl_->empty());
+  retry.set_hook(nullptr);
+}
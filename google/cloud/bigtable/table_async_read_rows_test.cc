@@ -0,0 +1,212 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/bigtable/table.h"
+#include "google/cloud/bigtable/testing/mock_async_response_reader.h"
+#include "google/cloud/bigtable/testing/mock_completion_queue.h"
+#include "google/cloud/bigtable/testing/retry_policy_with_setup_hook.h"
+#include "google/cloud/bigtable/testing/table_test_fixture.h"
+
+namespace btproto = google::bigtable::v2;
+namespace bigtable = google::cloud::bigtable;
+using namespace ::testing;
+
+/// Define helper types and functions for this test.
+namespace {
+class TableAsyncReadRowsTest : public bigtable::testing::TableTestFixture {
+ protected:
+  TableAsyncReadRowsTest()
+      : cq_impl_(std::make_shared<bigtable::testing::MockCompletionQueue>()),
+        cq_(cq_impl_) {}
+
+  /// Simulate a complete ReadRows stream with @p response_count responses.
+  void SimulateStream(int response_count) {
+    cq_impl_->SimulateCompletion(cq_, true);
+    for (int i = 0; i != response_count; ++i) {
+      cq_impl_->SimulateCompletion(cq_, true);
+    }
+    cq_impl_->SimulateCompletion(cq_, false);
+    cq_impl_->SimulateCompletion(cq_, true);
+  }
+
+  std::shared_ptr<bigtable::testing::MockCompletionQueue> cq_impl_;
+  bigtable::CompletionQueue cq_;
+};
+
+auto const MakeReader =
+    bigtable::testing::MakeMockAsyncReader<btproto::ReadRowsResponse,
+                                           btproto::ReadRowsRequest>;
+
+btproto::ReadRowsResponse MakeRowResponse(std::string const& row_key) {
+  return bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: ")" + row_key + R"("
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+      )");
+}
+}  // anonymous namespace
+
+/// @test Verify that Table::AsyncReadRows() delivers all the rows.
+TEST_F(TableAsyncReadRowsTest, ReadRows) {
+  EXPECT_CALL(*client_, PrepareAsyncReadRows(_, _, _))
+      .WillOnce(Invoke(MakeReader(
+          {MakeRowResponse("r1"), MakeRowResponse("r2")}, grpc::Status::OK)));
+
+  std::vector<std::string> keys;
+  bool finished = false;
+  table_.AsyncReadRows(
+      cq_,
+      [&keys](bigtable::CompletionQueue&, bigtable::Row row) {
+        keys.push_back(row.row_key());
+      },
+      [&finished](bigtable::CompletionQueue&, grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        finished = true;
+      },
+      bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter());
+
+  SimulateStream(2);
+  EXPECT_TRUE(finished);
+  EXPECT_THAT(keys, ElementsAre("r1", "r2"));
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that Table::AsyncReadRows() resumes after the last row.
+TEST_F(TableAsyncReadRowsTest, ReadRowsWithRetries) {
+  EXPECT_CALL(*client_, PrepareAsyncReadRows(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader({MakeRowResponse("r1")},
+                     grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))))
+      .WillOnce(Invoke([](grpc::ClientContext* context,
+                          btproto::ReadRowsRequest const& request,
+                          grpc::CompletionQueue* cq) {
+        // The retry must start after the last row received.
+        EXPECT_EQ(1, request.rows().row_ranges_size());
+        EXPECT_EQ("r1", request.rows().row_ranges(0).start_key_open());
+        return MakeReader({MakeRowResponse("r2")}, grpc::Status::OK)(
+            context, request, cq);
+      }));
+
+  std::vector<std::string> keys;
+  bool finished = false;
+  table_.AsyncReadRows(
+      cq_,
+      [&keys](bigtable::CompletionQueue&, bigtable::Row row) {
+        keys.push_back(row.row_key());
+      },
+      [&finished](bigtable::CompletionQueue&, grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        finished = true;
+      },
+      bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter());
+
+  SimulateStream(1);
+  EXPECT_FALSE(finished);
+  // The backoff timer.
+  cq_impl_->SimulateCompletion(cq_, true);
+  SimulateStream(1);
+  EXPECT_TRUE(finished);
+  EXPECT_THAT(keys, ElementsAre("r1", "r2"));
+  EXPECT_TRUE(cq_impl_->empty());
+}
+
+/// @test Verify that a Cancel() before the next attempt starts is not lost.
+TEST_F(TableAsyncReadRowsTest, CancelBeforeRetry) {
+  bigtable::testing::RetryPolicyWithSetupHook retry(3);
+  bigtable::Table table(client_, kTableId, retry);
+  EXPECT_CALL(*client_, PrepareAsyncReadRows(_, _, _))
+      .WillOnce(Invoke(
+          MakeReader({MakeRowResponse("r1")},
+                     grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"))));
+
+  std::vector<std::string> keys;
+  bool finished = false;
+  auto op = table.AsyncReadRows(
+      cq_,
+      [&keys](bigtable::CompletionQueue&, bigtable::Row row) {
+        keys.push_back(row.row_key());
+      },
+      [&finished](bigtable::CompletionQueue&, grpc::Status& status) {
+        EXPECT_EQ(grpc::StatusCode::CANCELLED, status.error_code());
+        finished = true;
+      },
+      bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter());
+  // Cancel after the timer fires, but before the second attempt starts.
+  retry.set_hook([op] { op->Cancel(); });
+
+  SimulateStream(1);
+  EXPECT_FALSE(finished);
+  // The backoff timer expires, the retry must not start.
+  cq_impl_->SimulateCompletion(cq_, true);
+  EXPECT_TRUE(finished);
+  EXPECT_THAT(keys, ElementsAre("r1"));
+  EXPECT_TRUE(cq_impl_->empty());
+  retry.set_hook(nullptr);
+}
+
+/// @test Verify that Table::AsyncReadRow() returns the row.
+TEST_F(TableAsyncReadRowsTest, ReadRow) {
+  EXPECT_CALL(*client_, PrepareAsyncReadRows(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext* context,
+                          btproto::ReadRowsRequest const& request,
+                          grpc::CompletionQueue* cq) {
+        EXPECT_EQ(1, request.rows_limit());
+        EXPECT_EQ(1, request.rows().row_keys_size());
+        return MakeReader({MakeRowResponse("r1")}, grpc::Status::OK)(
+            context, request, cq);
+      }));
+
+  bool finished = false;
+  table_.AsyncReadRow(
+      cq_,
+      [&finished](bigtable::CompletionQueue&,
+                  std::pair<bool, bigtable::Row> result, grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        EXPECT_TRUE(result.first);
+        EXPECT_EQ("r1", result.second.row_key());
+        finished = true;
+      },
+      "r1", bigtable::Filter::PassAllFilter());
+
+  SimulateStream(1);
+  EXPECT_TRUE(finished);
+}
+
+/// @test Verify that Table::AsyncReadRow() reports missing rows.
+TEST_F(TableAsyncReadRowsTest, ReadRowMissing) {
+  EXPECT_CALL(*client_, PrepareAsyncReadRows(_, _, _))
+      .WillOnce(Invoke(MakeReader({}, grpc::Status::OK)));
+
+  bool finished = false;
+  table_.AsyncReadRow(
+      cq_,
+      [&finished](bigtable::CompletionQueue&,
+                  std::pair<bool, bigtable::Row> result, grpc::Status& status) {
+        EXPECT_TRUE(status.ok());
+        EXPECT_FALSE(result.first);
+        finished = true;
+      },
+      "r1", bigtable::Filter::PassAllFilter());
+
+  SimulateStream(0);
+  EXPECT_TRUE(finished);
+}
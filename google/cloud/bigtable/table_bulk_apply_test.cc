@@ -102,6 +102,53 @@ TEST_F(TableBulkApplyTest, RetryPartialFailure) {
   SUCCEED();
 }
 
+/// @test Verify that Table::BulkApply() reports throttling to the limiter.
+TEST_F(TableBulkApplyTest, RateLimiterSeesThrottling) {
+  auto r1 = google::cloud::internal::make_unique<MockMutateRowsReader>();
+  EXPECT_CALL(*r1, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+        auto& e0 = *r->add_entries();
+        e0.set_index(0);
+        e0.mutable_status()->set_code(grpc::StatusCode::UNAVAILABLE);
+        auto& e1 = *r->add_entries();
+        e1.set_index(1);
+        e1.mutable_status()->set_code(grpc::StatusCode::OK);
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*r1, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto r2 = google::cloud::internal::make_unique<MockMutateRowsReader>();
+  EXPECT_CALL(*r2, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+        auto& e = *r->add_entries();
+        e.set_index(0);
+        e.mutable_status()->set_code(grpc::StatusCode::OK);
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*r2, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  EXPECT_CALL(*client_, MutateRows(_, _))
+      .WillOnce(Invoke(r1.release()->MakeMockReturner()))
+      .WillOnce(Invoke(r2.release()->MakeMockReturner()));
+
+  bt::BulkApplyRateLimiter limiter(
+      bt::BulkApplyRateLimiter::Options().SetAdjustmentInterval(
+          std::chrono::hours(1)));
+  bt::Table table(client_, kTableId, limiter);
+  table.BulkApply(bt::BulkMutation(
+      bt::SingleRowMutation("foo",
+                            {bigtable::SetCell("fam", "col", 0_ms, "baz")}),
+      bt::SingleRowMutation("bar",
+                            {bigtable::SetCell("fam", "col", 0_ms, "qux")})));
+  EXPECT_EQ(1, limiter.decrease_count());
+  EXPECT_EQ(0, limiter.increase_count());
+  EXPECT_DOUBLE_EQ(
+      bt::BulkApplyRateLimiter::Options().initial_mutations_per_second() / 2,
+      limiter.mutations_per_second());
+}
+
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 /// @test Verify that Table::BulkApply() handles permanent failures.
 TEST_F(TableBulkApplyTest, PermanentFailure) {
@@ -16,8 +16,10 @@
 #include "google/cloud/bigtable/testing/mock_read_rows_reader.h"
 #include "google/cloud/bigtable/testing/table_test_fixture.h"
 #include "google/cloud/internal/make_unique.h"
+#include "google/cloud/testing_util/chrono_literals.h"
 
 namespace bigtable = google::cloud::bigtable;
+using namespace google::cloud::testing_util::chrono_literals;
 
 /// Define helper types and functions for this test.
 namespace {
@@ -112,3 +114,95 @@ TEST_F(TableReadRowTest, UnrecoverableFailure) {
       "exceptions are disabled");
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 }
+
+namespace {
+/// Return a mock stream with a single row, `ReadRows()` takes ownership.
+MockReadRowsReader* MakeSingleRowStream(std::string const& row_key) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: ")" + row_key + R"("
+        family_name { value: "fam" }
+        qualifier { value: "col" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+)");
+  auto* stream = new MockReadRowsReader;
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(Invoke([response](btproto::ReadRowsResponse* r) {
+        *r = response;
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  return stream;
+}
+}  // anonymous namespace
+
+/// @test Verify that ReadRow() uses the RowCache.
+TEST_F(TableReadRowTest, ReadRowCached) {
+  using namespace ::testing;
+
+  auto* stream = MakeSingleRowStream("r1");
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+
+  bigtable::RowCache cache(1024 * 1024, std::chrono::minutes(1));
+  bigtable::Table table(client_, "foo-table", cache);
+  for (int i = 0; i != 2; ++i) {
+    auto result = table.ReadRow("r1", bigtable::Filter::PassAllFilter());
+    EXPECT_TRUE(result.first);
+    EXPECT_EQ("r1", result.second.row_key());
+    ASSERT_EQ(1U, result.second.cells().size());
+    EXPECT_EQ("value", result.second.cells()[0].value());
+  }
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+}
+
+/// @test Verify that writes through the Table invalidate the RowCache.
+TEST_F(TableReadRowTest, ReadRowCacheInvalidatedByApply) {
+  using namespace ::testing;
+
+  auto* s1 = MakeSingleRowStream("r1");
+  auto* s2 = MakeSingleRowStream("r1");
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(s1->MakeMockReturner()))
+      .WillOnce(Invoke(s2->MakeMockReturner()));
+  EXPECT_CALL(*client_, MutateRow(_, _, _)).WillOnce(Return(grpc::Status::OK));
+
+  bigtable::RowCache cache(1024 * 1024, std::chrono::minutes(1));
+  bigtable::Table table(client_, "foo-table", cache);
+  EXPECT_TRUE(table.ReadRow("r1", bigtable::Filter::PassAllFilter()).first);
+  table.Apply(bigtable::SingleRowMutation(
+      "r1", bigtable::SetCell("fam", "col", 0_ms, "new-value")));
+  EXPECT_TRUE(table.ReadRow("r1", bigtable::Filter::PassAllFilter()).first);
+  EXPECT_EQ(0, cache.hits());
+  EXPECT_EQ(2, cache.misses());
+}
+
+/// @test Verify that ReadRow() works with a ReadRowCoalescingPolicy.
+TEST_F(TableReadRowTest, ReadRowCoalesced) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  auto* stream = MakeSingleRowStream("r1");
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke([stream](grpc::ClientContext*,
+                                btproto::ReadRowsRequest const& req) {
+        EXPECT_EQ(1, req.rows().row_keys_size());
+        EXPECT_EQ("r1", req.rows().row_keys(0));
+        // The batch may contain multiple rows, there is no limit.
+        EXPECT_EQ(0, req.rows_limit());
+        return stream->AsUniqueMocked();
+      }));
+
+  bigtable::Table table(client_, "foo-table",
+                        bigtable::ReadRowCoalescingPolicy(1_ms, 100));
+  auto result = table.ReadRow("r1", bigtable::Filter::PassAllFilter());
+  EXPECT_TRUE(result.first);
+  EXPECT_EQ("r1", result.second.row_key());
+}
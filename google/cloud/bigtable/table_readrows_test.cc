@@ -139,3 +139,137 @@ TEST_F(TableReadRowsTest, ReadRowsThrowsWhenTooManyErrors) {
   EXPECT_THROW(reader.begin(), std::exception);
 }
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+namespace {
+/// Count the cells and rows delivered to a `RowVisitor`.
+class CountingVisitor : public bigtable::RowVisitor {
+ public:
+  void OnRowStart(std::string const& row_key) override {
+    keys.emplace_back(row_key);
+  }
+  void OnCell(bigtable::CellView const& cell) override {
+    values.emplace_back(cell.value());
+  }
+  void OnRowEnd() override { ++rows; }
+  void OnRowReset() override { ++resets; }
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  int rows = 0;
+  int resets = 0;
+};
+}  // anonymous namespace
+
+TEST_F(TableReadRowsTest, VisitRowsCanReadRows) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "v1"
+        commit_row: true
+      }
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "v2"
+        commit_row: true
+      }
+      )");
+
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+
+  CountingVisitor visitor;
+  table_.VisitRows(bigtable::RowSet(), bigtable::Filter::PassAllFilter(),
+                   visitor);
+  EXPECT_THAT(visitor.keys, ::testing::ElementsAre("r1", "r2"));
+  EXPECT_THAT(visitor.values, ::testing::ElementsAre("v1", "v2"));
+  EXPECT_EQ(2, visitor.rows);
+  EXPECT_EQ(0, visitor.resets);
+}
+
+TEST_F(TableReadRowsTest, VisitRowsResumesAfterLastRow) {
+  // The first stream fails in the middle of "r2".
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        value: "v1"
+        commit_row: true
+      }
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        value: "v2"
+      }
+      )");
+  auto response_retry = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        value: "v2"
+        commit_row: true
+      }
+      )");
+
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(grpc::Status(grpc::UNAVAILABLE, "try-again")));
+
+  auto stream_retry = new MockReadRowsReader;
+  EXPECT_CALL(*stream_retry, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response_retry), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()))
+      .WillOnce(Invoke([stream_retry](grpc::ClientContext*,
+                                      google::bigtable::v2::ReadRowsRequest
+                                          const& r) {
+        EXPECT_EQ(7, r.rows_limit());
+        EXPECT_EQ(1, r.rows().row_ranges_size());
+        EXPECT_EQ("r1", r.rows().row_ranges(0).start_key_open());
+        return stream_retry->AsUniqueMocked();
+      }));
+
+  CountingVisitor visitor;
+  table_.VisitRows(bigtable::RowSet(), 8, bigtable::Filter::PassAllFilter(),
+                   visitor);
+  EXPECT_THAT(visitor.keys, ::testing::ElementsAre("r1", "r2", "r2"));
+  EXPECT_THAT(visitor.values, ::testing::ElementsAre("v1", "v2", "v2"));
+  EXPECT_EQ(2, visitor.rows);
+  EXPECT_EQ(1, visitor.resets);
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST_F(TableReadRowsTest, VisitRowsThrowsOnPermanentError) {
+  auto stream = new MockReadRowsReader;
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(grpc::Status(grpc::PERMISSION_DENIED, "uh-oh")));
+  EXPECT_CALL(*client_, ReadRows(_, _))
+      .WillOnce(Invoke(stream->MakeMockReturner()));
+
+  CountingVisitor visitor;
+  EXPECT_THROW(table_.VisitRows(bigtable::RowSet(),
+                                bigtable::Filter::PassAllFilter(), visitor),
+               std::runtime_error);
+  EXPECT_EQ(0, visitor.rows);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
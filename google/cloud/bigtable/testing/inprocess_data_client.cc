@@ -60,6 +60,46 @@ InProcessDataClient::MutateRows(grpc::ClientContext* context,
   return Stub()->MutateRows(context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<btproto::MutateRowResponse>>
+InProcessDataClient::AsyncMutateRow(grpc::ClientContext* context,
+                                    btproto::MutateRowRequest const& request,
+                                    grpc::CompletionQueue* cq) {
+  return Stub()->AsyncMutateRow(context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+    btproto::CheckAndMutateRowResponse>>
+InProcessDataClient::AsyncCheckAndMutateRow(
+    grpc::ClientContext* context,
+    btproto::CheckAndMutateRowRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Stub()->AsyncCheckAndMutateRow(context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+    btproto::ReadModifyWriteRowResponse>>
+InProcessDataClient::AsyncReadModifyWriteRow(
+    grpc::ClientContext* context,
+    btproto::ReadModifyWriteRowRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Stub()->AsyncReadModifyWriteRow(context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>
+InProcessDataClient::PrepareAsyncReadRows(
+    grpc::ClientContext* context, btproto::ReadRowsRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Stub()->PrepareAsyncReadRows(context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientAsyncReaderInterface<btproto::MutateRowsResponse>>
+InProcessDataClient::PrepareAsyncMutateRows(
+    grpc::ClientContext* context, btproto::MutateRowsRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return Stub()->PrepareAsyncMutateRows(context, request, cq);
+}
+
 }  // namespace testing
 }  // namespace bigtable
 }  // namespace cloud
@@ -0,0 +1,110 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_MOCK_ASYNC_RESPONSE_READER_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_MOCK_ASYNC_RESPONSE_READER_H_
+
+#include <gmock/gmock.h>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/impl/codegen/async_stream.h>
+#include <grpcpp/impl/codegen/async_unary_call.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace testing {
+/**
+ * Mock the result of an asynchronous unary RPC.
+ *
+ * The `DataClient::Async*()` member functions return a
+ * `grpc::ClientAsyncResponseReaderInterface<Response>`, use this class to
+ * mock them in the tests.  The tests typically set an expectation on `Finish()`
+ * that fills the response and status, and then simulate the completion of the
+ * operation using a `MockCompletionQueue`.
+ *
+ * Note that gRPC specializes `std::default_delete<>` for
+ * `grpc::ClientAsyncResponseReaderInterface<>` (the real objects are allocated
+ * in the call arena), so the `std::unique_ptr<>` returned by the mocked
+ * functions does not delete the object.  The tests must own these mocks.
+ *
+ * @tparam Response the response type.
+ */
+template <typename Response>
+class MockAsyncResponseReader
+    : public grpc::ClientAsyncResponseReaderInterface<Response> {
+ public:
+  MOCK_METHOD0(StartCall, void());
+  MOCK_METHOD1(ReadInitialMetadata, void(void*));
+  MOCK_METHOD3_T(Finish, void(Response*, grpc::Status*, void*));
+};
+
+/**
+ * Mock the result of an asynchronous streaming read RPC.
+ *
+ * The `DataClient::PrepareAsync*()` member functions return a
+ * `grpc::ClientAsyncReaderInterface<Response>`, use this class to mock them in
+ * the tests.
+ *
+ * @tparam Response the response type.
+ */
+template <typename Response>
+class MockAsyncReader : public grpc::ClientAsyncReaderInterface<Response> {
+ public:
+  MOCK_METHOD1(StartCall, void(void*));
+  MOCK_METHOD1(ReadInitialMetadata, void(void*));
+  MOCK_METHOD2(Finish, void(grpc::Status*, void*));
+  MOCK_METHOD2_T(Read, void(Response*, void*));
+};
+
+/**
+ * Create a functor that returns a `MockAsyncReader` with canned responses.
+ *
+ * The functor is typically used with `::testing::Invoke()` to mock one of the
+ * `DataClient::PrepareAsync*()` member functions.  The mock returns each
+ * element of @p responses in the `Read()` calls, and @p status in `Finish()`.
+ * Note that the tests must still simulate the completion of each operation.
+ */
+template <typename Response, typename Request>
+std::function<std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>>(
+    grpc::ClientContext*, Request const&, grpc::CompletionQueue*)>
+MakeMockAsyncReader(std::vector<Response> responses, grpc::Status status) {
+  return [responses, status](grpc::ClientContext*, Request const&,
+                             grpc::CompletionQueue*) {
+    using ::testing::_;
+    auto reader = new MockAsyncReader<Response>;
+    EXPECT_CALL(*reader, StartCall(_)).Times(1);
+    auto index = std::make_shared<std::size_t>(0);
+    EXPECT_CALL(*reader, Read(_, _))
+        .WillRepeatedly(::testing::Invoke([responses, index](Response* r,
+                                                             void*) {
+          if (*index < responses.size()) {
+            *r = responses[(*index)++];
+          }
+        }));
+    EXPECT_CALL(*reader, Finish(_, _))
+        .WillOnce(::testing::Invoke(
+            [status](grpc::Status* s, void*) { *s = status; }));
+    return std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>>(reader);
+  };
+}
+
+}  // namespace testing
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_MOCK_ASYNC_RESPONSE_READER_H_
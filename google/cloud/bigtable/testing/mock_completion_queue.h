@@ -0,0 +1,42 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_MOCK_COMPLETION_QUEUE_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_MOCK_COMPLETION_QUEUE_H_
+
+#include "google/cloud/bigtable/completion_queue.h"
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace testing {
+/**
+ * A `CompletionQueueImpl` where the tests control when operations complete.
+ *
+ * The tests never call `Run()` on this queue, instead they call
+ * `SimulateCompletion()` to deliver the results of all the pending operations.
+ */
+class MockCompletionQueue : public bigtable::internal::CompletionQueueImpl {
+ public:
+  using CompletionQueueImpl::empty;
+  using CompletionQueueImpl::SimulateCompletion;
+  using CompletionQueueImpl::size;
+};
+
+}  // namespace testing
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_MOCK_COMPLETION_QUEUE_H_
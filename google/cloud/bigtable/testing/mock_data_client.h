@@ -63,6 +63,39 @@ class MockDataClient : public bigtable::DataClient {
                    google::bigtable::v2::MutateRowsResponse>>(
                    grpc::ClientContext* context,
                    google::bigtable::v2::MutateRowsRequest const& request));
+
+  MOCK_METHOD3(AsyncMutateRow,
+               std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+                   google::bigtable::v2::MutateRowResponse>>(
+                   grpc::ClientContext* context,
+                   google::bigtable::v2::MutateRowRequest const& request,
+                   grpc::CompletionQueue* cq));
+  MOCK_METHOD3(
+      AsyncCheckAndMutateRow,
+      std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+          google::bigtable::v2::CheckAndMutateRowResponse>>(
+          grpc::ClientContext* context,
+          google::bigtable::v2::CheckAndMutateRowRequest const& request,
+          grpc::CompletionQueue* cq));
+  MOCK_METHOD3(
+      AsyncReadModifyWriteRow,
+      std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+          google::bigtable::v2::ReadModifyWriteRowResponse>>(
+          grpc::ClientContext* context,
+          google::bigtable::v2::ReadModifyWriteRowRequest const& request,
+          grpc::CompletionQueue* cq));
+  MOCK_METHOD3(PrepareAsyncReadRows,
+               std::unique_ptr<grpc::ClientAsyncReaderInterface<
+                   google::bigtable::v2::ReadRowsResponse>>(
+                   grpc::ClientContext* context,
+                   google::bigtable::v2::ReadRowsRequest const& request,
+                   grpc::CompletionQueue* cq));
+  MOCK_METHOD3(PrepareAsyncMutateRows,
+               std::unique_ptr<grpc::ClientAsyncReaderInterface<
+                   google::bigtable::v2::MutateRowsResponse>>(
+                   grpc::ClientContext* context,
+                   google::bigtable::v2::MutateRowsRequest const& request,
+                   grpc::CompletionQueue* cq));
 };
 
 }  // namespace testing
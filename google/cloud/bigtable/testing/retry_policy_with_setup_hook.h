@@ -0,0 +1,67 @@
+// Copyright 2018 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_RETRY_POLICY_WITH_SETUP_HOOK_H_
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_RETRY_POLICY_WITH_SETUP_HOOK_H_
+
+#include "google/cloud/bigtable/rpc_retry_policy.h"
+#include <functional>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace bigtable {
+namespace testing {
+/**
+ * A retry policy that calls a test-provided function in `Setup()`.
+ *
+ * The operations call `Setup()` right before they start each attempt, the
+ * tests use the hook to run code (for example, cancel the operation) at that
+ * point.  The hook is shared by all the clones of the policy.  The retry
+ * decisions are delegated to a `LimitedErrorCountRetryPolicy`.
+ */
+class RetryPolicyWithSetupHook : public RPCRetryPolicy {
+ public:
+  explicit RetryPolicyWithSetupHook(int maximum_failures)
+      : hook_(std::make_shared<std::function<void()>>()),
+        impl_(maximum_failures) {}
+
+  /// Set the function called by `Setup()`, in this policy and its clones.
+  void set_hook(std::function<void()> hook) { *hook_ = std::move(hook); }
+
+  std::unique_ptr<RPCRetryPolicy> clone() const override {
+    return std::unique_ptr<RPCRetryPolicy>(
+        new RetryPolicyWithSetupHook(*this));
+  }
+  void Setup(grpc::ClientContext& context) const override {
+    impl_.Setup(context);
+    if (*hook_) {
+      (*hook_)();
+    }
+  }
+  bool OnFailure(grpc::Status const& status) override {
+    return impl_.OnFailure(status);
+  }
+
+ private:
+  std::shared_ptr<std::function<void()>> hook_;
+  LimitedErrorCountRetryPolicy impl_;
+};
+
+}  // namespace testing
+}  // namespace bigtable
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_BIGTABLE_TESTING_RETRY_POLICY_WITH_SETUP_HOOK_H_